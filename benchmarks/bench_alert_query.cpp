@@ -0,0 +1,111 @@
+// /api/alerts queries against the operator UI's alert index (operator_ui/alert_index)
+// as the history grows: the newest page, one node, one node and class, a one-minute
+// time window in the middle of the history, and paging ten pages back with the cursor.
+// JSON encoding and HTTP are left out. The alert file goes to a scratch directory under
+// the system temp dir.
+
+#include "alert_index.hpp"
+#include "bench_util.hpp"
+#include "time.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+constexpr uint64_t kStartMs = 1700000000000ULL;
+constexpr size_t kNodes = 200;
+constexpr size_t kQueries = 2000;
+const char* const kClasses[] = {"LOW", "MEDIUM", "HIGH"};
+
+// Alerts 20 ms apart; node i % kNodes, so each node holds 1/kNodes of the history
+void write_alerts(const std::string& path, size_t count) {
+    std::ofstream f(path, std::ios::trunc);
+    for (size_t i = 0; i < count; ++i) {
+        nlohmann::json a = {{"alert_id", "5f0c6f3e-0000-4000-8000-" + std::to_string(100000000000ULL + i)},
+                            {"event_id", "9a1d2c4b-0000-4000-8000-" + std::to_string(100000000000ULL + i)},
+                            {"source_node_id", "sensor_" + std::to_string(i % kNodes)},
+                            {"timestamp_utc", time::format_utc_ms(kStartMs + i * 20)},
+                            {"monotonic_ns", i * 20000000ULL},
+                            {"classification", kClasses[(i / kNodes) % 3]},
+                            {"processing_latency_ms", 1.5}};
+        f << a.dump() << '\n';
+    }
+}
+
+template <typename Fn>
+void run(const std::string& name, Fn&& fn) {
+    std::vector<uint64_t> latencies;
+    latencies.reserve(kQueries);
+    size_t returned = 0;
+    uint64_t start = time::monotonic_ns();
+    for (size_t i = 0; i < kQueries; ++i) {
+        uint64_t t0 = time::monotonic_ns();
+        returned += fn(i);
+        latencies.push_back(time::monotonic_ns() - t0);
+    }
+    double ns = static_cast<double>(time::monotonic_ns() - start) / kQueries;
+    bench::print_row(name + " (" + std::to_string(returned / kQueries) + ")", ns,
+                     bench::percentiles(std::move(latencies)));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {10000, 100000, 400000};
+    if (argc > 1) sizes = {std::stoul(argv[1])};
+
+    const auto dir = std::filesystem::temp_directory_path() / "bench_alert_query";
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "alerts.jsonl").string();
+
+    for (size_t n : sizes) {
+        write_alerts(path, n);
+        uint64_t t0 = time::monotonic_ns();
+        ui::AlertIndex index({path}, n);
+        double load_ms = static_cast<double>(time::monotonic_ns() - t0) / 1e6;
+        bench::print_header(std::to_string(n) + " alerts in history, loaded in " + std::to_string(load_ms) +
+                            " ms (ns per query, alerts returned)");
+
+        const uint64_t mid_ms = kStartMs + (n / 2) * 20;
+        run("newest 100", [&](size_t) { return index.query({}).alerts.size(); });
+        run("node_id", [&](size_t i) {
+            ui::AlertIndex::Query q;
+            q.node_id = "sensor_" + std::to_string(i % kNodes);
+            return index.query(q).alerts.size();
+        });
+        run("node_id + classification", [&](size_t i) {
+            ui::AlertIndex::Query q;
+            q.node_id = "sensor_" + std::to_string(i % kNodes);
+            q.classification = kClasses[i % 3];
+            return index.query(q).alerts.size();
+        });
+        run("1 min window", [&](size_t) {
+            ui::AlertIndex::Query q;
+            q.since_ms = mid_ms;
+            q.until_ms = mid_ms + 60000;
+            return index.query(q).alerts.size();
+        });
+        run("10 pages back", [&](size_t) {
+            ui::AlertIndex::Query q;
+            size_t total = 0;
+            for (int page = 0; page < 10; ++page) {
+                auto p = index.query(q);
+                total += p.alerts.size();
+                if (!p.next_cursor) break;
+                q.cursor = p.next_cursor;
+            }
+            return total;
+        });
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Stream codec against plain JSON for the three data-link message types: bytes on
+// the wire and encode + decode cost per message. Streams are interleaved across
+// nodes the way the emulator sees them. A second table compares the sender's cost of
+// serializing a typed message (icd_messages.hpp) directly against building the json
+// DOM first, as the sensor used to.
+
+#include "bench_util.hpp"
+#include "icd_messages.hpp"
+#include "stream_codec.hpp"
+#include "time.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+constexpr int kNodes = 50;
+
+std::string fake_uuid(std::mt19937_64& rng) {
+    static const char* kHex = "0123456789abcdef";
+    std::string s;
+    for (int i = 0; i < 32; ++i) {
+        if (i == 8 || i == 12 || i == 16 || i == 20) s.push_back('-');
+        s.push_back(kHex[rng() & 0xF]);
+    }
+    return s;
+}
+
+std::vector<icd::DisturbanceEvent> make_events(size_t count) {
+    std::mt19937_64 rng(1);
+    std::normal_distribution<double> amp(0.4, 0.1);
+    std::vector<icd::DisturbanceEvent> out(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t t_ms = 1700000000000ULL + i * 4;
+        auto& ev = out[i];
+        ev.event_id = fake_uuid(rng);
+        ev.node_id = "sensor_" + std::to_string(i % kNodes);
+        ev.sequence_number = i / kNodes + 1;
+        ev.timestamp_utc = time::format_utc_ms(t_ms);
+        ev.monotonic_ns = t_ms * 1000000ULL;
+        ev.signal_amplitude = amp(rng);
+        ev.signal_energy = amp(rng) * 25.0;
+        ev.event_type = "WALKING";
+        ev.generated_seed = static_cast<uint32_t>(rng());
+    }
+    return out;
+}
+
+std::vector<icd::NodeStatus> make_status(size_t count) {
+    std::vector<icd::NodeStatus> out(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t second = i / kNodes + 1;
+        auto& st = out[i];
+        st.node_id = "sensor_" + std::to_string(i % kNodes);
+        st.timestamp_utc = time::format_utc_ms(1700000000000ULL + second * 1000);
+        st.monotonic_ns = second * 1000000000ULL;
+        st.uptime_s = static_cast<double>(second);
+        st.last_sequence_number = second * 5;
+        st.bytes_sent = second * 1500;
+    }
+    return out;
+}
+
+template <typename M>
+std::vector<nlohmann::json> to_dom(const std::vector<M>& msgs) {
+    return std::vector<nlohmann::json>(msgs.begin(), msgs.end());
+}
+
+std::vector<nlohmann::json> make_blocks(size_t count) {
+    std::mt19937 rng(2);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    const size_t n = 200;
+    std::vector<nlohmann::json> out;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t block = i / kNodes;
+        nlohmann::json samples = nlohmann::json::array();
+        std::vector<int16_t> ch(n);
+        for (int c = 0; c < 2; ++c) {
+            for (size_t k = 0; k < n; ++k) {
+                double t = (block * n + k) / 2000.0;
+                float x = noise(rng) + ((block / 20) % 2 ? 0.3f * static_cast<float>(std::sin(2 * 3.14159265 * 40.0 * (c + 1) * t)) : 0.0f);
+                ch[k] = static_cast<int16_t>(std::lround(x * 32767.0f));
+            }
+            samples.push_back(ch);
+        }
+        out.push_back({
+            {"msg_type", "WaveformBlock"},
+            {"node_id", "sensor_" + std::to_string(i % kNodes)},
+            {"block_sequence", block + 1},
+            {"timestamp_utc", time::format_utc_ms(1700000000000ULL + block * 100)},
+            {"monotonic_ns", block * 100000000ULL},
+            {"sample_rate_hz", 2000},
+            {"first_sample", block * n},
+            {"scale", 1.0 / 32767.0},
+            {"samples", std::move(samples)}
+        });
+    }
+    return out;
+}
+
+void run(const char* name, const std::vector<nlohmann::json>& msgs, int keyframe_interval) {
+    size_t json_bytes = 0;
+    uint64_t start = time::monotonic_ns();
+    for (const auto& m : msgs) {
+        std::string s = m.dump() + "\n";
+        json_bytes += s.size();
+        auto back = nlohmann::json::parse(s);
+        (void)back;
+    }
+    double json_ns = static_cast<double>(time::monotonic_ns() - start) / msgs.size();
+
+    codec::StreamEncoder enc("bench_encode", keyframe_interval);
+    codec::StreamDecoder dec("bench_decode");
+    size_t frame_bytes = 0;
+    size_t mismatches = 0;
+    start = time::monotonic_ns();
+    for (const auto& m : msgs) {
+        std::string f = enc.encode(m);
+        frame_bytes += f.size();
+        auto back = dec.decode(f.data(), f.size());
+        if (!back) ++mismatches;
+    }
+    double codec_ns = static_cast<double>(time::monotonic_ns() - start) / msgs.size();
+
+    std::printf("%-18s json %6.1f B/msg %8.1f ns/msg   codec %6.1f B/msg %8.1f ns/msg   ratio %.2fx%s\n",
+                name,
+                static_cast<double>(json_bytes) / msgs.size(), json_ns,
+                static_cast<double>(frame_bytes) / msgs.size(), codec_ns,
+                static_cast<double>(json_bytes) / frame_bytes,
+                mismatches ? "   DECODE FAILURES" : "");
+}
+
+// Sender side only: typed message -> wire bytes, with and without a json DOM in between
+template <typename M>
+void run_typed(const char* name, const std::vector<M>& msgs, int keyframe_interval) {
+    auto per_msg = [&](uint64_t start) { return static_cast<double>(time::monotonic_ns() - start) / msgs.size(); };
+    volatile size_t sink = 0;
+
+    uint64_t start = time::monotonic_ns();
+    for (const auto& m : msgs) sink = sink + nlohmann::json(m).dump().size();
+    double dom_dump_ns = per_msg(start);
+
+    start = time::monotonic_ns();
+    for (const auto& m : msgs) sink = sink + icd::dump(m).size();
+    double typed_dump_ns = per_msg(start);
+
+    codec::StreamEncoder dom_enc("bench_encode_dom", keyframe_interval);
+    start = time::monotonic_ns();
+    for (const auto& m : msgs) sink = sink + dom_enc.encode(nlohmann::json(m)).size();
+    double dom_encode_ns = per_msg(start);
+
+    codec::StreamEncoder typed_enc("bench_encode_typed", keyframe_interval);
+    start = time::monotonic_ns();
+    for (const auto& m : msgs) sink = sink + typed_enc.encode(m).size();
+    double typed_encode_ns = per_msg(start);
+
+    std::printf("%-18s json: DOM %8.1f ns/msg  typed %8.1f ns/msg   codec: DOM %8.1f ns/msg  typed %8.1f ns/msg\n",
+                name, dom_dump_ns, typed_dump_ns, dom_encode_ns, typed_encode_ns);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int keyframe_interval = 32;
+    if (argc > 1) keyframe_interval = std::stoi(argv[1]);
+
+    bench::print_header("stream codec vs JSON, encode + decode (keyframe every " +
+                        std::to_string(keyframe_interval) + " frames)");
+    auto events = make_events(50000);
+    auto status = make_status(50000);
+    run("DisturbanceEvent", to_dom(events), keyframe_interval);
+    run("NodeStatus", to_dom(status), keyframe_interval);
+    run("WaveformBlock", make_blocks(5000), keyframe_interval);
+
+    bench::print_header("sender serialization of typed messages, via json DOM vs direct");
+    run_typed("DisturbanceEvent", events, keyframe_interval);
+    run_typed("NodeStatus", status, keyframe_interval);
+    return 0;
+}
@@ -0,0 +1,124 @@
+// The caller's side of the file output paths (common/async_file, common/segmented_file)
+// under each aio backend: a component log line flushed per line, a group-committed
+// alert batch with fdatasync, and a central_state.json replacement. The backend is
+// process-wide, so each one runs in a child process. Files go to a scratch directory
+// under the system temp dir.
+
+#include "async_file.hpp"
+#include "bench_util.hpp"
+#include "segmented_file.hpp"
+#include "time.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace surveillance;
+
+namespace {
+
+// Roughly an info line from the processing thread, and a 64-alert commit
+constexpr size_t kLineBytes = 220;
+constexpr size_t kBatchBytes = 64 * 330;
+// central_state.json of a few hundred nodes with its histograms
+constexpr size_t kStateBytes = 256 * 1024;
+
+void run_backend(const std::string& dir, const std::string& name, size_t lines) {
+    config::IoConfig io;
+    io.backend = name;
+    aio::Backend backend = aio::configure(io);
+    const std::string label = aio::backend_name(backend);
+
+    {
+        // As logging's sink: buffered, flushed after every line (logging.flush_every_n 1)
+        segments::SegmentedFile log(dir + "/log_" + label + ".jsonl", config::RotationConfig{}, true);
+        std::string line(kLineBytes - 1, 'x');
+        line += '\n';
+        std::vector<uint64_t> latencies;
+        latencies.reserve(lines);
+        uint64_t start = time::monotonic_ns();
+        for (size_t i = 0; i < lines; ++i) {
+            uint64_t t0 = time::monotonic_ns();
+            log.write(line.data(), line.size());
+            log.flush();
+            latencies.push_back(time::monotonic_ns() - t0);
+        }
+        double ns_per_line = static_cast<double>(time::monotonic_ns() - start) / lines;
+        log.close();
+        bench::print_row(label + "  log line", ns_per_line, bench::percentiles(std::move(latencies)));
+    }
+
+    {
+        // As the alert writer with central.alert_sync: the commit waits for write + fdatasync
+        segments::SegmentedFile alerts(dir + "/alerts_" + label + ".jsonl", config::RotationConfig{});
+        std::string batch(kBatchBytes - 1, 'a');
+        batch += '\n';
+        const size_t batches = 500;
+        std::vector<uint64_t> latencies;
+        uint64_t start = time::monotonic_ns();
+        for (size_t i = 0; i < batches; ++i) {
+            uint64_t t0 = time::monotonic_ns();
+            alerts.write(batch.data(), batch.size());
+            alerts.sync();
+            latencies.push_back(time::monotonic_ns() - t0);
+        }
+        double ns_per_batch = static_cast<double>(time::monotonic_ns() - start) / batches;
+        alerts.close();
+        bench::print_row(label + "  alert batch + sync", ns_per_batch, bench::percentiles(std::move(latencies)));
+    }
+
+    {
+        // As write_state_loop: one replacement per second in central, back to back here
+        const std::string state(kStateBytes, 's');
+        const size_t replacements = 2000;
+        std::vector<uint64_t> latencies;
+        uint64_t caller_ns = 0;
+        for (size_t i = 0; i < replacements; ++i) {
+            std::string copy = state; // the caller builds a fresh string each time
+            uint64_t t0 = time::monotonic_ns();
+            aio::replace_file(dir + "/state_" + label + ".json", std::move(copy));
+            latencies.push_back(time::monotonic_ns() - t0);
+            caller_ns += latencies.back();
+        }
+        aio::drain_replacements();
+        bench::print_row(label + "  state replace", static_cast<double>(caller_ns) / replacements,
+                         bench::percentiles(std::move(latencies)));
+    }
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t lines = 200000;
+    if (argc > 1) lines = std::stoul(argv[1]);
+
+    const auto dir = std::filesystem::temp_directory_path() / "bench_file_sink";
+    std::filesystem::create_directories(dir);
+
+    bench::print_header("caller's cost per operation (" + std::to_string(lines) + " log lines, " +
+                        std::to_string(kBatchBytes / 1024) + " KiB alert batches, " +
+                        std::to_string(kStateBytes / 1024) + " KiB state file)");
+#if defined(_WIN32)
+    run_backend(dir.string(), "sync", lines);
+#else
+    std::fflush(stdout); // or each child prints the header again
+    for (const char* backend : {"sync", "threads", "io_uring"}) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_backend(dir.string(), backend, lines);
+            std::_Exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+    }
+#endif
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
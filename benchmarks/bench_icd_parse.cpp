@@ -0,0 +1,180 @@
+// Per-message parse cost of central's ingress: the schema-specific ICD parser
+// (common/icd_parser) against nlohmann::json::parse plus the field lookups central
+// used to do on the DOM. Counts heap allocations per message with a replaced
+// global operator new.
+
+#include "bench_util.hpp"
+#include "icd_parser.hpp"
+#include "time.hpp"
+
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace surveillance;
+
+namespace {
+
+constexpr int kNodes = 50;
+
+std::string fake_uuid(std::mt19937_64& rng) {
+    static const char* kHex = "0123456789abcdef";
+    std::string s;
+    for (int i = 0; i < 32; ++i) {
+        if (i == 8 || i == 12 || i == 16 || i == 20) s.push_back('-');
+        s.push_back(kHex[rng() & 0xF]);
+    }
+    return s;
+}
+
+std::vector<std::string> make_events(size_t count) {
+    std::mt19937_64 rng(1);
+    std::normal_distribution<double> amp(0.4, 0.1);
+    std::vector<std::string> out;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t t_ms = 1700000000000ULL + i * 4;
+        uint64_t t_ns = t_ms * 1000000ULL;
+        out.push_back(nlohmann::json{
+            {"msg_type", "DisturbanceEvent"},
+            {"event_id", fake_uuid(rng)},
+            {"node_id", "sensor_" + std::to_string(i % kNodes)},
+            {"sequence_number", i / kNodes + 1},
+            {"timestamp_utc", time::format_utc_ms(t_ms)},
+            {"monotonic_ns", t_ns},
+            {"signal_amplitude", amp(rng)},
+            {"signal_energy", amp(rng) * 25.0},
+            {"event_type", "WALKING"},
+            {"generated_seed", static_cast<uint32_t>(rng())},
+            {"hops", {t_ns + 1000, t_ns + 60000, t_ns + 2000000}}
+        }.dump() + "\n");
+    }
+    return out;
+}
+
+std::vector<std::string> make_status(size_t count) {
+    std::vector<std::string> out;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t second = i / kNodes + 1;
+        out.push_back(nlohmann::json{
+            {"msg_type", "NodeStatus"},
+            {"node_id", "sensor_" + std::to_string(i % kNodes)},
+            {"timestamp_utc", time::format_utc_ms(1700000000000ULL + second * 1000)},
+            {"monotonic_ns", second * 1000000000ULL},
+            {"health", "OK"},
+            {"uptime_s", static_cast<double>(second)},
+            {"last_sequence_number", second * 5},
+            {"bytes_sent", second * 1500}
+        }.dump() + "\n");
+    }
+    return out;
+}
+
+// What central read from the DOM per message before the ICD parser: admission
+// fields on the receive thread, then the handler's fields
+double dom_fields(const nlohmann::json& msg) {
+    double sum = 0.0;
+    std::string type = msg.value("msg_type", "");
+    if (type == "DisturbanceEvent") {
+        sum += msg.value("signal_amplitude", 0.0) + msg.value("signal_energy", 0.0);
+        sum += static_cast<double>(msg.value("event_type", "").size() + msg.value("timestamp_utc", "").size());
+        sum += static_cast<double>(msg.value("monotonic_ns", 0ULL));
+        sum += static_cast<double>(msg["event_id"].get_ref<const std::string&>().size());
+        sum += static_cast<double>(msg["node_id"].get_ref<const std::string&>().size());
+        for (const auto& stamp : msg["hops"]) sum += static_cast<double>(stamp.get<uint64_t>());
+    } else {
+        sum += static_cast<double>(msg.value("node_id", "").size() + msg.value("health", "").size());
+        sum += msg.value("uptime_s", 0.0) + static_cast<double>(msg.value("last_sequence_number", 0ULL));
+        sum += static_cast<double>(msg.value("bytes_sent", 0ULL) + msg.value("edge_triggers", 0ULL));
+    }
+    return sum;
+}
+
+double view_fields(const icd::MessageView& v) {
+    double sum = v.signal_amplitude + v.signal_energy + v.uptime_s;
+    sum += static_cast<double>(v.event_type.size() + v.timestamp_utc.size() + v.event_id.size() + v.node_id.size());
+    sum += static_cast<double>(v.monotonic_ns + v.last_sequence_number + v.bytes_sent + v.edge_triggers);
+    for (uint64_t stamp : v.hops) sum += static_cast<double>(stamp);
+    return sum;
+}
+
+template <typename Fn>
+void measure(const std::string& name, const std::vector<std::string>& frames, Fn&& parse_one) {
+    std::vector<uint64_t> per_msg;
+    per_msg.reserve(frames.size());
+    size_t failures = 0;
+
+    uint64_t allocs_before = g_allocations.load(std::memory_order_relaxed);
+    uint64_t start = time::monotonic_ns();
+    for (const auto& f : frames) {
+        if (!parse_one(f)) ++failures;
+    }
+    uint64_t elapsed = time::monotonic_ns() - start;
+    uint64_t allocs = g_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+    for (const auto& f : frames) {
+        uint64_t t0 = time::monotonic_ns();
+        parse_one(f);
+        per_msg.push_back(time::monotonic_ns() - t0);
+    }
+
+    bench::print_row(name, static_cast<double>(elapsed) / frames.size(), bench::percentiles(std::move(per_msg)));
+    std::printf("%-28s %10.2f allocations/msg%s\n", "",
+                static_cast<double>(allocs) / frames.size(), failures ? "   PARSE FAILURES" : "");
+}
+
+void run(const char* type, const std::vector<std::string>& frames) {
+    volatile double sink = 0.0;
+    bench::print_header(std::string(type) + ", " + std::to_string(frames.size()) + " frames");
+    measure("nlohmann parse + lookups", frames, [&](const std::string& f) {
+        auto msg = nlohmann::json::parse(f, nullptr, false);
+        if (msg.is_discarded()) return false;
+        sink = sink + dom_fields(msg);
+        return true;
+    });
+    measure("icd::parse", frames, [&](const std::string& f) {
+        icd::MessageView view;
+        if (icd::parse(f, view) != icd::ParseError::NONE) return false;
+        sink = sink + view_fields(view);
+        return true;
+    });
+}
+
+} // namespace
+
+int main() {
+    auto events = make_events(100000);
+    auto status = make_status(100000);
+    run("DisturbanceEvent", events);
+    run("NodeStatus", status);
+
+    // Rejection cost: the same events with a required field removed
+    std::vector<std::string> broken;
+    for (size_t i = 0; i < 20000; ++i) {
+        std::string f = events[i];
+        f.replace(f.find("\"signal_energy\""), 15, "\"signal_enerxy\"");
+        broken.push_back(std::move(f));
+    }
+    bench::print_header("DisturbanceEvent missing signal_energy, " + std::to_string(broken.size()) + " frames");
+    measure("icd::parse (rejected)", broken, [](const std::string& f) {
+        icd::MessageView view;
+        return icd::parse(f, view) == icd::ParseError::MISSING_FIELD;
+    });
+    return 0;
+}
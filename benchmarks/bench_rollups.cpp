@@ -0,0 +1,68 @@
+// Central's time-series rollups (central_processor/rollups): the processing thread's
+// cost of recording one event, and the state writer's cost of snapshotting the rings
+// into central_timeseries.json, for fleets of 50 and 500 nodes.
+
+#include "bench_util.hpp"
+#include "icd_messages.hpp"
+#include "rollups.hpp"
+#include "time.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+using namespace surveillance::central;
+
+namespace {
+
+constexpr uint64_t kStartMs = 1700000000000ULL;
+
+void run_fleet(size_t nodes, size_t events) {
+    Rollups rollups(nodes);
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < nodes; ++i) ids.push_back("sensor_" + std::to_string(i));
+    std::vector<uint64_t> sequence(nodes, 0);
+
+    // 2000 events per simulated second across the fleet, one in 50 after a lost one
+    std::vector<uint64_t> latencies;
+    latencies.reserve(events);
+    uint64_t start = time::monotonic_ns();
+    for (size_t i = 0; i < events; ++i) {
+        const size_t n = i % nodes;
+        sequence[n] += (i % 50 == 0) ? 2 : 1;
+        const uint64_t utc_ms = kStartMs + i / 2;
+        const double latency_ms = 0.5 + static_cast<double>(i % 97) * 0.25;
+        uint64_t t0 = time::monotonic_ns();
+        rollups.record(ids[n], utc_ms, sequence[n], icd::kClassifications[i % 3], latency_ms);
+        latencies.push_back(time::monotonic_ns() - t0);
+    }
+    double ns_per_event = static_cast<double>(time::monotonic_ns() - start) / events;
+    bench::print_row(std::to_string(nodes) + " nodes  record", ns_per_event, bench::percentiles(std::move(latencies)));
+
+    // As write_state_loop, once a second
+    const size_t snapshots = 50;
+    std::vector<uint64_t> snapshot_ns;
+    size_t bytes = 0;
+    for (size_t i = 0; i < snapshots; ++i) {
+        uint64_t t0 = time::monotonic_ns();
+        bytes = rollups.to_json(0).dump().size();
+        snapshot_ns.push_back(time::monotonic_ns() - t0);
+    }
+    auto p = bench::percentiles(snapshot_ns);
+    std::printf("%-28s %10.1f ms/snapshot  (%zu KiB)\n", (std::to_string(nodes) + " nodes  snapshot").c_str(),
+                p.p50 / 1e6, bytes / 1024);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t events = 2000000;
+    if (argc > 1) events = std::stoul(argv[1]);
+
+    bench::print_header("rollups: " + std::to_string(events) + " events over " + std::to_string(events / 2000) +
+                        " simulated seconds");
+    run_fleet(50, events);
+    run_fleet(500, events);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Wakeup jitter of an idle-polling loop (central's receive and process threads, the
+// emulator's ingress and egress) under the runtime profiles of common/runtime: the
+// default 1 ms sleep, busy polling, and busy polling pinned to a core, with and without
+// SCHED_FIFO. A paced producer hands timestamped items over an SPSC ring; latency is
+// from the push to the consumer seeing the item, and the consumer's CPU use is what
+// the profile costs.
+//
+// Usage: bench_runtime_jitter [messages] [consumer_cpu] [producer_cpu]
+// The cores default to the last two; the pinned runs need two cores, and SCHED_FIFO
+// needs CAP_SYS_NICE (the run says when it did not get it).
+
+#include "bench_util.hpp"
+#include "runtime.hpp"
+#include "spsc_ring.hpp"
+#include "time.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace surveillance;
+
+namespace {
+
+constexpr uint64_t kPaceNs = 50000; // one item per 50 us
+
+uint64_t thread_cpu_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void run(const std::string& name, const config::RuntimeConfig& profile, size_t n) {
+    runtime::configure(profile, "bench");
+    spsc::Ring<uint64_t> ring(1 << 14);
+    std::vector<uint64_t> latencies;
+    latencies.reserve(n);
+    std::atomic<bool> ready{false};
+    uint64_t consumer_cpu_ns = 0;
+    int policy = SCHED_OTHER;
+
+    std::thread consumer([&] {
+        runtime::enter_thread("consumer");
+        sched_param param{};
+        pthread_getschedparam(pthread_self(), &policy, &param);
+        ready = true;
+        const uint64_t cpu_start = thread_cpu_ns();
+        size_t received = 0;
+        while (received < n) {
+            if (auto stamp = ring.try_pop()) {
+                latencies.push_back(time::monotonic_ns() - *stamp);
+                ++received;
+                continue;
+            }
+            runtime::idle(std::chrono::milliseconds(1));
+        }
+        consumer_cpu_ns = thread_cpu_ns() - cpu_start;
+    });
+
+    runtime::enter_thread("producer");
+    while (!ready) {
+        std::this_thread::yield();
+    }
+    const uint64_t start = time::monotonic_ns();
+    uint64_t next = start;
+    for (size_t i = 0; i < n; ++i) {
+        next += kPaceNs;
+        bench::spin_until(next);
+        while (!ring.try_push(time::monotonic_ns())) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    const uint64_t wall_ns = time::monotonic_ns() - start;
+
+    bench::print_row(name, 0, bench::percentiles(std::move(latencies)));
+    std::printf("%-28s consumer CPU %5.1f%%%s\n", "", 100.0 * consumer_cpu_ns / wall_ns,
+                profile.sched_fifo_priority > 0 && policy != SCHED_FIFO ? "  (SCHED_FIFO refused, ran SCHED_OTHER)" : "");
+    // The producer thread is this one; put it back for the next run
+    sched_param other{};
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &other);
+    cpu_set_t all;
+    CPU_ZERO(&all);
+    for (long c = 0; c < sysconf(_SC_NPROCESSORS_ONLN); ++c) CPU_SET(c, &all);
+    pthread_setaffinity_np(pthread_self(), sizeof(all), &all);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = 20000;
+    if (argc > 1) n = std::stoul(argv[1]);
+    const int cores = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    int consumer_cpu = argc > 2 ? std::stoi(argv[2]) : cores - 1;
+    int producer_cpu = argc > 3 ? std::stoi(argv[3]) : cores - 2;
+
+    bench::print_header("idle-loop wakeup, 1 item / " + std::to_string(kPaceNs / 1000) + " us (" +
+                        std::to_string(n) + " items)");
+
+    config::RuntimeConfig profile;
+    run("sleep 1 ms (no profile)", profile, n);
+
+    profile.threads["bench.consumer"].busy_poll = true;
+    run("busy poll", profile, n);
+
+    if (consumer_cpu < 0 || producer_cpu < 0 || consumer_cpu == producer_cpu) {
+        std::printf("%-28s skipped: needs two cores (%d online)\n", "busy poll + pinned", cores);
+        return 0;
+    }
+    profile.threads["bench.consumer"].cpu = consumer_cpu;
+    profile.threads["bench.producer"].cpu = producer_cpu;
+    run("busy poll + pinned", profile, n);
+
+    profile.sched_fifo_priority = 50;
+    run("busy poll + pinned + FIFO", profile, n);
+    return 0;
+}
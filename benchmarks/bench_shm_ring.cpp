@@ -0,0 +1,95 @@
+// The shared-memory data link (common/shm_ring) with one and several producer
+// threads against one consumer. Reports per-message cost under saturating producers
+// and one-way latency with paced ones, for comparison with bench_transport. Producers
+// are threads here; across processes the ring behaves the same, since the segment is
+// mapped by each side and nothing goes through the kernel on the data path.
+
+#include "bench_util.hpp"
+#include "shm_ring.hpp"
+#include "time.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+// About the size of a DisturbanceEvent on the wire, uncompressed
+constexpr size_t kPayloadBytes = 320;
+constexpr size_t kRingBytes = 16 << 20;
+
+// pace_ns == 0 saturates the ring; otherwise each producer sends one message per pace_ns.
+void run(int producers, size_t n, uint64_t pace_ns) {
+    const std::string endpoint = "shm://surveillance.bench_shm_ring";
+    shm::RingConsumer consumer(endpoint, kRingBytes, "bench");
+    std::atomic<bool> running{true};
+
+    const size_t per_producer = n / producers;
+    const size_t total = per_producer * producers;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            shm::RingProducer producer(endpoint, "bench");
+            producer.wait_for_consumer(std::chrono::seconds(5), running);
+            std::string payload(kPayloadBytes, 'x');
+            uint64_t next = time::monotonic_ns();
+            for (size_t i = 0; i < per_producer; ++i) {
+                if (pace_ns) {
+                    next += pace_ns;
+                    bench::spin_until(next);
+                }
+                uint64_t stamp_ns = time::monotonic_ns();
+                std::memcpy(payload.data(), &stamp_ns, sizeof(stamp_ns));
+                // A full ring drops; retry so every message is measured
+                while (!producer.send(payload)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve(total);
+    uint64_t start = time::monotonic_ns();
+    while (latencies.size() < total) {
+        auto frame = consumer.peek();
+        if (!frame) {
+            consumer.wait(std::chrono::milliseconds(1));
+            continue;
+        }
+        uint64_t stamp_ns;
+        std::memcpy(&stamp_ns, frame->data(), sizeof(stamp_ns));
+        latencies.push_back(time::monotonic_ns() - stamp_ns);
+        consumer.pop();
+    }
+    uint64_t elapsed = time::monotonic_ns() - start;
+    for (auto& t : threads) t.join();
+
+    shm::RingStats stats = consumer.stats();
+    double ns_per_msg = pace_ns ? 0.0 : static_cast<double>(elapsed) / total;
+    bench::print_row(std::to_string(producers) + " producer(s), hw " + std::to_string(stats.high_watermark_bytes >> 10) + " KiB",
+                     ns_per_msg, bench::percentiles(std::move(latencies)));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = 2000000;
+    if (argc > 1) n = std::stoul(argv[1]);
+
+    bench::print_header("saturated ring, " + std::to_string(kPayloadBytes) + " B msgs (" + std::to_string(n) + " msgs)");
+    for (int producers : {1, 4}) {
+        run(producers, n, 0);
+    }
+
+    size_t paced = std::min<size_t>(n, 100000);
+    bench::print_header("paced ring, 1 msg / 20 us per producer (" + std::to_string(paced) + " msgs)");
+    for (int producers : {1, 4}) {
+        run(producers, paced, 20000);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+// The same XPUB -> SUB link the components use (zmq_utils) over each transport
+// (common/transport): tcp on loopback, ipc and inproc. Reports per-message cost under
+// a saturating publisher and one-way latency with a paced publisher. Both ends share
+// a process here; for tcp and ipc that still goes through the kernel, as it does
+// between the real components.
+
+#include "bench_util.hpp"
+#include "time.hpp"
+#include "transport.hpp"
+#include "zmq_utils.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+// About the size of a DisturbanceEvent on the wire, uncompressed
+constexpr size_t kPayloadBytes = 320;
+// Messages in flight; well under the sockets' 10000 high-water mark, so XPUB never drops
+constexpr size_t kWindow = 4096;
+
+// pace_ns == 0 saturates the link; otherwise one message per pace_ns.
+void run(zmq::context_t& ctx, const config::TransportConfig& t, size_t n, uint64_t pace_ns) {
+    const std::string endpoint = transport::endpoint(t, transport::Link::CENTRAL_FEED);
+    auto pub = zmq_utils::create_publisher(ctx, endpoint, true);
+    auto sub = zmq_utils::create_subscriber(ctx, endpoint, false);
+    std::atomic<bool> running{true};
+    if (!zmq_utils::wait_for_subscriber(pub, std::chrono::seconds(5), running)) {
+        std::printf("%-28s no subscriber on %s\n", t.kind.c_str(), endpoint.c_str());
+        return;
+    }
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve(n);
+    std::atomic<size_t> received{0};
+
+    std::thread consumer([&] {
+        zmq::message_t msg;
+        while (received.load(std::memory_order_relaxed) < n) {
+            if (!zmq_utils::receive_frame(sub, msg, true)) continue;
+            uint64_t stamp_ns;
+            std::memcpy(&stamp_ns, msg.data(), sizeof(stamp_ns));
+            latencies.push_back(time::monotonic_ns() - stamp_ns);
+            received.fetch_add(1, std::memory_order_release);
+        }
+    });
+
+    std::string payload(kPayloadBytes, 'x');
+    uint64_t start = time::monotonic_ns();
+    uint64_t next = start;
+    for (size_t i = 0; i < n; ++i) {
+        if (pace_ns) {
+            next += pace_ns;
+            bench::spin_until(next);
+        }
+        while (i - received.load(std::memory_order_acquire) >= kWindow) {
+            std::this_thread::yield();
+        }
+        uint64_t stamp_ns = time::monotonic_ns();
+        std::memcpy(payload.data(), &stamp_ns, sizeof(stamp_ns));
+        zmq_utils::publish_string(pub, payload);
+    }
+    consumer.join();
+    uint64_t elapsed = time::monotonic_ns() - start;
+
+    double ns_per_msg = pace_ns ? 0.0 : static_cast<double>(elapsed) / n;
+    bench::print_row(t.kind + "  " + endpoint, ns_per_msg, bench::percentiles(std::move(latencies)));
+}
+
+void run_all(zmq::context_t& ctx, const config::TransportConfig& base, size_t n, uint64_t pace_ns) {
+    for (const char* kind : {"tcp", "ipc", "inproc"}) {
+        config::TransportConfig t = base;
+        t.kind = kind;
+        run(ctx, t, n, pace_ns);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = 500000;
+    if (argc > 1) n = std::stoul(argv[1]);
+
+    // Off the default ports and ipc_dir, so a running cluster does not get in the way
+    config::TransportConfig base;
+    base.base_port = 27000;
+    base.ipc_dir = (std::filesystem::temp_directory_path() / "bench_transport").string();
+
+    zmq::context_t ctx(1);
+
+    bench::print_header("saturated link, " + std::to_string(kPayloadBytes) + " B msgs (" + std::to_string(n) + " msgs)");
+    run_all(ctx, base, n, 0);
+
+    size_t paced = std::min<size_t>(n, 100000);
+    bench::print_header("paced link, 1 msg / 20 us (" + std::to_string(paced) + " msgs)");
+    run_all(ctx, base, paced, 20000);
+
+    std::filesystem::remove_all(base.ipc_dir);
+    return 0;
+}
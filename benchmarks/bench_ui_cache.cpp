@@ -0,0 +1,119 @@
+// The operator UI's per-request cost for /api/status (operator_ui/response_cache):
+// reading central_state.json on every request as the handler used to, a 304 to a
+// poll that names the current ETag, a gzip 200 from memory, and the first request
+// after the file changed, which rebuilds and compresses it. HTTP parsing and the
+// socket are left out. The state file goes to a scratch directory under the system
+// temp dir.
+
+#include "bench_util.hpp"
+#include "response_cache.hpp"
+#include "time.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+// Shaped like central_state.json, with `nodes` node entries
+std::string make_state(size_t nodes, uint64_t tick) {
+    nlohmann::json st;
+    st["timestamp_utc"] = time::format_utc_ms(1700000000000ULL + tick);
+    for (size_t i = 0; i < nodes; ++i) {
+        st["nodes"]["sensor_" + std::to_string(i)] = {{"health", "OK"},
+                                                      {"uptime_s", 3600.0 + i + tick},
+                                                      {"last_sequence_number", 1000 + i + tick},
+                                                      {"bytes_sent", 1000000 + i * 17 + tick}};
+    }
+    st["metrics"] = {{"central.events_received", 123456 + tick}, {"central.alerts_emitted", 789}};
+    return st.dump();
+}
+
+void write_file(const std::string& path, const std::string& data) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << data;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+template <typename Fn>
+void run(const std::string& name, size_t iterations, Fn&& fn) {
+    std::vector<uint64_t> latencies;
+    latencies.reserve(iterations);
+    uint64_t start = time::monotonic_ns();
+    for (size_t i = 0; i < iterations; ++i) {
+        uint64_t t0 = time::monotonic_ns();
+        fn(i);
+        latencies.push_back(time::monotonic_ns() - t0);
+    }
+    double ns = static_cast<double>(time::monotonic_ns() - start) / iterations;
+    bench::print_row(name, ns, bench::percentiles(std::move(latencies)));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t requests = 20000;
+    if (argc > 1) requests = std::stoul(argv[1]);
+
+    const auto dir = std::filesystem::temp_directory_path() / "bench_ui_cache";
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "central_state.json").string();
+    write_file(path, make_state(1000, 0));
+
+    ui::ResponseCache cache(1024);
+    cache.add("/api/status", "application/json", {path}, [&] { return read_file(path); });
+    const std::string gzip = "gzip, deflate, br";
+
+    auto first = cache.get("/api/status", "", "", gzip);
+    std::string etag;
+    for (auto& [name, value] : first.headers) {
+        if (name == "ETag") etag = value;
+    }
+    const size_t identity_bytes = read_file(path).size();
+    bench::print_header("/api/status, " + std::to_string(identity_bytes / 1024) + " KiB state, " +
+                        std::to_string(first.body->size() / 1024) + " KiB gzipped (" + std::to_string(requests) +
+                        " requests)");
+
+    size_t sink = 0;
+    run("read per request", requests, [&](size_t) { sink += read_file(path).size(); });
+    run("cached 304", requests, [&](size_t) { sink += cache.get("/api/status", etag, "", gzip).status; });
+    run("cached 200 gzip", requests, [&](size_t) { sink += cache.get("/api/status", "", "", gzip).body->size(); });
+    run("cached 200 identity", requests, [&](size_t) { sink += cache.get("/api/status", "", "", "").body->size(); });
+
+    // Central rewrites the file about once a second; only the first poll after that pays
+    const size_t rewrites = std::min<size_t>(requests, 500);
+    std::vector<std::string> states;
+    for (size_t i = 0; i < rewrites; ++i) states.push_back(make_state(1000, i + 1));
+    std::vector<uint64_t> latencies;
+    uint64_t total = 0;
+    for (size_t i = 0; i < rewrites; ++i) {
+        write_file(path, states[i]);
+        uint64_t t0 = time::monotonic_ns();
+        sink += cache.get("/api/status", etag, "", gzip).status;
+        latencies.push_back(time::monotonic_ns() - t0);
+        total += latencies.back();
+    }
+    bench::print_row("rebuild after change", static_cast<double>(total) / rewrites,
+                     bench::percentiles(std::move(latencies)));
+
+    auto st = cache.stats();
+    std::printf("builds=%llu not_modified=%llu gzip_replies=%llu (sink %zu)\n",
+                static_cast<unsigned long long>(st.builds), static_cast<unsigned long long>(st.not_modified),
+                static_cast<unsigned long long>(st.gzip_replies), sink);
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "time.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace surveillance {
+namespace bench {
+
+struct Percentiles {
+    double p50;
+    double p99;
+    double p999;
+    double max;
+};
+
+inline Percentiles percentiles(std::vector<uint64_t> samples) {
+    if (samples.empty()) return {0, 0, 0, 0};
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        size_t idx = std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()));
+        return static_cast<double>(samples[idx]);
+    };
+    return {at(0.50), at(0.99), at(0.999), static_cast<double>(samples.back())};
+}
+
+inline void print_header(const std::string& title) {
+    std::printf("\n== %s ==\n", title.c_str());
+}
+
+// ns_per_msg <= 0 means the run was paced and has no meaningful throughput cost
+inline void print_row(const std::string& name, double ns_per_msg, const Percentiles& lat) {
+    if (ns_per_msg > 0) {
+        std::printf("%-28s %10.1f ns/msg", name.c_str(), ns_per_msg);
+    } else {
+        std::printf("%-28s %10s       ", name.c_str(), "paced");
+    }
+    std::printf("   latency ns p50=%-8.0f p99=%-8.0f p99.9=%-8.0f max=%.0f\n",
+                lat.p50, lat.p99, lat.p999, lat.max);
+}
+
+// Busy-wait so that paced producers are not at the mercy of sleep granularity
+inline void spin_until(uint64_t deadline_ns) {
+    while (time::monotonic_ns() < deadline_ns) {
+    }
+}
+
+} // namespace bench
+} // namespace surveillance
@@ -4,13 +4,14 @@ set -e
 DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
 PROJECT_ROOT="$(dirname "$DIR")"
 BUILD_DIR="${PROJECT_ROOT}/build/release"
-CONFIG_PATH="${PROJECT_ROOT}/config/system_nominal.json"
+CONFIG_PATH="${1:-${PROJECT_ROOT}/config/system_nominal.json}"
 STATIC_DIR="${PROJECT_ROOT}/src/operator_ui/static"
+LOG_DIR="${PROJECT_ROOT}/run_logs"
 
 echo "Using config: $CONFIG_PATH"
 
-mkdir -p "${PROJECT_ROOT}/run_logs"
-rm -f "${PROJECT_ROOT}/run_logs/"*
+mkdir -p "${LOG_DIR}"
+rm -f "${LOG_DIR}/"*
 
 # Array to keep track of PIDs
 PIDS=()
@@ -25,27 +26,70 @@ function cleanup() {
 
 trap cleanup SIGINT SIGTERM
 
-echo "Starting Central Processor..."
-"${BUILD_DIR}/central_processor" "$CONFIG_PATH" &
-PIDS+=($!)
-sleep 0.5
+# Block until a component writes its readiness marker (see common/readiness.hpp)
+function wait_ready() {
+    local marker="${LOG_DIR}/$1.ready"
+    for _ in $(seq 1 200); do
+        [ -f "$marker" ] && return 0
+        sleep 0.05
+    done
+    echo "Timed out waiting for $1 to become ready" >&2
+    cleanup
+}
+
+# central.shards > 1 runs one central_processor per shard (config/system_sharded.json)
+SHARDS=$(grep -o '"shards": *[0-9]*' "$CONFIG_PATH" | grep -o '[0-9]*$' || true)
+SHARDS=${SHARDS:-1}
+
+if [ "$SHARDS" -gt 1 ]; then
+    echo "Starting ${SHARDS} Central Processor shards..."
+    for ((k = 0; k < SHARDS; k++)); do
+        "${BUILD_DIR}/central_processor" "$CONFIG_PATH" --shard "$k" &
+        PIDS+=($!)
+    done
+    for ((k = 0; k < SHARDS; k++)); do
+        wait_ready "central_$k"
+    done
+else
+    echo "Starting Central Processor..."
+    "${BUILD_DIR}/central_processor" "$CONFIG_PATH" &
+    PIDS+=($!)
+    wait_ready central
+    # STANDBY=1 adds a hot standby that takes over if the primary dies
+    if [ "${STANDBY:-0}" = "1" ]; then
+        echo "Starting standby Central Processor..."
+        "${BUILD_DIR}/central_processor" "$CONFIG_PATH" --standby &
+        PIDS+=($!)
+        wait_ready central_standby
+    fi
+fi
 
 echo "Starting Network Emulator..."
 "${BUILD_DIR}/network_emulator" "$CONFIG_PATH" &
 PIDS+=($!)
-sleep 0.5
+wait_ready network
+
+NODES=$(grep -o '"num_nodes": *[0-9]*' "$CONFIG_PATH" | grep -o '[0-9]*$' || true)
+NODES=${NODES:-10}
 
-echo "Starting 10 Sensor Nodes..."
-for i in {0..9}; do
+echo "Starting ${NODES} Sensor Nodes..."
+for ((i = 0; i < NODES; i++)); do
     "${BUILD_DIR}/sensor_node" "$CONFIG_PATH" "sensor_$i" "$i" &
     PIDS+=($!)
 done
+for ((i = 0; i < NODES; i++)); do
+    wait_ready "sensor_$i"
+done
+
+UI_PORT=$(grep -o '"ui_port": *[0-9]*' "$CONFIG_PATH" | grep -o '[0-9]*$' || true)
+UI_PORT=${UI_PORT:-8080}
 
-echo "Starting Operator UI (http://127.0.0.1:8080)..."
+echo "Starting Operator UI (http://127.0.0.1:${UI_PORT})..."
 "${BUILD_DIR}/operator_ui" "$CONFIG_PATH" "$STATIC_DIR" &
 PIDS+=($!)
+wait_ready ui
 
 echo "Cluster is running! Press Ctrl+C to stop."
-echo "Visit http://127.0.0.1:8080 in your browser to view the Operator UI."
+echo "Visit http://127.0.0.1:${UI_PORT} in your browser to view the Operator UI."
 
 wait
@@ -0,0 +1,136 @@
+#include "alert_writer.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "runtime.hpp"
+#include "time.hpp"
+#include "trace.hpp"
+
+namespace surveillance {
+namespace central {
+
+AlertWriter::AlertWriter(const AlertWriterConfig& cfg, CommitCallback on_commit)
+    : cfg_(cfg),
+      on_commit_(std::move(on_commit))
+{
+    if (cfg_.batch_max == 0) cfg_.batch_max = 1;
+    if (cfg_.max_pending < cfg_.batch_max) cfg_.max_pending = cfg_.batch_max;
+
+    // Unbuffered: each batch reaches the file as one write, so readers never see half a batch
+    file_ = std::make_unique<segments::SegmentedFile>(cfg_.path, cfg_.rotation, false, cfg_.resume);
+
+    pending_.reserve(cfg_.batch_max);
+    thread_ = std::thread(&AlertWriter::run, this);
+}
+
+AlertWriter::~AlertWriter() {
+    close();
+}
+
+void AlertWriter::append(icd::CentralAlert alert, const std::string* trace_id) {
+    Pending item{std::move(alert), time::monotonic_ns(), trace_id ? *trace_id : std::string()};
+    bool wake = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (pending_.size() >= cfg_.max_pending) {
+            metrics::increment("central.alert_writer_stalls");
+            space_cv_.wait(lock, [this] { return pending_.size() < cfg_.max_pending || closing_; });
+        }
+        pending_.push_back(std::move(item));
+        // The writer needs to hear about the first alert (to start the interval) and a full batch
+        wake = pending_.size() == 1 || pending_.size() == cfg_.batch_max;
+    }
+    if (wake) {
+        writer_cv_.notify_one();
+    }
+}
+
+void AlertWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_ && !thread_.joinable()) return;
+        closing_ = true;
+    }
+    writer_cv_.notify_one();
+    space_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    if (file_) {
+        file_->close();
+    }
+}
+
+void AlertWriter::run() {
+    trace::set_thread_name("alert_writer");
+    runtime::enter_thread("alert_writer");
+    std::vector<Pending> batch;
+    batch.reserve(cfg_.batch_max);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        writer_cv_.wait(lock, [this] { return !pending_.empty() || closing_; });
+        if (pending_.empty()) {
+            break; // closing and fully drained
+        }
+        if (pending_.size() < cfg_.batch_max && !closing_) {
+            // Group commit: give the batch until its oldest alert is `interval` old to fill up.
+            // enqueued_ns is on the steady clock, so the deadline does not move with wake-ups.
+            const std::chrono::steady_clock::time_point oldest{
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::nanoseconds(pending_.front().enqueued_ns))};
+            auto deadline = oldest + cfg_.interval;
+            writer_cv_.wait_until(lock, deadline, [this] {
+                return pending_.size() >= cfg_.batch_max || closing_;
+            });
+        }
+        batch.swap(pending_);
+        lock.unlock();
+        space_cv_.notify_all();
+
+        commit(batch);
+        batch.clear();
+
+        lock.lock();
+    }
+}
+
+void AlertWriter::commit(std::vector<Pending>& batch) {
+    buffer_.clear();
+    for (const auto& item : batch) {
+        icd::dump_to(buffer_, item.alert);
+        buffer_ += '\n';
+    }
+
+    uint64_t write_start_ns = time::monotonic_ns();
+    // Committed means written: with an asynchronous backend the write (and the sync,
+    // linked to it under io_uring) completes before the batch counts as committed
+    bool ok = file_->write(buffer_.data(), buffer_.size());
+    ok = ok && (cfg_.sync ? file_->sync() : file_->drain());
+    uint64_t committed_ns = time::monotonic_ns();
+    if (!ok) {
+        // Part of the batch may already be in the file, so a retry could duplicate lines;
+        // the batch is dropped and counted instead, and is never reported as committed
+        metrics::increment("central.alert_write_errors");
+        metrics::add("central.alerts_dropped_on_write_error", batch.size());
+        SURV_LOG_RATE(logging::Level::error, 1, "Alert batch write failed, batch dropped",
+                      {{"path", cfg_.path}, {"alerts", batch.size()}});
+        return;
+    }
+
+    write_time_->record(committed_ns - write_start_ns);
+    batch_size_->record(batch.size());
+    metrics::increment("central.alert_batches");
+    metrics::add("central.alerts_committed", batch.size());
+
+    committed_.clear();
+    for (auto& item : batch) {
+        commit_latency_->record(committed_ns - item.enqueued_ns);
+        if (!item.trace_id.empty()) {
+            trace::record("central.alert_commit", item.trace_id, item.enqueued_ns, committed_ns);
+        }
+        committed_.push_back(std::move(item.alert));
+    }
+    if (on_commit_) {
+        on_commit_(committed_);
+    }
+}
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,90 @@
+#pragma once
+#include "config.hpp"
+#include "histogram.hpp"
+#include "icd_messages.hpp"
+#include "segmented_file.hpp"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace surveillance {
+namespace central {
+
+struct AlertWriterConfig {
+    std::string path;
+    // A batch is committed when it reaches batch_max alerts or its oldest alert is interval old
+    size_t batch_max{256};
+    std::chrono::microseconds interval{5000};
+    // fdatasync after every commit, so a committed alert survives a host crash
+    bool sync{false};
+    // append() blocks once this many alerts are waiting (a stalled disk backs up into ingest)
+    size_t max_pending{4096};
+    config::RotationConfig rotation;
+    // Continue the file a failed primary was writing instead of truncating it
+    bool resume{false};
+};
+
+// Group-commit writer for alerts.jsonl.
+//
+// The processing thread hands alerts over with append() and a dedicated thread
+// serializes each batch into one buffer and commits it with a single write (plus
+// fdatasync when configured). Alerts are committed in append order. `on_commit`
+// runs on the writer thread after each commit with the committed alerts, so
+// anything published from it (recent_alerts) only ever shows alerts that are in
+// the file. A batch whose write or sync fails is dropped and counted in
+// central.alerts_dropped_on_write_error; it is neither counted as committed nor
+// passed to `on_commit`.
+class AlertWriter {
+public:
+    using CommitCallback = std::function<void(std::vector<icd::CentralAlert>& committed)>;
+
+    AlertWriter(const AlertWriterConfig& cfg, CommitCallback on_commit);
+    ~AlertWriter();
+
+    AlertWriter(const AlertWriter&) = delete;
+    AlertWriter& operator=(const AlertWriter&) = delete;
+
+    // `trace_id` is the sampled event_id (trace::sampled_event_id) or nullptr
+    void append(icd::CentralAlert alert, const std::string* trace_id);
+
+    // Commits everything appended so far and stops the writer thread
+    void close();
+
+private:
+    struct Pending {
+        icd::CentralAlert alert;
+        uint64_t enqueued_ns;
+        std::string trace_id;
+    };
+
+    void run();
+    void commit(std::vector<Pending>& batch);
+
+    AlertWriterConfig cfg_;
+    CommitCallback on_commit_;
+    std::unique_ptr<segments::SegmentedFile> file_;
+
+    std::vector<Pending> pending_;
+    bool closing_{false};
+    std::mutex mutex_;
+    std::condition_variable writer_cv_;
+    std::condition_variable space_cv_;
+    std::thread thread_;
+
+    // Writer thread only
+    std::string buffer_;
+    std::vector<icd::CentralAlert> committed_;
+    metrics::Histogram* commit_latency_ = &metrics::histogram("central.alert_commit_latency_ns");
+    metrics::Histogram* write_time_ = &metrics::histogram("central.alert_write_ns");
+    metrics::Histogram* batch_size_ = &metrics::histogram("central.alert_batch_size");
+};
+
+} // namespace central
+} // namespace surveillance
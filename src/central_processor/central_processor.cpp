@@ -1,41 +1,193 @@
 #include "central_processor.hpp"
+#include "async_file.hpp"
+#include "classifier.hpp"
 #include "zmq_utils.hpp"
 #include "time.hpp"
 #include "ids.hpp"
 #include "logging.hpp"
 #include "metrics.hpp"
+#include "readiness.hpp"
+#include "runtime.hpp"
+#include "hops.hpp"
+#include "shard_ring.hpp"
+#include "histogram.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
 #include <iostream>
-#include <fstream>
-#include <filesystem>
-#include <spdlog/sinks/basic_file_sink.h>
-#include <spdlog/pattern_formatter.h>
 
 namespace surveillance {
 namespace central {
 
-class AlertFormatter : public spdlog::formatter {
-public:
-    void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override {
-        std::string text = std::string(msg.payload.data(), msg.payload.size());
-        std::string out = text + "\n";
-        dest.append(out.data(), out.data() + out.size());
-    }
-    std::unique_ptr<spdlog::formatter> clone() const override {
-        return std::make_unique<AlertFormatter>();
-    }
-};
+namespace {
+
+constexpr size_t kQuarantineMaxRecords = 1000;
+
+IngestQueueConfig make_ingest_config(const config::AppConfig& cfg) {
+    IngestQueueConfig icfg;
+    icfg.capacity = static_cast<size_t>(std::max(1, cfg.central.ingest_capacity));
+    icfg.overload_high_watermark = cfg.central.overload_high_watermark;
+    icfg.overload_low_watermark = cfg.central.overload_low_watermark;
+    icfg.low_priority_sample_every_n = cfg.central.low_priority_sample_every_n;
+    icfg.lossless = (cfg.system.mode == "deterministic");
+    return icfg;
+}
+
+// NodeState as carried by the replication journal
+nlohmann::json node_record(const NodeState& state) {
+    return {
+        {"health", state.health},
+        {"uptime_s", state.uptime_s},
+        {"last_sequence_number", state.last_sequence_number},
+        {"last_seen_utc_ms", state.last_seen_utc_ms},
+        {"bytes_sent", state.bytes_sent},
+        {"edge_triggers", state.edge_triggers},
+        {"suppressed_events", state.suppressed_events}
+    };
+}
+
+NodeState node_from_record(const nlohmann::json& record) {
+    NodeState state;
+    state.health = record.value("health", "UNKNOWN");
+    state.uptime_s = record.value("uptime_s", 0.0);
+    state.last_sequence_number = record.value("last_sequence_number", uint64_t{0});
+    state.last_seen_utc_ms = record.value("last_seen_utc_ms", uint64_t{0});
+    state.bytes_sent = record.value("bytes_sent", uint64_t{0});
+    state.edge_triggers = record.value("edge_triggers", uint64_t{0});
+    state.suppressed_events = record.value("suppressed_events", uint64_t{0});
+    return state;
+}
+
+} // namespace
 
-CentralProcessor::CentralProcessor(const config::AppConfig& cfg, zmq::context_t& ctx)
+CentralProcessor::CentralProcessor(const config::AppConfig& cfg, zmq::context_t& ctx, int shard, Role role)
     : cfg_(cfg),
-      sub_socket_(zmq_utils::create_subscriber(ctx, "tcp://127.0.0.1:7002", false))
+      ctx_(ctx),
+      shard_(shard),
+      suffix_(shard::suffix(shard)),
+      sub_socket_(shm::is_shm_endpoint(cfg.transport.central_feed)
+                      ? zmq::socket_t()
+                      : zmq_utils::create_subscriber(ctx, cfg.transport.central_feed, false,
+                                                     shard >= 0 ? shard::topic(shard) : std::string())),
+      // A standby keeps its own quarantine file rather than truncating the primary's
+      quarantine_(cfg.logging.log_dir + "/quarantine" + suffix_ + (role == Role::STANDBY ? "_standby" : "") + ".jsonl",
+                  kQuarantineMaxRecords),
+      ingest_(make_ingest_config(cfg)),
+      rollups_(static_cast<size_t>(cfg.central.rollup_max_nodes)),
+      active_(role == Role::PRIMARY)
 {
-    // Setup pure alerts.jsonl logger
-    std::string alert_file = cfg_.logging.log_dir + "/alerts.jsonl";
-    auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(alert_file, true);
-    alerts_logger_ = std::make_shared<spdlog::logger>("alerts", file_sink);
-    alerts_logger_->set_formatter(std::make_unique<AlertFormatter>());
-    alerts_logger_->flush_on(spdlog::level::info);
+    if (cfg_.system.mode == "deterministic") {
+        emulator_credits_ = std::make_unique<flow::CreditGrantor>(ctx, cfg_.transport.central_credits, cfg_.network.credit_window);
+    }
+    if (shm::is_shm_endpoint(cfg_.transport.central_feed)) {
+        feed_ring_ = std::make_unique<shm::RingConsumer>(cfg_.transport.central_feed, cfg_.transport.shm_ring_bytes, "central_feed");
+    }
+
+    if (role == Role::STANDBY) {
+        primary_ = std::make_unique<ReplicationSubscriber>(ctx_, cfg_.central.replication_endpoint);
+        return; // alerts.jsonl belongs to the primary until the takeover
+    }
+    // Only an unsharded live central has a standby (see main.cpp)
+    if (shard_ < 0 && cfg_.system.mode != "deterministic" && !cfg_.central.replication_endpoint.empty()) {
+        replication_ = std::make_unique<ReplicationPublisher>(ctx_, cfg_.central.replication_endpoint,
+                                                              cfg_.central.replication_heartbeat_ms);
+    }
+    // A restored central continues the alerts.jsonl its recent alerts came from
+    const bool restored = restore_state();
+    open_checkpoints();
+    open_alert_writer(restored);
+}
+
+bool CentralProcessor::restore_state() {
+    if (cfg_.central.checkpoint_interval_s <= 0.0 || cfg_.system.mode == "deterministic") {
+        return false;
+    }
+    const uint64_t start_ns = time::monotonic_ns();
+    StateImage image;
+    RestoreStats stats;
+    if (!load_checkpoint(cfg_.logging.log_dir + "/central_checkpoint" + suffix_ + ".bin",
+                         cfg_.logging.log_dir + "/central_journal" + suffix_ + ".bin",
+                         static_cast<size_t>(std::max(0, cfg_.central.alerts_buffer)), image, stats)) {
+        return false;
+    }
+
+    // Nodes that went quiet while central was down are failed straight away
+    const uint64_t now_ms = time::utc_now_ms();
+    for (auto& [node_id, state] : image.nodes) {
+        if (now_ms > state.last_seen_utc_ms &&
+            (now_ms - state.last_seen_utc_ms) / 1000.0 > cfg_.central.heartbeat_timeout_s) {
+            state.health = "FAILED";
+        }
+    }
+    for (const auto& [key, value] : image.metrics) {
+        // The restore time is this run's, not a total across restarts
+        if (key == "central.restore_ns") continue;
+        metrics::add(key, value);
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        nodes_.swap(image.nodes);
+        recent_alerts_.swap(image.recent_alerts);
+    }
+
+    const uint64_t restore_ns = time::monotonic_ns() - start_ns;
+    metrics::add("central.restore_ns", restore_ns);
+    logging::info("Restored central state from checkpoint", {
+        {"nodes", nodes_.size()},
+        {"recent_alerts", recent_alerts_.size()},
+        {"checkpoint_bytes", stats.checkpoint_bytes},
+        {"journal_records", stats.journal_records},
+        {"journal_torn", stats.journal_torn},
+        {"restore_ms", restore_ns / 1e6}
+    });
+    return true;
+}
+
+void CentralProcessor::open_checkpoints() {
+    if (cfg_.central.checkpoint_interval_s <= 0.0 || cfg_.system.mode == "deterministic") {
+        return;
+    }
+    checkpoints_ = std::make_unique<CheckpointWriter>(cfg_.logging.log_dir + "/central_checkpoint" + suffix_ + ".bin",
+                                                      cfg_.logging.log_dir + "/central_journal" + suffix_ + ".bin");
+    // The journal starts after a checkpoint of what we begin with
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    checkpoints_->checkpoint(capture_state());
+}
+
+StateImage CentralProcessor::capture_state() const {
+    StateImage image;
+    image.nodes = nodes_;
+    image.recent_alerts = recent_alerts_;
+    image.metrics = metrics::get_all();
+    return image;
+}
+
+void CentralProcessor::open_alert_writer(bool resume) {
+    // alerts.jsonl is group-committed off the processing thread; the UI buffer
+    // only receives alerts once they are in the file
+    AlertWriterConfig wcfg;
+    wcfg.path = cfg_.logging.log_dir + "/alerts" + suffix_ + ".jsonl";
+    wcfg.batch_max = static_cast<size_t>(std::max(1, cfg_.central.alert_batch_max));
+    wcfg.interval = std::chrono::microseconds(static_cast<int64_t>(cfg_.central.alert_batch_interval_ms * 1000.0));
+    wcfg.sync = (cfg_.central.alert_sync == "fdatasync");
+    wcfg.rotation = cfg_.logging.rotation;
+    wcfg.resume = resume;
+    alert_writer_ = std::make_unique<AlertWriter>(wcfg, [this](std::vector<icd::CentralAlert>& committed) {
+        // Journal records are published under state_mutex_ so they are ordered with the snapshots
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (replication_) {
+            replication_->publish("AlertsCommitted", {{"alerts", committed}});
+        }
+        if (checkpoints_) {
+            checkpoints_->alerts_committed(committed);
+        }
+        for (auto& alert : committed) {
+            recent_alerts_.push_front(std::move(alert));
+        }
+        while (recent_alerts_.size() > static_cast<size_t>(cfg_.central.alerts_buffer)) {
+            recent_alerts_.pop_back();
+        }
+    });
 }
 
 CentralProcessor::~CentralProcessor() {
@@ -44,123 +196,484 @@ CentralProcessor::~CentralProcessor() {
 
 void CentralProcessor::stop() {
     running_ = false;
+    ingest_.close();
+    if (receive_thread_.joinable()) receive_thread_.join();
     if (processing_thread_.joinable()) processing_thread_.join();
     if (state_writer_thread_.joinable()) state_writer_thread_.join();
+    aio::drain_replacements(); // the last central_state.json
     
-    if (alerts_logger_) {
-        alerts_logger_->flush();
+    if (alert_writer_) {
+        alert_writer_->close();
+    }
+    // A clean shutdown leaves a checkpoint with an empty journal behind
+    if (checkpoints_) {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            checkpoints_->checkpoint(capture_state());
+        }
+        checkpoints_->close();
+        checkpoints_.reset();
     }
 }
 
 void CentralProcessor::run() {
+    receive_thread_ = std::thread(&CentralProcessor::receive_messages, this);
     processing_thread_ = std::thread(&CentralProcessor::process_messages, this);
     state_writer_thread_ = std::thread(&CentralProcessor::write_state_loop, this);
+    readiness::mark_ready(cfg_.logging.log_dir, active_ ? "central" + suffix_ : std::string("central_standby"));
 }
 
-uint64_t CentralProcessor::parse_utc_to_ms(const std::string& utc_iso) {
-    // Basic approximate parsing for exact millisecond extraction assuming fixed width format "%Y-%m-%dT%H:%M:%S.123Z"
-    if (utc_iso.size() >= 24) {
-        std::tm tm{};
-        int ms = 0;
-        sscanf(utc_iso.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d.%3dZ",
-               &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-               &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &ms);
-        tm.tm_year -= 1900;
-        tm.tm_mon -= 1;
-        
-#if defined(_WIN32)
-        time_t t = _mkgmtime(&tm);
-#else
-        time_t t = timegm(&tm);
-#endif
-        return (static_cast<uint64_t>(t) * 1000ULL) + ms;
-    }
-    return 0; // Fallback
+uint64_t CentralProcessor::parse_utc_to_ms(std::string_view utc_iso) {
+    return time::parse_utc_ms(utc_iso);
 }
 
-void CentralProcessor::handle_event(const nlohmann::json& msg) {
-    double amp = msg.value("signal_amplitude", 0.0);
-    double en = msg.value("signal_energy", 0.0);
-    std::string type = msg.value("event_type", "");
-
-    std::string classification = "LOW";
-    if (type == "DIGGING" || (en >= 22.0 && amp >= 0.65)) {
-        classification = "HIGH";
-    } else if (type == "VEHICLE" || (en >= 14.0 && amp >= 0.45)) {
-        classification = "MEDIUM";
+void CentralProcessor::handle_event(const icd::MessageView& ev, uint64_t rx_ns) {
+    // Only sampled events pay for an owned copy of the id
+    std::string traced;
+    const std::string* trace_id = nullptr;
+    if (trace::is_sampled(ev.event_id)) {
+        traced.assign(ev.event_id);
+        trace_id = &traced;
     }
+    trace::Span span("central.handle_event", trace_id);
+
+    const char* classification = classify_event(ev.event_type, ev.signal_amplitude, ev.signal_energy);
 
     uint64_t central_utc_ms = time::utc_now_ms();
-    uint64_t event_utc_ms = parse_utc_to_ms(msg.value("timestamp_utc", ""));
+    uint64_t event_utc_ms = parse_utc_to_ms(ev.timestamp_utc);
     uint64_t mono_ns = time::monotonic_ns();
     std::string timestamp_utc = time::utc_now_string();
 
     if (cfg_.system.mode == "deterministic") {
         central_utc_ms = event_utc_ms + cfg_.network.latency_ms + 1; 
         timestamp_utc = time::format_utc_ms(central_utc_ms);
-        mono_ns = msg.value("monotonic_ns", 0ULL) + (cfg_.network.latency_ms + 1) * 1000000ULL;
+        mono_ns = ev.monotonic_ns + (cfg_.network.latency_ms + 1) * 1000000ULL;
     }
     double latency = std::max(0.0, static_cast<double>(central_utc_ms) - static_cast<double>(event_utc_ms));
-
-    nlohmann::json alert = {
-        {"msg_type", "CentralAlert"},
-        {"alert_id", ids::generate_uuid()},
-        {"event_id", msg["event_id"]},
-        {"source_node_id", msg["node_id"]},
-        {"timestamp_utc", timestamp_utc},
-        {"monotonic_ns", mono_ns},
-        {"classification", classification},
-        {"processing_latency_ms", latency}
-    };
-
-    alerts_logger_->info(alert.dump());
-    
-    {
-        std::lock_guard<std::mutex> lock(state_mutex_);
-        recent_alerts_.push_front(alert);
-        if (recent_alerts_.size() > static_cast<size_t>(cfg_.central.alerts_buffer)) {
-            recent_alerts_.pop_back();
+    if (cfg_.system.mode != "deterministic") {
+        // Prefer the monotonic end-to-end time: ns resolution and immune to wall-clock steps
+        if (auto end_to_end_ns = record_hops(ev, rx_ns, mono_ns)) {
+            latency = *end_to_end_ns / 1e6;
         }
     }
 
+    icd::CentralAlert alert;
+    alert.alert_id = ids::generate_uuid();
+    alert.event_id = ev.event_id;
+    alert.source_node_id = ev.node_id;
+    alert.timestamp_utc = std::move(timestamp_utc);
+    alert.monotonic_ns = mono_ns;
+    alert.classification = classification;
+    alert.processing_latency_ms = latency;
+
+    rollups_.record(alert.source_node_id, central_utc_ms,
+                    rx_ns != 0 ? std::optional<uint64_t>(ev.sequence_number) : std::nullopt, classification, latency);
+
+    alert_writer_->append(std::move(alert), trace_id);
     metrics::increment("central.alerts_generated");
 }
 
-void CentralProcessor::handle_status(const nlohmann::json& msg) {
-    std::string node_id = msg.value("node_id", "");
+void CentralProcessor::handle_status(const icd::MessageView& status) {
     std::lock_guard<std::mutex> lock(state_mutex_);
-    auto& state = nodes_[node_id];
-    state.health = msg.value("health", "UNKNOWN");
-    state.uptime_s = msg.value("uptime_s", 0.0);
-    state.last_sequence_number = msg.value("last_sequence_number", 0ULL);
+    auto& [node_id, state] = *nodes_.try_emplace(std::string(status.node_id)).first;
+    if (status.uptime_s < state.uptime_s) {
+        // The node rebooted, so its sequence numbers start over
+        rollups_.node_restarted(node_id);
+    }
+    state.health.assign(status.health);
+    state.uptime_s = status.uptime_s;
+    state.last_sequence_number = status.last_sequence_number;
     state.last_seen_utc_ms = time::utc_now_ms();
+    state.bytes_sent = status.bytes_sent;
+    state.edge_triggers = status.edge_triggers;
+    state.suppressed_events = status.suppressed_events;
+    if (replication_) {
+        auto record = node_record(state);
+        record["node_id"] = node_id;
+        replication_->publish("NodeStateUpdate", std::move(record));
+    }
+    if (checkpoints_) {
+        checkpoints_->node_updated(node_id, state);
+    }
+}
+
+bool CentralProcessor::parse_inbound(InboundMessage& in) {
+    const char* data = static_cast<const char*>(in.frame.data());
+    const size_t size = in.frame.size();
+
+    icd::ParseError err;
+    if (size > 0 && data[0] == '{') {
+        // JSON text: events and status are parsed in place; the view points into the frame
+        err = icd::parse(std::string_view(data, size), in.view);
+        if (err == icd::ParseError::UNSUPPORTED_TYPE) {
+            in.dom = nlohmann::json::parse(data, data + size, nullptr, false);
+            if (!in.dom.is_discarded()) {
+                in.frame.rebuild();
+                return true;
+            }
+            err = icd::ParseError::SYNTAX;
+        }
+    } else {
+        auto decoded = decoder_.decode(data, size);
+        if (!decoded) {
+            return false; // Counted by the decoder (malformed frame or lost stream sync)
+        }
+        in.dom = std::move(*decoded);
+        err = icd::from_json(in.dom, in.view);
+        if (err == icd::ParseError::NONE || err == icd::ParseError::UNSUPPORTED_TYPE) {
+            in.frame.rebuild();
+            return true;
+        }
+    }
+
+    if (err != icd::ParseError::NONE) {
+        quarantine_.add(err, data, size);
+        return false;
+    }
+    return true;
+}
+
+bool CentralProcessor::receive_frame(zmq::message_t& frame) {
+    if (!feed_ring_) {
+        return zmq_utils::receive_frame(sub_socket_, frame, false);
+    }
+    auto data = feed_ring_->peek();
+    if (!data) return false;
+    // Copied out: parsed views point into the frame, which outlives the ring slot
+    frame.rebuild(data->data(), data->size());
+    feed_ring_->pop();
+    return true;
+}
+
+void CentralProcessor::receive_messages() {
+    // Drain the socket as fast as possible so overload is decided by our admission
+    // policy rather than by ZMQ dropping at rcvhwm.
+    trace::set_thread_name("receive");
+    runtime::enter_thread("receive");
+    while (running_) {
+        if (emulator_credits_) {
+            emulator_credits_->poll();
+        }
+        if (!active_) {
+            follow_primary();
+        } else if (replication_) {
+            replication_->heartbeat_if_due();
+        }
+
+        uint64_t rx_start_ns = time::monotonic_ns();
+        InboundMessage in;
+        if (!receive_frame(in.frame)) {
+            decoder_.flush_metrics();
+            if (runtime::busy_polling()) {
+                runtime::cpu_relax();
+            } else if (feed_ring_) {
+                feed_ring_->wait(std::chrono::milliseconds(1));
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            continue;
+        }
+        in.rx_ns = time::monotonic_ns();
+        bool admitted = parse_inbound(in);
+
+        if (admitted && !active_) {
+            hold_event(std::move(in));
+        } else if (admitted) {
+            // The view moves with the message, so the trace id is read before offering it
+            const bool traced = trace::is_sampled(in.view.event_id);
+            std::string trace_id = traced ? std::string(in.view.event_id) : std::string();
+
+            PriorityClass cls = admission_class(in);
+            ingest_.offer(cls, std::move(in));
+            if (traced) {
+                trace::record("central.receive", trace_id, rx_start_ns, time::monotonic_ns());
+            }
+        }
+
+        // Lossless ingest blocks in offer() when full, so credits are only returned once admitted.
+        // Rejected messages still used a credit on the emulator side.
+        if (emulator_credits_) {
+            emulator_credits_->on_message(flow::kEmulatorIdentity);
+        }
+    }
+}
+
+void CentralProcessor::follow_primary() {
+    while (auto record = primary_->receive()) {
+        apply_replicated(*record);
+    }
+
+    const uint64_t now_ns = time::monotonic_ns();
+    const uint64_t window_ns = 2ULL * static_cast<uint64_t>(cfg_.central.failover_timeout_ms) * 1000000ULL;
+    while (!alerted_order_.empty() && now_ns - alerted_order_.front().first > window_ns) {
+        alerted_ids_.erase(alerted_order_.front().second);
+        alerted_order_.pop_front();
+    }
+
+    if (now_ns - primary_->last_heard_ns() > static_cast<uint64_t>(cfg_.central.failover_timeout_ms) * 1000000ULL) {
+        take_over();
+    }
+}
+
+void CentralProcessor::apply_replicated(const nlohmann::json& record) {
+    const std::string type = record.value("msg_type", "");
+    try {
+        if (type == "NodeStateUpdate") {
+            NodeState state = node_from_record(record);
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            nodes_[record.at("node_id").get<std::string>()] = std::move(state);
+        } else if (type == "AlertsCommitted") {
+            const uint64_t now_ns = time::monotonic_ns();
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            for (const auto& entry : record.at("alerts")) {
+                auto alert = entry.get<icd::CentralAlert>();
+                if (alerted_ids_.insert(alert.event_id).second) {
+                    alerted_order_.emplace_back(now_ns, alert.event_id);
+                }
+                recent_alerts_.push_front(std::move(alert));
+            }
+            while (recent_alerts_.size() > static_cast<size_t>(cfg_.central.alerts_buffer)) {
+                recent_alerts_.pop_back();
+            }
+        } else if (type == "StateSnapshot") {
+            std::unordered_map<std::string, NodeState> nodes;
+            for (const auto& [node_id, entry] : record.at("nodes").items()) {
+                nodes[node_id] = node_from_record(entry);
+            }
+            std::deque<icd::CentralAlert> alerts;
+            for (const auto& entry : record.at("recent_alerts")) {
+                alerts.push_back(entry.get<icd::CentralAlert>());
+            }
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            nodes_.swap(nodes);
+            recent_alerts_.swap(alerts);
+            replicated_metrics_ = record.at("metrics");
+        }
+    } catch (const nlohmann::json::exception&) {
+        metrics::increment("central.replication_invalid_records");
+    }
+}
+
+void CentralProcessor::hold_event(InboundMessage in) {
+    // Only events are replayed: node state comes from the journal, and waveform
+    // detector state is not replicated (the detector restarts at the takeover)
+    const uint64_t window_ns = 2ULL * static_cast<uint64_t>(cfg_.central.failover_timeout_ms) * 1000000ULL;
+    while (!held_events_.empty() && in.rx_ns - held_events_.front().rx_ns > window_ns) {
+        held_events_.pop_front();
+    }
+    if (in.view.type == icd::MessageType::DISTURBANCE_EVENT) {
+        held_events_.push_back(std::move(in));
+    }
+}
+
+void CentralProcessor::take_over() {
+    const uint64_t silent_since_ns = primary_->last_heard_ns();
+
+    // Binding the journal endpoint fences a primary that is only slow: it still holds it
+    try {
+        replication_ = std::make_unique<ReplicationPublisher>(ctx_, cfg_.central.replication_endpoint,
+                                                              cfg_.central.replication_heartbeat_ms);
+    } catch (const zmq::error_t& e) {
+        logging::warn("Primary silent but still bound to the replication endpoint; staying standby",
+                      {{"error", e.what()}});
+        primary_->reset_last_heard();
+        return;
+    }
+    primary_.reset();
+    open_checkpoints();
+
+    // Counters continue from the primary's last snapshot, except those this process kept itself
+    if (replicated_metrics_.is_object()) {
+        for (const auto& [key, value] : replicated_metrics_.items()) {
+            if (value.is_number_unsigned() && metrics::get(key) == 0) {
+                metrics::add(key, value.get<uint64_t>());
+            }
+        }
+    }
+
+    open_alert_writer(true);
+
+    // Events the primary received but did not alert on before it died
+    size_t replayed = 0;
+    for (auto& in : held_events_) {
+        if (alerted_ids_.count(std::string(in.view.event_id))) continue;
+        PriorityClass cls = admission_class(in);
+        ingest_.offer(cls, std::move(in));
+        ++replayed;
+    }
+    held_events_.clear();
+    alerted_ids_.clear();
+    alerted_order_.clear();
+
+    active_ = true;
+    readiness::mark_ready(cfg_.logging.log_dir, "central" + suffix_);
+
+    const uint64_t failover_ns = time::monotonic_ns() - silent_since_ns;
+    metrics::histogram("central.failover_ns").record(failover_ns);
+    metrics::increment("central.failovers");
+    metrics::add("central.failover_replayed_events", replayed);
+    logging::warn("Primary central went silent; standby took over",
+                  {{"failover_ms", failover_ns / 1e6}, {"replayed_events", replayed}});
+}
+
+void CentralProcessor::handle_waveform(const nlohmann::json& msg) {
+    uint64_t start_ns = time::monotonic_ns();
+
+    std::string node_id = msg.value("node_id", "");
+    const auto& channels = msg.at("samples");
+    const size_t num_channels = channels.size();
+    if (num_channels == 0 || static_cast<int>(num_channels) != cfg_.waveform.channels) {
+        metrics::increment("central.waveform_rejected_blocks");
+        return;
+    }
+    const size_t n = channels[0].size();
+    const float scale = msg.value("scale", 1.0 / 32767.0);
+    const double fs = msg.value("sample_rate_hz", cfg_.waveform.sample_rate_hz);
+
+    wave_raw_.resize(num_channels * n);
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+        if (channels[ch].size() != n) {
+            metrics::increment("central.waveform_rejected_blocks");
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            wave_raw_[ch * n + i] = channels[ch][i].get<int16_t>();
+        }
+    }
+    wave_buf_.resize(wave_raw_.size());
+    dsp::int16_to_float(wave_raw_.data(), wave_buf_.data(), wave_raw_.size(), scale);
+
+    auto it = waveforms_.find(node_id);
+    if (it == waveforms_.end()) {
+        it = waveforms_.emplace(node_id, WaveformNodeState(dsp::make_detector_config(cfg_.waveform))).first;
+    }
+    auto& state = it->second;
+
+    uint64_t first_sample = msg.value("first_sample", 0ULL);
+    if (state.detector.samples_seen() != 0 && first_sample != state.detector.samples_seen()) {
+        // Lost blocks: the detector keeps running across the gap
+        metrics::increment("central.waveform_gaps");
+    }
+
+    bursts_.clear();
+    state.detector.process(wave_buf_.data(), n, bursts_);
+
+    metrics::increment("central.waveform_blocks");
+    metrics::add("central.waveform_samples", num_channels * n);
+    metrics::add("central.feature_extraction_ns", time::monotonic_ns() - start_ns);
+
+    uint64_t block_mono_ns = msg.value("monotonic_ns", 0ULL);
+    uint64_t block_utc_ms = parse_utc_to_ms(msg.value("timestamp_utc", ""));
+    for (const auto& burst : bursts_) {
+        // The event is stamped at the sample where the burst detriggered, i.e. when it was detected
+        double offset_s = (static_cast<double>(burst.start_sample) - static_cast<double>(first_sample)) / fs
+                          + burst.duration_s;
+        int64_t offset_ns = static_cast<int64_t>(offset_s * 1e9);
+        int64_t offset_ms = static_cast<int64_t>(offset_s * 1000.0);
+
+        icd::DisturbanceEvent derived;
+        derived.event_id = ids::generate_uuid();
+        derived.node_id = node_id;
+        derived.sequence_number = state.derived_sequence++;
+        derived.timestamp_utc = time::format_utc_ms(static_cast<uint64_t>(static_cast<int64_t>(block_utc_ms) + offset_ms));
+        derived.monotonic_ns = static_cast<uint64_t>(static_cast<int64_t>(block_mono_ns) + offset_ns);
+        derived.signal_amplitude = burst.peak_amplitude;
+        derived.signal_energy = burst.energy;
+        derived.band_energy_low = burst.band_energy_low;
+        derived.band_energy_high = burst.band_energy_high;
+        derived.duration_s = burst.duration_s;
+        metrics::increment("central.waveform_bursts");
+        handle_event(icd::view_of(derived), 0);
+    }
 }
 
 void CentralProcessor::process_messages() {
+    trace::set_thread_name("process");
+    runtime::enter_thread("process");
+    const bool busy_poll = runtime::busy_polling();
     while (running_) {
-        auto msg_opt = zmq_utils::receive_json(sub_socket_, false);
-        if (!msg_opt) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        auto item = ingest_.pop(std::chrono::milliseconds(busy_poll ? 0 : 10));
+        if (!item) {
+            if (busy_poll) runtime::cpu_relax();
             continue;
         }
+        const InboundMessage& msg = item->msg;
+        if (trace::is_sampled(msg.view.event_id)) {
+            trace::record("central.ingest_queue", msg.view.event_id, item->enqueued_ns, time::monotonic_ns());
+        }
 
-        nlohmann::json msg = *msg_opt;
-        std::string msg_type = msg.value("msg_type", "");
+        switch (msg.view.type) {
+            case icd::MessageType::DISTURBANCE_EVENT:
+                handle_event(msg.view, msg.rx_ns);
+                break;
+            case icd::MessageType::NODE_STATUS:
+                handle_status(msg.view);
+                break;
+            default:
+                if (msg.dom.is_object() && msg.dom.value("msg_type", "") == "WaveformBlock") {
+                    try {
+                        handle_waveform(msg.dom);
+                    } catch (const nlohmann::json::exception&) {
+                        metrics::increment("central.waveform_rejected_blocks");
+                    }
+                }
+                break;
+        }
+    }
+}
 
-        if (msg_type == "DisturbanceEvent") {
-            handle_event(msg);
-        } else if (msg_type == "NodeStatus") {
-            handle_status(msg);
+std::optional<uint64_t> CentralProcessor::record_hops(const icd::MessageView& ev, uint64_t rx_ns, uint64_t alert_ns) {
+    if (ev.hops.size() != hops::CENTRAL_RX || rx_ns == 0) {
+        return std::nullopt; // Derived events, or a sender that does not stamp
+    }
+    uint64_t stamps[hops::COUNT + 1];
+    std::copy(ev.hops.begin(), ev.hops.end(), stamps);
+    stamps[hops::CENTRAL_RX] = rx_ns;
+    stamps[hops::COUNT] = alert_ns;
+    for (size_t i = 1; i <= hops::COUNT; ++i) {
+        if (stamps[i] < stamps[i - 1]) {
+            // Not one host's monotonic clock; the differences would be meaningless
+            metrics::increment("central.hop_clock_mismatch");
+            return std::nullopt;
         }
     }
+
+    hop_histograms_.sensor_to_emulator->record(stamps[hops::EMULATOR_RX] - stamps[hops::SENSOR_TX]);
+    hop_histograms_.emulator_residence->record(stamps[hops::EMULATOR_TX] - stamps[hops::EMULATOR_RX]);
+    hop_histograms_.emulator_to_central->record(stamps[hops::CENTRAL_RX] - stamps[hops::EMULATOR_TX]);
+    hop_histograms_.central->record(alert_ns - stamps[hops::CENTRAL_RX]);
+    uint64_t end_to_end = alert_ns - stamps[hops::SENSOR_TX];
+    hop_histograms_.end_to_end->record(end_to_end);
+    return end_to_end;
+}
+
+nlohmann::json CentralProcessor::ingest_state_json() const {
+    nlohmann::json dropped = nlohmann::json::object();
+    for (size_t c = 0; c < kNumPriorityClasses; ++c) {
+        auto cls = static_cast<PriorityClass>(c);
+        dropped[priority_class_name(cls)] = ingest_.dropped(cls);
+    }
+    return {
+        {"overloaded", ingest_.overloaded()},
+        {"depth", ingest_.depth()},
+        {"capacity", ingest_.capacity()},
+        {"dropped", dropped}
+    };
 }
 
 void CentralProcessor::write_state_loop() {
-    std::string state_file = cfg_.logging.log_dir + "/central_state.json";
-    std::string temp_file = state_file + ".tmp";
+    std::string state_file = cfg_.logging.log_dir + "/central_state" + suffix_ + ".json";
+    std::string timeseries_file = cfg_.logging.log_dir + "/central_timeseries" + suffix_ + ".json";
+    const bool deterministic = cfg_.system.mode == "deterministic";
+    const uint64_t checkpoint_interval_ns = static_cast<uint64_t>(cfg_.central.checkpoint_interval_s * 1e9);
+    uint64_t last_checkpoint_ns = time::monotonic_ns();
+    runtime::enter_thread("state_writer");
 
     while (running_) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (!active_) {
+            continue; // The primary's state file is the one the UI reads
+        }
 
         nlohmann::json state_json;
         uint64_t now_ms = time::utc_now_ms();
@@ -169,6 +682,7 @@ void CentralProcessor::write_state_loop() {
             std::lock_guard<std::mutex> lock(state_mutex_);
             
             nlohmann::json nodes_json = nlohmann::json::object();
+            nlohmann::json node_records = nlohmann::json::object();
             for (auto& [node_id, state] : nodes_) {
                 double age_s = (now_ms - state.last_seen_utc_ms) / 1000.0;
                 if (age_s > cfg_.central.heartbeat_timeout_s) {
@@ -178,23 +692,58 @@ void CentralProcessor::write_state_loop() {
                     {"health", state.health},
                     {"uptime_s", state.uptime_s},
                     {"last_seen_age_s", age_s},
-                    {"last_sequence_number", state.last_sequence_number}
+                    {"last_sequence_number", state.last_sequence_number},
+                    {"bytes_sent", state.bytes_sent},
+                    {"edge_triggers", state.edge_triggers},
+                    {"suppressed_events", state.suppressed_events}
                 };
+                if (replication_) {
+                    node_records[node_id] = node_record(state);
+                }
             }
 
+            if (shard_ >= 0) {
+                state_json["shard"] = shard_;
+                state_json["written_utc_ms"] = now_ms;
+            }
             state_json["nodes"] = nodes_json;
             state_json["metrics"] = metrics::get_all();
+            state_json["ingest"] = ingest_state_json();
+            state_json["codec"] = codec::stats_json("central_ingress");
+            state_json["latency_histograms"] = metrics::histograms_json();
+            if (feed_ring_) {
+                shm::RingStats ring = feed_ring_->stats();
+                state_json["feed_ring"] = {
+                    {"capacity_bytes", ring.capacity_bytes},
+                    {"used_bytes", ring.used_bytes},
+                    {"high_watermark_bytes", ring.high_watermark_bytes},
+                    {"producers", ring.producers}
+                };
+            }
             state_json["recent_alerts"] = recent_alerts_;
-        }
 
-        try {
-            std::ofstream f(temp_file);
-            f << state_json.dump() << "\n";
-            f.close();
-            std::filesystem::rename(temp_file, state_file);
-        } catch (...) {
-            logging::error("Failed to write central_state.json atomicity");
+            if (checkpoints_ && time::monotonic_ns() - last_checkpoint_ns >= checkpoint_interval_ns) {
+                checkpoints_->checkpoint(capture_state());
+                last_checkpoint_ns = time::monotonic_ns();
+            }
+
+            if (replication_) {
+                replication_->publish("StateSnapshot", {
+                    {"nodes", std::move(node_records)},
+                    {"recent_alerts", state_json["recent_alerts"]},
+                    {"metrics", state_json["metrics"]}
+                });
+            }
         }
+
+        // Written to a temporary file and renamed over the old one by the aio engine;
+        // failures count in aio.replace_errors
+        uint64_t write_start_ns = time::monotonic_ns();
+        aio::replace_file(state_file, state_json.dump() + "\n");
+        state_write_ns_->record(time::monotonic_ns() - write_start_ns);
+
+        // Deterministic runs chart the simulated clock rather than the wall clock
+        aio::replace_file(timeseries_file, rollups_.to_json(deterministic ? 0 : now_ms).dump() + "\n");
     }
 }
 
@@ -1,54 +1,147 @@
 #pragma once
+#include "alert_writer.hpp"
+#include "checkpoint.hpp"
 #include "config.hpp"
+#include "dsp.hpp"
+#include "flow_control.hpp"
+#include "histogram.hpp"
+#include "icd_parser.hpp"
+#include "ingest_queue.hpp"
+#include "node_state.hpp"
+#include "quarantine.hpp"
+#include "replication.hpp"
+#include "rollups.hpp"
+#include "shm_ring.hpp"
+#include "stream_codec.hpp"
 #include <zmq.hpp>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
 #include <nlohmann/json.hpp>
-#include <spdlog/logger.h>
 
 namespace surveillance {
 namespace central {
 
-struct NodeState {
-    std::string health{"UNKNOWN"};
-    double uptime_s{0.0};
-    uint64_t last_sequence_number{0};
-    uint64_t last_seen_utc_ms{0};
+// Per-node feature extraction state for raw waveform streams (processing thread only)
+struct WaveformNodeState {
+    explicit WaveformNodeState(const dsp::DetectorConfig& cfg) : detector(cfg) {}
+    dsp::BurstDetector detector;
+    uint64_t derived_sequence{1};
+};
+
+// Per-hop latency histograms fed from the DisturbanceEvent hop stamps (hops.hpp)
+struct HopHistograms {
+    metrics::Histogram* sensor_to_emulator = &metrics::histogram("hop.sensor_to_emulator_ns");
+    metrics::Histogram* emulator_residence = &metrics::histogram("hop.emulator_residence_ns");
+    metrics::Histogram* emulator_to_central = &metrics::histogram("hop.emulator_to_central_ns");
+    metrics::Histogram* central = &metrics::histogram("hop.central_ns");
+    metrics::Histogram* end_to_end = &metrics::histogram("hop.end_to_end_ns");
+};
+
+enum class Role {
+    PRIMARY,
+    // Decodes the same stream and mirrors the primary's replicated state, but raises
+    // no alerts until the primary goes silent and it takes over (replication.hpp)
+    STANDBY
 };
 
 class CentralProcessor {
 public:
-    CentralProcessor(const config::AppConfig& cfg, zmq::context_t& ctx);
+    // `shard` >= 0 runs as that shard of a sharded central tier (central.shards > 1):
+    // it subscribes to its shard topic only and its files carry the shard suffix
+    CentralProcessor(const config::AppConfig& cfg, zmq::context_t& ctx, int shard = -1,
+                     Role role = Role::PRIMARY);
     ~CentralProcessor();
 
     void run();
     void stop();
 
 private:
+    void receive_messages();
+    bool receive_frame(zmq::message_t& frame); // from the feed socket or ring, non-blocking
     void process_messages();
     void write_state_loop();
 
-    void handle_event(const nlohmann::json& msg);
-    void handle_status(const nlohmann::json& msg);
+    // Validates a received frame into in.view (and in.dom where needed); false if it
+    // was quarantined or dropped by the stream decoder
+    bool parse_inbound(InboundMessage& in);
+
+    // `rx_ns` is the central receive stamp, 0 for events derived locally
+    void handle_event(const icd::MessageView& ev, uint64_t rx_ns);
+    void handle_status(const icd::MessageView& status);
+    void handle_waveform(const nlohmann::json& msg);
+
+    void open_alert_writer(bool resume);
 
-    uint64_t parse_utc_to_ms(const std::string& utc_iso);
+    // Warm restart: loads the last checkpoint and journal; true if there was one
+    bool restore_state();
+    void open_checkpoints();
+    StateImage capture_state() const; // state_mutex_ held
+
+    // Standby, receive thread: applies the journal and takes over once the primary is silent
+    void follow_primary();
+    void apply_replicated(const nlohmann::json& record);
+    void hold_event(InboundMessage in);
+    void take_over();
+
+    nlohmann::json ingest_state_json() const;
+    // Records the hop breakdown of a stamped event; returns its end-to-end time
+    std::optional<uint64_t> record_hops(const icd::MessageView& ev, uint64_t rx_ns, uint64_t alert_ns);
+
+    uint64_t parse_utc_to_ms(std::string_view utc_iso);
 
     config::AppConfig cfg_;
+    zmq::context_t& ctx_;
+    int shard_;
+    std::string suffix_; // shard::suffix(shard_)
     zmq::socket_t sub_socket_;
+    std::unique_ptr<shm::RingConsumer> feed_ring_; // replaces sub_socket_ on a shm:// feed
+    codec::StreamDecoder decoder_{"central_ingress"}; // receive thread only
+    Quarantine quarantine_;                           // receive thread only
+    std::unique_ptr<flow::CreditGrantor> emulator_credits_; // deterministic mode only
     
+    IngestQueue ingest_;
+    HopHistograms hop_histograms_;
+    Rollups rollups_; // written to central_timeseries.json with the state
+
     std::atomic<bool> running_{true};
+    // False while a standby; replication_ is set before it turns true
+    std::atomic<bool> active_;
+    std::unique_ptr<ReplicationPublisher> replication_;
+
+    // Standby, receive thread only: the journal, the events received lately and the
+    // event_ids the primary has alerted on, so a takeover replays what the primary
+    // received but never alerted
+    std::unique_ptr<ReplicationSubscriber> primary_;
+    std::deque<InboundMessage> held_events_;
+    std::unordered_set<std::string> alerted_ids_;
+    std::deque<std::pair<uint64_t, std::string>> alerted_order_; // (receive ns, event_id)
+    nlohmann::json replicated_metrics_;
+    std::thread receive_thread_;
     std::thread processing_thread_;
     std::thread state_writer_thread_;
+    // Caller's cost of handing central_state.json over; the write itself is off-thread
+    metrics::Histogram* state_write_ns_ = &metrics::histogram("central.state_write_ns");
+
+    std::unordered_map<std::string, WaveformNodeState> waveforms_;
+    std::vector<int16_t> wave_raw_;
+    std::vector<float> wave_buf_;
+    std::vector<dsp::BurstFeatures> bursts_;
 
     std::unordered_map<std::string, NodeState> nodes_;
-    std::deque<nlohmann::json> recent_alerts_;
+    std::deque<icd::CentralAlert> recent_alerts_;
     std::mutex state_mutex_;
 
-    std::shared_ptr<spdlog::logger> alerts_logger_;
+    std::unique_ptr<AlertWriter> alert_writer_;
+    std::unique_ptr<CheckpointWriter> checkpoints_; // journal calls under state_mutex_
 };
 
 } // namespace central
@@ -0,0 +1,395 @@
+#include "checkpoint.hpp"
+#include "histogram.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+namespace surveillance {
+namespace central {
+
+namespace {
+
+constexpr char kMagic[4] = {'S', 'V', 'C', 'K'};
+constexpr uint64_t kVersion = 1;
+constexpr size_t kRecordHeaderBytes = 8; // size + CRC-32
+
+enum RecordType : uint8_t {
+    NODE_UPDATED = 1,
+    ALERTS_COMMITTED = 2
+};
+
+uint32_t crc(const char* data, size_t size) {
+    return static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size)));
+}
+
+void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void put_u32_at(std::string& out, size_t pos, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out[pos + i] = static_cast<char>(v >> (8 * i));
+    }
+}
+
+void put_u32(std::string& out, uint32_t v) {
+    out.append(4, '\0');
+    put_u32_at(out, out.size() - 4, v);
+}
+
+void put_string(std::string& out, std::string_view s) {
+    put_varint(out, s.size());
+    out.append(s);
+}
+
+void put_f64(std::string& out, double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+}
+
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok{true};
+
+    Reader(const char* data, size_t size)
+        : p(reinterpret_cast<const uint8_t*>(data)), end(reinterpret_cast<const uint8_t*>(data) + size) {}
+
+    size_t remaining() const { return static_cast<size_t>(end - p); }
+
+    uint8_t u8() {
+        if (p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+
+    uint32_t u32() {
+        if (remaining() < 4) { ok = false; return 0; }
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(*p++) << (8 * i);
+        return v;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) break;
+            uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::string string() {
+        uint64_t n = varint();
+        if (!ok || remaining() < n) { ok = false; return {}; }
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+
+    double f64() {
+        if (remaining() < 8) { ok = false; return 0.0; }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(*p++) << (8 * i);
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+};
+
+void put_node(std::string& out, const NodeState& state) {
+    put_string(out, state.health);
+    put_f64(out, state.uptime_s);
+    put_varint(out, state.last_sequence_number);
+    put_varint(out, state.last_seen_utc_ms);
+    put_varint(out, state.bytes_sent);
+    put_varint(out, state.edge_triggers);
+    put_varint(out, state.suppressed_events);
+}
+
+NodeState read_node(Reader& in) {
+    NodeState state;
+    state.health = in.string();
+    state.uptime_s = in.f64();
+    state.last_sequence_number = in.varint();
+    state.last_seen_utc_ms = in.varint();
+    state.bytes_sent = in.varint();
+    state.edge_triggers = in.varint();
+    state.suppressed_events = in.varint();
+    return state;
+}
+
+// Typed messages go field by field from their descriptors (icd_messages.hpp)
+template <icd::Message M>
+void put_message(std::string& out, const M& msg) {
+    icd::for_each_field<M>([&](const auto& f) {
+        const auto& v = msg.*(f.member);
+        using V = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<V, std::string>) put_string(out, v);
+        else if constexpr (std::is_same_v<V, uint64_t>) put_varint(out, v);
+        else if constexpr (std::is_same_v<V, double>) put_f64(out, v);
+        else static_assert(sizeof(V) == 0, "field type not supported in checkpoints");
+    });
+}
+
+template <icd::Message M>
+M read_message(Reader& in) {
+    M msg;
+    icd::for_each_field<M>([&](const auto& f) {
+        auto& v = msg.*(f.member);
+        using V = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<V, std::string>) v = in.string();
+        else if constexpr (std::is_same_v<V, uint64_t>) v = in.varint();
+        else if constexpr (std::is_same_v<V, double>) v = in.f64();
+    });
+    return msg;
+}
+
+std::string encode_image(const StateImage& image) {
+    std::string out(kMagic, sizeof(kMagic));
+    put_varint(out, kVersion);
+    put_varint(out, image.seq);
+    put_varint(out, time::utc_now_ms());
+    put_varint(out, image.nodes.size());
+    for (const auto& [node_id, state] : image.nodes) {
+        put_string(out, node_id);
+        put_node(out, state);
+    }
+    put_varint(out, image.recent_alerts.size());
+    for (const auto& alert : image.recent_alerts) {
+        put_message(out, alert);
+    }
+    put_varint(out, image.metrics.size());
+    for (const auto& [key, value] : image.metrics) {
+        put_string(out, key);
+        put_varint(out, value);
+    }
+    put_u32(out, crc(out.data(), out.size()));
+    return out;
+}
+
+bool decode_image(const std::string& data, StateImage& out) {
+    if (data.size() < sizeof(kMagic) + 4 || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    const size_t body = data.size() - 4;
+    Reader tail(data.data() + body, 4);
+    if (tail.u32() != crc(data.data(), body)) {
+        return false;
+    }
+
+    Reader in(data.data() + sizeof(kMagic), body - sizeof(kMagic));
+    if (in.varint() != kVersion) return false;
+    out.seq = in.varint();
+    in.varint(); // written_utc_ms, for humans and tools
+    for (uint64_t n = in.varint(); n > 0 && in.ok; --n) {
+        std::string node_id = in.string();
+        out.nodes[std::move(node_id)] = read_node(in);
+    }
+    for (uint64_t n = in.varint(); n > 0 && in.ok; --n) {
+        out.recent_alerts.push_back(read_message<icd::CentralAlert>(in));
+    }
+    for (uint64_t n = in.varint(); n > 0 && in.ok; --n) {
+        std::string key = in.string();
+        out.metrics[std::move(key)] = in.varint();
+    }
+    return in.ok;
+}
+
+bool read_file(const std::string& path, std::string& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return false;
+    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+} // namespace
+
+CheckpointWriter::CheckpointWriter(const std::string& checkpoint_path, const std::string& journal_path)
+    : checkpoint_path_(checkpoint_path),
+      journal_path_(journal_path)
+{
+    thread_ = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    close();
+}
+
+void CheckpointWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+    if (journal_) {
+        std::fclose(journal_);
+        journal_ = nullptr;
+    }
+}
+
+void CheckpointWriter::begin_record(uint8_t type) {
+    record_start_ = pending_.size();
+    pending_.append(kRecordHeaderBytes, '\0');
+    pending_.push_back(static_cast<char>(type));
+    put_varint(pending_, ++seq_);
+}
+
+void CheckpointWriter::end_record() {
+    const size_t body = record_start_ + kRecordHeaderBytes;
+    const size_t size = pending_.size() - body;
+    put_u32_at(pending_, record_start_, static_cast<uint32_t>(size));
+    put_u32_at(pending_, record_start_ + 4, crc(pending_.data() + body, size));
+}
+
+void CheckpointWriter::node_updated(const std::string& node_id, const NodeState& state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        begin_record(NODE_UPDATED);
+        put_string(pending_, node_id);
+        put_node(pending_, state);
+        end_record();
+    }
+    cv_.notify_one();
+}
+
+void CheckpointWriter::alerts_committed(const std::vector<icd::CentralAlert>& alerts) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        begin_record(ALERTS_COMMITTED);
+        put_varint(pending_, alerts.size());
+        for (const auto& alert : alerts) {
+            put_message(pending_, alert);
+        }
+        end_record();
+    }
+    cv_.notify_one();
+}
+
+void CheckpointWriter::checkpoint(StateImage image) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        image.seq = seq_;
+        pending_image_ = std::move(image);
+        image_at_ = pending_.size();
+    }
+    cv_.notify_one();
+}
+
+void CheckpointWriter::run() {
+    auto& write_time = metrics::histogram("central.checkpoint_write_ns");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return closing_ || !pending_.empty() || pending_image_; });
+        if (pending_.empty() && !pending_image_) break;
+
+        buffer_.swap(pending_);
+        std::optional<StateImage> image = std::move(pending_image_);
+        pending_image_.reset();
+        size_t from = image ? image_at_ : 0;
+        lock.unlock();
+
+        if (image) {
+            // Records before the image are in it. The journal starts over only once the
+            // new checkpoint is in place; until then the old pair stays consistent.
+            uint64_t start_ns = time::monotonic_ns();
+            const std::string bytes = encode_image(*image);
+            const std::string tmp = checkpoint_path_ + ".tmp";
+            bool written = false;
+            if (std::FILE* f = std::fopen(tmp.c_str(), "wb")) {
+                written = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+                written = (std::fclose(f) == 0) && written;
+            }
+            std::error_code ec;
+            if (written) std::filesystem::rename(tmp, checkpoint_path_, ec);
+            if (!written || ec) {
+                metrics::increment("central.checkpoint_errors");
+                SURV_LOG_RATE(logging::Level::error, 1, "Failed to write central checkpoint", {{"path", checkpoint_path_}});
+                from = 0; // keep journaling against the previous checkpoint
+            } else {
+                if (journal_) std::fclose(journal_);
+                journal_ = std::fopen(journal_path_.c_str(), "wb");
+                metrics::increment("central.checkpoints");
+                metrics::add("central.checkpoint_bytes", bytes.size());
+                write_time.record(time::monotonic_ns() - start_ns);
+            }
+        }
+
+        // Records before the first checkpoint have no journal to go to; they are in it
+        if (journal_ && from < buffer_.size()) {
+            std::fwrite(buffer_.data() + from, 1, buffer_.size() - from, journal_);
+            std::fflush(journal_);
+        }
+        buffer_.clear();
+        lock.lock();
+    }
+}
+
+bool load_checkpoint(const std::string& checkpoint_path, const std::string& journal_path,
+                     size_t alerts_buffer, StateImage& out, RestoreStats& stats) {
+    out = StateImage{};
+    stats = RestoreStats{};
+    std::string data;
+    if (!read_file(checkpoint_path, data) || !decode_image(data, out)) {
+        out = StateImage{};
+        return false;
+    }
+    stats.checkpoint_bytes = data.size();
+
+    if (!read_file(journal_path, data)) {
+        return true;
+    }
+    Reader journal(data.data(), data.size());
+    while (journal.remaining() > 0) {
+        const uint32_t size = journal.u32();
+        const uint32_t expected_crc = journal.u32();
+        if (!journal.ok || journal.remaining() < size ||
+            crc(reinterpret_cast<const char*>(journal.p), size) != expected_crc) {
+            stats.journal_torn = true; // the writer died mid-record
+            break;
+        }
+        Reader record(reinterpret_cast<const char*>(journal.p), size);
+        journal.p += size;
+
+        const uint8_t type = record.u8();
+        const uint64_t seq = record.varint();
+        if (seq <= out.seq) continue; // already in the checkpoint
+
+        if (type == NODE_UPDATED) {
+            std::string node_id = record.string();
+            NodeState state = read_node(record);
+            if (record.ok) out.nodes[std::move(node_id)] = std::move(state);
+        } else if (type == ALERTS_COMMITTED) {
+            for (uint64_t n = record.varint(); n > 0 && record.ok; --n) {
+                out.recent_alerts.push_front(read_message<icd::CentralAlert>(record));
+            }
+            while (out.recent_alerts.size() > alerts_buffer) {
+                out.recent_alerts.pop_back();
+            }
+        }
+        out.seq = seq;
+        ++stats.journal_records;
+    }
+    return true;
+}
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,93 @@
+#pragma once
+#include "icd_messages.hpp"
+#include "node_state.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace surveillance {
+namespace central {
+
+// The state a restarted central needs to carry on where it stopped: node health
+// and sequence tracking, the recent alerts and the counters
+struct StateImage {
+    uint64_t seq{0}; // last journal record the image includes
+    std::unordered_map<std::string, NodeState> nodes;
+    std::deque<icd::CentralAlert> recent_alerts; // newest first
+    std::unordered_map<std::string, uint64_t> metrics;
+};
+
+// Binary checkpoint plus change journal of central's state.
+//
+// Every NodeState change and every alerts.jsonl commit is appended to the journal
+// as a small binary record; checkpoint() writes the whole StateImage and starts the
+// journal over after it. Callers only encode into a buffer: a dedicated thread does
+// the file I/O, so the processing thread never waits on the disk. Records and the
+// image are sequence-numbered, so a crash between writing a checkpoint and truncating
+// the journal replays nothing twice. Callers serialize their calls (central holds its
+// state mutex), which keeps the journal in the order the state changed.
+//
+// File formats (little-endian, see docs/Architecture.md §2.12): the checkpoint is a
+// header, the image and a CRC-32; each journal record is its size, its CRC-32 and the
+// record. A torn or corrupt record ends the replay.
+class CheckpointWriter {
+public:
+    CheckpointWriter(const std::string& checkpoint_path, const std::string& journal_path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void node_updated(const std::string& node_id, const NodeState& state);
+    void alerts_committed(const std::vector<icd::CentralAlert>& alerts);
+
+    // Writes `image` (its seq is set here) and restarts the journal after it. A newer
+    // checkpoint queued before the writer got to this one replaces it.
+    void checkpoint(StateImage image);
+
+    // Writes everything queued and stops the writer thread
+    void close();
+
+private:
+    void run();
+    void begin_record(uint8_t type);
+    void end_record();
+
+    std::string checkpoint_path_;
+    std::string journal_path_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string pending_;                  // encoded journal records
+    size_t record_start_{0};
+    std::optional<StateImage> pending_image_;
+    size_t image_at_{0};                   // records before this offset are in the image
+    uint64_t seq_{0};
+    bool closing_{false};
+    std::thread thread_;
+
+    // Writer thread only
+    std::FILE* journal_{nullptr};
+    std::string buffer_;
+};
+
+struct RestoreStats {
+    size_t checkpoint_bytes{0};
+    size_t journal_records{0};
+    bool journal_torn{false};
+};
+
+// Loads the checkpoint and replays the journal records written after it into `out`.
+// Returns false, leaving `out` empty, when there is no valid checkpoint.
+bool load_checkpoint(const std::string& checkpoint_path, const std::string& journal_path,
+                     size_t alerts_buffer, StateImage& out, RestoreStats& stats);
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,19 @@
+#pragma once
+#include <string_view>
+
+namespace surveillance {
+namespace central {
+
+// Rule-based threat classification shared by the processing path and ingest admission.
+inline const char* classify_event(std::string_view event_type, double amplitude, double energy) {
+    if (event_type == "DIGGING" || (energy >= 22.0 && amplitude >= 0.65)) {
+        return "HIGH";
+    }
+    if (event_type == "VEHICLE" || (energy >= 14.0 && amplitude >= 0.45)) {
+        return "MEDIUM";
+    }
+    return "LOW";
+}
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,162 @@
+#include "ingest_queue.hpp"
+#include "classifier.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+
+#include <cstring>
+
+namespace surveillance {
+namespace central {
+
+const char* priority_class_name(PriorityClass cls) {
+    switch (cls) {
+        case PriorityClass::STATUS: return "status";
+        case PriorityClass::HIGH:   return "high";
+        case PriorityClass::MEDIUM: return "medium";
+        case PriorityClass::LOW:    return "low";
+    }
+    return "unknown";
+}
+
+PriorityClass admission_class(const InboundMessage& msg) {
+    const icd::MessageView& view = msg.view;
+    if (view.type == icd::MessageType::NODE_STATUS) {
+        return PriorityClass::STATUS;
+    }
+    if (view.type != icd::MessageType::DISTURBANCE_EVENT) {
+        // Raw waveform samples may hide a HIGH event, but are the bulk of the load; shed before HIGH
+        auto type_it = msg.dom.find("msg_type");
+        if (type_it != msg.dom.end() && *type_it == "WaveformBlock") {
+            return PriorityClass::MEDIUM;
+        }
+        return PriorityClass::LOW;
+    }
+
+    const char* predicted = classify_event(view.event_type, view.signal_amplitude, view.signal_energy);
+    if (std::strcmp(predicted, "HIGH") == 0) return PriorityClass::HIGH;
+    if (std::strcmp(predicted, "MEDIUM") == 0) return PriorityClass::MEDIUM;
+    return PriorityClass::LOW;
+}
+
+IngestQueue::IngestQueue(const IngestQueueConfig& cfg) : cfg_(cfg) {
+    if (cfg_.capacity == 0) cfg_.capacity = 1;
+    if (cfg_.low_priority_sample_every_n < 1) cfg_.low_priority_sample_every_n = 1;
+}
+
+size_t IngestQueue::total_locked() const {
+    size_t total = 0;
+    for (const auto& q : queues_) total += q.size();
+    return total;
+}
+
+size_t IngestQueue::depth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_locked();
+}
+
+uint64_t IngestQueue::dropped(PriorityClass cls) const {
+    return dropped_[static_cast<size_t>(cls)].load(std::memory_order_relaxed);
+}
+
+void IngestQueue::record_drop(PriorityClass cls) {
+    dropped_[static_cast<size_t>(cls)]++;
+    metrics::increment(std::string("central.ingest_dropped_") + priority_class_name(cls));
+}
+
+void IngestQueue::update_overload_locked() {
+    size_t total = total_locked();
+    bool was = overloaded_.load(std::memory_order_relaxed);
+    if (!was && total >= static_cast<size_t>(cfg_.overload_high_watermark * cfg_.capacity)) {
+        overloaded_ = true;
+        low_seen_in_overload_ = 0;
+        metrics::increment("central.ingest_overload_episodes");
+    } else if (was && total <= static_cast<size_t>(cfg_.overload_low_watermark * cfg_.capacity)) {
+        overloaded_ = false;
+    }
+}
+
+bool IngestQueue::offer(PriorityClass cls, InboundMessage msg) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (cfg_.lossless) {
+        not_full_.wait(lock, [this] { return closed_ || total_locked() < cfg_.capacity; });
+        if (closed_) return false;
+    } else {
+        update_overload_locked();
+
+        if (cls == PriorityClass::LOW && overloaded_) {
+            // Keep a predictable 1-in-N sample of low-value events while overloaded
+            if (low_seen_in_overload_++ % static_cast<uint64_t>(cfg_.low_priority_sample_every_n) != 0) {
+                lock.unlock();
+                record_drop(cls);
+                return false;
+            }
+        }
+
+        if (total_locked() >= cfg_.capacity) {
+            // Evict the newest message of the lowest class below the arriving one
+            bool evicted = false;
+            for (size_t c = kNumPriorityClasses; c-- > static_cast<size_t>(cls) + 1;) {
+                if (!queues_[c].empty()) {
+                    queues_[c].pop_back();
+                    record_drop(static_cast<PriorityClass>(c));
+                    evicted = true;
+                    break;
+                }
+            }
+            if (!evicted) {
+                lock.unlock();
+                record_drop(cls);
+                return false;
+            }
+        }
+    }
+
+    queues_[static_cast<size_t>(cls)].push_back({arrival_seq_++, std::move(msg), time::monotonic_ns()});
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+std::optional<IngestItem> IngestQueue::pop(std::chrono::milliseconds wait) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!not_empty_.wait_for(lock, wait, [this] { return closed_ || total_locked() > 0; })) {
+        return std::nullopt;
+    }
+
+    size_t chosen = kNumPriorityClasses;
+    for (size_t c = 0; c < kNumPriorityClasses; ++c) {
+        if (queues_[c].empty()) continue;
+        if (chosen == kNumPriorityClasses) {
+            chosen = c;
+            if (!cfg_.lossless) break; // strict priority
+        } else if (queues_[c].front().arrival < queues_[chosen].front().arrival) {
+            chosen = c; // arrival order
+        }
+    }
+    if (chosen == kNumPriorityClasses) {
+        return std::nullopt;
+    }
+
+    auto& entry = queues_[chosen].front();
+    IngestItem item{static_cast<PriorityClass>(chosen), std::move(entry.msg), entry.enqueued_ns};
+    queues_[chosen].pop_front();
+    if (!cfg_.lossless) {
+        update_overload_locked();
+    }
+    lock.unlock();
+    not_full_.notify_one();
+    return item;
+}
+
+void IngestQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+}
+
+} // namespace central
+} // namespace surveillance
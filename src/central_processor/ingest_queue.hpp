@@ -0,0 +1,120 @@
+#pragma once
+#include "icd_parser.hpp"
+#include <zmq.hpp>
+#include <nlohmann/json.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace surveillance {
+namespace central {
+
+// Admission classes, highest priority first. Status messages keep node health
+// accurate, HIGH/MEDIUM are predicted from the same rules as the classifier.
+enum class PriorityClass : int {
+    STATUS = 0,
+    HIGH = 1,
+    MEDIUM = 2,
+    LOW = 3
+};
+
+constexpr size_t kNumPriorityClasses = 4;
+
+const char* priority_class_name(PriorityClass cls);
+
+// One received message and the storage its view points into: the ZMQ frame for
+// JSON text parsed by icd::parse, or a json DOM for decoded codec frames and message
+// types the ICD parser does not cover (`view.type` is OTHER and only `dom` is set).
+// Moving re-points the view at the moved frame.
+struct InboundMessage {
+    InboundMessage() = default;
+    InboundMessage(InboundMessage&& other) noexcept { *this = std::move(other); }
+    InboundMessage& operator=(InboundMessage&& other) noexcept {
+        const char* from = static_cast<const char*>(other.frame.data());
+        frame = std::move(other.frame);
+        dom = std::move(other.dom);
+        view = other.view;
+        rx_ns = other.rx_ns;
+        if (frame.size() > 0) {
+            view.rebase(from, static_cast<const char*>(frame.data()));
+        }
+        return *this;
+    }
+
+    zmq::message_t frame;
+    nlohmann::json dom;
+    icd::MessageView view;
+    uint64_t rx_ns{0}; // monotonic receive stamp (hops::CENTRAL_RX)
+};
+
+// Cheap pre-classification of a received message, done on the receive thread.
+PriorityClass admission_class(const InboundMessage& msg);
+
+struct IngestItem {
+    PriorityClass cls;
+    InboundMessage msg;
+    uint64_t enqueued_ns;
+};
+
+struct IngestQueueConfig {
+    size_t capacity{10000};
+    double overload_high_watermark{0.8};
+    double overload_low_watermark{0.5};
+    int low_priority_sample_every_n{10};
+    // Lossless mode blocks the producer when full and pops in arrival order.
+    // Used in deterministic mode, where shedding or reordering would change the alert sequence.
+    bool lossless{false};
+};
+
+// Bounded ingest queue between the ZMQ receive thread and the processing thread.
+// Under overload, LOW events are sampled 1-in-N; when full, an arriving message evicts
+// the newest queued message of a strictly lower class, otherwise it is dropped.
+class IngestQueue {
+public:
+    explicit IngestQueue(const IngestQueueConfig& cfg);
+
+    // Returns false if the message was shed or dropped.
+    bool offer(PriorityClass cls, InboundMessage msg);
+
+    std::optional<IngestItem> pop(std::chrono::milliseconds wait);
+
+    // Wakes any blocked producer/consumer so threads can observe shutdown.
+    void close();
+
+    bool overloaded() const { return overloaded_.load(std::memory_order_relaxed); }
+    size_t depth() const;
+    size_t capacity() const { return cfg_.capacity; }
+    uint64_t dropped(PriorityClass cls) const;
+
+private:
+    struct Entry {
+        uint64_t arrival;
+        InboundMessage msg;
+        uint64_t enqueued_ns;
+    };
+
+    size_t total_locked() const;
+    void record_drop(PriorityClass cls);
+    void update_overload_locked();
+
+    IngestQueueConfig cfg_;
+    std::array<std::deque<Entry>, kNumPriorityClasses> queues_;
+    std::array<std::atomic<uint64_t>, kNumPriorityClasses> dropped_{};
+    uint64_t arrival_seq_{0};
+    uint64_t low_seen_in_overload_{0};
+    std::atomic<bool> overloaded_{false};
+    bool closed_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+} // namespace central
+} // namespace surveillance
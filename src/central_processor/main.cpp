@@ -1,8 +1,15 @@
 #include "central_processor.hpp"
+#include "control.hpp"
 #include "logging.hpp"
+#include "readiness.hpp"
+#include "runtime.hpp"
+#include "shard_ring.hpp"
+#include "shm_ring.hpp"
+#include "trace.hpp"
 #include "ids.hpp"
 #include <iostream>
 #include <csignal>
+#include <memory>
 #include <thread>
 
 using namespace surveillance;
@@ -17,30 +24,75 @@ int main(int argc, char** argv) {
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
+    // Usage: central_processor [config] [--shard <k> | --standby]
     std::string config_path = "config/system_nominal.json";
-    if (argc > 1) {
-        config_path = argv[1];
+    int shard = -1;
+    bool standby = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shard" && i + 1 < argc) shard = std::stoi(argv[++i]);
+        else if (arg == "--standby") standby = true;
+        else config_path = arg;
     }
 
     auto cfg = config::load(config_path);
     if (cfg.system.mode == "deterministic") {
         ids::seed(cfg.system.seed_base + 100);
     }
-    
-    logging::init("central", cfg.logging.log_dir, cfg.logging.flush_every_n);
-    logging::info("Starting central processor");
+    if (cfg.central.shards > 1 && (shard < 0 || shard >= cfg.central.shards)) {
+        std::cerr << "central.shards is " << cfg.central.shards << ": pass --shard <0.."
+                  << cfg.central.shards - 1 << ">\n";
+        return 1;
+    }
+    if (cfg.central.shards == 1) {
+        shard = -1; // unsharded, whatever was passed
+    }
+    if (standby && (cfg.central.shards > 1 || cfg.system.mode == "deterministic" ||
+                    cfg.central.replication_endpoint.empty())) {
+        std::cerr << "--standby needs an unsharded live-mode central with central.replication_endpoint set\n";
+        return 1;
+    }
+    if (standby && shm::is_shm_endpoint(cfg.transport.central_feed)) {
+        // The ring has one consumer, and it is the primary's
+        std::cerr << "--standby cannot share a shm:// central_feed with the primary\n";
+        return 1;
+    }
+
+    // Each shard is its own component: central_<k>.jsonl, central_<k>.ready, ...
+    // The standby keeps its name after a takeover, only its readiness marker changes.
+    const std::string component = standby ? std::string("central_standby") : "central" + shard::suffix(shard);
+    logging::init(component, cfg.logging);
+    readiness::clear(cfg.logging.log_dir, component);
+    trace::init(component, cfg.logging.log_dir, cfg.tracing);
+    runtime::configure(cfg.runtime, component);
+    logging::info("Starting central processor", {{"shard", shard}, {"shards", cfg.central.shards}, {"standby", standby}});
 
     zmq::context_t ctx{1};
-    central::CentralProcessor central{cfg, ctx};
-    central.run();
+    auto control_listener = control::start(ctx, cfg.logging.control_endpoint, component);
+    std::unique_ptr<central::CentralProcessor> central;
+    try {
+        central = std::make_unique<central::CentralProcessor>(
+            cfg, ctx, shard, standby ? central::Role::STANDBY : central::Role::PRIMARY);
+    } catch (const zmq::error_t& e) {
+        // Most likely a standby has taken over and holds the replication endpoint
+        logging::error("Central processor failed to bind", {{"error", e.what()}});
+        std::cerr << "central_processor: " << e.what() << " (another central is primary? restart with --standby)\n";
+        trace::shutdown();
+        logging::shutdown();
+        return 1;
+    }
+    central->run();
 
     while (!g_quit) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
-    central.stop();
+    central->stop();
     
+    control_listener.reset();
     logging::info("Central processor shutting down");
+    readiness::clear(cfg.logging.log_dir, component);
+    trace::shutdown();
     logging::shutdown();
     return 0;
 }
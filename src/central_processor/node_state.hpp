@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace surveillance {
+namespace central {
+
+// What central knows about a node, from its NodeStatus messages
+struct NodeState {
+    std::string health{"UNKNOWN"};
+    double uptime_s{0.0};
+    uint64_t last_sequence_number{0};
+    uint64_t last_seen_utc_ms{0};
+    uint64_t bytes_sent{0};
+    uint64_t edge_triggers{0};
+    uint64_t suppressed_events{0};
+};
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,57 @@
+#include "quarantine.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+namespace surveillance {
+namespace central {
+
+Quarantine::Quarantine(const std::string& path, size_t max_records) : max_records_(max_records) {
+    file_ = std::fopen(path.c_str(), "w");
+    if (!file_) {
+        logging::error("Failed to open quarantine file", {{"path", path}});
+    }
+}
+
+Quarantine::~Quarantine() {
+    if (file_) std::fclose(file_);
+}
+
+void Quarantine::add(icd::ParseError reason, const void* data, size_t size) {
+    metrics::increment("invalid_messages_total");
+    metrics::increment(std::string("central.invalid_messages.") + icd::parse_error_name(reason));
+    if (++total_ > max_records_ || !file_) return;
+
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    size_t n = std::min(size, kMaxFrameBytes);
+    bool printable = std::all_of(bytes, bytes + n, [](unsigned char c) { return c >= 0x20 || c == '\n' || c == '\t'; });
+
+    nlohmann::json record = {
+        {"reason", icd::parse_error_name(reason)},
+        {"timestamp_utc", time::utc_now_string()},
+        {"size", size}
+    };
+    if (printable) {
+        record["frame"] = std::string(reinterpret_cast<const char*>(bytes), n);
+    } else {
+        static const char* kHex = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(2 * n);
+        for (size_t i = 0; i < n; ++i) {
+            hex.push_back(kHex[bytes[i] >> 4]);
+            hex.push_back(kHex[bytes[i] & 0xF]);
+        }
+        record["frame_hex"] = std::move(hex);
+    }
+    // Invalid UTF-8 in a printable frame would make dump() throw; replace it instead
+    line_ = record.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    line_.push_back('\n');
+    std::fwrite(line_.data(), 1, line_.size(), file_);
+    std::fflush(file_);
+}
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,40 @@
+#pragma once
+#include "icd_parser.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace surveillance {
+namespace central {
+
+// Counted quarantine for inbound messages that fail ICD validation.
+//
+// Every rejected message is counted in invalid_messages_total and
+// central.invalid_messages.<reason>. The first `max_records` are also kept in
+// `path` (one JSON line each: reason, receive time and the frame, as text when it
+// is printable and as hex otherwise, truncated to kMaxFrameBytes) so a bad sender
+// can be diagnosed after the run. Receive thread only.
+class Quarantine {
+public:
+    static constexpr size_t kMaxFrameBytes = 4096;
+
+    Quarantine(const std::string& path, size_t max_records);
+    ~Quarantine();
+
+    Quarantine(const Quarantine&) = delete;
+    Quarantine& operator=(const Quarantine&) = delete;
+
+    void add(icd::ParseError reason, const void* data, size_t size);
+
+    uint64_t total() const { return total_; }
+
+private:
+    std::FILE* file_{nullptr};
+    size_t max_records_;
+    uint64_t total_{0};
+    std::string line_;
+};
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,66 @@
+#include "replication.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+#include "zmq_utils.hpp"
+
+namespace surveillance {
+namespace central {
+
+ReplicationPublisher::ReplicationPublisher(zmq::context_t& ctx, const std::string& endpoint, int heartbeat_ms)
+    : socket_(zmq_utils::create_publisher(ctx, endpoint, true)),
+      heartbeat_ns_(static_cast<uint64_t>(heartbeat_ms) * 1000000ULL)
+{
+}
+
+void ReplicationPublisher::publish(const char* msg_type, nlohmann::json record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    record["msg_type"] = msg_type;
+    record["seq"] = ++seq_;
+    record["monotonic_ns"] = time::monotonic_ns();
+    if (zmq_utils::publish_json(socket_, record)) {
+        metrics::increment("central.replication_records");
+    }
+}
+
+void ReplicationPublisher::heartbeat_if_due() {
+    const uint64_t now_ns = time::monotonic_ns();
+    if (now_ns < next_heartbeat_ns_) return;
+    next_heartbeat_ns_ = now_ns + heartbeat_ns_;
+    publish("CentralHeartbeat", nlohmann::json::object());
+}
+
+ReplicationSubscriber::ReplicationSubscriber(zmq::context_t& ctx, const std::string& endpoint)
+    : socket_(zmq_utils::create_subscriber(ctx, endpoint, false)),
+      last_heard_ns_(time::monotonic_ns())
+{
+}
+
+void ReplicationSubscriber::reset_last_heard() {
+    last_heard_ns_ = time::monotonic_ns();
+}
+
+std::optional<nlohmann::json> ReplicationSubscriber::receive() {
+    while (auto record = zmq_utils::receive_json(socket_)) {
+        const uint64_t now_ns = time::monotonic_ns();
+        last_heard_ns_ = now_ns;
+
+        const uint64_t sent_ns = record->value("monotonic_ns", uint64_t{0});
+        if (sent_ns != 0 && sent_ns <= now_ns) {
+            lag_->record(now_ns - sent_ns);
+        }
+        // A lower seq is a new primary starting over, not a gap
+        const uint64_t seq = record->value("seq", uint64_t{0});
+        if (next_seq_ != 0 && seq > next_seq_) {
+            metrics::add("central.replication_gaps", seq - next_seq_);
+        }
+        next_seq_ = seq + 1;
+
+        if (record->value("msg_type", "") != "CentralHeartbeat") {
+            return record;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,65 @@
+#pragma once
+#include "histogram.hpp"
+#include <zmq.hpp>
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace surveillance {
+namespace central {
+
+// State journal from a primary central to its hot standby (ICD §2.8).
+//
+// The primary publishes every change to the state the operator sees: a
+// NodeStateUpdate per NodeStatus, an AlertsCommitted per alerts.jsonl commit, a full
+// StateSnapshot every second (which a standby that just joined, or lost a record,
+// converges from) and a CentralHeartbeat every central.replication_heartbeat_ms.
+// Records are JSON lines numbered by `seq` and stamped with the primary's monotonic
+// clock, which is also what replication lag is measured against.
+class ReplicationPublisher {
+public:
+    // Binds `endpoint`. Throws zmq::error_t while another primary still holds it.
+    ReplicationPublisher(zmq::context_t& ctx, const std::string& endpoint, int heartbeat_ms);
+
+    ReplicationPublisher(const ReplicationPublisher&) = delete;
+    ReplicationPublisher& operator=(const ReplicationPublisher&) = delete;
+
+    // Sets msg_type, seq and monotonic_ns on `record` and publishes it. Any thread.
+    void publish(const char* msg_type, nlohmann::json record);
+
+    // Publishes a CentralHeartbeat when one is due
+    void heartbeat_if_due();
+
+private:
+    zmq::socket_t socket_;
+    uint64_t heartbeat_ns_;
+    uint64_t next_heartbeat_ns_{0};
+    uint64_t seq_{0};
+    std::mutex mutex_;
+};
+
+// Standby side of the journal. One thread.
+class ReplicationSubscriber {
+public:
+    ReplicationSubscriber(zmq::context_t& ctx, const std::string& endpoint);
+
+    // Next record other than a heartbeat, without blocking. Every record received
+    // counts as hearing from the primary and is recorded in central.replication_lag_ns;
+    // missing sequence numbers are counted in central.replication_gaps.
+    std::optional<nlohmann::json> receive();
+
+    // Monotonic time the primary was last heard from (construction until then)
+    uint64_t last_heard_ns() const { return last_heard_ns_; }
+    void reset_last_heard();
+
+private:
+    zmq::socket_t socket_;
+    uint64_t last_heard_ns_;
+    uint64_t next_seq_{0};
+    metrics::Histogram* lag_ = &metrics::histogram("central.replication_lag_ns");
+};
+
+} // namespace central
+} // namespace surveillance
@@ -0,0 +1,233 @@
+#include "rollups.hpp"
+#include "icd_messages.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace surveillance {
+namespace central {
+
+namespace {
+
+constexpr double kFirstBucketMs = 0.1;
+constexpr double kQuantiles[3] = {0.50, 0.90, 0.99};
+constexpr const char* kQuantileNames[3] = {"p50", "p90", "p99"};
+
+size_t class_index(std::string_view classification) {
+    for (size_t c = 0; c < Rollups::kClasses; ++c) {
+        if (icd::kClassifications[c] == classification) return c;
+    }
+    return Rollups::kClasses;
+}
+
+} // namespace
+
+Rollups::Series::Series() {
+    for (size_t r = 0; r < kResolutions.size(); ++r) {
+        rings[r].resize(kResolutions[r].slots);
+    }
+}
+
+Rollups::Rollups(size_t max_nodes) : max_nodes_(max_nodes) {}
+
+size_t Rollups::bucket_index(double latency_ms) {
+    if (!(latency_ms > kFirstBucketMs)) return 0;
+    const double i = std::ceil(4.0 * std::log2(latency_ms / kFirstBucketMs));
+    return std::min(static_cast<size_t>(i), kLatencyBuckets - 1);
+}
+
+double Rollups::bucket_upper_ms(size_t index) {
+    // The last bucket holds everything above the one before it
+    index = std::min(index, kLatencyBuckets - 2);
+    return kFirstBucketMs * std::exp2(static_cast<double>(index) / 4.0);
+}
+
+void Rollups::add(Series& s, uint64_t utc_s, uint32_t lost, size_t cls, size_t bucket) {
+    for (size_t r = 0; r < kResolutions.size(); ++r) {
+        const int64_t index = static_cast<int64_t>(utc_s / static_cast<uint64_t>(kResolutions[r].seconds));
+        Slot& slot = s.rings[r][static_cast<size_t>(index) % kResolutions[r].slots];
+        if (slot.index != index) {
+            if (slot.index > index) continue; // older than the ring reaches back
+            slot = Slot{};
+            slot.index = index;
+        }
+        slot.events += 1;
+        slot.lost += lost;
+        if (cls < kClasses) slot.alerts[cls] += 1;
+        slot.latency[bucket] += 1;
+        slot.summarized = false;
+    }
+}
+
+void Rollups::credit(Series& s, uint64_t utc_s) {
+    for (size_t r = 0; r < kResolutions.size(); ++r) {
+        const int64_t index = static_cast<int64_t>(utc_s / static_cast<uint64_t>(kResolutions[r].seconds));
+        Slot& slot = s.rings[r][static_cast<size_t>(index) % kResolutions[r].slots];
+        if (slot.index == index && slot.lost > 0) slot.lost -= 1;
+    }
+}
+
+int64_t Rollups::track(Node& node, uint64_t sequence, uint64_t utc_s, uint64_t& found_s) {
+    if (!node.seen) {
+        node.seen = true;
+        node.highest = sequence;
+        node.received = 1;
+        return 0;
+    }
+    if (sequence > node.highest) {
+        const uint64_t ahead = sequence - node.highest;
+        for (uint64_t missing = node.highest + 1; missing < sequence && sequence - missing < kReorderWindow; ++missing) {
+            node.gap_s[missing % kReorderWindow] = utc_s;
+        }
+        node.received = ahead >= kReorderWindow ? 0 : node.received << ahead;
+        node.received |= 1;
+        node.highest = sequence;
+        return static_cast<int64_t>(std::min<uint64_t>(ahead - 1, INT32_MAX));
+    }
+    const uint64_t behind = node.highest - sequence;
+    if (behind >= kReorderWindow) return 0; // too late to tell; its gap stays counted
+    const uint64_t bit = uint64_t{1} << behind;
+    if (node.received & bit) return 0;      // duplicate
+    node.received |= bit;
+    found_s = node.gap_s[sequence % kReorderWindow];
+    return -1;
+}
+
+void Rollups::record(const std::string& node_id, uint64_t central_utc_ms, std::optional<uint64_t> sequence,
+                     std::string_view classification, double latency_ms) {
+    const size_t cls = class_index(classification);
+    const size_t bucket = bucket_index(latency_ms);
+    const uint64_t utc_s = central_utc_ms / 1000;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& node = nodes_[node_id];
+    if (!node.series && tracked_nodes_ < max_nodes_) {
+        node.series = std::make_unique<Series>();
+        ++tracked_nodes_;
+    }
+
+    uint32_t lost = 0;
+    if (sequence) {
+        uint64_t found_s = 0;
+        const int64_t delta = track(node, *sequence, utc_s, found_s);
+        if (delta > 0) {
+            lost = static_cast<uint32_t>(delta);
+        } else if (delta < 0) {
+            // A late arrival fills a gap counted earlier
+            credit(fleet_, found_s);
+            if (node.series) credit(*node.series, found_s);
+        }
+    }
+
+    add(fleet_, utc_s, lost, cls, bucket);
+    if (node.series) add(*node.series, utc_s, lost, cls, bucket);
+    latest_ms_ = std::max(latest_ms_, central_utc_ms);
+}
+
+void Rollups::node_restarted(const std::string& node_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = nodes_.find(node_id);
+    if (it != nodes_.end()) it->second.seen = false;
+}
+
+void Rollups::summarize(Series& s, size_t r, int64_t end_index, std::vector<Summary>& out) {
+    const auto& res = kResolutions[r];
+    auto& ring = s.rings[r];
+    for (int64_t index = end_index - static_cast<int64_t>(res.slots) + 1; index <= end_index; ++index) {
+        Summary sum;
+        Slot& slot = ring[static_cast<size_t>(index) % res.slots];
+        if (index >= 0 && slot.index == index) {
+            if (!slot.summarized) {
+                // One pass over the buckets for all three quantiles
+                size_t q = 0;
+                uint64_t seen = 0;
+                for (size_t b = 0; b < kLatencyBuckets && q < 3; ++b) {
+                    seen += slot.latency[b];
+                    while (q < 3 && seen > 0 && static_cast<double>(seen) >= kQuantiles[q] * slot.events) {
+                        slot.percentiles[q++] = static_cast<float>(bucket_upper_ms(b));
+                    }
+                }
+                slot.summarized = true;
+            }
+            sum.used = true;
+            sum.events = slot.events;
+            sum.lost = slot.lost;
+            sum.alerts = slot.alerts;
+            sum.percentiles = slot.percentiles;
+        }
+        out.push_back(sum);
+    }
+}
+
+nlohmann::json Rollups::series_json(const Summary* slots, size_t r, int64_t end_index) {
+    const auto& res = kResolutions[r];
+    nlohmann::json events = nlohmann::json::array();
+    nlohmann::json lost = nlohmann::json::array();
+    std::array<nlohmann::json, kClasses> alerts;
+    std::array<nlohmann::json, 3> percentiles;
+    for (auto& a : alerts) a = nlohmann::json::array();
+    for (auto& p : percentiles) p = nlohmann::json::array();
+
+    for (size_t i = 0; i < res.slots; ++i) {
+        const Summary& slot = slots[i];
+        events.push_back(slot.events);
+        lost.push_back(slot.lost);
+        for (size_t c = 0; c < kClasses; ++c) alerts[c].push_back(slot.alerts[c]);
+        for (size_t q = 0; q < 3; ++q) {
+            if (slot.used) {
+                percentiles[q].push_back(std::round(slot.percentiles[q] * 1000.0) / 1000.0);
+            } else {
+                percentiles[q].push_back(nullptr);
+            }
+        }
+    }
+
+    nlohmann::json alerts_json = nlohmann::json::object();
+    for (size_t c = 0; c < kClasses; ++c) alerts_json[std::string(icd::kClassifications[c])] = std::move(alerts[c]);
+    nlohmann::json latency_json = nlohmann::json::object();
+    for (size_t q = 0; q < 3; ++q) latency_json[kQuantileNames[q]] = std::move(percentiles[q]);
+    return {{"start_s", (end_index - static_cast<int64_t>(res.slots) + 1) * res.seconds},
+            {"step_s", res.seconds},
+            {"events", std::move(events)},
+            {"lost", std::move(lost)},
+            {"alerts", std::move(alerts_json)},
+            {"latency_ms", std::move(latency_json)}};
+}
+
+nlohmann::json Rollups::to_json(uint64_t now_ms) {
+    std::array<int64_t, kResolutions.size()> end_index{};
+    std::vector<std::string> node_ids;
+    std::vector<Summary> slots; // fleet, then each node; every ring of each in turn
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t end_s = std::max(now_ms, latest_ms_) / 1000;
+        for (size_t r = 0; r < kResolutions.size(); ++r) {
+            end_index[r] = static_cast<int64_t>(end_s / static_cast<uint64_t>(kResolutions[r].seconds));
+            summarize(fleet_, r, end_index[r], slots);
+        }
+        for (auto& [node_id, node] : nodes_) {
+            if (!node.series) continue;
+            node_ids.push_back(node_id);
+            for (size_t r = 0; r < kResolutions.size(); ++r) summarize(*node.series, r, end_index[r], slots);
+        }
+    }
+
+    const Summary* next = slots.data();
+    auto encode = [&] {
+        nlohmann::json series = nlohmann::json::object();
+        for (size_t r = 0; r < kResolutions.size(); ++r) {
+            series[std::to_string(kResolutions[r].seconds)] = series_json(next, r, end_index[r]);
+            next += kResolutions[r].slots;
+        }
+        return series;
+    };
+    nlohmann::json resolutions = nlohmann::json::array();
+    for (const auto& res : kResolutions) resolutions.push_back(res.seconds);
+    nlohmann::json fleet = encode();
+    nlohmann::json nodes = nlohmann::json::object();
+    for (const auto& node_id : node_ids) nodes[node_id] = encode();
+    return {{"resolutions", std::move(resolutions)}, {"fleet", std::move(fleet)}, {"nodes", std::move(nodes)}};
+}
+
+} // namespace central
+} // namespace surveillance
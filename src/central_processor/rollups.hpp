@@ -0,0 +1,128 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace surveillance {
+namespace central {
+
+// Time-series rollups of the event stream for the operator UI's charts.
+//
+// For the fleet and for each node, three rings of fixed-size slots hold per-second,
+// per-10 s and per-minute counts of events, alerts by classification and events lost
+// (gaps in a node's sequence numbers), plus a latency histogram. Slot k of a ring
+// covers [k, k + 1) * resolution seconds of central's clock, at position k % length. A
+// slot that still holds an older k is cleared when the ring comes round to it. Recording
+// an event touches one slot per ring, for the node and for the fleet. Nodes beyond
+// `max_nodes` count in the fleet series only.
+//
+// Events of one node may arrive out of order (network jitter, and the ingest queue
+// serves HIGH before MEDIUM and LOW). A gap counts as lost in the slot where it is seen,
+// and an event that fills it later, within the last kReorderWindow sequence numbers, is
+// credited back to that slot. Anything older is ignored. A node's numbering starts over
+// only on node_restarted(), never because a lower number arrives.
+//
+// Latency percentiles are the upper bound of their histogram bucket, a quarter octave
+// wide (at most 19% above the true value), between 0.1 ms and 1.6 s; anything slower
+// reports 1.6 s.
+//
+// Thread-safe: the processing thread records, the state writer snapshots. The
+// snapshot is copied under the lock and encoded after it.
+class Rollups {
+public:
+    struct Resolution {
+        int seconds;
+        size_t slots;
+    };
+    // 1 minute of seconds, 10 minutes of 10 s, 1 hour of minutes
+    static constexpr std::array<Resolution, 3> kResolutions{{{1, 60}, {10, 60}, {60, 60}}};
+    static constexpr size_t kClasses = 3; // icd::kClassifications
+    static constexpr size_t kLatencyBuckets = 58;
+    static constexpr uint64_t kReorderWindow = 64;
+
+    explicit Rollups(size_t max_nodes);
+
+    // `sequence` is the event's sequence_number, absent for events derived at central
+    void record(const std::string& node_id, uint64_t central_utc_ms, std::optional<uint64_t> sequence,
+                std::string_view classification, double latency_ms);
+
+    // The node rebooted (its uptime went back); its sequence numbers start over
+    void node_restarted(const std::string& node_id);
+
+    // The rings up to the slot holding `now_ms`, or the latest event when that is later
+    // (deterministic mode passes 0 and gets the simulated clock):
+    //   { "resolutions": [1, 10, 60],
+    //     "fleet": { "<res>": <series>, ... },
+    //     "nodes": { "<node_id>": { "<res>": <series>, ... }, ... } }
+    // where a series lists its slots oldest first:
+    //   { "start_s": <UTC seconds of the first slot>, "step_s": <res>,
+    //     "events": [...], "lost": [...], "alerts": { "LOW": [...], "MEDIUM": [...], "HIGH": [...] },
+    //     "latency_ms": { "p50": [...], "p90": [...], "p99": [...] } }
+    // Percentiles are null for slots without events.
+    nlohmann::json to_json(uint64_t now_ms);
+
+    // Upper bound in ms of the latency bucket at `index`
+    static double bucket_upper_ms(size_t index);
+    static size_t bucket_index(double latency_ms);
+
+private:
+    struct Slot {
+        int64_t index{-1}; // utc_s / resolution; -1 never used
+        uint32_t events{0};
+        uint32_t lost{0};
+        std::array<uint32_t, kClasses> alerts{};
+        std::array<uint32_t, kLatencyBuckets> latency{};
+        // Percentiles cached by to_json until the slot changes
+        bool summarized{false};
+        std::array<float, 3> percentiles{};
+    };
+
+    struct Series {
+        Series();
+        std::array<std::vector<Slot>, kResolutions.size()> rings;
+    };
+
+    struct Node {
+        uint64_t highest{0};  // highest sequence number seen
+        uint64_t received{0}; // bit i: highest - i arrived
+        bool seen{false};
+        std::array<uint64_t, kReorderWindow> gap_s{}; // by sequence % window: second its loss was counted
+        std::unique_ptr<Series> series; // null past max_nodes
+    };
+
+    // What to_json reports of a slot, copied out under the lock
+    struct Summary {
+        bool used{false};
+        uint32_t events{0};
+        uint32_t lost{0};
+        std::array<uint32_t, kClasses> alerts{};
+        std::array<float, 3> percentiles{};
+    };
+
+    static void add(Series& s, uint64_t utc_s, uint32_t lost, size_t cls, size_t bucket);
+    // Takes back one lost event counted at `utc_s`, where the rings still hold it
+    static void credit(Series& s, uint64_t utc_s);
+    // Events lost (> 0) or found (< 0, their seconds in `found_s`) by `sequence`
+    static int64_t track(Node& node, uint64_t sequence, uint64_t utc_s, uint64_t& found_s);
+    // The ring's slots from end_index back, oldest first, appended to `out`
+    static void summarize(Series& s, size_t r, int64_t end_index, std::vector<Summary>& out);
+    static nlohmann::json series_json(const Summary* slots, size_t r, int64_t end_index);
+
+    const size_t max_nodes_;
+    std::mutex mutex_;
+    Series fleet_;
+    std::unordered_map<std::string, Node> nodes_;
+    size_t tracked_nodes_{0};
+    uint64_t latest_ms_{0};
+};
+
+} // namespace central
+} // namespace surveillance
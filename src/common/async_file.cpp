@@ -0,0 +1,669 @@
+#include "async_file.hpp"
+#include "histogram.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace surveillance {
+namespace aio {
+
+namespace {
+
+struct Replacement {
+    std::string path;
+    std::string data;
+    int fd{-1};
+    size_t done{0};
+    uint64_t queued_ns{0};
+};
+
+#if !defined(_WIN32)
+// `written`, if given, receives the bytes that reached the file, also on failure
+bool write_all(int fd, const char* data, size_t size, uint64_t offset, size_t* written = nullptr) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pwrite(fd, data + done, size - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    if (written) *written = done;
+    return done == size;
+}
+
+bool datasync(int fd) {
+#if defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+#endif
+
+// Whole replacement on the calling thread: write path.tmp, rename over path
+bool replace_now(const std::string& path, const std::string& data) {
+    const std::string tmp = path + ".tmp";
+#if defined(_WIN32)
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!f) return false;
+    }
+#else
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = write_all(fd, data.data(), data.size(), 0);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) return false;
+#endif
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+#if defined(__linux__)
+// Minimal io_uring: one submission and one completion ring, no SQPOLL, no registered
+// buffers. Only the engine thread touches it.
+class Uring {
+public:
+    ~Uring() {
+        if (sqes_) ::munmap(sqes_, sqes_bytes_);
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_bytes_);
+        if (sq_ptr_) ::munmap(sq_ptr_, sq_bytes_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params p{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0) return false;
+        // IORING_OP_WRITE arrived together with this feature (5.6)
+        if (!(p.features & IORING_FEAT_RW_CUR_POS) || !(p.features & IORING_FEAT_NODROP)) return false;
+
+        sq_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+        sq_ptr_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+        if (!sq_ptr_) return false;
+        cq_ptr_ = single ? sq_ptr_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+        if (!cq_ptr_) return false;
+        sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+        if (!sqes_) return false;
+
+        char* sq = static_cast<char*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        char* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        sq_entries_ = p.sq_entries;
+        cq_entries_ = p.cq_entries;
+        sqe_tail_ = submitted_ = *sq_tail_;
+        return true;
+    }
+
+    unsigned sq_entries() const { return sq_entries_; }
+    unsigned cq_entries() const { return cq_entries_; }
+
+    // nullptr when the submission ring is full
+    io_uring_sqe* get_sqe() {
+        unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sqe_tail_ - head >= sq_entries_) return nullptr;
+        unsigned index = sqe_tail_ & sq_mask_;
+        sq_array_[index] = index;
+        io_uring_sqe* sqe = &sqes_[index];
+        *sqe = io_uring_sqe{};
+        ++sqe_tail_;
+        return sqe;
+    }
+
+    // Submits the prepared entries and, with `wait_nr`, waits for that many completions
+    void submit(unsigned wait_nr) {
+        __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+        while (true) {
+            unsigned to_submit = sqe_tail_ - submitted_;
+            if (to_submit == 0 && wait_nr == 0) return;
+            long ret = ::syscall(__NR_io_uring_enter, fd_, to_submit, wait_nr,
+                                 wait_nr ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (ret >= 0) {
+                submitted_ += static_cast<unsigned>(ret);
+                if (submitted_ == sqe_tail_) return;
+                continue;
+            }
+            if (errno == EINTR) continue;
+            // EBUSY/EAGAIN: completions must be reaped first; the caller does that next
+            metrics::increment("aio.uring_enter_errors");
+            return;
+        }
+    }
+
+    // Calls fn(user_data, res) for every completion
+    template <typename Fn>
+    void reap(Fn&& fn) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            uint64_t user_data = cqe.user_data;
+            int res = cqe.res;
+            ++head;
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            fn(user_data, res);
+            tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        }
+    }
+
+private:
+    void* map(size_t bytes, uint64_t offset) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, static_cast<off_t>(offset));
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    int fd_{-1};
+    void* sq_ptr_{nullptr};
+    void* cq_ptr_{nullptr};
+    size_t sq_bytes_{0};
+    size_t cq_bytes_{0};
+    io_uring_sqe* sqes_{nullptr};
+    size_t sqes_bytes_{0};
+    unsigned* sq_head_{nullptr};
+    unsigned* sq_tail_{nullptr};
+    unsigned* sq_array_{nullptr};
+    unsigned sq_mask_{0};
+    unsigned* cq_head_{nullptr};
+    unsigned* cq_tail_{nullptr};
+    unsigned cq_mask_{0};
+    io_uring_cqe* cqes_{nullptr};
+    unsigned sq_entries_{0};
+    unsigned cq_entries_{0};
+    unsigned sqe_tail_{0};
+    unsigned submitted_{0};
+};
+
+// user_data: the File or Replacement pointer with the operation in the low bits
+constexpr uint64_t kOpFileWrite = 0;
+constexpr uint64_t kOpFileSync = 1;
+constexpr uint64_t kOpReplaceWrite = 2;
+constexpr uint64_t kOpMask = 3;
+// IORING_OP_WRITE takes a 32-bit length; the rest of a longer write is a short write
+constexpr size_t kMaxSqeBytes = size_t(1) << 30;
+#endif
+
+std::mutex g_configure_mutex;
+std::atomic<int> g_backend{static_cast<int>(Backend::SYNC)};
+uint64_t g_max_pending_bytes = 8 << 20;
+
+} // namespace
+
+class Engine {
+public:
+    explicit Engine(Backend backend) : backend_(backend) {}
+
+#if defined(__linux__)
+    bool init_uring() { return ring_.init(256); }
+#endif
+
+    void start(int threads) {
+#if defined(__linux__)
+        if (backend_ == Backend::IO_URING) {
+            threads_.emplace_back(&Engine::run_uring, this);
+            return;
+        }
+#endif
+        for (int i = 0; i < threads; ++i) {
+            threads_.emplace_back(&Engine::run_worker, this);
+        }
+    }
+
+    void enqueue(File* file) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(file);
+        }
+        work_cv_.notify_one();
+    }
+
+    void enqueue(const std::string& path, std::string data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& queued : replacements_) {
+                if (queued->path == path) {
+                    // Not started yet; only the newest contents matter
+                    queued->data = std::move(data);
+                    metrics::increment("aio.superseded_replacements");
+                    return;
+                }
+            }
+            auto r = std::make_unique<Replacement>();
+            r->path = path;
+            r->data = std::move(data);
+            r->queued_ns = time::monotonic_ns();
+            replacements_.push_back(std::move(r));
+        }
+        work_cv_.notify_one();
+    }
+
+    void drain_replacements() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return replacements_.empty() && replacements_active_ == 0; });
+    }
+
+private:
+    // Moves the file's queue into its in-flight buffer
+    void begin(File* f) {
+        {
+            std::lock_guard<std::mutex> lock(f->mutex_);
+            f->inflight_.swap(f->pending_);
+            f->pending_.clear();
+            f->inflight_sync_ = f->sync_pending_;
+            f->sync_pending_ = false;
+        }
+        f->cv_.notify_all(); // room in pending_
+        f->inflight_done_ = 0;
+        f->inflight_failed_ = false;
+        f->submitted_ns_ = time::monotonic_ns();
+    }
+
+    void finish(File* f) {
+        const size_t bytes = f->inflight_.size();
+        if (bytes > 0) {
+            write_ns_->record(time::monotonic_ns() - f->submitted_ns_);
+            write_bytes_->record(bytes);
+            metrics::increment("aio.writes");
+            metrics::add("aio.bytes_written", bytes);
+        }
+        if (f->inflight_sync_) metrics::increment("aio.syncs");
+        if (f->inflight_failed_) metrics::increment("aio.write_errors");
+        // Only what reached the file: after a failure nothing more is written to it
+        f->offset_ += f->inflight_failed_ ? f->inflight_done_ : bytes;
+        f->inflight_.clear();
+
+        bool again;
+        {
+            std::lock_guard<std::mutex> lock(f->mutex_);
+            if (f->inflight_failed_) {
+                f->failed_ = true;
+                f->size_ -= bytes - f->inflight_done_;
+                if (bytes > f->inflight_done_) metrics::add("aio.discarded_bytes", bytes - f->inflight_done_);
+                f->discard_pending();
+            }
+            again = !f->pending_.empty() || f->sync_pending_;
+            if (!again) {
+                f->busy_ = false;
+                // Under the lock: a drained File may be destroyed as soon as it is released
+                f->cv_.notify_all();
+            }
+        }
+        if (again) enqueue(f);
+    }
+
+    void finish(std::unique_ptr<Replacement> r, bool ok) {
+        replace_ns_->record(time::monotonic_ns() - r->queued_ns);
+        metrics::increment(ok ? "aio.replacements" : "aio.replace_errors");
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --replacements_active_;
+        }
+        idle_cv_.notify_all();
+    }
+
+#if !defined(_WIN32)
+    void write_now(File* f) {
+        size_t written = 0;
+        bool ok = write_all(f->fd_, f->inflight_.data() + f->inflight_done_,
+                            f->inflight_.size() - f->inflight_done_, f->offset_ + f->inflight_done_, &written);
+        f->inflight_done_ += written;
+        if (ok && f->inflight_sync_) ok = datasync(f->fd_);
+        if (!ok) f->inflight_failed_ = true;
+    }
+#endif
+
+    void run_worker() {
+        trace::set_thread_name("aio");
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            work_cv_.wait(lock, [this] { return !ready_.empty() || !replacements_.empty(); });
+            if (!ready_.empty()) {
+                File* f = ready_.front();
+                ready_.pop_front();
+                lock.unlock();
+                begin(f);
+#if !defined(_WIN32)
+                write_now(f);
+#endif
+                finish(f);
+            } else {
+                std::unique_ptr<Replacement> r = std::move(replacements_.front());
+                replacements_.pop_front();
+                ++replacements_active_;
+                lock.unlock();
+                bool ok = replace_now(r->path, r->data);
+                finish(std::move(r), ok);
+            }
+            lock.lock();
+        }
+    }
+
+#if defined(__linux__)
+    void submit_file(File* f) {
+        const size_t left = f->inflight_.size() - f->inflight_done_;
+        if (left > 0) {
+            io_uring_sqe* sqe = ring_.get_sqe();
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->fd = f->fd_;
+            sqe->addr = reinterpret_cast<uint64_t>(f->inflight_.data() + f->inflight_done_);
+            sqe->len = static_cast<uint32_t>(std::min(left, kMaxSqeBytes));
+            sqe->off = f->offset_ + f->inflight_done_;
+            sqe->user_data = reinterpret_cast<uint64_t>(f) | kOpFileWrite;
+            if (f->inflight_sync_) sqe->flags |= IOSQE_IO_LINK; // the sync runs only after a full write
+            ++f->ops_;
+            ++inflight_ops_;
+        }
+        if (f->inflight_sync_) {
+            io_uring_sqe* sqe = ring_.get_sqe();
+            sqe->opcode = IORING_OP_FSYNC;
+            sqe->fd = f->fd_;
+            sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+            sqe->user_data = reinterpret_cast<uint64_t>(f) | kOpFileSync;
+            ++f->ops_;
+            ++inflight_ops_;
+        }
+        if (f->ops_ == 0) finish(f); // nothing to do
+    }
+
+    void submit_replacement(Replacement* r) {
+        io_uring_sqe* sqe = ring_.get_sqe();
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = r->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(r->data.data());
+        sqe->len = static_cast<uint32_t>(std::min(r->data.size(), kMaxSqeBytes));
+        sqe->off = 0;
+        sqe->user_data = reinterpret_cast<uint64_t>(r) | kOpReplaceWrite;
+        ++inflight_ops_;
+    }
+
+    void on_completion(uint64_t user_data, int res) {
+        --inflight_ops_;
+        const uint64_t op = user_data & kOpMask;
+        if (op == kOpReplaceWrite) {
+            std::unique_ptr<Replacement> r(reinterpret_cast<Replacement*>(user_data & ~kOpMask));
+            bool ok = res >= 0;
+            if (ok) r->done = static_cast<size_t>(res);
+            // A short write is finished here; it does not happen on local filesystems
+            ok = ok && write_all(r->fd, r->data.data() + r->done, r->data.size() - r->done, r->done);
+            ok = ::close(r->fd) == 0 && ok;
+            std::error_code ec;
+            if (ok) std::filesystem::rename(r->path + ".tmp", r->path, ec);
+            finish(std::move(r), ok && !ec);
+            return;
+        }
+
+        File* f = reinterpret_cast<File*>(user_data & ~kOpMask);
+        --f->ops_;
+        if (op == kOpFileWrite) {
+            if (res < 0) {
+                f->inflight_failed_ = true;
+            } else {
+                f->inflight_done_ += static_cast<size_t>(res);
+            }
+        } else if (res < 0 && res != -ECANCELED) {
+            f->inflight_failed_ = true; // ECANCELED: the write before it was short
+        }
+        if (f->ops_ > 0) return;
+
+        if (!f->inflight_failed_ && f->inflight_done_ < f->inflight_.size()) {
+            // Short write: the rest, and the sync it cancelled, on this thread
+            write_now(f);
+        }
+        finish(f);
+    }
+
+    void run_uring() {
+        trace::set_thread_name("aio");
+        std::vector<File*> files;
+        std::vector<std::unique_ptr<Replacement>> replacements;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            if (inflight_ops_ == 0) {
+                work_cv_.wait(lock, [this] { return !ready_.empty() || !replacements_.empty(); });
+            }
+            // Each file takes up to two entries; the completion ring must hold every op in flight
+            size_t room = std::min<size_t>(ring_.sq_entries(), ring_.cq_entries() - inflight_ops_);
+            while (!ready_.empty() && room >= 2) {
+                files.push_back(ready_.front());
+                ready_.pop_front();
+                room -= 2;
+            }
+            while (!replacements_.empty() && room >= 1) {
+                replacements.push_back(std::move(replacements_.front()));
+                replacements_.pop_front();
+                ++replacements_active_;
+                room -= 1;
+            }
+            lock.unlock();
+
+            const bool submitted = !files.empty() || !replacements.empty();
+            for (File* f : files) {
+                begin(f);
+                submit_file(f);
+            }
+            files.clear();
+            for (auto& r : replacements) {
+                r->fd = ::open((r->path + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (r->fd < 0) {
+                    finish(std::move(r), false);
+                } else {
+                    submit_replacement(r.release());
+                }
+            }
+            replacements.clear();
+
+            // New work is submitted without waiting; otherwise block for a completion
+            ring_.submit(!submitted && inflight_ops_ > 0 ? 1 : 0);
+            ring_.reap([this](uint64_t user_data, int res) { on_completion(user_data, res); });
+            lock.lock();
+        }
+    }
+
+    Uring ring_;
+#endif
+
+    Backend backend_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_; // replacements drained
+    std::deque<File*> ready_;
+    std::deque<std::unique_ptr<Replacement>> replacements_;
+    size_t replacements_active_{0};
+    size_t inflight_ops_{0}; // io_uring engine thread only
+    std::vector<std::thread> threads_;
+
+    metrics::Histogram* write_ns_ = &metrics::histogram("aio.write_ns");
+    metrics::Histogram* write_bytes_ = &metrics::histogram("aio.write_bytes");
+    metrics::Histogram* replace_ns_ = &metrics::histogram("aio.replace_ns");
+};
+
+namespace {
+// Never destroyed: files may still be closed during static destruction
+Engine* g_engine = nullptr;
+} // namespace
+
+Backend configure(const config::IoConfig& cfg) {
+    std::lock_guard<std::mutex> lock(g_configure_mutex);
+    if (g_engine) return backend();
+    g_max_pending_bytes = cfg.max_pending_bytes;
+
+    Backend chosen = Backend::SYNC;
+#if !defined(_WIN32)
+    if (cfg.backend == "threads" || cfg.backend == "auto" || cfg.backend == "io_uring") {
+        chosen = Backend::THREADS;
+    }
+#endif
+    if (chosen == Backend::SYNC) return chosen;
+
+    auto engine = std::make_unique<Engine>(cfg.backend == "threads" ? Backend::THREADS : Backend::IO_URING);
+#if defined(__linux__)
+    // Fails under seccomp filters or kernel.io_uring_disabled, and before Linux 5.6
+    if (cfg.backend != "threads" && !engine->init_uring()) {
+        engine = std::make_unique<Engine>(Backend::THREADS);
+    } else if (cfg.backend != "threads") {
+        chosen = Backend::IO_URING;
+    }
+#else
+    engine = std::make_unique<Engine>(Backend::THREADS);
+#endif
+    engine->start(cfg.threads);
+    g_engine = engine.release();
+    g_backend.store(static_cast<int>(chosen), std::memory_order_release);
+    return chosen;
+}
+
+Backend backend() {
+    return static_cast<Backend>(g_backend.load(std::memory_order_acquire));
+}
+
+const char* backend_name(Backend backend) {
+    switch (backend) {
+        case Backend::SYNC: return "sync";
+        case Backend::THREADS: return "threads";
+        case Backend::IO_URING: return "io_uring";
+    }
+    return "sync";
+}
+
+File::File(const std::string& path, bool append) : path_(path) {
+#if defined(_WIN32)
+    (void)append;
+    throw std::runtime_error("Asynchronous file output needs POSIX: " + path_);
+#else
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC), 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open " + path_);
+    }
+    if (append) {
+        off_t end = ::lseek(fd_, 0, SEEK_END);
+        offset_ = size_ = end > 0 ? static_cast<uint64_t>(end) : 0;
+    }
+#endif
+}
+
+File::~File() {
+    drain();
+#if !defined(_WIN32)
+    if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+void File::append(const char* data, size_t size) {
+    if (size == 0) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (failed_) {
+        metrics::add("aio.discarded_bytes", size);
+        return;
+    }
+    if (!g_engine) {
+#if !defined(_WIN32)
+        size_t written = 0;
+        if (!write_all(fd_, data, size, offset_, &written)) {
+            failed_ = true;
+            metrics::increment("aio.write_errors");
+            metrics::add("aio.discarded_bytes", size - written);
+        }
+        offset_ += written;
+        size_ += written;
+#endif
+        return;
+    }
+    if (pending_.size() >= g_max_pending_bytes) {
+        metrics::increment("aio.queue_full_waits");
+        cv_.wait(lock, [this] { return pending_.size() < g_max_pending_bytes; });
+    }
+    pending_.append(data, size);
+    size_ += size;
+    if (!busy_) {
+        busy_ = true;
+        lock.unlock();
+        g_engine->enqueue(this);
+    }
+}
+
+void File::request_sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (failed_) return;
+    if (!g_engine) {
+#if !defined(_WIN32)
+        if (!datasync(fd_)) failed_ = true;
+#endif
+        return;
+    }
+    sync_pending_ = true;
+    if (!busy_) {
+        busy_ = true;
+        lock.unlock();
+        g_engine->enqueue(this);
+    }
+}
+
+bool File::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !busy_; });
+    return !failed_;
+}
+
+void File::discard_pending() {
+    if (!pending_.empty()) metrics::add("aio.discarded_bytes", pending_.size());
+    size_ -= pending_.size();
+    pending_.clear();
+    sync_pending_ = false;
+    cv_.notify_all(); // room in pending_
+}
+
+uint64_t File::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+void replace_file(const std::string& path, std::string data) {
+    if (g_engine) {
+        g_engine->enqueue(path, std::move(data));
+        return;
+    }
+    metrics::increment(replace_now(path, data) ? "aio.replacements" : "aio.replace_errors");
+}
+
+void drain_replacements() {
+    if (g_engine) g_engine->drain_replacements();
+}
+
+} // namespace aio
+} // namespace surveillance
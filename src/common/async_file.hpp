@@ -0,0 +1,97 @@
+#pragma once
+
+#include "config.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace surveillance {
+namespace aio {
+
+// Asynchronous file output for the component logs, alerts.jsonl and
+// central_state.json.
+//
+// Writers copy their bytes into a per-file queue and return. A process-wide engine
+// turns whatever a file has queued into one write at the file's offset, and tracks the
+// completions on its own thread(s). Backends (logging.io.backend):
+//   io_uring  one engine thread submits every ready file's write, with a linked
+//             fdatasync when one was requested, in a single io_uring_enter
+//   threads   logging.io.threads workers doing pwrite and fdatasync
+//   sync      no engine: SegmentedFile writes through stdio on the caller's thread
+// "auto" picks io_uring when the kernel allows it and threads otherwise.
+//
+// A file has at most one write in flight, so its bytes land in append order and a
+// reader never sees a gap. A failed write or sync stops the file where its written
+// bytes end: what is queued and appended after that is discarded (aio.discarded_bytes)
+// and drain() keeps returning false. Bytes still queued when the process is killed are
+// lost.
+
+enum class Backend { SYNC, THREADS, IO_URING };
+
+// Starts the engine. Call once, before opening any File (logging::init does); later
+// calls return the backend already chosen. Without a call the backend is sync.
+Backend configure(const config::IoConfig& cfg);
+Backend backend();
+const char* backend_name(Backend backend);
+
+class Engine;
+
+class File {
+public:
+    // Opens `path` for writing, truncating it unless `append`. Throws std::runtime_error.
+    File(const std::string& path, bool append);
+    ~File(); // drains and closes
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    // Queues a copy of `data`. Blocks only while logging.io.max_pending_bytes are
+    // already queued for this file (counted in aio.queue_full_waits).
+    void append(const char* data, size_t size);
+    // Queues an fdatasync after everything appended so far
+    void request_sync();
+    // Waits until everything queued so far is written (and synced, if requested).
+    // False once a write or sync has failed; the file takes no more bytes after that.
+    bool drain();
+
+    // Bytes in the file, counting queued ones
+    uint64_t size() const;
+
+private:
+    friend class Engine;
+
+    void discard_pending(); // under mutex_, once failed_
+
+    int fd_{-1};
+    std::string path_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_; // drained, or room in pending_
+    std::string pending_;
+    bool sync_pending_{false};
+    bool busy_{false};  // handed to the engine: queued there or in flight
+    bool failed_{false}; // sticky
+    uint64_t size_{0};
+
+    // Engine side; owned by whoever holds the file while busy_
+    std::string inflight_;
+    size_t inflight_done_{0};
+    bool inflight_sync_{false};
+    bool inflight_failed_{false};
+    uint64_t offset_{0}; // where inflight_ starts
+    uint64_t submitted_ns_{0};
+    int ops_{0};         // io_uring operations outstanding
+};
+
+// Writes `data` to `path`.tmp and renames it over `path`, off the caller's thread
+// unless the backend is sync. A replacement of the same path that has not started yet
+// is superseded (aio.superseded_replacements); failures count in aio.replace_errors.
+void replace_file(const std::string& path, std::string data);
+
+// Waits for every replace_file() queued so far
+void drain_replacements();
+
+} // namespace aio
+} // namespace surveillance
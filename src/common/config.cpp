@@ -1,4 +1,6 @@
 #include "config.hpp"
+#include "shm_ring.hpp"
+#include "transport.hpp"
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
@@ -32,6 +34,24 @@ AppConfig load(const std::string& path) {
         if (s.contains("status_rate_hz")) cfg.sensor.status_rate_hz = s["status_rate_hz"];
     }
 
+    if (j.contains("waveform")) {
+        auto& s = j["waveform"];
+        if (s.contains("enabled")) cfg.waveform.enabled = s["enabled"];
+        if (s.contains("sample_rate_hz")) cfg.waveform.sample_rate_hz = s["sample_rate_hz"];
+        if (s.contains("channels")) cfg.waveform.channels = s["channels"];
+        if (s.contains("block_samples")) cfg.waveform.block_samples = s["block_samples"];
+        if (s.contains("hop_samples")) cfg.waveform.hop_samples = s["hop_samples"];
+        if (s.contains("sta_s")) cfg.waveform.sta_s = s["sta_s"];
+        if (s.contains("lta_s")) cfg.waveform.lta_s = s["lta_s"];
+        if (s.contains("trigger_ratio")) cfg.waveform.trigger_ratio = s["trigger_ratio"];
+        if (s.contains("detrigger_ratio")) cfg.waveform.detrigger_ratio = s["detrigger_ratio"];
+        if (s.contains("noise_floor")) cfg.waveform.noise_floor = s["noise_floor"];
+        if (s.contains("edge_detection")) cfg.waveform.edge_detection = s["edge_detection"];
+        if (s.contains("suppress_max_amplitude")) cfg.waveform.suppress_max_amplitude = s["suppress_max_amplitude"];
+        if (s.contains("suppress_max_energy")) cfg.waveform.suppress_max_energy = s["suppress_max_energy"];
+        if (s.contains("suppress_max_hf_ratio")) cfg.waveform.suppress_max_hf_ratio = s["suppress_max_hf_ratio"];
+    }
+
     if (j.contains("network")) {
         auto& s = j["network"];
         if (s.contains("latency_ms")) cfg.network.latency_ms = s["latency_ms"];
@@ -39,18 +59,174 @@ AppConfig load(const std::string& path) {
         if (s.contains("loss_rate")) cfg.network.loss_rate = s["loss_rate"];
         if (s.contains("network_seed")) cfg.network.network_seed = s["network_seed"];
         if (s.contains("reorder_enabled")) cfg.network.reorder_enabled = s["reorder_enabled"];
+        if (s.contains("credit_window")) cfg.network.credit_window = s["credit_window"];
+        if (s.contains("compression")) cfg.network.compression = s["compression"];
+        if (s.contains("keyframe_interval")) cfg.network.keyframe_interval = s["keyframe_interval"];
     }
 
     if (j.contains("central")) {
         auto& s = j["central"];
         if (s.contains("heartbeat_timeout_s")) cfg.central.heartbeat_timeout_s = s["heartbeat_timeout_s"];
         if (s.contains("alerts_buffer")) cfg.central.alerts_buffer = s["alerts_buffer"];
+        if (s.contains("ingest_capacity")) cfg.central.ingest_capacity = s["ingest_capacity"];
+        if (s.contains("overload_high_watermark")) cfg.central.overload_high_watermark = s["overload_high_watermark"];
+        if (s.contains("overload_low_watermark")) cfg.central.overload_low_watermark = s["overload_low_watermark"];
+        if (s.contains("low_priority_sample_every_n")) cfg.central.low_priority_sample_every_n = s["low_priority_sample_every_n"];
+        if (s.contains("alert_batch_max")) cfg.central.alert_batch_max = s["alert_batch_max"];
+        if (s.contains("alert_batch_interval_ms")) cfg.central.alert_batch_interval_ms = s["alert_batch_interval_ms"];
+        if (s.contains("alert_sync")) cfg.central.alert_sync = s["alert_sync"];
+        if (s.contains("shards")) cfg.central.shards = s["shards"];
+        if (s.contains("shard_virtual_nodes")) cfg.central.shard_virtual_nodes = s["shard_virtual_nodes"];
+        if (s.contains("replication_endpoint")) cfg.central.replication_endpoint = s["replication_endpoint"];
+        if (s.contains("replication_heartbeat_ms")) cfg.central.replication_heartbeat_ms = s["replication_heartbeat_ms"];
+        if (s.contains("failover_timeout_ms")) cfg.central.failover_timeout_ms = s["failover_timeout_ms"];
+        if (s.contains("checkpoint_interval_s")) cfg.central.checkpoint_interval_s = s["checkpoint_interval_s"];
+        if (s.contains("rollup_max_nodes")) cfg.central.rollup_max_nodes = s["rollup_max_nodes"];
     }
 
     if (j.contains("logging")) {
         auto& s = j["logging"];
         if (s.contains("log_dir")) cfg.logging.log_dir = s["log_dir"];
         if (s.contains("flush_every_n")) cfg.logging.flush_every_n = s["flush_every_n"];
+        if (s.contains("level")) cfg.logging.level = s["level"];
+        if (s.contains("sample_every_n")) cfg.logging.sample_every_n = s["sample_every_n"];
+        if (s.contains("control_endpoint")) cfg.logging.control_endpoint = s["control_endpoint"];
+        if (s.contains("rotation")) {
+            auto& r = s["rotation"];
+            if (r.contains("max_segment_bytes")) cfg.logging.rotation.max_segment_bytes = r["max_segment_bytes"];
+            if (r.contains("max_segment_age_s")) cfg.logging.rotation.max_segment_age_s = r["max_segment_age_s"];
+            if (r.contains("max_segments")) cfg.logging.rotation.max_segments = r["max_segments"];
+            if (r.contains("max_total_bytes")) cfg.logging.rotation.max_total_bytes = r["max_total_bytes"];
+            if (r.contains("compress")) cfg.logging.rotation.compress = r["compress"];
+        }
+        if (s.contains("io")) {
+            auto& io = s["io"];
+            if (io.contains("backend")) cfg.logging.io.backend = io["backend"];
+            if (io.contains("threads")) cfg.logging.io.threads = io["threads"];
+            if (io.contains("max_pending_bytes")) cfg.logging.io.max_pending_bytes = io["max_pending_bytes"];
+        }
+    }
+
+    if (j.contains("tracing")) {
+        auto& s = j["tracing"];
+        if (s.contains("enabled")) cfg.tracing.enabled = s["enabled"];
+        if (s.contains("sample_every_n")) cfg.tracing.sample_every_n = s["sample_every_n"];
+    }
+
+    if (j.contains("ui")) {
+        auto& s = j["ui"];
+        if (s.contains("http_threads")) cfg.ui.http_threads = s["http_threads"];
+        if (s.contains("keep_alive_s")) cfg.ui.keep_alive_s = s["keep_alive_s"];
+        if (s.contains("gzip_min_bytes")) cfg.ui.gzip_min_bytes = s["gzip_min_bytes"];
+        if (s.contains("alert_history")) cfg.ui.alert_history = s["alert_history"];
+    }
+
+    if (j.contains("runtime")) {
+        auto& s = j["runtime"];
+        if (s.contains("threads")) {
+            for (auto& [name, t] : s["threads"].items()) {
+                ThreadProfile profile;
+                if (t.contains("cpu")) profile.cpu = t["cpu"];
+                if (t.contains("busy_poll")) profile.busy_poll = t["busy_poll"];
+                cfg.runtime.threads[name] = profile;
+            }
+        }
+        if (s.contains("sched_fifo_priority")) cfg.runtime.sched_fifo_priority = s["sched_fifo_priority"];
+        if (s.contains("lock_memory")) cfg.runtime.lock_memory = s["lock_memory"];
+        if (s.contains("prefault_heap_bytes")) cfg.runtime.prefault_heap_bytes = s["prefault_heap_bytes"];
+    }
+
+    if (j.contains("transport")) {
+        auto& s = j["transport"];
+        if (s.contains("kind")) cfg.transport.kind = s["kind"];
+        if (s.contains("host")) cfg.transport.host = s["host"];
+        if (s.contains("base_port")) cfg.transport.base_port = s["base_port"];
+        if (s.contains("ipc_dir")) cfg.transport.ipc_dir = s["ipc_dir"];
+        if (s.contains("sensor_uplink")) cfg.transport.sensor_uplink = s["sensor_uplink"];
+        if (s.contains("central_feed")) cfg.transport.central_feed = s["central_feed"];
+        if (s.contains("sensor_credits")) cfg.transport.sensor_credits = s["sensor_credits"];
+        if (s.contains("central_credits")) cfg.transport.central_credits = s["central_credits"];
+        if (s.contains("shm_ring_bytes")) cfg.transport.shm_ring_bytes = s["shm_ring_bytes"];
+        if (s.contains("ui_host")) cfg.transport.ui_host = s["ui_host"];
+        if (s.contains("ui_port")) cfg.transport.ui_port = s["ui_port"];
+    }
+
+    auto& t = cfg.transport;
+    // inproc (transport::endpoint) needs one shared ZeroMQ context, but the components
+    // are separate processes: their sockets would never connect
+    if (t.kind != "tcp" && t.kind != "ipc" && t.kind != "shm") {
+        throw std::runtime_error("transport.kind must be \"tcp\", \"ipc\" or \"shm\"");
+    }
+    if (t.base_port < 1 || t.base_port + static_cast<int>(transport::Link::REPLICATION) > 65535 ||
+        t.ui_port < 1 || t.ui_port > 65535) {
+        throw std::runtime_error("transport.base_port and transport.ui_port must leave every port in 1..65535");
+    }
+    // Links the file does not pin follow the transport
+    auto follow = [&t](std::string& endpoint, transport::Link link) {
+        if (endpoint.empty()) endpoint = transport::endpoint(t, link);
+    };
+    follow(t.sensor_uplink, transport::Link::SENSOR_UPLINK);
+    follow(t.central_feed, transport::Link::CENTRAL_FEED);
+    follow(t.sensor_credits, transport::Link::SENSOR_CREDITS);
+    follow(t.central_credits, transport::Link::CENTRAL_CREDITS);
+    for (const std::string* endpoint : {&t.sensor_uplink, &t.central_feed, &t.sensor_credits, &t.central_credits}) {
+        if (endpoint->compare(0, 9, "inproc://") == 0) {
+            throw std::runtime_error("inproc:// endpoints cannot connect separate processes: " + *endpoint);
+        }
+    }
+    // For these two an empty endpoint in the file disables the feature
+    if (!j.contains("logging") || !j["logging"].contains("control_endpoint")) {
+        cfg.logging.control_endpoint = transport::endpoint(t, transport::Link::LOG_CONTROL);
+    }
+    if (!j.contains("central") || !j["central"].contains("replication_endpoint")) {
+        cfg.central.replication_endpoint = transport::endpoint(t, transport::Link::REPLICATION);
+    }
+
+    if (t.shm_ring_bytes > shm::kMaxRingBytes) {
+        throw std::runtime_error("transport.shm_ring_bytes must be at most 1 GiB");
+    }
+    // A ring has one consumer; shards each subscribe to a topic on the feed
+    if (shm::is_shm_endpoint(t.central_feed) && cfg.central.shards > 1) {
+        throw std::runtime_error("transport.central_feed cannot be a shm:// ring with central.shards > 1");
+    }
+    if (shm::is_shm_endpoint(t.sensor_credits) || shm::is_shm_endpoint(t.central_credits) ||
+        shm::is_shm_endpoint(cfg.logging.control_endpoint) || shm::is_shm_endpoint(cfg.central.replication_endpoint)) {
+        throw std::runtime_error("shm:// endpoints are only supported on the sensor_uplink and central_feed links");
+    }
+
+    // Deterministic mode relies on one ordered emulator -> central link with credit flow control
+    if (cfg.central.shards < 1 || (cfg.central.shards > 1 && cfg.system.mode == "deterministic")) {
+        throw std::runtime_error("central.shards must be 1 in deterministic mode and at least 1 otherwise");
+    }
+    if (cfg.central.replication_heartbeat_ms < 1 || cfg.central.failover_timeout_ms <= cfg.central.replication_heartbeat_ms) {
+        throw std::runtime_error("central.failover_timeout_ms must exceed central.replication_heartbeat_ms (>= 1)");
+    }
+    if (cfg.central.checkpoint_interval_s < 0.0) {
+        throw std::runtime_error("central.checkpoint_interval_s must be >= 0 (0 disables checkpoints)");
+    }
+    if (cfg.central.rollup_max_nodes < 0) {
+        throw std::runtime_error("central.rollup_max_nodes must be >= 0");
+    }
+    const auto& io = cfg.logging.io;
+    if (io.backend != "auto" && io.backend != "io_uring" && io.backend != "threads" && io.backend != "sync") {
+        throw std::runtime_error("logging.io.backend must be \"auto\", \"io_uring\", \"threads\" or \"sync\"");
+    }
+    if (io.threads < 1 || io.max_pending_bytes == 0) {
+        throw std::runtime_error("logging.io.threads and logging.io.max_pending_bytes must be >= 1");
+    }
+    if (cfg.ui.http_threads < 1 || cfg.ui.keep_alive_s < 1 || cfg.ui.alert_history == 0) {
+        throw std::runtime_error("ui.http_threads, ui.keep_alive_s and ui.alert_history must be >= 1");
+    }
+    for (const auto& [name, profile] : cfg.runtime.threads) {
+        if (profile.cpu < -1) {
+            throw std::runtime_error("runtime.threads." + name + ".cpu must be a core number or -1");
+        }
+    }
+    if (cfg.runtime.sched_fifo_priority < 0 || cfg.runtime.sched_fifo_priority > 99) {
+        throw std::runtime_error("runtime.sched_fifo_priority must be 0..99 (0 keeps SCHED_OTHER)");
+    }
+    if (cfg.runtime.prefault_heap_bytes > 0 && !cfg.runtime.lock_memory) {
+        throw std::runtime_error("runtime.prefault_heap_bytes needs runtime.lock_memory");
     }
 
     return cfg;
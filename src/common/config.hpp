@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <cstdint>
+#include <map>
 
 namespace surveillance {
 namespace config {
@@ -17,30 +18,168 @@ struct SensorConfig {
     double status_rate_hz{1.0};
 };
 
+// Raw waveform streaming: sensors send sample blocks and central extracts features.
+struct WaveformConfig {
+    bool enabled{false};
+    int sample_rate_hz{2000};
+    int channels{2};            // 0 = seismic, 1 = acoustic
+    int block_samples{200};     // per channel, per WaveformBlock message
+    int hop_samples{10};        // STA/LTA update granularity
+    double sta_s{0.05};
+    double lta_s{1.0};
+    double trigger_ratio{4.0};
+    double detrigger_ratio{1.5};
+    double noise_floor{0.01};   // stddev of background noise, full scale = 1.0
+
+    // Edge mode: sensors run the detector themselves and uplink only feature summaries.
+    // A burst is suppressed as wind when all three limits hold; set an amplitude of 0 to send everything.
+    bool edge_detection{false};
+    double suppress_max_amplitude{0.35};
+    double suppress_max_energy{8.0};
+    double suppress_max_hf_ratio{0.027}; // high-band / low-band energy; wind is low frequency
+};
+
 struct NetworkConfig {
     int latency_ms{20};
     int jitter_ms{5};
     double loss_rate{0.001};
     uint32_t network_seed{4242};
     bool reorder_enabled{false};
+    // Per-sender credit window for deterministic-mode flow control
+    int credit_window{1000};
+    // Delta/varint stream codec on the 7001/7002 links; a keyframe every N frames per stream
+    bool compression{true};
+    int keyframe_interval{32};
 };
 
 struct CentralConfig {
     double heartbeat_timeout_s{3.0};
     int alerts_buffer{100};
+    // Bounded ingest queue and overload shedding policy (see IngestQueue)
+    int ingest_capacity{10000};
+    double overload_high_watermark{0.8};
+    double overload_low_watermark{0.5};
+    int low_priority_sample_every_n{10};
+    // Group commit of alerts.jsonl (see AlertWriter)
+    int alert_batch_max{256};
+    double alert_batch_interval_ms{5.0};
+    std::string alert_sync{"none"}; // "none" or "fdatasync" (after every batch)
+    // Horizontal scaling (live mode only): the emulator routes each node_id to one of
+    // `shards` central instances by consistent hash (see shard::Ring); 1 = unsharded
+    int shards{1};
+    int shard_virtual_nodes{64};
+    // Hot standby (unsharded live mode): the primary publishes its state journal and a
+    // heartbeat every replication_heartbeat_ms on replication_endpoint; a standby
+    // (central_processor --standby) takes over after failover_timeout_ms of silence.
+    // Follows transport unless set; empty disables the journal.
+    std::string replication_endpoint{"tcp://127.0.0.1:7011"};
+    int replication_heartbeat_ms{50};
+    int failover_timeout_ms{250};
+    // Warm restart (live mode): a binary checkpoint of node state, recent alerts and
+    // counters every checkpoint_interval_s plus a journal of the changes in between
+    // (see central::CheckpointWriter); 0 disables both
+    double checkpoint_interval_s{10.0};
+    // Time-series rollups (see central::Rollups): nodes with their own series; any
+    // further nodes count in the fleet series only
+    int rollup_max_nodes{500};
+};
+
+// Rotation of the .jsonl logs (see segments::SegmentedFile); 0 disables a limit
+struct RotationConfig {
+    uint64_t max_segment_bytes{0};
+    double max_segment_age_s{0.0};
+    int max_segments{0};          // closed segments kept per file
+    uint64_t max_total_bytes{0};  // on-disk size of the closed segments per file
+    bool compress{true};          // gzip closed segments in the background
+};
+
+// File output backend for the component logs, alerts.jsonl and central_state.json
+// (see aio::configure)
+struct IoConfig {
+    std::string backend{"auto"};          // auto, io_uring, threads or sync
+    int threads{2};                       // workers of the threads backend
+    uint64_t max_pending_bytes{8 << 20};  // queued per file before writers block
 };
 
 struct LoggingConfig {
     std::string log_dir{"run_logs"};
     int flush_every_n{1};
+    std::string level{"info"}; // debug, info, warn, error or off
+    int sample_every_n{1};     // keep 1 in N lines of high-volume (sampled) call sites
+    // LogControl messages (ICD §2.7) change level and sampling at runtime. Follows
+    // transport unless set; empty disables
+    std::string control_endpoint{"tcp://127.0.0.1:7010"};
+    // Applies to the component logs and alerts.jsonl
+    RotationConfig rotation;
+    IoConfig io;
+};
+
+// How the components reach each other (see transport::endpoint). A link left empty
+// follows `kind`: tcp on `host` at base_port + the link's offset, ipc as one socket
+// file per link in ipc_dir, or shm: shared-memory rings (shm::RingConsumer) for the
+// two data links and ipc for the rest. config::load rejects inproc, which only
+// connects sockets within one process.
+// logging.control_endpoint and central.replication_endpoint follow it too unless the
+// config file sets them.
+struct TransportConfig {
+    std::string kind{"tcp"}; // tcp, ipc or shm
+    std::string host{"127.0.0.1"};
+    int base_port{7000};
+    std::string ipc_dir{"run_ipc"};
+    std::string sensor_uplink;   // sensors -> emulator
+    std::string central_feed;    // emulator -> central
+    std::string sensor_credits;  // deterministic-mode credits to the sensors
+    std::string central_credits; // deterministic-mode credits to the emulator
+    uint64_t shm_ring_bytes{16 << 20}; // per shm:// link, rounded up to a power of two; at most 1 GiB
+    // Operator UI HTTP listener
+    std::string ui_host{"127.0.0.1"};
+    int ui_port{8080};
+};
+
+struct TracingConfig {
+    bool enabled{false};
+    int sample_every_n{1000}; // trace 1 in N events, chosen by event_id hash
+};
+
+// Operator UI HTTP server; it listens on transport.ui_host:ui_port
+struct UiConfig {
+    // A kept-alive connection holds a server thread between requests, so allow one
+    // per polling dashboard
+    int http_threads{64};
+    int keep_alive_s{30};
+    size_t gzip_min_bytes{1024}; // smaller responses are not worth compressing
+    size_t alert_history{100000}; // alerts /api/alerts can query, newest kept
+};
+
+// Low-latency runtime profile (see runtime::configure). Threads are named
+// "<component>.<thread>": central.receive, central.process, central.state_writer,
+// central.alert_writer (central_<k>.* for shards), network.ingress, network.egress
+// and <node_id>.generate for a sensor.
+struct ThreadProfile {
+    int cpu{-1};            // core to pin to; -1 leaves the thread unpinned
+    bool busy_poll{false};  // spin instead of sleeping while the thread's loop is idle
+};
+
+struct RuntimeConfig {
+    std::map<std::string, ThreadProfile> threads;
+    // SCHED_FIFO priority (1..99) for the pinned threads; 0 keeps SCHED_OTHER
+    int sched_fifo_priority{0};
+    // mlockall and keep freed heap, so pages are faulted in once and stay resident
+    bool lock_memory{false};
+    uint64_t prefault_heap_bytes{0}; // heap touched at startup; needs lock_memory
 };
 
 struct AppConfig {
     SystemConfig system;
     SensorConfig sensor;
+    WaveformConfig waveform;
     NetworkConfig network;
     CentralConfig central;
     LoggingConfig logging;
+    TracingConfig tracing;
+    TransportConfig transport;
+    UiConfig ui;
+    RuntimeConfig runtime;
 };
 
 // Loads from file and returns config object. Throws on error.
@@ -0,0 +1,85 @@
+#include "control.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "zmq_utils.hpp"
+
+namespace surveillance {
+namespace control {
+
+bool matches(const std::string& target, const std::string& component) {
+    if (target.empty() || target == "*" || target == component) return true;
+    if (target.back() == '*') {
+        return component.compare(0, target.size() - 1, target, 0, target.size() - 1) == 0;
+    }
+    return false;
+}
+
+bool apply_log_control(const nlohmann::json& msg) {
+    std::optional<logging::Level> level;
+    if (msg.contains("level")) {
+        if (!msg["level"].is_string()) return false;
+        level = logging::parse_level(msg["level"].get<std::string>());
+        if (!level) return false;
+    }
+    if (msg.contains("sample_every_n") && !msg["sample_every_n"].is_number_integer()) {
+        return false;
+    }
+
+    if (level) {
+        logging::set_level(*level);
+    }
+    if (msg.contains("sample_every_n")) {
+        logging::set_sample_every_n(msg["sample_every_n"].get<int>());
+    }
+    return true;
+}
+
+std::unique_ptr<Listener> start(zmq::context_t& ctx, const std::string& endpoint, const std::string& component) {
+    if (endpoint.empty()) return nullptr;
+    return std::make_unique<Listener>(ctx, endpoint, component);
+}
+
+Listener::Listener(zmq::context_t& ctx, const std::string& endpoint, const std::string& component)
+    : socket_(zmq_utils::create_subscriber(ctx, endpoint, false)),
+      component_(component)
+{
+    thread_ = std::thread(&Listener::run, this);
+}
+
+Listener::~Listener() {
+    stop();
+}
+
+void Listener::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+void Listener::run() {
+    while (running_) {
+        zmq::pollitem_t items[] = {{socket_.handle(), 0, ZMQ_POLLIN, 0}};
+        try {
+            if (zmq::poll(items, 1, std::chrono::milliseconds(100)) <= 0) continue;
+        } catch (const zmq::error_t&) {
+            break; // Context terminated
+        }
+        auto msg = zmq_utils::receive_json(socket_, false);
+        if (!msg || msg->value("msg_type", "") != "LogControl") continue;
+        if (!matches(msg->value("target", "*"), component_)) continue;
+
+        if (apply_log_control(*msg)) {
+            metrics::increment("control.commands_applied");
+            // Logged at warn so the change is visible whatever the new level
+            logging::warn("Log control applied", {
+                {"level", logging::level_name(logging::level())},
+                {"sample_every_n", logging::sample_every_n()}
+            });
+        } else {
+            metrics::increment("control.commands_rejected");
+            logging::warn("Malformed LogControl message ignored", *msg);
+        }
+    }
+}
+
+} // namespace control
+} // namespace surveillance
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <zmq.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace surveillance {
+namespace control {
+
+// Runtime control bus (ICD §2.7). Every component connects a SUB socket to
+// `logging.control_endpoint`; tools/survctl binds the publisher for as long as it
+// takes to deliver one command. Components never need the bus to be up.
+class Listener {
+public:
+    Listener(zmq::context_t& ctx, const std::string& endpoint, const std::string& component);
+    ~Listener();
+
+    Listener(const Listener&) = delete;
+    Listener& operator=(const Listener&) = delete;
+
+    void stop();
+
+private:
+    void run();
+
+    zmq::socket_t socket_;
+    std::string component_;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+// Starts a listener for `component`, or returns nullptr when `endpoint` is empty
+std::unique_ptr<Listener> start(zmq::context_t& ctx, const std::string& endpoint, const std::string& component);
+
+// True if a command `target` addresses `component`: "*", the exact name, or a
+// prefix ending in '*' ("sensor_*")
+bool matches(const std::string& target, const std::string& component);
+
+// Applies a LogControl message; returns false if it is malformed
+bool apply_log_control(const nlohmann::json& msg);
+
+} // namespace control
+} // namespace surveillance
@@ -0,0 +1,322 @@
+#include "dsp.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SURV_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SURV_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SURV_SIMD_NEON 1
+#endif
+
+namespace surveillance {
+namespace dsp {
+
+// ---------------------------------------------------------------------------
+// Scalar reference kernels
+
+namespace scalar {
+
+float sum_squares(const float* x, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; ++i) acc += x[i] * x[i];
+    return acc;
+}
+
+float peak_abs(const float* x, size_t n) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; ++i) peak = std::max(peak, std::fabs(x[i]));
+    return peak;
+}
+
+float lowpass_energy(const float* x, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i + 3 < n; ++i) {
+        float y = 0.25f * (x[i] + x[i + 1] + x[i + 2] + x[i + 3]);
+        acc += y * y;
+    }
+    return acc;
+}
+
+float highpass_energy(const float* x, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        float d = x[i + 1] - x[i];
+        acc += d * d;
+    }
+    return acc;
+}
+
+void int16_to_float(const int16_t* in, float* out, size_t n, float scale) {
+    for (size_t i = 0; i < n; ++i) out[i] = static_cast<float>(in[i]) * scale;
+}
+
+} // namespace scalar
+
+// ---------------------------------------------------------------------------
+// Minimal vector abstraction so each kernel is written once per backend family
+
+#if defined(SURV_SIMD_AVX2) || defined(SURV_SIMD_SSE2) || defined(SURV_SIMD_NEON)
+namespace {
+
+#if defined(SURV_SIMD_AVX2)
+using vf = __m256;
+constexpr size_t W = 8;
+inline vf vload(const float* p) { return _mm256_loadu_ps(p); }
+inline vf vzero() { return _mm256_setzero_ps(); }
+inline vf vset1(float f) { return _mm256_set1_ps(f); }
+inline vf vadd(vf a, vf b) { return _mm256_add_ps(a, b); }
+inline vf vsub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+inline vf vmul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+inline vf vmax(vf a, vf b) { return _mm256_max_ps(a, b); }
+inline vf vabs(vf a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline void vstore(float* p, vf a) { _mm256_storeu_ps(p, a); }
+#elif defined(SURV_SIMD_SSE2)
+using vf = __m128;
+constexpr size_t W = 4;
+inline vf vload(const float* p) { return _mm_loadu_ps(p); }
+inline vf vzero() { return _mm_setzero_ps(); }
+inline vf vset1(float f) { return _mm_set1_ps(f); }
+inline vf vadd(vf a, vf b) { return _mm_add_ps(a, b); }
+inline vf vsub(vf a, vf b) { return _mm_sub_ps(a, b); }
+inline vf vmul(vf a, vf b) { return _mm_mul_ps(a, b); }
+inline vf vmax(vf a, vf b) { return _mm_max_ps(a, b); }
+inline vf vabs(vf a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline void vstore(float* p, vf a) { _mm_storeu_ps(p, a); }
+#elif defined(SURV_SIMD_NEON)
+using vf = float32x4_t;
+constexpr size_t W = 4;
+inline vf vload(const float* p) { return vld1q_f32(p); }
+inline vf vzero() { return vdupq_n_f32(0.0f); }
+inline vf vset1(float f) { return vdupq_n_f32(f); }
+inline vf vadd(vf a, vf b) { return vaddq_f32(a, b); }
+inline vf vsub(vf a, vf b) { return vsubq_f32(a, b); }
+inline vf vmul(vf a, vf b) { return vmulq_f32(a, b); }
+inline vf vmax(vf a, vf b) { return vmaxq_f32(a, b); }
+inline vf vabs(vf a) { return vabsq_f32(a); }
+inline void vstore(float* p, vf a) { vst1q_f32(p, a); }
+#endif
+
+inline float hsum(vf a) {
+    float lanes[W];
+    vstore(lanes, a);
+    float s = 0.0f;
+    for (size_t i = 0; i < W; ++i) s += lanes[i];
+    return s;
+}
+
+inline float hmax(vf a) {
+    float lanes[W];
+    vstore(lanes, a);
+    float m = lanes[0];
+    for (size_t i = 1; i < W; ++i) m = std::max(m, lanes[i]);
+    return m;
+}
+
+} // namespace
+#endif
+
+#if defined(SURV_SIMD_AVX2) || defined(SURV_SIMD_SSE2) || defined(SURV_SIMD_NEON)
+
+float sum_squares(const float* x, size_t n) {
+    vf acc0 = vzero(), acc1 = vzero();
+    size_t i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        vf a = vload(x + i);
+        vf b = vload(x + i + W);
+        acc0 = vadd(acc0, vmul(a, a));
+        acc1 = vadd(acc1, vmul(b, b));
+    }
+    float acc = hsum(vadd(acc0, acc1));
+    return acc + scalar::sum_squares(x + i, n - i);
+}
+
+float peak_abs(const float* x, size_t n) {
+    vf peak = vzero();
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        peak = vmax(peak, vabs(vload(x + i)));
+    }
+    return std::max(hmax(peak), scalar::peak_abs(x + i, n - i));
+}
+
+float lowpass_energy(const float* x, size_t n) {
+    if (n < 4) return 0.0f;
+    const size_t outputs = n - 3;
+    const vf quarter = vset1(0.25f);
+    vf acc = vzero();
+    size_t i = 0;
+    for (; i + W <= outputs; i += W) {
+        vf y = vmul(quarter, vadd(vadd(vload(x + i), vload(x + i + 1)),
+                                  vadd(vload(x + i + 2), vload(x + i + 3))));
+        acc = vadd(acc, vmul(y, y));
+    }
+    return hsum(acc) + scalar::lowpass_energy(x + i, n - i);
+}
+
+float highpass_energy(const float* x, size_t n) {
+    if (n < 2) return 0.0f;
+    const size_t outputs = n - 1;
+    vf acc = vzero();
+    size_t i = 0;
+    for (; i + W <= outputs; i += W) {
+        vf d = vsub(vload(x + i + 1), vload(x + i));
+        acc = vadd(acc, vmul(d, d));
+    }
+    return hsum(acc) + scalar::highpass_energy(x + i, n - i);
+}
+
+void int16_to_float(const int16_t* in, float* out, size_t n, float scale) {
+    size_t i = 0;
+#if defined(SURV_SIMD_AVX2)
+    const __m256 s = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(raw));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(f, s));
+    }
+#elif defined(SURV_SIMD_SSE2)
+    const __m128 s = _mm_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend by placing each int16 in the high half of a lane and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+#elif defined(SURV_SIMD_NEON)
+    const float32x4_t s = vdupq_n_f32(scale);
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t raw = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(raw))), s));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(raw))), s));
+    }
+#endif
+    scalar::int16_to_float(in + i, out + i, n - i, scale);
+}
+
+#else
+
+float sum_squares(const float* x, size_t n) { return scalar::sum_squares(x, n); }
+float peak_abs(const float* x, size_t n) { return scalar::peak_abs(x, n); }
+float lowpass_energy(const float* x, size_t n) { return scalar::lowpass_energy(x, n); }
+float highpass_energy(const float* x, size_t n) { return scalar::highpass_energy(x, n); }
+void int16_to_float(const int16_t* in, float* out, size_t n, float scale) {
+    scalar::int16_to_float(in, out, n, scale);
+}
+
+#endif
+
+const char* simd_backend() {
+#if defined(SURV_SIMD_AVX2)
+    return "avx2";
+#elif defined(SURV_SIMD_SSE2)
+    return "sse2";
+#elif defined(SURV_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// STA/LTA burst detector
+
+DetectorConfig make_detector_config(const config::WaveformConfig& cfg) {
+    DetectorConfig d;
+    d.sample_rate_hz = cfg.sample_rate_hz;
+    d.channels = cfg.channels;
+    d.hop_samples = cfg.hop_samples;
+    d.sta_s = cfg.sta_s;
+    d.lta_s = cfg.lta_s;
+    d.trigger_ratio = cfg.trigger_ratio;
+    d.detrigger_ratio = cfg.detrigger_ratio;
+    return d;
+}
+
+BurstDetector::BurstDetector(const DetectorConfig& cfg) : cfg_(cfg) {
+    cfg_.channels = std::max(1, cfg_.channels);
+    cfg_.hop_samples = std::max(4, cfg_.hop_samples);
+    double hop_s = static_cast<double>(cfg_.hop_samples) / cfg_.sample_rate_hz;
+    sta_alpha_ = std::min(1.0, hop_s / cfg_.sta_s);
+    lta_alpha_ = std::min(1.0, hop_s / cfg_.lta_s);
+    warmup_samples_ = static_cast<uint64_t>(cfg_.lta_s * cfg_.sample_rate_hz);
+}
+
+void BurstDetector::close_burst(std::vector<BurstFeatures>& out) {
+    burst_.duration_s = static_cast<double>(burst_samples_) / cfg_.sample_rate_hz;
+    out.push_back(burst_);
+    triggered_ = false;
+}
+
+void BurstDetector::process(const float* samples, size_t n, std::vector<BurstFeatures>& out) {
+    const size_t hop = static_cast<size_t>(cfg_.hop_samples);
+    const double per_sample_energy = kEnergyScale / cfg_.sample_rate_hz / cfg_.channels;
+
+    for (size_t start = 0; start < n; start += hop) {
+        const size_t len = std::min(hop, n - start);
+
+        double hop_sq = 0.0;
+        double hop_peak = 0.0;
+        double hop_low = 0.0;
+        double hop_high = 0.0;
+        for (int ch = 0; ch < cfg_.channels; ++ch) {
+            const float* x = samples + static_cast<size_t>(ch) * n + start;
+            hop_sq += sum_squares(x, len);
+            if (triggered_) {
+                hop_peak = std::max(hop_peak, static_cast<double>(peak_abs(x, len)));
+                hop_low += lowpass_energy(x, len);
+                hop_high += highpass_energy(x, len);
+            }
+        }
+        const double mean_sq = hop_sq / (static_cast<double>(len) * cfg_.channels);
+
+        if (samples_seen_ == 0) {
+            sta_ = lta_ = mean_sq;
+        }
+        sta_ += (mean_sq - sta_) * sta_alpha_;
+        if (!triggered_) {
+            lta_ += (mean_sq - lta_) * lta_alpha_;
+        }
+        const double ratio = sta_ / std::max(lta_, 1e-12);
+
+        if (!triggered_ && samples_seen_ >= warmup_samples_ && ratio >= cfg_.trigger_ratio) {
+            triggered_ = true;
+            ++triggers_;
+            burst_ = BurstFeatures{samples_seen_, 0.0, 0.0, 0.0, 0.0, 0.0, ratio};
+            burst_samples_ = 0;
+            // Re-run this hop's feature kernels now that the burst is open
+            for (int ch = 0; ch < cfg_.channels; ++ch) {
+                const float* x = samples + static_cast<size_t>(ch) * n + start;
+                hop_peak = std::max(hop_peak, static_cast<double>(peak_abs(x, len)));
+                hop_low += lowpass_energy(x, len);
+                hop_high += highpass_energy(x, len);
+            }
+        }
+
+        if (triggered_) {
+            burst_samples_ += len;
+            burst_.peak_amplitude = std::max(burst_.peak_amplitude, hop_peak);
+            burst_.energy += hop_sq * per_sample_energy;
+            burst_.band_energy_low += hop_low * per_sample_energy;
+            burst_.band_energy_high += hop_high * per_sample_energy;
+            burst_.max_sta_lta = std::max(burst_.max_sta_lta, ratio);
+
+            double burst_s = static_cast<double>(burst_samples_) / cfg_.sample_rate_hz;
+            if (ratio <= cfg_.detrigger_ratio || burst_s >= cfg_.max_burst_s) {
+                close_burst(out);
+            }
+        }
+
+        samples_seen_ += len;
+    }
+}
+
+} // namespace dsp
+} // namespace surveillance
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace surveillance {
+namespace dsp {
+
+// Vectorized kernels over float sample blocks. Uses AVX2 when the build enables it
+// (SURVEILLANCE_NATIVE_ARCH), SSE2 on any x86-64, NEON on AArch64, scalar otherwise.
+float sum_squares(const float* x, size_t n);
+float peak_abs(const float* x, size_t n);
+// Energy of the 4-tap moving average (low band) and of the first difference (high band).
+// Both consume n samples and produce n - 3 / n - 1 outputs respectively.
+float lowpass_energy(const float* x, size_t n);
+float highpass_energy(const float* x, size_t n);
+void int16_to_float(const int16_t* in, float* out, size_t n, float scale);
+
+// Human-readable name of the kernel set compiled in ("avx2", "sse2", "neon", "scalar")
+const char* simd_backend();
+
+// Reference implementations, used by the benchmarks and as the portable fallback
+namespace scalar {
+float sum_squares(const float* x, size_t n);
+float peak_abs(const float* x, size_t n);
+float lowpass_energy(const float* x, size_t n);
+float highpass_energy(const float* x, size_t n);
+void int16_to_float(const int16_t* in, float* out, size_t n, float scale);
+} // namespace scalar
+
+// Energy scale shared by sensors and central: a full-scale sine lasting 1 s has energy 50,
+// which keeps waveform-derived features in the same range as the scalar event model.
+constexpr double kEnergyScale = 100.0;
+
+struct DetectorConfig {
+    int sample_rate_hz{2000};
+    int channels{2};
+    int hop_samples{10};
+    double sta_s{0.05};
+    double lta_s{1.0};
+    double trigger_ratio{4.0};
+    double detrigger_ratio{1.5};
+    double max_burst_s{5.0};
+};
+
+DetectorConfig make_detector_config(const config::WaveformConfig& cfg);
+
+struct BurstFeatures {
+    uint64_t start_sample;   // absolute sample index in the stream
+    double duration_s;
+    double peak_amplitude;   // max |x| over all channels, full scale = 1.0
+    double energy;           // mean per-channel energy, scaled by kEnergyScale
+    double band_energy_low;
+    double band_energy_high;
+    double max_sta_lta;
+};
+
+// Recursive STA/LTA trigger over hop energies; the LTA is frozen while triggered.
+// Feeds multi-channel blocks (channel-major) and reports bursts as they detrigger.
+class BurstDetector {
+public:
+    explicit BurstDetector(const DetectorConfig& cfg);
+
+    // `samples` holds `channels` runs of `n` samples each. Completed bursts are appended to `out`.
+    void process(const float* samples, size_t n, std::vector<BurstFeatures>& out);
+
+    uint64_t samples_seen() const { return samples_seen_; }
+    uint64_t triggers() const { return triggers_; }
+
+private:
+    void close_burst(std::vector<BurstFeatures>& out);
+
+    DetectorConfig cfg_;
+    double sta_alpha_;
+    double lta_alpha_;
+    uint64_t warmup_samples_;
+
+    double sta_{0.0};
+    double lta_{0.0};
+    uint64_t samples_seen_{0};
+    uint64_t triggers_{0};
+
+    bool triggered_{false};
+    BurstFeatures burst_{};
+    uint64_t burst_samples_{0};
+};
+
+} // namespace dsp
+} // namespace surveillance
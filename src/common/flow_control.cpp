@@ -0,0 +1,149 @@
+#include "flow_control.hpp"
+#include "zmq_utils.hpp"
+#include "metrics.hpp"
+#include "transport.hpp"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <random>
+
+namespace surveillance {
+namespace flow {
+
+CreditSender::CreditSender(zmq::context_t& ctx,
+                           const std::string& endpoint,
+                           const std::string& identity,
+                           std::chrono::milliseconds resync_timeout)
+    : socket_(ctx, zmq::socket_type::dealer),
+      epoch_(std::random_device{}() | (static_cast<uint64_t>(std::random_device{}()) << 32)),
+      resync_timeout_(resync_timeout)
+{
+    socket_.set(zmq::sockopt::routing_id, identity);
+    socket_.set(zmq::sockopt::linger, 0);
+    socket_.connect(endpoint);
+}
+
+void CreditSender::send_hello() {
+    zmq_utils::publish_json(socket_, {{"msg_type", "CreditHello"}, {"epoch", epoch_}, {"sent", sent_}});
+    hello_sent_ = true;
+}
+
+void CreditSender::drain_grants(std::chrono::milliseconds wait) {
+    zmq::pollitem_t items[] = {{socket_.handle(), 0, ZMQ_POLLIN, 0}};
+    if (zmq::poll(items, 1, wait) <= 0) {
+        return;
+    }
+    while (auto grant = zmq_utils::receive_json(socket_, false)) {
+        // Grants of an earlier instance of this sender are not ours
+        if (grant->value("msg_type", "") == "CreditGrant" && grant->value("epoch", uint64_t{0}) == epoch_) {
+            granted_ = std::max(granted_, grant->value("granted", uint64_t{0}));
+        }
+    }
+}
+
+bool CreditSender::acquire(const std::atomic<bool>& running) {
+    if (!hello_sent_) {
+        send_hello();
+    }
+
+    if (credits() <= 0) {
+        drain_grants(std::chrono::milliseconds(0));
+    }
+    if (credits() <= 0) {
+        ++waits_;
+        metrics::increment("flow.credit_waits");
+        auto starved_since = std::chrono::steady_clock::now();
+        while (credits() <= 0) {
+            if (!running) return false;
+            drain_grants(std::chrono::milliseconds(10));
+            if (credits() <= 0 && std::chrono::steady_clock::now() - starved_since > resync_timeout_) {
+                ++resyncs_;
+                metrics::increment("flow.credit_resyncs");
+                send_hello();
+                starved_since = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    ++sent_;
+    return true;
+}
+
+CreditGrantor::CreditGrantor(zmq::context_t& ctx, const std::string& endpoint, int window,
+                             std::chrono::milliseconds loss_timeout)
+    : socket_(ctx, zmq::socket_type::router),
+      window_(static_cast<uint32_t>(std::max(2, window))),
+      batch_(std::max(1u, window_ / 2)),
+      loss_timeout_(loss_timeout)
+{
+    socket_.set(zmq::sockopt::linger, 0);
+    transport::prepare_bind(endpoint);
+    socket_.bind(endpoint);
+}
+
+void CreditGrantor::grant(const std::string& peer_id, const Peer& peer) {
+    std::string body = nlohmann::json{{"msg_type", "CreditGrant"}, {"epoch", peer.epoch}, {"granted", peer.granted}}.dump();
+    try {
+        socket_.send(zmq::buffer(peer_id), zmq::send_flags::sndmore);
+        socket_.send(zmq::buffer(body), zmq::send_flags::none);
+    } catch (const zmq::error_t&) {
+        // Peer gone; it will resync with a new hello if it comes back
+    }
+}
+
+void CreditGrantor::poll() {
+    while (true) {
+        zmq::message_t peer;
+        zmq::message_t body;
+        try {
+            if (!socket_.recv(peer, zmq::recv_flags::dontwait)) return;
+            if (!peer.more() || !socket_.recv(body, zmq::recv_flags::none)) continue;
+        } catch (const zmq::error_t&) {
+            return;
+        }
+
+        auto hello = nlohmann::json::parse(body.to_string_view(), nullptr, false);
+        if (!hello.is_object() || hello.value("msg_type", "") != "CreditHello") continue;
+        on_hello(peer.to_string(), hello.value("epoch", uint64_t{0}), hello.value("sent", uint64_t{0}));
+        metrics::increment("flow.credit_hellos");
+    }
+}
+
+void CreditGrantor::on_hello(const std::string& peer_id, uint64_t epoch, uint64_t sent) {
+    const auto now = std::chrono::steady_clock::now();
+    auto [it, added] = peers_.try_emplace(peer_id);
+    Peer& peer = it->second;
+    if (added || peer.epoch != epoch) {
+        // New to us: whatever it sent before went to another receiver or instance
+        peer = Peer{};
+        peer.epoch = epoch;
+        peer.consumed = sent;
+        peer.granted = sent + window_;
+    } else if (sent > peer.consumed && sent == peer.hello_sent && peer.consumed == peer.hello_consumed &&
+               now - peer.hello_at >= loss_timeout_) {
+        // Starved on messages that have not arrived while we kept polling: lost
+        metrics::add("flow.credits_written_off", sent - peer.consumed);
+        peer.consumed = sent;
+        peer.granted = std::max(peer.granted, peer.consumed + window_);
+    }
+    peer.hello_sent = sent;
+    peer.hello_consumed = peer.consumed;
+    peer.hello_at = now;
+    grant(peer_id, peer); // the current total again, in case a grant was lost
+}
+
+void CreditGrantor::on_message(const std::string& peer_id) {
+    auto it = peers_.find(peer_id);
+    if (it == peers_.end()) {
+        return; // Not flow controlled
+    }
+    Peer& peer = it->second;
+    ++peer.consumed;
+    if (peer.consumed + window_ - peer.granted >= batch_) {
+        peer.granted = peer.consumed + window_;
+        grant(peer_id, peer);
+    }
+}
+
+} // namespace flow
+} // namespace surveillance
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <zmq.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace surveillance {
+namespace flow {
+
+// Credit-based flow control for a PUB/SUB data link (deterministic mode only).
+//
+// The receiving side binds a ROUTER and the sending side connects a DEALER whose
+// routing id names the sender. The sender announces itself with a CreditHello and
+// may only publish while it holds credits; the receiver grants credits back in
+// batches of window/2 as it consumes the sender's messages. With the window below
+// the socket HWM the PUB/SUB link can never overflow, so nothing is dropped.
+//
+// Both sides count in totals rather than deltas. The sender's hello names its epoch (a
+// random id per sender instance) and how many messages it has sent; a grant names the
+// epoch and the total credits granted, so a grant that is lost, late or repeated
+// changes nothing. A sender starved for `resync_timeout` re-sends its hello and gets
+// the current total again. It is granted a fresh window only when it is new to the
+// receiver (new epoch, or a restarted receiver), starting from its sent count.
+//
+// Messages in flight still hold their credits, however long they are delayed, so
+// the window is never exceeded. A message lost before it reaches the receiver (e.g.
+// before the subscription is up) would leak its credit: when two hellos at least
+// `loss_timeout` apart find the same sent count outstanding, and nothing from the
+// sender has been consumed in between, the receiver writes those messages off.
+
+// Routing id used by the network emulator on the emulator -> central link
+inline constexpr const char* kEmulatorIdentity = "network_emulator";
+
+class CreditSender {
+public:
+    CreditSender(zmq::context_t& ctx,
+                 const std::string& endpoint,
+                 const std::string& identity,
+                 std::chrono::milliseconds resync_timeout = std::chrono::milliseconds(1000));
+
+    // Blocks until one credit is available and consumes it.
+    // Returns false if `running` turns false while waiting.
+    bool acquire(const std::atomic<bool>& running);
+
+    uint64_t waits() const { return waits_; }
+    uint64_t resyncs() const { return resyncs_; }
+
+private:
+    void send_hello();
+    void drain_grants(std::chrono::milliseconds wait);
+    int64_t credits() const { return static_cast<int64_t>(granted_ - sent_); }
+
+    zmq::socket_t socket_;
+    uint64_t epoch_;
+    uint64_t sent_{0};
+    uint64_t granted_{0}; // highest total granted in this epoch
+    bool hello_sent_{false};
+    uint64_t waits_{0};
+    uint64_t resyncs_{0};
+    std::chrono::milliseconds resync_timeout_;
+};
+
+class CreditGrantor {
+public:
+    CreditGrantor(zmq::context_t& ctx, const std::string& endpoint, int window,
+                  std::chrono::milliseconds loss_timeout = std::chrono::milliseconds(500));
+
+    // Answers pending hellos. Non-blocking; call from the thread that consumes the data link.
+    void poll();
+
+    // Records one consumed message from `peer` and grants credits back when due.
+    void on_message(const std::string& peer);
+
+private:
+    struct Peer {
+        uint64_t epoch{0};
+        uint64_t granted{0};  // total credits granted
+        uint64_t consumed{0}; // total messages consumed (or written off)
+        // At the previous hello
+        uint64_t hello_sent{0};
+        uint64_t hello_consumed{0};
+        std::chrono::steady_clock::time_point hello_at;
+    };
+
+    void on_hello(const std::string& peer_id, uint64_t epoch, uint64_t sent);
+    void grant(const std::string& peer_id, const Peer& peer);
+
+    zmq::socket_t socket_;
+    uint32_t window_;
+    uint32_t batch_;
+    std::chrono::milliseconds loss_timeout_;
+    std::unordered_map<std::string, Peer> peers_;
+};
+
+} // namespace flow
+} // namespace surveillance
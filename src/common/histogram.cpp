@@ -0,0 +1,107 @@
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+namespace surveillance {
+namespace metrics {
+
+size_t Histogram::bucket_index(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    const int msb = 63 - std::countl_zero(value);                  // >= 4
+    const uint64_t sub = (value >> (msb - 4)) & (kSubBuckets - 1);
+    return static_cast<size_t>(msb - 3) * kSubBuckets + static_cast<size_t>(sub);
+}
+
+uint64_t Histogram::bucket_upper_bound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const int msb = static_cast<int>(index / kSubBuckets) + 3;
+    const uint64_t sub = index % kSubBuckets;
+    const uint64_t lower = (kSubBuckets + sub) << (msb - 4);
+    return lower + (uint64_t(1) << (msb - 4)) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t prev = max_.load(std::memory_order_relaxed);
+    while (value > prev && !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::percentile(double q) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max_.load(std::memory_order_relaxed));
+        }
+    }
+    return max_.load(std::memory_order_relaxed);
+}
+
+nlohmann::json Histogram::to_json() const {
+    const uint64_t total = count();
+    nlohmann::json buckets = nlohmann::json::array();
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        uint64_t c = buckets_[i].load(std::memory_order_relaxed);
+        if (c != 0) {
+            buckets.push_back({bucket_upper_bound(i), c});
+        }
+    }
+    return {
+        {"count", total},
+        {"mean", total ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / total : 0.0},
+        {"p50", percentile(0.50)},
+        {"p90", percentile(0.90)},
+        {"p99", percentile(0.99)},
+        {"p999", percentile(0.999)},
+        {"max", max_.load(std::memory_order_relaxed)},
+        {"buckets", std::move(buckets)}
+    };
+}
+
+namespace {
+std::map<std::string, std::unique_ptr<Histogram>> g_histograms;
+std::shared_mutex g_histograms_mutex;
+} // namespace
+
+Histogram& histogram(const std::string& key) {
+    {
+        std::shared_lock<std::shared_mutex> lock(g_histograms_mutex);
+        auto it = g_histograms.find(key);
+        if (it != g_histograms.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(g_histograms_mutex);
+    auto& slot = g_histograms[key];
+    if (!slot) {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+nlohmann::json histograms_json() {
+    nlohmann::json out = nlohmann::json::object();
+    std::shared_lock<std::shared_mutex> lock(g_histograms_mutex);
+    for (const auto& [key, h] : g_histograms) {
+        out[key] = h->to_json();
+    }
+    return out;
+}
+
+} // namespace metrics
+} // namespace surveillance
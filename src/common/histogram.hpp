@@ -0,0 +1,48 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace surveillance {
+namespace metrics {
+
+// Lock-free log-linear histogram: values below 16 are exact, above that each power
+// of two is split into 16 buckets (<= 6.25% relative error). Safe to record from
+// any number of threads.
+class Histogram {
+public:
+    static constexpr size_t kSubBuckets = 16;
+    static constexpr size_t kNumBuckets = (64 - 3) * kSubBuckets;
+
+    void record(uint64_t value);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the q-quantile (0 <= q <= 1)
+    uint64_t percentile(double q) const;
+
+    // count, mean, p50/p90/p99/p99.9, max, and the non-empty buckets as [upper_bound, count]
+    nlohmann::json to_json() const;
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Named histograms, created on first use. The reference stays valid for the process
+// lifetime, so hot paths can look a histogram up once and keep it.
+Histogram& histogram(const std::string& key);
+
+// Snapshot of all named histograms, keyed by name
+nlohmann::json histograms_json();
+
+} // namespace metrics
+} // namespace surveillance
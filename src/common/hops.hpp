@@ -0,0 +1,38 @@
+#pragma once
+
+#include "icd_messages.hpp"
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace surveillance {
+namespace hops {
+
+// Monotonic nanosecond stamps carried by DisturbanceEvent in "hops" (ICD §2.1), one per
+// hop in path order. CLOCK_MONOTONIC is shared by all processes on a host, so
+// differences between stamps are exact per-hop times when the components are co-located.
+enum Index : size_t {
+    SENSOR_TX = 0,
+    EMULATOR_RX,
+    EMULATOR_TX,
+    CENTRAL_RX,
+    COUNT
+};
+
+// Starts the stamp list; called by the sender right before publishing
+inline void begin(icd::Stamps& hops, uint64_t now_ns) {
+    hops.clear();
+    hops.push_back(now_ns);
+}
+
+// Adds this hop's stamp to a message that carries a stamp list
+inline void append(nlohmann::json& msg, uint64_t now_ns) {
+    auto it = msg.find("hops");
+    if (it != msg.end() && it->is_array()) {
+        it->push_back(now_ns);
+    }
+}
+
+} // namespace hops
+} // namespace surveillance
@@ -0,0 +1,76 @@
+#include "icd_messages.hpp"
+
+#include <charconv>
+#include <cmath>
+
+namespace surveillance {
+namespace icd {
+namespace detail {
+
+void write_key(std::string& out, bool& first, std::string_view key) {
+    if (!first) out.push_back(',');
+    first = false;
+    out.push_back('"');
+    out.append(key);
+    out.append("\":");
+}
+
+// Escapes the way nlohmann::json::dump does: quote, backslash and control characters;
+// other bytes are copied unchanged
+void write_value(std::string& out, std::string_view v) {
+    static const char* kHex = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : v) {
+        switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\b': out.append("\\b"); break;
+            case '\f': out.append("\\f"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out.append("\\u00");
+                    out.push_back(kHex[(c >> 4) & 0xF]);
+                    out.push_back(kHex[c & 0xF]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void write_value(std::string& out, uint64_t v) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+// Shortest round-trip form; integral values keep a ".0" so they read back as doubles.
+// Non-finite values have no JSON form and are written as null, as nlohmann does.
+void write_value(std::string& out, double v) {
+    if (!std::isfinite(v)) {
+        out.append("null");
+        return;
+    }
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    std::string_view text(buf, static_cast<size_t>(res.ptr - buf));
+    out.append(text);
+    if (text.find_first_of(".e") == std::string_view::npos) out.append(".0");
+}
+
+void write_value(std::string& out, const Stamps& v) {
+    out.push_back('[');
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (i) out.push_back(',');
+        write_value(out, v[i]);
+    }
+    out.push_back(']');
+}
+
+} // namespace detail
+} // namespace icd
+} // namespace surveillance
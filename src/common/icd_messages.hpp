@@ -0,0 +1,373 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace surveillance {
+namespace icd {
+
+// Typed ICD messages: DisturbanceEvent (§2.1), NodeStatus (§2.2) and CentralAlert (§2.3).
+//
+// Each struct lists its fields once, in fields(): the JSON key, the member, the
+// presence bit used by the ICD parser (icd_parser.hpp) and the stream codec encoding
+// (ICD §2.6), in codec wire order. The JSON writer (dump), the DOM conversion
+// (to_json), the codec's typed encoder and the parser's required-field masks are all
+// generated from that list at compile time, so a field cannot be renamed or dropped
+// in one place only, and none of them looks keys up at run time. std::optional members
+// and an empty Stamps are optional fields, left out of the message when unset.
+
+constexpr size_t kMaxHops = 8;
+
+// Presence bits (MessageView::fields); one per field name across the parsed schemas
+enum Field : uint32_t {
+    MSG_TYPE             = 1u << 0,
+    NODE_ID              = 1u << 1,
+    TIMESTAMP_UTC        = 1u << 2,
+    MONOTONIC_NS         = 1u << 3,
+    EVENT_ID             = 1u << 4,
+    SEQUENCE_NUMBER      = 1u << 5,
+    SIGNAL_AMPLITUDE     = 1u << 6,
+    SIGNAL_ENERGY        = 1u << 7,
+    EVENT_TYPE           = 1u << 8,
+    GENERATED_SEED       = 1u << 9,
+    HOPS                 = 1u << 10,
+    BAND_ENERGY_LOW      = 1u << 11,
+    BAND_ENERGY_HIGH     = 1u << 12,
+    DURATION_S           = 1u << 13,
+    HEALTH               = 1u << 14,
+    UPTIME_S             = 1u << 15,
+    LAST_SEQUENCE_NUMBER = 1u << 16,
+    BYTES_SENT           = 1u << 17,
+    EDGE_TRIGGERS        = 1u << 18,
+    SUPPRESSED_EVENTS    = 1u << 19,
+    NOT_PARSED           = 0  // CentralAlert fields: central writes them, nobody parses them
+};
+
+// How a field is carried by the stream codec (ICD §2.6)
+enum class Encoding : uint8_t {
+    U64,        // zigzag varint delta from the stream's previous frame
+    TIMESTAMP,  // millisecond delta, or a literal for non-canonical strings
+    F64,        // 8 raw little-endian bytes
+    ENUM,       // one-byte table index, 0xFF + literal otherwise
+    UUID,       // 16 raw bytes for canonical UUIDs, literal otherwise
+    STRING,     // varint length + bytes
+    STAMPS,     // varint count + zigzag deltas (hops)
+    SAMPLES,    // WaveformBlock samples
+    NODE_ID     // the stream key, carried in the frame header
+};
+
+inline constexpr std::string_view kEventTypes[] = {"", "WALKING", "VEHICLE", "DIGGING", "WIND"};
+inline constexpr std::string_view kHealthValues[] = {"OK", "DEGRADED", "FAILED", "UNKNOWN"};
+inline constexpr std::string_view kClassifications[] = {"LOW", "MEDIUM", "HIGH"};
+
+// Hop stamps of a DisturbanceEvent (hops.hpp), stored inline. Empty means absent.
+class Stamps {
+public:
+    Stamps() = default;
+    Stamps(std::initializer_list<uint64_t> values) {
+        for (uint64_t v : values) push_back(v);
+    }
+
+    // Returns false (and drops the stamp) when already holding kMaxHops
+    bool push_back(uint64_t v) {
+        if (count_ == kMaxHops) return false;
+        values_[count_++] = v;
+        return true;
+    }
+    void clear() { count_ = 0; }
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    uint64_t operator[](size_t i) const { return values_[i]; }
+    const uint64_t* begin() const { return values_.data(); }
+    const uint64_t* end() const { return values_.data() + count_; }
+
+private:
+    std::array<uint64_t, kMaxHops> values_{};
+    size_t count_{0};
+};
+
+template <typename Msg, typename T>
+struct FieldDef {
+    using value_type = T;
+
+    std::string_view name;
+    T Msg::*member;
+    uint32_t bit;
+    Encoding encoding;
+    std::span<const std::string_view> values; // ENUM only
+};
+
+template <typename Msg, typename T>
+constexpr FieldDef<Msg, T> field(std::string_view name, T Msg::*member, uint32_t bit, Encoding encoding,
+                                 std::span<const std::string_view> values = {}) {
+    return {name, member, bit, encoding, values};
+}
+
+template <typename T> struct is_std_optional : std::false_type {};
+template <typename T> struct is_std_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_optional_field_v = is_std_optional<T>::value || std::is_same_v<T, Stamps>;
+
+template <typename T>
+bool present(const T& v) {
+    if constexpr (is_std_optional<T>::value) return v.has_value();
+    else if constexpr (std::is_same_v<T, Stamps>) return !v.empty();
+    else return true;
+}
+
+template <typename T>
+const auto& value_of(const T& v) {
+    if constexpr (is_std_optional<T>::value) return *v;
+    else return v;
+}
+
+template <typename M>
+concept Message = requires {
+    { M::kMsgType } -> std::convertible_to<std::string_view>;
+    M::fields();
+};
+
+struct DisturbanceEvent {
+    static constexpr std::string_view kMsgType = "DisturbanceEvent";
+
+    std::string node_id;
+    std::string event_id;
+    uint64_t sequence_number{0};
+    std::string timestamp_utc;
+    uint64_t monotonic_ns{0};
+    double signal_amplitude{0.0};
+    double signal_energy{0.0};
+    std::string event_type;                 // "" when classified from features only
+    std::optional<uint64_t> generated_seed;
+    std::optional<double> band_energy_low;
+    std::optional<double> band_energy_high;
+    std::optional<double> duration_s;
+    Stamps hops;
+
+    static constexpr auto fields() {
+        using M = DisturbanceEvent;
+        return std::make_tuple(
+            field("node_id", &M::node_id, NODE_ID, Encoding::NODE_ID),
+            field("event_id", &M::event_id, EVENT_ID, Encoding::UUID),
+            field("sequence_number", &M::sequence_number, SEQUENCE_NUMBER, Encoding::U64),
+            field("timestamp_utc", &M::timestamp_utc, TIMESTAMP_UTC, Encoding::TIMESTAMP),
+            field("monotonic_ns", &M::monotonic_ns, MONOTONIC_NS, Encoding::U64),
+            field("signal_amplitude", &M::signal_amplitude, SIGNAL_AMPLITUDE, Encoding::F64),
+            field("signal_energy", &M::signal_energy, SIGNAL_ENERGY, Encoding::F64),
+            field("event_type", &M::event_type, EVENT_TYPE, Encoding::ENUM, kEventTypes),
+            field("generated_seed", &M::generated_seed, GENERATED_SEED, Encoding::U64),
+            field("band_energy_low", &M::band_energy_low, BAND_ENERGY_LOW, Encoding::F64),
+            field("band_energy_high", &M::band_energy_high, BAND_ENERGY_HIGH, Encoding::F64),
+            field("duration_s", &M::duration_s, DURATION_S, Encoding::F64),
+            field("hops", &M::hops, HOPS, Encoding::STAMPS));
+    }
+};
+
+struct NodeStatus {
+    static constexpr std::string_view kMsgType = "NodeStatus";
+
+    std::string node_id;
+    std::string timestamp_utc;
+    uint64_t monotonic_ns{0};
+    std::string health{"OK"};
+    double uptime_s{0.0};
+    uint64_t last_sequence_number{0};
+    std::optional<uint64_t> bytes_sent;
+    std::optional<uint64_t> edge_triggers;      // edge detection only
+    std::optional<uint64_t> suppressed_events;  // edge detection only
+
+    static constexpr auto fields() {
+        using M = NodeStatus;
+        return std::make_tuple(
+            field("node_id", &M::node_id, NODE_ID, Encoding::NODE_ID),
+            field("timestamp_utc", &M::timestamp_utc, TIMESTAMP_UTC, Encoding::TIMESTAMP),
+            field("monotonic_ns", &M::monotonic_ns, MONOTONIC_NS, Encoding::U64),
+            field("health", &M::health, HEALTH, Encoding::ENUM, kHealthValues),
+            field("uptime_s", &M::uptime_s, UPTIME_S, Encoding::F64),
+            field("last_sequence_number", &M::last_sequence_number, LAST_SEQUENCE_NUMBER, Encoding::U64),
+            field("bytes_sent", &M::bytes_sent, BYTES_SENT, Encoding::U64),
+            field("edge_triggers", &M::edge_triggers, EDGE_TRIGGERS, Encoding::U64),
+            field("suppressed_events", &M::suppressed_events, SUPPRESSED_EVENTS, Encoding::U64));
+    }
+};
+
+struct CentralAlert {
+    static constexpr std::string_view kMsgType = "CentralAlert";
+
+    std::string alert_id;
+    std::string event_id;
+    std::string source_node_id;
+    std::string timestamp_utc;
+    uint64_t monotonic_ns{0};
+    std::string classification;
+    double processing_latency_ms{0.0};
+
+    static constexpr auto fields() {
+        using M = CentralAlert;
+        return std::make_tuple(
+            field("alert_id", &M::alert_id, NOT_PARSED, Encoding::UUID),
+            field("event_id", &M::event_id, NOT_PARSED, Encoding::UUID),
+            field("source_node_id", &M::source_node_id, NOT_PARSED, Encoding::STRING),
+            field("timestamp_utc", &M::timestamp_utc, NOT_PARSED, Encoding::TIMESTAMP),
+            field("monotonic_ns", &M::monotonic_ns, NOT_PARSED, Encoding::U64),
+            field("classification", &M::classification, NOT_PARSED, Encoding::ENUM, kClassifications),
+            field("processing_latency_ms", &M::processing_latency_ms, NOT_PARSED, Encoding::F64));
+    }
+};
+
+// Calls fn(descriptor) for every field of M, in declaration order
+template <Message M, typename Fn>
+constexpr void for_each_field(Fn&& fn) {
+    std::apply([&](const auto&... f) { (fn(f), ...); }, M::fields());
+}
+
+template <Message M>
+constexpr size_t field_count() {
+    return std::tuple_size_v<decltype(M::fields())>;
+}
+
+// Presence bits a valid M must carry: msg_type plus every non-optional field
+template <Message M>
+constexpr uint32_t required_fields() {
+    uint32_t mask = MSG_TYPE;
+    for_each_field<M>([&](const auto& f) {
+        if (!is_optional_field_v<typename std::decay_t<decltype(f)>::value_type>) mask |= f.bit;
+    });
+    return mask;
+}
+
+namespace detail {
+
+// Field indices in JSON key order (nlohmann's sorted object order), so dump() output
+// matches nlohmann::json::dump of the same message
+template <Message M>
+constexpr std::array<size_t, field_count<M>()> json_order() {
+    std::array<std::string_view, field_count<M>()> names{};
+    size_t n = 0;
+    for_each_field<M>([&](const auto& f) { names[n++] = f.name; });
+    std::array<size_t, field_count<M>()> order{};
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return names[a] < names[b]; });
+    return order;
+}
+
+template <Message M>
+constexpr bool unique_names() {
+    std::array<std::string_view, field_count<M>() + 1> names{};
+    size_t n = 0;
+    names[n++] = "msg_type";
+    for_each_field<M>([&](const auto& f) { names[n++] = f.name; });
+    std::sort(names.begin(), names.end());
+    return std::adjacent_find(names.begin(), names.end()) == names.end();
+}
+
+// Number of field names that sort before "msg_type"
+template <Message M>
+constexpr size_t msg_type_position() {
+    size_t pos = 0;
+    for_each_field<M>([&](const auto& f) { pos += f.name < std::string_view("msg_type"); });
+    return pos;
+}
+
+void write_key(std::string& out, bool& first, std::string_view key);
+void write_value(std::string& out, std::string_view v);
+void write_value(std::string& out, uint64_t v);
+void write_value(std::string& out, double v);
+void write_value(std::string& out, const Stamps& v);
+
+} // namespace detail
+
+// Appends M as single-line JSON with keys in sorted order (the same bytes as
+// nlohmann::json::dump of to_json(msg), up to the formatting of doubles)
+template <Message M>
+void dump_to(std::string& out, const M& msg) {
+    static_assert(detail::unique_names<M>(), "duplicate field name");
+    static constexpr auto kOrder = detail::json_order<M>();
+    static constexpr size_t kTypePosition = detail::msg_type_position<M>();
+    static constexpr auto kFields = M::fields();
+
+    bool first = true;
+    out.push_back('{');
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ([&] {
+            if constexpr (I == kTypePosition) {
+                detail::write_key(out, first, "msg_type");
+                detail::write_value(out, M::kMsgType);
+            }
+            const auto& f = std::get<kOrder[I]>(kFields);
+            const auto& v = msg.*(f.member);
+            if (present(v)) {
+                detail::write_key(out, first, f.name);
+                detail::write_value(out, value_of(v));
+            }
+        }(), ...);
+    }(std::make_index_sequence<kOrder.size()>{});
+    if constexpr (kTypePosition == kOrder.size()) {
+        detail::write_key(out, first, "msg_type");
+        detail::write_value(out, M::kMsgType);
+    }
+    out.push_back('}');
+}
+
+template <Message M>
+std::string dump(const M& msg) {
+    std::string out;
+    dump_to(out, msg);
+    return out;
+}
+
+// nlohmann ADL hook: `nlohmann::json j = msg;` (UI state, log fields)
+template <Message M>
+void to_json(nlohmann::json& j, const M& msg) {
+    j = nlohmann::json::object();
+    j.emplace("msg_type", std::string(M::kMsgType));
+    for_each_field<M>([&](const auto& f) {
+        const auto& v = msg.*(f.member);
+        if (!present(v)) return;
+        if constexpr (std::is_same_v<std::decay_t<decltype(v)>, Stamps>) {
+            j.emplace(std::string(f.name), nlohmann::json(std::vector<uint64_t>(v.begin(), v.end())));
+        } else {
+            j.emplace(std::string(f.name), value_of(v));
+        }
+    });
+}
+
+// And back, for messages central reads from its own output (the standby's replicated
+// alerts). Absent optional fields stay unset; a missing required field or a wrong type
+// throws nlohmann::json::exception.
+template <Message M>
+void from_json(const nlohmann::json& j, M& msg) {
+    for_each_field<M>([&](const auto& f) {
+        auto& v = msg.*(f.member);
+        using V = std::decay_t<decltype(v)>;
+        const std::string key(f.name);
+        if constexpr (is_optional_field_v<V>) {
+            auto it = j.find(key);
+            if (it == j.end()) return;
+            if constexpr (std::is_same_v<V, Stamps>) {
+                v.clear();
+                for (const auto& stamp : *it) v.push_back(stamp.template get<uint64_t>());
+            } else {
+                v = it->template get<typename V::value_type>();
+            }
+        } else {
+            j.at(key).get_to(v);
+        }
+    });
+}
+
+} // namespace icd
+} // namespace surveillance
@@ -0,0 +1,495 @@
+#include "icd_parser.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+namespace surveillance {
+namespace icd {
+
+namespace {
+
+enum class Kind : uint8_t { STRING, U64, F64, HOPS };
+
+struct KeyInfo {
+    std::string_view name;
+    Field field{MSG_TYPE};
+    Kind kind{Kind::STRING};
+};
+
+template <typename T>
+constexpr Kind kind_of() {
+    if constexpr (std::is_same_v<T, std::string>) return Kind::STRING;
+    else if constexpr (std::is_same_v<T, Stamps>) return Kind::HOPS;
+    else if constexpr (is_std_optional<T>::value) return kind_of<typename T::value_type>();
+    else if constexpr (std::is_same_v<T, double>) return Kind::F64;
+    else {
+        static_assert(std::is_same_v<T, uint64_t>, "unsupported field type");
+        return Kind::U64;
+    }
+}
+
+// Known keys: msg_type plus the fields of both schemas, generated from their descriptors
+struct KeyTable {
+    std::array<KeyInfo, 1 + field_count<DisturbanceEvent>() + field_count<NodeStatus>()> keys{};
+    size_t size{0};
+
+    template <typename FieldDescriptor>
+    constexpr void add(const FieldDescriptor& f) {
+        for (size_t i = 0; i < size; ++i) {
+            if (keys[i].name == f.name) return; // shared by both schemas
+        }
+        keys[size++] = {f.name, static_cast<Field>(f.bit), kind_of<typename FieldDescriptor::value_type>()};
+    }
+};
+
+constexpr KeyTable make_key_table() {
+    KeyTable table;
+    table.keys[table.size++] = {"msg_type", MSG_TYPE, Kind::STRING};
+    for_each_field<DisturbanceEvent>([&](const auto& f) { table.add(f); });
+    for_each_field<NodeStatus>([&](const auto& f) { table.add(f); });
+    return table;
+}
+
+constexpr KeyTable kKeys = make_key_table();
+
+constexpr int kMaxDepth = 64;
+
+const KeyInfo* lookup(std::string_view key) {
+    for (size_t i = 0; i < kKeys.size; ++i) {
+        const KeyInfo& k = kKeys.keys[i];
+        if (k.name.size() == key.size() && std::memcmp(k.name.data(), key.data(), key.size()) == 0) {
+            return &k;
+        }
+    }
+    return nullptr;
+}
+
+void set_string(MessageView& out, Field field, std::string_view value) {
+    switch (field) {
+        case MSG_TYPE:
+            out.msg_type = value;
+            if (value == "DisturbanceEvent") out.type = MessageType::DISTURBANCE_EVENT;
+            else if (value == "NodeStatus") out.type = MessageType::NODE_STATUS;
+            else out.type = MessageType::OTHER;
+            break;
+        case NODE_ID:       out.node_id = value; break;
+        case TIMESTAMP_UTC: out.timestamp_utc = value; break;
+        case EVENT_ID:      out.event_id = value; break;
+        case EVENT_TYPE:    out.event_type = value; break;
+        case HEALTH:        out.health = value; break;
+        default: break;
+    }
+}
+
+void set_u64(MessageView& out, Field field, uint64_t value) {
+    switch (field) {
+        case MONOTONIC_NS:         out.monotonic_ns = value; break;
+        case SEQUENCE_NUMBER:      out.sequence_number = value; break;
+        case GENERATED_SEED:       out.generated_seed = value; break;
+        case LAST_SEQUENCE_NUMBER: out.last_sequence_number = value; break;
+        case BYTES_SENT:           out.bytes_sent = value; break;
+        case EDGE_TRIGGERS:        out.edge_triggers = value; break;
+        case SUPPRESSED_EVENTS:    out.suppressed_events = value; break;
+        default: break;
+    }
+}
+
+void set_f64(MessageView& out, Field field, double value) {
+    switch (field) {
+        case SIGNAL_AMPLITUDE: out.signal_amplitude = value; break;
+        case SIGNAL_ENERGY:    out.signal_energy = value; break;
+        case BAND_ENERGY_LOW:  out.band_energy_low = value; break;
+        case BAND_ENERGY_HIGH: out.band_energy_high = value; break;
+        case DURATION_S:       out.duration_s = value; break;
+        case UPTIME_S:         out.uptime_s = value; break;
+        default: break;
+    }
+}
+
+void set_value(MessageView& out, Field field, const std::string& v) { set_string(out, field, v); }
+void set_value(MessageView& out, Field field, uint64_t v) { set_u64(out, field, v); }
+void set_value(MessageView& out, Field field, double v) { set_f64(out, field, v); }
+void set_value(MessageView& out, Field, const Stamps& v) { out.hops = v; }
+
+template <Message M>
+MessageView make_view(const M& msg) {
+    MessageView out;
+    set_string(out, MSG_TYPE, M::kMsgType);
+    out.fields = MSG_TYPE;
+    for_each_field<M>([&](const auto& f) {
+        const auto& v = msg.*(f.member);
+        if (!present(v)) return;
+        set_value(out, static_cast<Field>(f.bit), value_of(v));
+        out.fields |= f.bit;
+    });
+    return out;
+}
+
+// What parse() accepts in a string field without escapes
+bool plain_ascii(std::string_view s) {
+    for (unsigned char c : s) {
+        if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') return false;
+    }
+    return true;
+}
+
+// Type and completeness checks shared by parse() and from_json()
+ParseError finish(const MessageView& out, ParseError deferred) {
+    if (!out.has(MSG_TYPE)) return ParseError::MISSING_TYPE;
+    if (out.type == MessageType::OTHER) return ParseError::UNSUPPORTED_TYPE;
+    if (deferred != ParseError::NONE) return deferred;
+    uint32_t required = out.type == MessageType::DISTURBANCE_EVENT ? kDisturbanceEventRequired : kNodeStatusRequired;
+    return (out.fields & required) == required ? ParseError::NONE : ParseError::MISSING_FIELD;
+}
+
+// Cursor over one JSON text. Every method expects the cursor on the first byte of
+// its token (after skip_ws) and leaves it just past the token.
+class Reader {
+public:
+    explicit Reader(std::string_view s) : p_(s.data()), end_(s.data() + s.size()) {}
+
+    const char* pos() const { return p_; }
+    void seek(const char* p) { p_ = p; }
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+
+    bool at_end() {
+        skip_ws();
+        return p_ == end_;
+    }
+
+    bool consume(char c) {
+        skip_ws();
+        if (p_ < end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    char peek() {
+        skip_ws();
+        return p_ < end_ ? *p_ : '\0';
+    }
+
+    // Raw contents between the quotes; `special` is set if they hold escapes or non-ASCII bytes
+    bool string(std::string_view& out, bool& special) {
+        if (!consume('"')) return false;
+        const char* start = p_;
+        special = false;
+        while (p_ < end_) {
+            unsigned char c = static_cast<unsigned char>(*p_);
+            if (c == '"') {
+                out = std::string_view(start, static_cast<size_t>(p_ - start));
+                ++p_;
+                return true;
+            }
+            if (c < 0x20) return false;
+            if (c >= 0x80) special = true;
+            if (c == '\\') {
+                special = true;
+                if (++p_ == end_) return false;
+                if (*p_ == 'u') {
+                    if (end_ - p_ < 5) return false;
+                    for (int i = 1; i <= 4; ++i) {
+                        if (!std::isxdigit(static_cast<unsigned char>(p_[i]))) return false;
+                    }
+                    p_ += 4;
+                } else if (*p_ == '\0' || !std::strchr("\"\\/bfnrt", *p_)) {
+                    return false;
+                }
+            }
+            ++p_;
+        }
+        return false;
+    }
+
+    ParseError u64(uint64_t& out) {
+        char c = peek();
+        if (c != '-' && (c < '0' || c > '9')) return wrong_type();
+        bool integer;
+        const char* end = number_end(integer);
+        if (!end) return ParseError::SYNTAX;
+        auto [ptr, ec] = std::from_chars(p_, end, out);
+        p_ = end;
+        // Negative, fractional or out of range
+        return (c == '-' || !integer || ec != std::errc() || ptr != end) ? ParseError::WRONG_TYPE : ParseError::NONE;
+    }
+
+    ParseError f64(double& out) {
+        char c = peek();
+        if (c != '-' && (c < '0' || c > '9')) return wrong_type();
+        bool integer;
+        const char* end = number_end(integer);
+        if (!end) return ParseError::SYNTAX;
+        auto [ptr, ec] = std::from_chars(p_, end, out);
+        p_ = end;
+        return (ec != std::errc() || ptr != end) ? ParseError::WRONG_TYPE : ParseError::NONE;
+    }
+
+    // Skips one value of any type, validating it
+    bool skip_value(int depth = 0) {
+        if (depth > kMaxDepth) return false;
+        switch (peek()) {
+            case '{': {
+                ++p_;
+                if (consume('}')) return true;
+                do {
+                    std::string_view key;
+                    bool special;
+                    if (!string(key, special) || !consume(':') || !skip_value(depth + 1)) return false;
+                } while (consume(','));
+                return consume('}');
+            }
+            case '[': {
+                ++p_;
+                if (consume(']')) return true;
+                do {
+                    if (!skip_value(depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            }
+            case '"': {
+                std::string_view s;
+                bool special;
+                return string(s, special);
+            }
+            case 't': return literal("true");
+            case 'f': return literal("false");
+            case 'n': return literal("null");
+            default: return skip_number();
+        }
+    }
+
+private:
+    bool literal(std::string_view word) {
+        if (static_cast<size_t>(end_ - p_) < word.size() || std::memcmp(p_, word.data(), word.size()) != 0) {
+            return false;
+        }
+        p_ += word.size();
+        return true;
+    }
+
+    bool skip_number() {
+        bool integer;
+        const char* end = number_end(integer);
+        if (!end) return false;
+        p_ = end;
+        return true;
+    }
+
+    // End of the JSON number at the cursor (RFC 8259 grammar), or nullptr
+    const char* number_end(bool& integer) const {
+        auto digit = [this](const char* q) { return q < end_ && *q >= '0' && *q <= '9'; };
+        const char* q = p_;
+        integer = true;
+        if (q < end_ && *q == '-') ++q;
+        if (!digit(q)) return nullptr;
+        if (*q == '0') {
+            ++q;
+        } else {
+            while (digit(q)) ++q;
+        }
+        if (q < end_ && *q == '.') {
+            integer = false;
+            if (!digit(++q)) return nullptr;
+            while (digit(q)) ++q;
+        }
+        if (q < end_ && (*q == 'e' || *q == 'E')) {
+            integer = false;
+            ++q;
+            if (q < end_ && (*q == '+' || *q == '-')) ++q;
+            if (!digit(q)) return nullptr;
+            while (digit(q)) ++q;
+        }
+        return q;
+    }
+
+    // A well-formed value of the wrong type, or a syntax error
+    ParseError wrong_type() {
+        return skip_value() ? ParseError::WRONG_TYPE : ParseError::SYNTAX;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+ParseError parse_hops(Reader& r, MessageView& out) {
+    out.hops.clear();
+    if (r.peek() != '[') return r.skip_value() ? ParseError::WRONG_TYPE : ParseError::SYNTAX;
+    r.consume('[');
+    if (r.consume(']')) return ParseError::NONE;
+    do {
+        uint64_t stamp;
+        if (ParseError err = r.u64(stamp); err != ParseError::NONE) return err;
+        if (!out.hops.push_back(stamp)) return ParseError::TOO_MANY_HOPS;
+    } while (r.consume(','));
+    return r.consume(']') ? ParseError::NONE : ParseError::SYNTAX;
+}
+
+ParseError parse_value(Reader& r, const KeyInfo& key, MessageView& out) {
+    switch (key.kind) {
+        case Kind::STRING: {
+            if (r.peek() != '"') return r.skip_value() ? ParseError::WRONG_TYPE : ParseError::SYNTAX;
+            std::string_view value;
+            bool special;
+            if (!r.string(value, special)) return ParseError::SYNTAX;
+            if (special) return ParseError::BAD_STRING;
+            set_string(out, key.field, value);
+            return ParseError::NONE;
+        }
+        case Kind::U64: {
+            uint64_t value;
+            ParseError err = r.u64(value);
+            if (err == ParseError::NONE) set_u64(out, key.field, value);
+            return err;
+        }
+        case Kind::F64: {
+            double value;
+            ParseError err = r.f64(value);
+            if (err == ParseError::NONE) set_f64(out, key.field, value);
+            return err;
+        }
+        case Kind::HOPS:
+            return parse_hops(r, out);
+    }
+    return ParseError::SYNTAX;
+}
+
+} // namespace
+
+const char* parse_error_name(ParseError err) {
+    switch (err) {
+        case ParseError::NONE:             return "none";
+        case ParseError::SYNTAX:           return "syntax";
+        case ParseError::NOT_OBJECT:       return "not_object";
+        case ParseError::MISSING_TYPE:     return "missing_type";
+        case ParseError::UNSUPPORTED_TYPE: return "unsupported_type";
+        case ParseError::WRONG_TYPE:       return "wrong_type";
+        case ParseError::MISSING_FIELD:    return "missing_field";
+        case ParseError::BAD_STRING:       return "bad_string";
+        case ParseError::TOO_MANY_HOPS:    return "too_many_hops";
+        case ParseError::COUNT:            break;
+    }
+    return "unknown";
+}
+
+void MessageView::rebase(const char* from, const char* to) {
+    for (std::string_view* v : {&msg_type, &node_id, &timestamp_utc, &event_id, &event_type, &health}) {
+        if (v->data() != nullptr) {
+            *v = std::string_view(to + (v->data() - from), v->size());
+        }
+    }
+}
+
+MessageView view_of(const DisturbanceEvent& msg) {
+    return make_view(msg);
+}
+
+MessageView view_of(const NodeStatus& msg) {
+    return make_view(msg);
+}
+
+ParseError parse(std::string_view frame, MessageView& out) {
+    out = MessageView{};
+    Reader r(frame);
+
+    if (r.peek() != '{') {
+        return r.skip_value() && r.at_end() ? ParseError::NOT_OBJECT : ParseError::SYNTAX;
+    }
+    r.consume('{');
+
+    // Type errors are reported only once the message is known to be one we cover;
+    // other message types may reuse a key name with a different type
+    ParseError deferred = ParseError::NONE;
+    if (!r.consume('}')) {
+        do {
+            std::string_view key;
+            bool special;
+            if (!r.string(key, special) || !r.consume(':')) return ParseError::SYNTAX;
+
+            const KeyInfo* info = special ? nullptr : lookup(key);
+            if (!info) {
+                if (!r.skip_value()) return ParseError::SYNTAX;
+                continue;
+            }
+
+            r.skip_ws();
+            const char* value_start = r.pos();
+            ParseError err = parse_value(r, *info, out);
+            if (err == ParseError::NONE) {
+                out.fields |= info->field;
+                if (out.type == MessageType::OTHER) return ParseError::UNSUPPORTED_TYPE;
+            } else if (err == ParseError::SYNTAX) {
+                return err;
+            } else {
+                // Resynchronize after the offending value
+                r.seek(value_start);
+                if (!r.skip_value()) return ParseError::SYNTAX;
+                if (deferred == ParseError::NONE) deferred = err;
+            }
+        } while (r.consume(','));
+        if (!r.consume('}')) return ParseError::SYNTAX;
+    }
+    if (!r.at_end()) return ParseError::SYNTAX;
+
+    return finish(out, deferred);
+}
+
+ParseError from_json(const nlohmann::json& msg, MessageView& out) {
+    out = MessageView{};
+    if (!msg.is_object()) return ParseError::NOT_OBJECT;
+
+    ParseError deferred = ParseError::NONE;
+    for (auto it = msg.begin(); it != msg.end(); ++it) {
+        const KeyInfo* info = lookup(it.key());
+        if (!info) continue;
+        const nlohmann::json& v = it.value();
+
+        ParseError err = ParseError::NONE;
+        switch (info->kind) {
+            case Kind::STRING:
+                if (!v.is_string()) err = ParseError::WRONG_TYPE;
+                else if (!plain_ascii(v.get_ref<const std::string&>())) err = ParseError::BAD_STRING;
+                else set_string(out, info->field, v.get_ref<const std::string&>());
+                break;
+            case Kind::U64:
+                if (v.is_number_unsigned()) set_u64(out, info->field, v.get<uint64_t>());
+                else err = ParseError::WRONG_TYPE;
+                break;
+            case Kind::F64:
+                if (v.is_number()) set_f64(out, info->field, v.get<double>());
+                else err = ParseError::WRONG_TYPE;
+                break;
+            case Kind::HOPS:
+                if (!v.is_array()) {
+                    err = ParseError::WRONG_TYPE;
+                } else if (v.size() > kMaxHops) {
+                    err = ParseError::TOO_MANY_HOPS;
+                } else {
+                    out.hops.clear();
+                    for (const auto& stamp : v) {
+                        if (!stamp.is_number_unsigned()) {
+                            err = ParseError::WRONG_TYPE;
+                            break;
+                        }
+                        out.hops.push_back(stamp.get<uint64_t>());
+                    }
+                }
+                break;
+        }
+
+        if (err == ParseError::NONE) {
+            out.fields |= info->field;
+        } else if (deferred == ParseError::NONE) {
+            deferred = err;
+        }
+    }
+    return finish(out, deferred);
+}
+
+} // namespace icd
+} // namespace surveillance
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "icd_messages.hpp"
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace surveillance {
+namespace icd {
+
+// Schema-specific parser for the two high-rate ICD messages, DisturbanceEvent (§2.1)
+// and NodeStatus (§2.2).
+//
+// parse() makes one pass over the frame and fills a MessageView: known keys are
+// matched against a fixed table, numbers are converted in place with from_chars,
+// string fields are views into the frame and unknown keys are skipped without being
+// materialized. Nothing is allocated. Required fields are checked as part of the
+// pass, so a message that parses is complete and correctly typed. Other message types
+// are recognized from msg_type and reported as UNSUPPORTED_TYPE for the caller to
+// parse generically (WaveformBlock, ...).
+//
+// String fields must be plain ASCII without escapes, as every identifier in the ICD
+// is; anything else is rejected rather than decoded or validated into a copy.
+
+enum class MessageType : uint8_t {
+    UNKNOWN = 0,
+    DISTURBANCE_EVENT,
+    NODE_STATUS,
+    OTHER
+};
+
+enum class ParseError : uint8_t {
+    NONE = 0,
+    SYNTAX,            // not well-formed JSON, or trailing bytes
+    NOT_OBJECT,        // top level is not an object
+    MISSING_TYPE,      // no msg_type
+    UNSUPPORTED_TYPE,  // valid msg_type this parser does not cover
+    WRONG_TYPE,        // a known field with the wrong JSON type or out of range
+    MISSING_FIELD,     // a required field is absent
+    BAD_STRING,        // a string field holds escapes or non-ASCII bytes
+    TOO_MANY_HOPS,     // more hop stamps than kMaxHops
+    COUNT
+};
+
+const char* parse_error_name(ParseError err);
+
+constexpr uint32_t kDisturbanceEventRequired = required_fields<DisturbanceEvent>();
+constexpr uint32_t kNodeStatusRequired = required_fields<NodeStatus>();
+
+// A parsed DisturbanceEvent or NodeStatus. String views point into the parsed buffer
+// (or the json it came from) and are only valid while that is alive and unmoved.
+struct MessageView {
+    MessageType type{MessageType::UNKNOWN};
+    uint32_t fields{0};
+
+    bool has(Field f) const { return (fields & f) != 0; }
+
+    // Common
+    std::string_view msg_type;
+    std::string_view node_id;
+    std::string_view timestamp_utc;
+    uint64_t monotonic_ns{0};
+
+    // DisturbanceEvent
+    std::string_view event_id;
+    uint64_t sequence_number{0};
+    double signal_amplitude{0.0};
+    double signal_energy{0.0};
+    std::string_view event_type;
+    uint64_t generated_seed{0};
+    Stamps hops;
+    double band_energy_low{0.0};
+    double band_energy_high{0.0};
+    double duration_s{0.0};
+
+    // NodeStatus
+    std::string_view health;
+    double uptime_s{0.0};
+    uint64_t last_sequence_number{0};
+    uint64_t bytes_sent{0};
+    uint64_t edge_triggers{0};
+    uint64_t suppressed_events{0};
+
+    // Re-points the string views after the buffer they point into moved from `from` to `to`
+    void rebase(const char* from, const char* to);
+};
+
+// View of a typed message; string fields point into `msg`
+MessageView view_of(const DisturbanceEvent& msg);
+MessageView view_of(const NodeStatus& msg);
+
+// Parses one JSON text frame. `out` is reset first; on error its contents are unspecified.
+ParseError parse(std::string_view frame, MessageView& out);
+
+// Same validation for a message that is already a json DOM (decoded codec frames,
+// locally derived events). Views point into `msg`.
+ParseError from_json(const nlohmann::json& msg, MessageView& out);
+
+} // namespace icd
+} // namespace surveillance
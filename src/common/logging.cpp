@@ -1,12 +1,19 @@
 #include "logging.hpp"
+#include "async_file.hpp"
+#include "metrics.hpp"
+#include "segmented_file.hpp"
 #include "time.hpp"
 
 #include <spdlog/spdlog.h>
-#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/base_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/pattern_formatter.h>
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
 
 namespace surveillance {
 namespace logging {
@@ -31,8 +38,7 @@ public:
         if (!text.empty() && text[0] == '{') {
             try {
                 auto parsed = nlohmann::json::parse(text);
-                j.merge_patch(parsed);
-                j.erase("message"); // Move custom message field if any
+                j.merge_patch(parsed); // "message" and "fields" come from the payload
             } catch (...) {
                 // Ignore and treat as string
             }
@@ -47,71 +53,220 @@ public:
     }
 };
 
+// File sink over a SegmentedFile, so component logs rotate under logging.rotation
+class SegmentedSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    SegmentedSink(const std::string& path, const config::RotationConfig& cfg) : file_(path, cfg, true) {}
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        spdlog::memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+        file_.write(formatted.data(), formatted.size());
+    }
+    void flush_() override {
+        file_.flush();
+    }
+
+private:
+    segments::SegmentedFile file_;
+};
+
 static std::shared_ptr<spdlog::logger> logger;
 static std::string g_component_name;
 static int g_flush_every_n = 1;
 
-void init(const std::string& component_name, const std::string& log_dir, int flush_every_n) {
+namespace detail {
+std::atomic<int> g_level{static_cast<int>(Level::info)};
+}
+
+static std::atomic<int> g_sample_every_n{1};
+
+static std::mutex g_sites_mutex;
+static std::vector<CallSite*> g_sites;
+
+std::optional<Level> parse_level(std::string_view name) {
+    if (name == "debug") return Level::debug;
+    if (name == "info") return Level::info;
+    if (name == "warn" || name == "warning") return Level::warn;
+    if (name == "error") return Level::error;
+    if (name == "off") return Level::off;
+    return std::nullopt;
+}
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::debug: return "debug";
+        case Level::info: return "info";
+        case Level::warn: return "warn";
+        case Level::error: return "error";
+        case Level::off: return "off";
+    }
+    return "info";
+}
+
+void set_level(Level level) {
+    detail::g_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+Level level() {
+    return static_cast<Level>(detail::g_level.load(std::memory_order_relaxed));
+}
+
+void set_sample_every_n(int n) {
+    g_sample_every_n.store(std::max(1, n), std::memory_order_relaxed);
+}
+
+int sample_every_n() {
+    return g_sample_every_n.load(std::memory_order_relaxed);
+}
+
+void init(const std::string& component_name, const config::LoggingConfig& cfg) {
     g_component_name = component_name;
-    g_flush_every_n = flush_every_n;
-    
+    g_flush_every_n = cfg.flush_every_n;
+    auto configured_level = parse_level(cfg.level);
+    set_level(configured_level.value_or(Level::info));
+    set_sample_every_n(cfg.sample_every_n);
+    // Before the file sink opens its file: the backend decides how it writes
+    const aio::Backend io_backend = aio::configure(cfg.io);
+
     try {
-        std::string log_file = log_dir + "/" + component_name + ".jsonl";
-        auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_file, true);
+        std::string log_file = cfg.log_dir + "/" + component_name + ".jsonl";
+        auto file_sink = std::make_shared<SegmentedSink>(log_file, cfg.rotation);
         auto console_sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
         
         logger = std::make_shared<spdlog::logger>(component_name, spdlog::sinks_init_list{file_sink, console_sink});
         
         // Custom JSON formatter
         logger->set_formatter(std::make_unique<JsonFormatter>(component_name));
+        // Levels are filtered before the call reaches spdlog (see enabled())
+        logger->set_level(spdlog::level::trace);
         
-        if (flush_every_n <= 1) {
-            logger->flush_on(spdlog::level::info);
+        if (cfg.flush_every_n <= 1) {
+            logger->flush_on(spdlog::level::debug);
         } // We will manually flush if needed
         
         spdlog::set_default_logger(logger);
-    } catch (const spdlog::spdlog_ex& ex) {
+    } catch (const std::exception& ex) {
         std::cerr << "Log init failed: " << ex.what() << std::endl;
         std::exit(1);
     }
+    if (!configured_level) {
+        warn("Unknown logging.level, using info", {{"level", cfg.level}});
+    }
+    if (cfg.io.backend == "io_uring" && io_backend != aio::Backend::IO_URING) {
+        warn("io_uring unavailable, file output uses the threads backend", {{"backend", aio::backend_name(io_backend)}});
+    }
 }
 
-void internal_log(spdlog::level::level_enum level, const std::string& msg, const nlohmann::json& fields) {
+static spdlog::level::level_enum to_spdlog(Level level) {
+    switch (level) {
+        case Level::debug: return spdlog::level::debug;
+        case Level::warn: return spdlog::level::warn;
+        case Level::error: return spdlog::level::err;
+        default: return spdlog::level::info;
+    }
+}
+
+void write(Level level, const std::string& msg, const nlohmann::json& fields, uint64_t suppressed) {
     if (!logger) return;
     
     nlohmann::json payload;
     payload["message"] = msg;
-    if (!fields.empty()) {
+    if (fields.is_object()) {
         payload["fields"] = fields;
     } else {
         payload["fields"] = nlohmann::json::object();
     }
-    logger->log(level, payload.dump());
+    if (suppressed != 0) {
+        payload["suppressed"] = suppressed;
+    }
+    logger->log(to_spdlog(level), payload.dump());
     
-    static int log_count = 0;
-    if (++log_count >= g_flush_every_n) {
+    static std::atomic<int> log_count{0};
+    if (log_count.fetch_add(1, std::memory_order_relaxed) + 1 >= g_flush_every_n) {
         logger->flush();
-        log_count = 0;
+        log_count.store(0, std::memory_order_relaxed);
     }
 }
 
+void debug(const std::string& msg, const nlohmann::json& fields) {
+    if (enabled(Level::debug)) write(Level::debug, msg, fields);
+}
+
 void info(const std::string& msg, const nlohmann::json& fields) {
-    internal_log(spdlog::level::info, msg, fields);
+    if (enabled(Level::info)) write(Level::info, msg, fields);
 }
 
 void warn(const std::string& msg, const nlohmann::json& fields) {
-    internal_log(spdlog::level::warn, msg, fields);
+    if (enabled(Level::warn)) write(Level::warn, msg, fields);
 }
 
 void error(const std::string& msg, const nlohmann::json& fields) {
-    internal_log(spdlog::level::err, msg, fields);
+    if (enabled(Level::error)) write(Level::error, msg, fields);
+}
+
+CallSite::CallSite(const char* file, int line) : file_(file), line_(line) {
+    std::lock_guard<std::mutex> lock(g_sites_mutex);
+    g_sites.push_back(this);
+}
+
+bool CallSite::sample(uint64_t& suppressed) {
+    const int n = g_sample_every_n.load(std::memory_order_relaxed);
+    if (n > 1) {
+        thread_local std::minstd_rand rng{std::random_device{}()};
+        if (rng() % static_cast<uint32_t>(n) != 0) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    if (suppressed != 0) {
+        metrics::add("log.suppressed_lines", suppressed);
+    }
+    return true;
+}
+
+bool CallSite::rate_limit(double per_second, uint64_t& suppressed) {
+    // Fixed one-second windows; a racing window reset can let a line or two extra through
+    const uint64_t window = time::monotonic_ns() / 1000000000ULL;
+    if (window_.load(std::memory_order_relaxed) != window) {
+        window_.store(window, std::memory_order_relaxed);
+        window_count_.store(0, std::memory_order_relaxed);
+    }
+    if (static_cast<double>(window_count_.fetch_add(1, std::memory_order_relaxed)) >= per_second) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    if (suppressed != 0) {
+        metrics::add("log.suppressed_lines", suppressed);
+    }
+    return true;
 }
 
 void shutdown() {
+    // Report what sampled and rate-limited sites dropped since their last line
+    nlohmann::json sites = nlohmann::json::array();
+    {
+        std::lock_guard<std::mutex> lock(g_sites_mutex);
+        for (auto* site : g_sites) {
+            if (uint64_t n = site->take_suppressed()) {
+                sites.push_back({{"site", std::string(site->file()) + ":" + std::to_string(site->line())},
+                                 {"suppressed", n}});
+                metrics::add("log.suppressed_lines", n);
+            }
+        }
+    }
+    if (!sites.empty()) {
+        info("Log suppression summary", {{"sites", sites}});
+    }
     if (logger) {
         logger->flush();
     }
     spdlog::shutdown();
+    // Closes the file sink, which waits for background compression of rotated segments
+    logger.reset();
 }
 
 } // namespace logging
@@ -1,18 +1,119 @@
 #pragma once
 
+#include "config.hpp"
 #include <string>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 namespace surveillance {
 namespace logging {
 
-void init(const std::string& component_name, const std::string& log_dir, int flush_every_n);
+enum class Level : int {
+    debug = 0,
+    info = 1,
+    warn = 2,
+    error = 3,
+    off = 4
+};
 
+std::optional<Level> parse_level(std::string_view name);
+const char* level_name(Level level);
+
+void init(const std::string& component_name, const config::LoggingConfig& cfg);
+
+// Runtime controls, also driven by LogControl messages (control.hpp). `sample_every_n`
+// applies to the SURV_LOG_*_SAMPLED call sites: each call is kept with probability 1/N.
+void set_level(Level level);
+Level level();
+void set_sample_every_n(int n);
+int sample_every_n();
+
+namespace detail {
+extern std::atomic<int> g_level;
+}
+
+// Cheap enough for every call site: one relaxed atomic load
+inline bool enabled(Level level) {
+    return static_cast<int>(level) >= detail::g_level.load(std::memory_order_relaxed);
+}
+
+void debug(const std::string& msg, const nlohmann::json& fields = nlohmann::json::object());
 void info(const std::string& msg, const nlohmann::json& fields = nlohmann::json::object());
 void warn(const std::string& msg, const nlohmann::json& fields = nlohmann::json::object());
 void error(const std::string& msg, const nlohmann::json& fields = nlohmann::json::object());
 
+// Writes a line that passed its level check; `suppressed` is added to the line when
+// calls of the same site were sampled out or rate limited before it
+void write(Level level, const std::string& msg, const nlohmann::json& fields = nlohmann::json::object(),
+           uint64_t suppressed = 0);
+
+// Per-call-site state of the sampled and rate-limited macros. Sites are static
+// locals, registered on first use so shutdown() can account for what they dropped.
+class CallSite {
+public:
+    CallSite(const char* file, int line);
+
+    // Probabilistic 1-in-sample_every_n(); on true, `suppressed` is the number of
+    // calls dropped since the last kept one
+    bool sample(uint64_t& suppressed);
+    // At most `per_second` lines per wall-clock second
+    bool rate_limit(double per_second, uint64_t& suppressed);
+
+    const char* file() const { return file_; }
+    int line() const { return line_; }
+    uint64_t take_suppressed() { return suppressed_.exchange(0, std::memory_order_relaxed); }
+
+private:
+    const char* file_;
+    int line_;
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<uint64_t> window_{0};
+    std::atomic<uint64_t> window_count_{0};
+};
+
 void shutdown();
 
 } // namespace logging
 } // namespace surveillance
+
+// Logging macros: the message and field arguments are only evaluated when the line
+// is actually written, so a disabled or dropped call costs one atomic load (plus the
+// sampling/rate decision). Fields are a braced nlohmann::json initializer.
+#define SURV_LOG(level, msg, ...)                                                                \
+    do {                                                                                         \
+        if (::surveillance::logging::enabled(level)) {                                           \
+            ::surveillance::logging::write(level, msg __VA_OPT__(, ) __VA_ARGS__);               \
+        }                                                                                        \
+    } while (0)
+
+#define SURV_LOG_SAMPLED(level, msg, ...)                                                        \
+    do {                                                                                         \
+        if (::surveillance::logging::enabled(level)) {                                           \
+            static ::surveillance::logging::CallSite surv_log_site_(__FILE__, __LINE__);         \
+            uint64_t surv_log_suppressed_ = 0;                                                   \
+            if (surv_log_site_.sample(surv_log_suppressed_)) {                                   \
+                ::surveillance::logging::write(level, msg, nlohmann::json(__VA_ARGS__),          \
+                                               surv_log_suppressed_);                            \
+            }                                                                                    \
+        }                                                                                        \
+    } while (0)
+
+#define SURV_LOG_RATE(level, per_second, msg, ...)                                               \
+    do {                                                                                         \
+        if (::surveillance::logging::enabled(level)) {                                           \
+            static ::surveillance::logging::CallSite surv_log_site_(__FILE__, __LINE__);         \
+            uint64_t surv_log_suppressed_ = 0;                                                   \
+            if (surv_log_site_.rate_limit(per_second, surv_log_suppressed_)) {                   \
+                ::surveillance::logging::write(level, msg, nlohmann::json(__VA_ARGS__),          \
+                                               surv_log_suppressed_);                            \
+            }                                                                                    \
+        }                                                                                        \
+    } while (0)
+
+#define SURV_LOG_DEBUG(msg, ...) SURV_LOG(::surveillance::logging::Level::debug, msg __VA_OPT__(, ) __VA_ARGS__)
+#define SURV_LOG_INFO(msg, ...) SURV_LOG(::surveillance::logging::Level::info, msg __VA_OPT__(, ) __VA_ARGS__)
+#define SURV_LOG_WARN(msg, ...) SURV_LOG(::surveillance::logging::Level::warn, msg __VA_OPT__(, ) __VA_ARGS__)
+#define SURV_LOG_ERROR(msg, ...) SURV_LOG(::surveillance::logging::Level::error, msg __VA_OPT__(, ) __VA_ARGS__)
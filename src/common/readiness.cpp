@@ -0,0 +1,48 @@
+#include "readiness.hpp"
+#include "time.hpp"
+#include "logging.hpp"
+
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <process.h>
+#define SURV_GETPID _getpid
+#else
+#include <unistd.h>
+#define SURV_GETPID getpid
+#endif
+
+namespace surveillance {
+namespace readiness {
+
+std::string marker_path(const std::string& log_dir, const std::string& component) {
+    return log_dir + "/" + component + ".ready";
+}
+
+void mark_ready(const std::string& log_dir, const std::string& component) {
+    std::string path = marker_path(log_dir, component);
+    std::string tmp = path + ".tmp";
+    try {
+        std::ofstream f(tmp);
+        f << nlohmann::json{
+            {"component", component},
+            {"pid", static_cast<int>(SURV_GETPID())},
+            {"timestamp_utc", time::utc_now_string()}
+        }.dump() << "\n";
+        f.close();
+        std::filesystem::rename(tmp, path);
+        logging::info("Component ready", {{"component", component}});
+    } catch (...) {
+        logging::error("Failed to write readiness marker", {{"path", path}});
+    }
+}
+
+void clear(const std::string& log_dir, const std::string& component) {
+    std::error_code ec;
+    std::filesystem::remove(marker_path(log_dir, component), ec);
+}
+
+} // namespace readiness
+} // namespace surveillance
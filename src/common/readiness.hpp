@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+namespace surveillance {
+namespace readiness {
+
+// Readiness markers for harnesses: `<log_dir>/<component>.ready` exists only while the
+// component is up and connected to its peers. Written atomically (tmp + rename).
+void mark_ready(const std::string& log_dir, const std::string& component);
+void clear(const std::string& log_dir, const std::string& component);
+
+std::string marker_path(const std::string& log_dir, const std::string& component);
+
+} // namespace readiness
+} // namespace surveillance
@@ -0,0 +1,122 @@
+#include "runtime.hpp"
+#include "logging.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace surveillance {
+namespace runtime {
+
+namespace {
+
+config::RuntimeConfig g_cfg;
+std::string g_component;
+thread_local bool t_busy_poll = false;
+
+// Deep enough for every loop's call chain; a page touched under mlockall stays resident
+constexpr size_t kStackPrefaultBytes = 256 * 1024;
+
+#if defined(__linux__)
+__attribute__((noinline)) void prefault_stack() {
+    char stack[kStackPrefaultBytes];
+    std::memset(stack, 0, sizeof(stack));
+    asm volatile("" : : "r"(stack) : "memory"); // keeps the stores
+}
+
+void lock_memory(uint64_t prefault_heap_bytes) {
+    // Freed heap stays in the process, and large blocks come from the heap rather than
+    // a fresh mmap, so a page is faulted in once
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        logging::warn("mlockall failed, memory is not locked",
+                      {{"error", std::strerror(errno)}, {"hint", "raise RLIMIT_MEMLOCK (ulimit -l)"}});
+    }
+    if (prefault_heap_bytes > 0) {
+        // Touched and freed: the pages stay in the heap for later allocations
+        char* block = static_cast<char*>(std::malloc(prefault_heap_bytes));
+        if (block) {
+            std::memset(block, 0, prefault_heap_bytes);
+            std::free(block);
+        }
+    }
+}
+#endif
+
+} // namespace
+
+void configure(const config::RuntimeConfig& cfg, const std::string& component) {
+    g_cfg = cfg;
+    g_component = component;
+
+    nlohmann::json threads = nlohmann::json::object();
+    const std::string prefix = component + ".";
+    for (const auto& [name, profile] : cfg.threads) {
+        if (name.compare(0, prefix.size(), prefix) != 0) continue;
+        threads[name.substr(prefix.size())] = {{"cpu", profile.cpu}, {"busy_poll", profile.busy_poll}};
+    }
+    if (threads.empty() && !cfg.lock_memory) return;
+
+#if defined(__linux__)
+    if (cfg.lock_memory) lock_memory(cfg.prefault_heap_bytes);
+#endif
+    logging::info("Runtime profile", {{"threads", threads},
+                                      {"sched_fifo_priority", cfg.sched_fifo_priority},
+                                      {"lock_memory", cfg.lock_memory},
+                                      {"prefault_heap_bytes", cfg.prefault_heap_bytes}});
+}
+
+void enter_thread(const std::string& thread) {
+#if defined(__linux__)
+    if (g_cfg.lock_memory) prefault_stack();
+#endif
+    t_busy_poll = false;
+    auto it = g_cfg.threads.find(g_component + "." + thread);
+    if (it == g_cfg.threads.end()) return;
+    const config::ThreadProfile& profile = it->second;
+    t_busy_poll = profile.busy_poll;
+    if (profile.cpu < 0) return;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(profile.cpu, &set);
+    int rc = profile.cpu < CPU_SETSIZE ? pthread_setaffinity_np(pthread_self(), sizeof(set), &set) : EINVAL;
+    if (rc != 0) {
+        logging::warn("Could not pin thread", {{"thread", thread}, {"cpu", profile.cpu}, {"error", std::strerror(rc)}});
+    }
+    if (g_cfg.sched_fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = g_cfg.sched_fifo_priority;
+        rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            logging::warn("Could not switch thread to SCHED_FIFO",
+                          {{"thread", thread}, {"error", std::strerror(rc)}, {"hint", "needs CAP_SYS_NICE or RLIMIT_RTPRIO"}});
+        }
+    }
+#endif
+}
+
+bool busy_polling() {
+    return t_busy_poll;
+}
+
+void idle(std::chrono::microseconds sleep) {
+    if (t_busy_poll) {
+        cpu_relax();
+    } else {
+        std::this_thread::sleep_for(sleep);
+    }
+}
+
+} // namespace runtime
+} // namespace surveillance
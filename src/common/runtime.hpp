@@ -0,0 +1,47 @@
+#pragma once
+
+#include "config.hpp"
+#include <chrono>
+#include <string>
+
+namespace surveillance {
+namespace runtime {
+
+// Low-latency runtime profile (config `runtime`), for deployments that give CPU away
+// for tail latency.
+//
+// Each latency-critical thread announces its name with enter_thread() and gets the
+// profile of "<component>.<thread>": pinned to a core, SCHED_FIFO at
+// runtime.sched_fifo_priority when pinned, and busy polling. A busy-polling loop spins
+// on a pause instruction where it would otherwise sleep for 1 to 10 ms, so it picks up
+// work within a microsecond but keeps its core at 100%. Give a busy-polling
+// SCHED_FIFO thread a core of its own: it never yields to SCHED_OTHER threads there.
+//
+// runtime.lock_memory locks the process's pages (mlockall) and stops the heap from
+// returning freed memory, so nothing is faulted in on the hot path after warm-up.
+// Linux only; elsewhere the profile is accepted and ignored, apart from busy polling.
+
+// Call once per process, after logging::init. Settings the kernel refuses (a core that
+// does not exist, no CAP_SYS_NICE or RLIMIT_MEMLOCK for the rest) are logged as
+// warnings and skipped.
+void configure(const config::RuntimeConfig& cfg, const std::string& component);
+
+// Applies the calling thread's profile; threads without one run as before
+void enter_thread(const std::string& thread);
+
+// Whether the calling thread's profile asks for busy polling
+bool busy_polling();
+
+// One idle round of a polling loop: a spin-wait hint when busy polling, else a sleep
+void idle(std::chrono::microseconds sleep);
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+} // namespace runtime
+} // namespace surveillance
@@ -0,0 +1,379 @@
+#include "segmented_file.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace surveillance {
+namespace segments {
+
+namespace {
+
+std::string index_path(const std::string& dir, const std::string& stem) {
+    return (fs::path(dir) / (stem + ".index.json")).string();
+}
+
+void lower_thread_priority() {
+#if defined(__linux__)
+    // Per-thread nice value on Linux; compression only gets otherwise idle CPU
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+}
+
+} // namespace
+
+uint64_t gzip_file(const std::string& src, const std::string& dst) {
+    std::FILE* in = std::fopen(src.c_str(), "rb");
+    if (!in) return 0;
+    const std::string tmp = dst + ".tmp";
+    gzFile out = gzopen(tmp.c_str(), "wb6");
+    if (!out) {
+        std::fclose(in);
+        return 0;
+    }
+    std::vector<char> buf(1 << 16);
+    bool ok = true;
+    size_t n;
+    while (ok && (n = std::fread(buf.data(), 1, buf.size(), in)) > 0) {
+        ok = gzwrite(out, buf.data(), static_cast<unsigned>(n)) == static_cast<int>(n);
+    }
+    ok = ok && !std::ferror(in);
+    std::fclose(in);
+    ok = (gzclose(out) == Z_OK) && ok;
+
+    std::error_code ec;
+    if (ok) fs::rename(tmp, dst, ec);
+    if (!ok || ec) {
+        fs::remove(tmp, ec);
+        return 0;
+    }
+    return static_cast<uint64_t>(fs::file_size(dst, ec));
+}
+
+SegmentedFile::SegmentedFile(const std::string& path, const config::RotationConfig& cfg, bool buffered,
+                             bool resume)
+    : path_(path),
+      cfg_(cfg),
+      buffered_(buffered)
+{
+    fs::path p(path_);
+    dir_ = p.has_parent_path() ? p.parent_path().string() : ".";
+    stem_ = p.stem().string();
+    ext_ = p.extension().string();
+
+    // Leftovers of a previous run: <stem>.<seq><ext>[.gz] and the index. A resumed file
+    // keeps them and numbers its own segments after the highest one.
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir_, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind(stem_ + ".", 0) != 0) continue;
+        const std::string rest = name.substr(stem_.size() + 1);
+        const size_t digits = rest.find_first_not_of("0123456789");
+        const bool segment = digits == 6 && (rest.substr(6) == ext_ || rest.substr(6) == ext_ + ".gz" ||
+                                             rest.substr(6) == ext_ + ".gz.tmp");
+        if (resume) {
+            if (segment) next_seq_ = std::max<uint64_t>(next_seq_, std::stoull(rest.substr(0, 6)) + 1);
+        } else if (segment || rest == "index.json") {
+            fs::remove(entry.path(), ec);
+        }
+    }
+    if (resume) {
+        load_index();
+    }
+
+    if (!open_active(resume)) {
+        throw std::runtime_error("Failed to open " + path_);
+    }
+    if (cfg_.max_segment_bytes > 0 || cfg_.max_segment_age_s > 0.0) {
+        thread_ = std::thread(&SegmentedFile::run_background, this);
+    }
+}
+
+SegmentedFile::~SegmentedFile() {
+    close();
+}
+
+bool SegmentedFile::open_active(bool append) {
+    // A writer that died mid-write leaves a torn last line; it is terminated so our
+    // first line starts on a line of its own
+    bool torn = false;
+    if (append) {
+        if (std::FILE* in = std::fopen(path_.c_str(), "rb")) {
+            torn = std::fseek(in, -1, SEEK_END) == 0 && std::fgetc(in) != '\n';
+            std::fclose(in);
+        }
+    }
+
+    if (aio::backend() != aio::Backend::SYNC) {
+        try {
+            async_ = std::make_unique<aio::File>(path_, append);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    } else {
+        file_ = std::fopen(path_.c_str(), append ? "ab" : "wb");
+        if (!file_) return false;
+        if (!buffered_) {
+            // Callers hand over whole batches, each becomes one write
+            std::setvbuf(file_, nullptr, _IONBF, 0);
+        }
+    }
+    active_ = Segment{};
+    active_opened_ms_ = time::utc_now_ms();
+    if (append) {
+        std::error_code ec;
+        active_.bytes = static_cast<uint64_t>(fs::file_size(path_, ec));
+        // The resumed segment's line count and time range start when it is resumed
+        if (active_.bytes > 0) active_.first_utc_ms = active_.last_utc_ms = active_opened_ms_;
+        if (torn) {
+            if (async_) {
+                async_->append("\n", 1);
+            } else {
+                std::fputc('\n', file_);
+            }
+            active_.bytes += 1;
+        }
+    }
+    return true;
+}
+
+void SegmentedFile::load_index() {
+    std::ifstream f(index_path(dir_, stem_));
+    if (!f.is_open()) return;
+    try {
+        auto index = nlohmann::json::parse(f);
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        for (const auto& s : index.at("segments")) {
+            Segment seg;
+            seg.file = s.at("file").get<std::string>();
+            seg.first_utc_ms = s.at("first_utc_ms").get<uint64_t>();
+            seg.last_utc_ms = s.at("last_utc_ms").get<uint64_t>();
+            seg.lines = s.at("lines").get<uint64_t>();
+            seg.bytes = s.at("bytes").get<uint64_t>();
+            seg.compressed_bytes = s.at("compressed_bytes").get<uint64_t>();
+            closed_bytes_ += seg.compressed_bytes;
+            closed_.push_back(std::move(seg));
+        }
+    } catch (const nlohmann::json::exception&) {
+        // Unreadable index: the closed segments stay on disk but are no longer listed
+        metrics::increment("log.index_errors");
+    }
+}
+
+bool SegmentedFile::write(const char* data, size_t size) {
+    if (!file_ && !async_) return false;
+    if (thread_.joinable() && active_.bytes > 0) {
+        const bool too_big = cfg_.max_segment_bytes > 0 && active_.bytes + size > cfg_.max_segment_bytes;
+        const bool too_old = cfg_.max_segment_age_s > 0.0 &&
+            static_cast<double>(time::utc_now_ms() - active_opened_ms_) >= cfg_.max_segment_age_s * 1000.0;
+        if (too_big || too_old) {
+            rotate();
+            if (!file_ && !async_) return false;
+        }
+    }
+
+    const uint64_t now_ms = time::utc_now_ms();
+    if (active_.bytes == 0) active_.first_utc_ms = now_ms;
+    active_.last_utc_ms = now_ms;
+    active_.lines += static_cast<uint64_t>(std::count(data, data + size, '\n'));
+    active_.bytes += size;
+    if (async_) {
+        async_->append(data, size);
+        return true; // failures surface in drain()
+    }
+    return std::fwrite(data, 1, size, file_) == size;
+}
+
+bool SegmentedFile::flush() {
+    if (async_) return true;
+    return file_ && std::fflush(file_) == 0;
+}
+
+bool SegmentedFile::drain() {
+    if (async_) return async_->drain();
+    return flush();
+}
+
+bool SegmentedFile::sync() {
+    if (async_) {
+        async_->request_sync();
+        return async_->drain();
+    }
+    if (!file_) return false;
+#if defined(_WIN32)
+    return _commit(_fileno(file_)) == 0;
+#else
+    return fdatasync(fileno(file_)) == 0;
+#endif
+}
+
+void SegmentedFile::rotate() {
+    if (async_) {
+        // The segment is complete before it is renamed and handed to compression. This
+        // waits, on the writing thread, for the writes still queued on the segment.
+        async_.reset();
+    } else {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    char seq[16];
+    std::snprintf(seq, sizeof(seq), "%06" PRIu64, next_seq_++);
+    Segment seg = active_;
+    seg.file = stem_ + "." + seq + ext_;
+
+    std::error_code ec;
+    fs::rename(path_, fs::path(dir_) / seg.file, ec);
+    if (ec) {
+        // The segment is still under the active name: keep appending to it rather than
+        // truncating it, and try again at the next rotation
+        --next_seq_;
+        metrics::increment("log.rotation_errors");
+        open_active(true);
+        active_.first_utc_ms = seg.first_utc_ms;
+        active_.lines = seg.lines;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        jobs_.push_back(std::move(seg));
+    }
+    jobs_cv_.notify_one();
+    metrics::increment("log.rotations");
+
+    open_active();
+}
+
+void SegmentedFile::close() {
+    async_.reset();
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        closing_ = true;
+    }
+    jobs_cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void SegmentedFile::run_background() {
+    lower_thread_priority();
+    std::unique_lock<std::mutex> lock(jobs_mutex_);
+    while (true) {
+        jobs_cv_.wait(lock, [this] { return !jobs_.empty() || closing_; });
+        if (jobs_.empty()) break;
+        Segment seg = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+        finish_segment(std::move(seg));
+        lock.lock();
+    }
+}
+
+void SegmentedFile::finish_segment(Segment seg) {
+    const std::string plain = (fs::path(dir_) / seg.file).string();
+    std::error_code ec;
+    seg.compressed_bytes = seg.bytes;
+    if (cfg_.compress) {
+        uint64_t start_ns = time::monotonic_ns();
+        if (uint64_t gz_bytes = gzip_file(plain, plain + ".gz")) {
+            fs::remove(plain, ec);
+            seg.file += ".gz";
+            seg.compressed_bytes = gz_bytes;
+            metrics::add("log.compressed_bytes_in", seg.bytes);
+            metrics::add("log.compressed_bytes_out", gz_bytes);
+            metrics::add("log.compression_ns", time::monotonic_ns() - start_ns);
+        } else {
+            metrics::increment("log.compression_errors");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    closed_bytes_ += seg.compressed_bytes;
+    closed_.push_back(std::move(seg));
+
+    // Retention: drop the oldest closed segments beyond either limit
+    while (!closed_.empty() &&
+           ((cfg_.max_segments > 0 && closed_.size() > static_cast<size_t>(cfg_.max_segments)) ||
+            (cfg_.max_total_bytes > 0 && closed_bytes_ > cfg_.max_total_bytes))) {
+        fs::remove(fs::path(dir_) / closed_.front().file, ec);
+        closed_bytes_ -= closed_.front().compressed_bytes;
+        closed_.pop_front();
+        metrics::increment("log.segments_deleted");
+    }
+    write_index();
+}
+
+void SegmentedFile::write_index() {
+    nlohmann::json segs = nlohmann::json::array();
+    for (const auto& s : closed_) {
+        segs.push_back({
+            {"file", s.file},
+            {"first_utc_ms", s.first_utc_ms},
+            {"last_utc_ms", s.last_utc_ms},
+            {"lines", s.lines},
+            {"bytes", s.bytes},
+            {"compressed_bytes", s.compressed_bytes}
+        });
+    }
+    nlohmann::json index = {{"active", fs::path(path_).filename().string()}, {"segments", std::move(segs)}};
+
+    const std::string target = index_path(dir_, stem_);
+    const std::string tmp = target + ".tmp";
+    {
+        std::ofstream f(tmp);
+        f << index.dump(2) << "\n";
+    }
+    std::error_code ec;
+    fs::rename(tmp, target, ec);
+}
+
+std::vector<std::string> SegmentedFile::find(const std::string& path, uint64_t from_utc_ms, uint64_t to_utc_ms) {
+    fs::path p(path);
+    const std::string dir = p.has_parent_path() ? p.parent_path().string() : ".";
+    std::vector<std::string> out;
+
+    std::ifstream f(index_path(dir, p.stem().string()));
+    if (f.is_open()) {
+        try {
+            auto index = nlohmann::json::parse(f);
+            for (const auto& s : index.at("segments")) {
+                if (s.at("last_utc_ms").get<uint64_t>() >= from_utc_ms &&
+                    s.at("first_utc_ms").get<uint64_t>() <= to_utc_ms) {
+                    out.push_back((fs::path(dir) / s.at("file").get<std::string>()).string());
+                }
+            }
+        } catch (const nlohmann::json::exception&) {
+            // A missing or unreadable index means no closed segments are known
+        }
+    }
+    std::error_code ec;
+    if (fs::exists(p, ec)) {
+        out.push_back(path);
+    }
+    return out;
+}
+
+} // namespace segments
+} // namespace surveillance
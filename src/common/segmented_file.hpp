@@ -0,0 +1,115 @@
+#pragma once
+
+#include "async_file.hpp"
+#include "config.hpp"
+#include <nlohmann/json.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace surveillance {
+namespace segments {
+
+// Append-only line file with size/age rotation and bounded retention.
+//
+// The active segment always has the base name (e.g. run_logs/alerts.jsonl), so
+// readers that tail it keep working. On rotation it is renamed to
+// <stem>.<seq>.jsonl and handed to a low-priority background thread that gzips
+// it, records it in <stem>.index.json and deletes the oldest closed segments
+// beyond the retention limits. The writing thread only pays for the rename.
+//
+// Unless the aio backend is sync, writes go through an aio::File: write() only queues
+// the bytes, and the engine writes them off the caller's thread.
+//
+// <stem>.index.json lists the closed segments oldest first:
+//   { "active": "alerts.jsonl",
+//     "segments": [ { "file": "alerts.000001.jsonl.gz", "first_utc_ms": ..., "last_utc_ms": ...,
+//                     "lines": ..., "bytes": ..., "compressed_bytes": ... }, ... ] }
+// where the time range is the wall-clock time of the first and last write.
+//
+// Not thread-safe: one writer at a time (callers already serialize).
+class SegmentedFile {
+public:
+    // Truncates `path` and removes the segments and index of a previous run. With the
+    // sync aio backend, unbuffered files turn every write() into one system call and
+    // buffered ones need flush(); otherwise `buffered` makes no difference.
+    // With `resume` the previous writer's file is continued instead: the active segment
+    // is appended to (after completing a torn last line) and the index is kept.
+    SegmentedFile(const std::string& path, const config::RotationConfig& cfg, bool buffered = false,
+                  bool resume = false);
+    ~SegmentedFile();
+
+    SegmentedFile(const SegmentedFile&) = delete;
+    SegmentedFile& operator=(const SegmentedFile&) = delete;
+
+    // `data` must hold whole lines; a write never straddles two segments
+    bool write(const char* data, size_t size);
+    // Hands buffered bytes to the OS; queued asynchronous writes are already on their way
+    bool flush();
+    // Waits until everything written so far has reached the OS. False on a failed write.
+    bool drain();
+    // drain() plus fdatasync of the active segment
+    bool sync();
+
+    // Closes the active segment and waits for pending compression
+    void close();
+
+    const std::string& path() const { return path_; }
+
+    // Closed segments of `path` overlapping [from_utc_ms, to_utc_ms], oldest first, as
+    // paths next to `path`, followed by `path` itself if it exists. Reads the index only.
+    static std::vector<std::string> find(const std::string& path, uint64_t from_utc_ms, uint64_t to_utc_ms);
+
+private:
+    struct Segment {
+        std::string file;
+        uint64_t first_utc_ms{0};
+        uint64_t last_utc_ms{0};
+        uint64_t lines{0};
+        uint64_t bytes{0};
+        uint64_t compressed_bytes{0};
+    };
+
+    bool open_active(bool append = false);
+    void load_index();
+    void rotate();
+    void run_background();
+    void finish_segment(Segment seg); // background thread
+    void write_index();                // background thread, under index_mutex_
+
+    std::string path_;
+    std::string dir_;
+    std::string stem_;
+    std::string ext_;
+    config::RotationConfig cfg_;
+    bool buffered_;
+
+    std::FILE* file_{nullptr};             // sync aio backend
+    std::unique_ptr<aio::File> async_;     // any other
+    Segment active_;
+    uint64_t active_opened_ms_{0};
+    uint64_t next_seq_{1};
+
+    // Background compression and retention
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<Segment> jobs_;
+    bool closing_{false};
+    std::thread thread_;
+
+    std::mutex index_mutex_;
+    std::deque<Segment> closed_;
+    uint64_t closed_bytes_{0};
+};
+
+// Gzips `src` into `dst` (written to dst + ".tmp" and renamed). Returns the compressed size, 0 on failure.
+uint64_t gzip_file(const std::string& src, const std::string& dst);
+
+} // namespace segments
+} // namespace surveillance
@@ -0,0 +1,97 @@
+#include "shard_ring.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace surveillance {
+namespace shard {
+
+namespace {
+
+constexpr std::string_view kTopicPrefix = "central/";
+
+// FNV-1a followed by a 64-bit finalizer: node_ids differ only in their last digits,
+// which plain FNV-1a leaves clustered on the ring
+uint64_t hash(std::string_view s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+Ring::Ring(int virtual_nodes) : virtual_nodes_(std::max(1, virtual_nodes)) {}
+
+bool Ring::add(int shard) {
+    auto it = std::lower_bound(members_.begin(), members_.end(), shard);
+    if (it != members_.end() && *it == shard) return false;
+    members_.insert(it, shard);
+    rebuild();
+    return true;
+}
+
+bool Ring::remove(int shard) {
+    auto it = std::lower_bound(members_.begin(), members_.end(), shard);
+    if (it == members_.end() || *it != shard) return false;
+    members_.erase(it);
+    rebuild();
+    return true;
+}
+
+bool Ring::contains(int shard) const {
+    return std::binary_search(members_.begin(), members_.end(), shard);
+}
+
+std::optional<int> Ring::owner(std::string_view node_id) const {
+    if (points_.empty()) return std::nullopt;
+    uint64_t h = hash(node_id);
+    auto it = std::lower_bound(points_.begin(), points_.end(), std::make_pair(h, INT32_MIN));
+    if (it == points_.end()) it = points_.begin(); // wrap around
+    return it->second;
+}
+
+void Ring::rebuild() {
+    // Points depend only on (shard, replica), so every process builds the same ring
+    // from the same members
+    points_.clear();
+    points_.reserve(members_.size() * static_cast<size_t>(virtual_nodes_));
+    for (int shard : members_) {
+        for (int v = 0; v < virtual_nodes_; ++v) {
+            points_.emplace_back(hash(topic(shard) + std::to_string(v)), shard);
+        }
+    }
+    std::sort(points_.begin(), points_.end());
+}
+
+std::string topic(int shard) {
+    return std::string(kTopicPrefix) + std::to_string(shard) + "/";
+}
+
+std::optional<int> parse_topic(std::string_view topic) {
+    if (topic.size() <= kTopicPrefix.size() + 1 || topic.substr(0, kTopicPrefix.size()) != kTopicPrefix ||
+        topic.back() != '/') {
+        return std::nullopt;
+    }
+    std::string_view digits = topic.substr(kTopicPrefix.size(), topic.size() - kTopicPrefix.size() - 1);
+    int shard = 0;
+    auto res = std::from_chars(digits.data(), digits.data() + digits.size(), shard);
+    if (res.ec != std::errc() || res.ptr != digits.data() + digits.size() || shard < 0) {
+        return std::nullopt;
+    }
+    return shard;
+}
+
+std::string suffix(int shard) {
+    return shard < 0 ? std::string() : "_" + std::to_string(shard);
+}
+
+} // namespace shard
+} // namespace surveillance
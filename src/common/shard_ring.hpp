@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace surveillance {
+namespace shard {
+
+// Consistent-hash assignment of sensor node_ids to central shards.
+//
+// Each shard owns `virtual_nodes` points on a 64-bit ring and a node_id belongs to
+// the first point at or after its hash. Adding or removing a shard only moves the
+// node_ids in the ranges next to that shard's points, about 1/K of the fleet; all
+// other nodes keep their owner and with it their stream codec and node state.
+class Ring {
+public:
+    explicit Ring(int virtual_nodes = 64);
+
+    // Both return false if nothing changed
+    bool add(int shard);
+    bool remove(int shard);
+
+    bool contains(int shard) const;
+    bool empty() const { return points_.empty(); }
+    const std::vector<int>& members() const { return members_; }
+
+    // Owning shard, or nullopt when the ring is empty
+    std::optional<int> owner(std::string_view node_id) const;
+
+private:
+    void rebuild();
+
+    int virtual_nodes_;
+    std::vector<int> members_;                    // sorted
+    std::vector<std::pair<uint64_t, int>> points_; // sorted by hash
+};
+
+// PUB/SUB topic of a shard on the emulator -> central link. Shard topics never
+// prefix one another ("central/1/" vs "central/10/").
+std::string topic(int shard);
+
+// Shard id of a topic, or nullopt if it is not a shard topic
+std::optional<int> parse_topic(std::string_view topic);
+
+// "" for an unsharded central (shard < 0), "_<k>" otherwise. Appended to the
+// component name and to the names of the files a shard writes (alerts_<k>.jsonl, ...).
+std::string suffix(int shard);
+
+} // namespace shard
+} // namespace surveillance
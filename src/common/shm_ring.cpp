@@ -0,0 +1,519 @@
+#include "shm_ring.hpp"
+#include "logging.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace surveillance {
+namespace shm {
+
+namespace {
+constexpr std::string_view kScheme = "shm://";
+}
+
+bool is_shm_endpoint(const std::string& endpoint) {
+    return endpoint.compare(0, kScheme.size(), kScheme) == 0;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr uint32_t kMagic = 0x53524E47; // "SRNG"
+constexpr uint32_t kVersion = 2;
+constexpr int kMaxProducers = 256;
+constexpr size_t kFrameHeaderBytes = 8;
+constexpr size_t kDataOffset = 16384; // header pages; keeps the data page-aligned
+constexpr size_t kMinCapacity = 1 << 16;
+
+// Frame header: payload length in the high word, flags in the low word. Zero means
+// nothing has been written there yet.
+constexpr uint64_t kClaimed = 1;
+constexpr uint64_t kCommitted = 2;
+constexpr uint64_t kPadding = 4;
+
+// An uncommitted head frame older than this is checked for a dead producer
+constexpr uint64_t kAbandonCheckNs = 50'000'000;
+constexpr uint64_t kSweepIntervalNs = 1'000'000'000;
+constexpr uint64_t kReattachIntervalNs = 100'000'000;
+constexpr uint64_t kSpinNs = 20'000;
+constexpr uint32_t kOccupancySampleEvery = 64;
+
+} // namespace
+
+struct Slot {
+    std::atomic<int32_t> pid;
+    std::atomic<uint64_t> start_time;  // of pid, see start_time(); 0 while unknown
+    std::atomic<uint32_t> claim_bytes; // 0 when not in the middle of a send; see kMaxRingBytes
+    std::atomic<uint64_t> claim_pos;
+};
+
+struct alignas(64) RingHeader {
+    std::atomic<uint32_t> magic;     // stored last by the consumer
+    uint32_t version;
+    uint64_t capacity;
+    std::atomic<int32_t> consumer_pid;
+    std::atomic<uint64_t> consumer_start_time;
+    std::atomic<uint32_t> closed;    // set by the consumer's destructor or replacement
+    alignas(64) std::atomic<uint64_t> reserve; // producers: end of the claimed bytes
+    alignas(64) std::atomic<uint64_t> head;    // consumer: start of the unread bytes
+    std::atomic<uint64_t> high_watermark;
+    alignas(64) std::atomic<uint32_t> wake_seq; // futex word
+    std::atomic<uint32_t> consumer_sleeping;
+    alignas(64) Slot slots[kMaxProducers];
+};
+
+static_assert(sizeof(RingHeader) <= kDataOffset);
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be address-free");
+
+namespace {
+
+std::string segment_name(const std::string& endpoint) {
+    return "/" + endpoint.substr(kScheme.size());
+}
+
+uint64_t round_up_pow2(uint64_t v) {
+    uint64_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+uint64_t frame_bytes(uint64_t payload) {
+    return (kFrameHeaderBytes + payload + 7) & ~uint64_t{7};
+}
+
+std::atomic_ref<uint64_t> frame_header(char* data, uint64_t index) {
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(data + index));
+}
+
+// Start time of a process in clock ticks since boot (/proc/<pid>/stat field 22), or 0
+// if it cannot be read. Together with the pid it names one process: a pid can be
+// reused, the pair cannot.
+uint64_t start_time(int32_t pid) {
+    std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    if (!std::getline(in, stat)) return 0;
+    // Field 2 is the command in parentheses and may contain spaces; count from its end
+    const size_t close = stat.rfind(')');
+    if (close == std::string::npos) return 0;
+    size_t pos = close + 1;
+    for (int field = 3; field < 22 && pos != std::string::npos; ++field) {
+        pos = stat.find(' ', pos + 1);
+    }
+    if (pos == std::string::npos) return 0;
+    return std::strtoull(stat.c_str() + pos + 1, nullptr, 10);
+}
+
+// `started` == 0 falls back to the pid alone
+bool alive(int32_t pid, uint64_t started) {
+    if (pid <= 0 || (::kill(pid, 0) != 0 && errno != EPERM)) return false;
+    if (started == 0) return true;
+    const uint64_t now = start_time(pid);
+    return now == 0 || now == started;
+}
+
+// A slot's start time is cleared before its pid, so whoever claims the slot next
+// never shows its pid with the previous owner's start time
+void free_slot(Slot& slot) {
+    slot.start_time.store(0, std::memory_order_relaxed);
+    slot.pid.store(0, std::memory_order_release);
+}
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::microseconds timeout) {
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+    ts.tv_nsec = static_cast<long>((timeout.count() % 1000000) * 1000);
+    // Not FUTEX_PRIVATE: the word is shared between processes
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>& word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+// Marks a segment left by an earlier consumer closed, so its producers reattach
+void close_stale(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return;
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(RingHeader)) {
+        void* p = ::mmap(nullptr, sizeof(RingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            static_cast<RingHeader*>(p)->closed.store(1, std::memory_order_release);
+            ::munmap(p, sizeof(RingHeader));
+        }
+    }
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+}
+
+} // namespace
+
+RingConsumer::RingConsumer(const std::string& endpoint, size_t capacity_bytes, const std::string& link_name)
+    : name_(segment_name(endpoint)),
+      link_(link_name),
+      occupancy_(&metrics::histogram("shm." + link_name + ".occupancy_bytes"))
+{
+    if (capacity_bytes > kMaxRingBytes) {
+        throw std::runtime_error("shm ring " + name_ + ": capacity above " + std::to_string(kMaxRingBytes) + " bytes");
+    }
+    const uint64_t capacity = round_up_pow2(std::max<uint64_t>(capacity_bytes, kMinCapacity));
+    close_stale(name_);
+
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open " + name_ + ": " + std::strerror(errno));
+    }
+    map_bytes_ = kDataOffset + capacity;
+    if (::ftruncate(fd, static_cast<off_t>(map_bytes_)) != 0) {
+        int err = errno;
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("ftruncate " + name_ + ": " + std::strerror(err));
+    }
+    void* p = ::mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("mmap " + name_ + ": " + std::strerror(errno));
+    }
+
+    // ftruncate zero-fills, which is the empty state of every field and frame header
+    header_ = static_cast<RingHeader*>(p);
+    data_ = static_cast<char*>(p) + kDataOffset;
+    mask_ = capacity - 1;
+    header_->version = kVersion;
+    header_->capacity = capacity;
+    header_->consumer_pid.store(::getpid(), std::memory_order_relaxed);
+    header_->consumer_start_time.store(start_time(::getpid()), std::memory_order_relaxed);
+    header_->magic.store(kMagic, std::memory_order_release);
+}
+
+RingConsumer::~RingConsumer() {
+    if (!header_) return;
+    header_->closed.store(1, std::memory_order_release);
+    ::munmap(header_, map_bytes_);
+    ::shm_unlink(name_.c_str());
+}
+
+std::optional<std::string_view> RingConsumer::peek() {
+    while (head_ != header_->reserve.load(std::memory_order_acquire)) {
+        const uint64_t index = head_ & mask_;
+        const uint64_t h = frame_header(data_, index).load(std::memory_order_acquire);
+        if (h & kCommitted) {
+            stuck_since_ns_ = 0;
+            if (h & kPadding) {
+                release(mask_ + 1 - index);
+                continue;
+            }
+            const uint64_t payload = h >> 32;
+            current_bytes_ = frame_bytes(payload);
+            return std::string_view(data_ + index + kFrameHeaderBytes, payload);
+        }
+
+        // Claimed but not committed yet: normally a producer mid-copy
+        const uint64_t now_ns = time::monotonic_ns();
+        if (stuck_since_ns_ == 0) {
+            stuck_since_ns_ = now_ns;
+        } else if (now_ns - stuck_since_ns_ > kAbandonCheckNs && recover_abandoned()) {
+            stuck_since_ns_ = 0;
+            continue;
+        }
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+void RingConsumer::pop() {
+    release(current_bytes_);
+    current_bytes_ = 0;
+    if (++pops_ % kOccupancySampleEvery == 0) {
+        const uint64_t used = header_->reserve.load(std::memory_order_relaxed) - head_;
+        occupancy_->record(used);
+        if (used > header_->high_watermark.load(std::memory_order_relaxed)) {
+            header_->high_watermark.store(used, std::memory_order_relaxed);
+        }
+    }
+}
+
+void RingConsumer::release(uint64_t len) {
+    // Producers rely on zeroed headers, wherever the next frame starts
+    zero(head_, len);
+    head_ += len;
+    header_->head.store(head_, std::memory_order_release);
+}
+
+void RingConsumer::zero(uint64_t pos, uint64_t len) {
+    const uint64_t index = pos & mask_;
+    const uint64_t first = std::min(len, mask_ + 1 - index);
+    std::memset(data_ + index, 0, first);
+    if (first < len) {
+        std::memset(data_, 0, len - first);
+    }
+}
+
+bool RingConsumer::recover_abandoned() {
+    // A producer that died between announcing a claim and losing the CAS for it also
+    // covers the head, so any live producer covering it wins: that one is just slow
+    Slot* dead = nullptr;
+    for (int i = 0; i < kMaxProducers; ++i) {
+        Slot& slot = header_->slots[i];
+        const int32_t pid = slot.pid.load(std::memory_order_acquire);
+        const uint64_t started = slot.start_time.load(std::memory_order_acquire);
+        const uint64_t bytes = slot.claim_bytes.load(std::memory_order_acquire);
+        const uint64_t pos = slot.claim_pos.load(std::memory_order_acquire);
+        if (pid == 0 || bytes == 0 || head_ < pos || head_ >= pos + bytes) continue;
+        if (alive(pid, started)) return false;
+        if (!dead) dead = &slot;
+    }
+    if (!dead) return false;
+
+    const int32_t pid = dead->pid.load(std::memory_order_relaxed);
+    const uint64_t end = dead->claim_pos.load(std::memory_order_relaxed) + dead->claim_bytes.load(std::memory_order_relaxed);
+    zero(head_, end - head_);
+    head_ = end;
+    header_->head.store(head_, std::memory_order_release);
+    dead->claim_bytes.store(0, std::memory_order_relaxed);
+    free_slot(*dead);
+    metrics::increment("shm." + link_ + ".abandoned_frames");
+    metrics::increment("shm." + link_ + ".producer_crashes");
+    logging::warn("Skipped a frame abandoned by a crashed producer", {{"link", link_}, {"pid", pid}});
+    return true;
+}
+
+void RingConsumer::sweep_producers() {
+    // Slots of producers that died between sends; those mid-send are left to
+    // recover_abandoned() when the consumer reaches their claim
+    for (int i = 0; i < kMaxProducers; ++i) {
+        Slot& slot = header_->slots[i];
+        const int32_t pid = slot.pid.load(std::memory_order_acquire);
+        if (pid == 0 || alive(pid, slot.start_time.load(std::memory_order_acquire))) continue;
+        const uint64_t bytes = slot.claim_bytes.load(std::memory_order_acquire);
+        const uint64_t pos = slot.claim_pos.load(std::memory_order_acquire);
+        if (bytes != 0 && pos + bytes > head_) continue;
+        free_slot(slot);
+        metrics::increment("shm." + link_ + ".producer_crashes");
+        logging::warn("Freed the ring slot of a crashed producer", {{"link", link_}, {"pid", pid}});
+    }
+}
+
+void RingConsumer::wait(std::chrono::microseconds timeout) {
+    const uint64_t start_ns = time::monotonic_ns();
+    auto ready = [this] { return header_->reserve.load(std::memory_order_acquire) != head_; };
+    while (time::monotonic_ns() - start_ns < kSpinNs) {
+        if (ready()) return;
+    }
+
+    const uint32_t seq = header_->wake_seq.load(std::memory_order_acquire);
+    header_->consumer_sleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!ready()) {
+        futex_wait(header_->wake_seq, seq, timeout);
+    }
+    header_->consumer_sleeping.store(0, std::memory_order_relaxed);
+
+    const uint64_t now_ns = time::monotonic_ns();
+    if (now_ns >= next_sweep_ns_) {
+        next_sweep_ns_ = now_ns + kSweepIntervalNs;
+        sweep_producers();
+    }
+}
+
+RingStats RingConsumer::stats() const {
+    RingStats s;
+    s.capacity_bytes = mask_ + 1;
+    // head first: it never passes reserve, so this cannot underflow from another thread
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    s.used_bytes = header_->reserve.load(std::memory_order_acquire) - head;
+    s.high_watermark_bytes = header_->high_watermark.load(std::memory_order_relaxed);
+    for (const auto& slot : header_->slots) {
+        if (slot.pid.load(std::memory_order_relaxed) != 0) ++s.producers;
+    }
+    return s;
+}
+
+RingProducer::RingProducer(const std::string& endpoint, const std::string& link_name)
+    : name_(segment_name(endpoint)),
+      link_(link_name)
+{
+}
+
+RingProducer::~RingProducer() {
+    detach();
+}
+
+bool RingProducer::attach() {
+    int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    void* p = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > kDataOffset) {
+        p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    auto* header = static_cast<RingHeader*>(p);
+    const size_t bytes = static_cast<size_t>(st.st_size);
+    if (header->magic.load(std::memory_order_acquire) != kMagic || header->version != kVersion ||
+        header->capacity + kDataOffset != bytes || header->closed.load(std::memory_order_acquire) ||
+        !alive(header->consumer_pid.load(std::memory_order_relaxed),
+               header->consumer_start_time.load(std::memory_order_relaxed))) {
+        ::munmap(p, bytes);
+        return false;
+    }
+
+    const int32_t pid = ::getpid();
+    const uint64_t started = start_time(pid);
+    for (int i = 0; i < kMaxProducers; ++i) {
+        int32_t expected = 0;
+        if (header->slots[i].pid.compare_exchange_strong(expected, pid, std::memory_order_acq_rel)) {
+            header->slots[i].claim_bytes.store(0, std::memory_order_relaxed);
+            header->slots[i].start_time.store(started, std::memory_order_release);
+            header_ = header;
+            data_ = static_cast<char*>(p) + kDataOffset;
+            map_bytes_ = bytes;
+            mask_ = header->capacity - 1;
+            slot_ = i;
+            return true;
+        }
+    }
+    ::munmap(p, bytes);
+    SURV_LOG_RATE(logging::Level::error, 1, "Shared-memory ring has no free producer slot", {{"link", link_}});
+    return false;
+}
+
+void RingProducer::detach() {
+    if (!header_) return;
+    free_slot(header_->slots[slot_]);
+    ::munmap(header_, map_bytes_);
+    header_ = nullptr;
+    data_ = nullptr;
+    slot_ = -1;
+}
+
+bool RingProducer::wait_for_consumer(std::chrono::milliseconds timeout, const std::atomic<bool>& running) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (running && std::chrono::steady_clock::now() < deadline) {
+        if (header_ && !header_->closed.load(std::memory_order_acquire)) return true;
+        detach();
+        if (attach()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+bool RingProducer::send(std::string_view frame) {
+    if (!header_ || header_->closed.load(std::memory_order_relaxed)) {
+        // The consumer went away; look for its replacement now and then
+        const uint64_t now_ns = time::monotonic_ns();
+        bool attached = false;
+        if (now_ns >= next_attach_ns_) {
+            next_attach_ns_ = now_ns + kReattachIntervalNs;
+            detach();
+            attached = attach();
+            if (attached) metrics::increment("shm." + link_ + ".reattaches");
+        }
+        if (!attached) {
+            metrics::increment("shm." + link_ + ".unattached_drops");
+            return false;
+        }
+    }
+
+    const uint64_t capacity = mask_ + 1;
+    const uint64_t bytes = frame_bytes(frame.size());
+    if (bytes > capacity / 4) {
+        metrics::increment("shm." + link_ + ".full_drops");
+        SURV_LOG_RATE(logging::Level::warn, 1, "Frame too large for the shared-memory ring",
+                      {{"link", link_}, {"bytes", frame.size()}});
+        return false;
+    }
+
+    Slot& slot = header_->slots[slot_];
+    uint64_t pos = header_->reserve.load(std::memory_order_relaxed);
+    uint64_t pad = 0;
+    while (true) {
+        const uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (head > pos) {
+            // Our view of reserve is older than the consumer's progress
+            pos = header_->reserve.load(std::memory_order_relaxed);
+            continue;
+        }
+        const uint64_t index = pos & mask_;
+        pad = capacity - index < bytes ? capacity - index : 0;
+        if (pos + pad + bytes - head > capacity) {
+            metrics::increment("shm." + link_ + ".full_drops");
+            return false;
+        }
+        // Announce the claim before making it, so a crash right after the CAS is recoverable
+        slot.claim_bytes.store(static_cast<uint32_t>(pad + bytes), std::memory_order_relaxed);
+        slot.claim_pos.store(pos, std::memory_order_release);
+        if (header_->reserve.compare_exchange_weak(pos, pos + pad + bytes, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+
+    if (pad) {
+        frame_header(data_, pos & mask_).store(kClaimed | kCommitted | kPadding, std::memory_order_release);
+        pos += pad;
+    }
+    const uint64_t index = pos & mask_;
+    auto header = frame_header(data_, index);
+    const uint64_t len = static_cast<uint64_t>(frame.size()) << 32;
+    header.store(len | kClaimed, std::memory_order_relaxed);
+    std::memcpy(data_ + index + kFrameHeaderBytes, frame.data(), frame.size());
+    header.store(len | kClaimed | kCommitted, std::memory_order_release);
+    slot.claim_bytes.store(0, std::memory_order_release);
+
+    // Pairs with the fence in RingConsumer::wait(): either it sees the frame or we see it asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->consumer_sleeping.load(std::memory_order_relaxed)) {
+        header_->wake_seq.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->wake_seq);
+    }
+    return true;
+}
+
+#else // !__linux__
+
+struct RingHeader {};
+
+RingConsumer::RingConsumer(const std::string&, size_t, const std::string& link_name)
+    : link_(link_name), occupancy_(nullptr) {
+    throw std::runtime_error("shm:// endpoints need Linux");
+}
+RingConsumer::~RingConsumer() = default;
+std::optional<std::string_view> RingConsumer::peek() { return std::nullopt; }
+void RingConsumer::pop() {}
+void RingConsumer::wait(std::chrono::microseconds) {}
+RingStats RingConsumer::stats() const { return {}; }
+
+RingProducer::RingProducer(const std::string&, const std::string& link_name) : link_(link_name) {
+    throw std::runtime_error("shm:// endpoints need Linux");
+}
+RingProducer::~RingProducer() = default;
+bool RingProducer::send(std::string_view) { return false; }
+bool RingProducer::wait_for_consumer(std::chrono::milliseconds, const std::atomic<bool>&) { return false; }
+
+#endif
+
+} // namespace shm
+} // namespace surveillance
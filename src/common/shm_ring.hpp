@@ -0,0 +1,121 @@
+#pragma once
+
+#include "histogram.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace surveillance {
+namespace shm {
+
+// Multi-producer/single-consumer ring of variable-length frames in POSIX shared
+// memory, for the two data links when every component runs on one host
+// (`shm://<name>` endpoints, see transport). Linux only: wakeups are futexes.
+//
+// Producers claim space with a CAS on a shared reserve counter, copy the frame and
+// commit it by publishing its header; the consumer reads committed frames in claim
+// order and zeroes them on release. A frame that does not fit before the end of the
+// buffer is preceded by a padding frame, so every frame is contiguous.
+//
+// Each producer holds a slot naming its pid and start time and the claim it is working
+// on. A claim that stays uncommitted while its producer is gone (no such pid, or the
+// pid now belongs to a process started later) is a producer crash: the
+// consumer skips it and frees the slot. The consumer owns the segment; a new consumer
+// closes the old one, and producers reattach to its replacement.
+//
+// A full ring drops the frame, like a ZeroMQ PUB at its high-water mark.
+
+bool is_shm_endpoint(const std::string& endpoint);
+
+// Largest ring: a claim (frame plus wrap padding) is recorded in 32 bits
+constexpr uint64_t kMaxRingBytes = uint64_t(1) << 30;
+
+struct RingHeader; // shared layout, see shm_ring.cpp
+
+struct RingStats {
+    uint64_t capacity_bytes{0};
+    uint64_t used_bytes{0};
+    uint64_t high_watermark_bytes{0};
+    uint32_t producers{0};
+};
+
+// One thread, apart from stats().
+class RingConsumer {
+public:
+    // Creates the segment, replacing any left by a previous consumer. `capacity_bytes`
+    // is rounded up to a power of two. Throws std::runtime_error when it exceeds
+    // kMaxRingBytes or the segment cannot be created.
+    RingConsumer(const std::string& endpoint, size_t capacity_bytes, const std::string& link_name);
+    ~RingConsumer(); // closes and unlinks the segment
+
+    RingConsumer(const RingConsumer&) = delete;
+    RingConsumer& operator=(const RingConsumer&) = delete;
+
+    // Next committed frame, valid until pop()
+    std::optional<std::string_view> peek();
+    void pop();
+
+    // Returns once a frame may be ready or `timeout` has passed. Spins for a few
+    // microseconds before sleeping on the futex.
+    void wait(std::chrono::microseconds timeout);
+
+    RingStats stats() const; // any thread
+
+private:
+    bool recover_abandoned();
+    void sweep_producers();
+    void zero(uint64_t pos, uint64_t len);
+    void release(uint64_t len);
+
+    std::string name_;
+    std::string link_;
+    RingHeader* header_{nullptr};
+    char* data_{nullptr};
+    size_t map_bytes_{0};
+    uint64_t mask_{0};
+    uint64_t head_{0};            // local copy; the consumer is the only writer
+    uint64_t current_bytes_{0};   // size of the frame handed out by peek()
+    uint64_t stuck_since_ns_{0};  // first time the head frame was seen uncommitted
+    uint64_t next_sweep_ns_{0};
+    uint32_t pops_{0};
+    metrics::Histogram* occupancy_;
+};
+
+// One thread per producer; any number of producers across processes.
+class RingProducer {
+public:
+    // Attaches lazily: the segment need not exist yet
+    RingProducer(const std::string& endpoint, const std::string& link_name);
+    ~RingProducer(); // frees the slot
+
+    RingProducer(const RingProducer&) = delete;
+    RingProducer& operator=(const RingProducer&) = delete;
+
+    // Copies `frame` into the ring. False, counted in shm.<link>.full_drops or
+    // shm.<link>.unattached_drops, when there is no room or no consumer.
+    bool send(std::string_view frame);
+
+    // Blocks until a live consumer's segment is attached. Returns false on timeout or
+    // when `running` turns false.
+    bool wait_for_consumer(std::chrono::milliseconds timeout, const std::atomic<bool>& running);
+
+private:
+    bool attach();
+    void detach();
+
+    std::string name_;
+    std::string link_;
+    RingHeader* header_{nullptr};
+    char* data_{nullptr};
+    size_t map_bytes_{0};
+    uint64_t mask_{0};
+    int slot_{-1};
+    uint64_t next_attach_ns_{0};
+};
+
+} // namespace shm
+} // namespace surveillance
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace surveillance {
+namespace spsc {
+
+// Fixed rather than std::hardware_destructive_interference_size, which is not ABI-stable
+inline constexpr size_t kCacheLine = 64;
+
+// Bounded lock-free single-producer/single-consumer ring.
+// Exactly one thread may call try_push and exactly one thread may call try_pop.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class Ring {
+public:
+    explicit Ring(size_t capacity)
+        : mask_(round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+          slots_(mask_ + 1) {}
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    bool try_push(T&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return std::nullopt;
+            }
+        }
+        std::optional<T> value{std::move(slots_[head & mask_])};
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Approximate; exact only when called from the producer or consumer thread with the other idle.
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static size_t round_up_pow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::vector<T> slots_;
+
+    // Producer-owned line: tail plus its cached view of head
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t head_cache_{0};
+
+    // Consumer-owned line: head plus its cached view of tail
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t tail_cache_{0};
+};
+
+} // namespace spsc
+} // namespace surveillance
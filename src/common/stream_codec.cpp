@@ -0,0 +1,896 @@
+#include "stream_codec.hpp"
+#include "metrics.hpp"
+#include "time.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace surveillance {
+namespace codec {
+
+namespace {
+
+constexpr uint8_t kMagic = 0xC6; // never '{', so JSON frames are unambiguous; 0xC5 was the 32-bit stream hash layout
+constexpr uint8_t kFlagKeyframe = 0x01;
+constexpr uint8_t kEnumLiteral = 0xFF;
+constexpr uint64_t kRatioSampleEvery = 16;  // messages also serialized as JSON for the ratio
+constexpr uint64_t kFlushEvery = 256;
+constexpr size_t kMaxStamps = 16;
+constexpr uint8_t kDisturbanceEventSchema = 1;
+constexpr uint8_t kNodeStatusSchema = 2;
+
+} // namespace
+
+using Kind = icd::Encoding;
+
+struct Field {
+    std::string name;
+    Kind kind;
+    bool optional;
+    std::span<const std::string_view> values; // ENUM only
+};
+
+struct Schema {
+    uint8_t id;
+    std::string msg_type;
+    std::vector<Field> fields;
+    bool has_optional;
+};
+
+namespace {
+
+Schema make_schema(uint8_t id, std::string msg_type, std::vector<Field> fields) {
+    bool has_optional = false;
+    for (const auto& f : fields) has_optional |= f.optional;
+    return Schema{id, std::move(msg_type), std::move(fields), has_optional};
+}
+
+// Wire field order of a typed message is its descriptor order (icd_messages.hpp);
+// node_id is the stream key and travels in the frame header
+template <icd::Message M>
+Schema schema_of(uint8_t id) {
+    std::vector<Field> fields;
+    icd::for_each_field<M>([&](const auto& f) {
+        using T = typename std::decay_t<decltype(f)>::value_type;
+        if (f.encoding == Kind::NODE_ID) return;
+        fields.push_back(Field{std::string(f.name), f.encoding, icd::is_optional_field_v<T>, f.values});
+    });
+    return make_schema(id, std::string(M::kMsgType), std::move(fields));
+}
+
+// DisturbanceEvent and NodeStatus follow their descriptors (ICD §2.1, §2.2);
+// WaveformBlock (§2.4) is only ever handled as JSON and is listed by hand.
+// msg_type and node_id are implicit.
+const std::vector<Schema>& schemas() {
+    static const std::vector<Schema> table = {
+        schema_of<icd::DisturbanceEvent>(kDisturbanceEventSchema),
+        schema_of<icd::NodeStatus>(kNodeStatusSchema),
+        make_schema(3, "WaveformBlock", {
+            {"block_sequence", Kind::U64, false, {}},
+            {"timestamp_utc", Kind::TIMESTAMP, false, {}},
+            {"monotonic_ns", Kind::U64, false, {}},
+            {"sample_rate_hz", Kind::U64, false, {}},
+            {"first_sample", Kind::U64, false, {}},
+            {"scale", Kind::F64, false, {}},
+            {"samples", Kind::SAMPLES, false, {}},
+        }),
+    };
+    return table;
+}
+
+const Schema* find_schema(const std::string& msg_type) {
+    for (const auto& s : schemas()) {
+        if (msg_type == s.msg_type) return &s;
+    }
+    return nullptr;
+}
+
+const Schema* find_schema(uint8_t id) {
+    for (const auto& s : schemas()) {
+        if (s.id == id) return &s;
+    }
+    return nullptr;
+}
+
+// Stream id on the wire: FNV-1a 64 of the schema id byte followed by the node_id
+uint64_t stream_hash(uint8_t schema_id, std::string_view node_id) {
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](unsigned char c) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    };
+    mix(schema_id);
+    for (unsigned char c : node_id) mix(c);
+    return h;
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// Deltas wrap modulo 2^64: a forged or extreme delta never overflows a signed add,
+// and the decoder's range checks reject what does not fit
+uint64_t delta(int64_t x, int64_t base) {
+    return zigzag(static_cast<int64_t>(static_cast<uint64_t>(x) - static_cast<uint64_t>(base)));
+}
+
+int64_t undelta(int64_t base, uint64_t v) {
+    return static_cast<int64_t>(static_cast<uint64_t>(base) + static_cast<uint64_t>(unzigzag(v)));
+}
+
+void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void put_string(std::string& out, std::string_view s) {
+    put_varint(out, s.size());
+    out.append(s);
+}
+
+void put_u64(std::string& out, uint64_t bits) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+}
+
+void put_f64(std::string& out, double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    put_u64(out, bits);
+}
+
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok{true};
+
+    uint8_t u8() {
+        if (p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) break;
+            uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::string_view bytes(size_t n) {
+        if (static_cast<size_t>(end - p) < n) { ok = false; return {}; }
+        std::string_view v(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return v;
+    }
+
+    std::string string() {
+        uint64_t n = varint();
+        return std::string(bytes(ok ? n : 0));
+    }
+
+    uint64_t u64() {
+        auto b = bytes(8);
+        if (!ok) return 0;
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(b[i])) << (8 * i);
+        }
+        return bits;
+    }
+
+    double f64() {
+        const uint64_t bits = u64();
+        if (!ok) return 0.0;
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+};
+
+// Civil date <-> days since 1970-01-01 (proleptic Gregorian)
+int64_t days_from_civil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civil_from_days(int64_t z, int64_t& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+constexpr int64_t kMsPerDay = 86400000;
+constexpr int64_t kMaxTimestampMs = 253402300800000; // 10000-01-01
+
+// Accepts exactly the "YYYY-MM-DDTHH:MM:SS.mmmZ" form produced by time::format_utc_ms,
+// so that formatting the parsed value reproduces the original string.
+bool parse_timestamp(std::string_view s, int64_t& ms) {
+    if (s.size() != 24 || s[4] != '-' || s[7] != '-' || s[10] != 'T' || s[13] != ':' ||
+        s[16] != ':' || s[19] != '.' || s[23] != 'Z') {
+        return false;
+    }
+    auto num = [&s](size_t pos, size_t len, int& out) {
+        out = 0;
+        for (size_t i = pos; i < pos + len; ++i) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            out = out * 10 + (s[i] - '0');
+        }
+        return true;
+    };
+    int y, mo, d, h, mi, sec, milli;
+    if (!num(0, 4, y) || !num(5, 2, mo) || !num(8, 2, d) || !num(11, 2, h) ||
+        !num(14, 2, mi) || !num(17, 2, sec) || !num(20, 3, milli)) {
+        return false;
+    }
+    if (y < 1970 || mo < 1 || mo > 12 || d < 1 || h > 23 || mi > 59 || sec > 59) {
+        return false;
+    }
+    int64_t days = days_from_civil(y, mo, d);
+    int64_t cy; int cm, cd;
+    civil_from_days(days, cy, cm, cd);
+    if (cy != y || cm != mo || cd != d) {
+        return false; // e.g. Feb 30
+    }
+    ms = ((days * 24 + h) * 60 + mi) * 60000 + sec * 1000 + milli;
+    return true;
+}
+
+std::string format_timestamp(int64_t ms) {
+    int64_t days = ms / kMsPerDay;
+    int64_t rem = ms % kMsPerDay;
+    int64_t y; int m, d;
+    civil_from_days(days, y, m, d);
+
+    char buf[25];
+    auto put = [&buf](size_t pos, size_t len, int64_t v) {
+        for (size_t i = len; i-- > 0;) {
+            buf[pos + i] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        }
+    };
+    put(0, 4, y); buf[4] = '-';
+    put(5, 2, m); buf[7] = '-';
+    put(8, 2, d); buf[10] = 'T';
+    put(11, 2, rem / 3600000); buf[13] = ':';
+    put(14, 2, rem / 60000 % 60); buf[16] = ':';
+    put(17, 2, rem / 1000 % 60); buf[19] = '.';
+    put(20, 3, rem % 1000); buf[23] = 'Z';
+    return std::string(buf, 24);
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Canonical lowercase 8-4-4-4-12 form, as produced by ids::generate_uuid
+bool pack_uuid(std::string_view s, std::array<uint8_t, 16>& out) {
+    if (s.size() != 36 || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-') {
+        return false;
+    }
+    size_t byte = 0;
+    for (size_t i = 0; i < 36; i += 2) {
+        if (s[i] == '-') --i; // realign after a dash
+        else {
+            int hi = hex_value(s[i]);
+            int lo = hex_value(s[i + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out[byte++] = static_cast<uint8_t>(hi << 4 | lo);
+        }
+    }
+    return byte == 16;
+}
+
+std::string unpack_uuid(std::string_view b) {
+    static const char* kHex = "0123456789abcdef";
+    std::string s;
+    s.reserve(36);
+    for (size_t i = 0; i < 16; ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) s.push_back('-');
+        uint8_t v = static_cast<uint8_t>(b[i]);
+        s.push_back(kHex[v >> 4]);
+        s.push_back(kHex[v & 0xF]);
+    }
+    return s;
+}
+
+bool get_u64(const nlohmann::json& v, int64_t& out) {
+    if (v.is_number_unsigned()) {
+        uint64_t u = v.get<uint64_t>();
+        if (u > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) return false;
+        out = static_cast<int64_t>(u);
+        return true;
+    }
+    if (v.is_number_integer()) {
+        out = v.get<int64_t>();
+        return out >= 0;
+    }
+    return false;
+}
+
+// Field writers shared by the JSON and typed encoders. `prev` is the stream's slot
+// for the field.
+
+void write_u64(std::string& out, int64_t& prev, int64_t x) {
+    put_varint(out, delta(x, prev));
+    prev = x;
+}
+
+void write_timestamp(std::string& out, int64_t& prev, std::string_view s) {
+    int64_t ms;
+    if (parse_timestamp(s, ms)) {
+        put_varint(out, delta(ms, prev) << 1);
+        prev = ms;
+    } else {
+        put_varint(out, (uint64_t(s.size()) << 1) | 1);
+        out.append(s);
+    }
+}
+
+void write_enum(std::string& out, std::span<const std::string_view> values, std::string_view s) {
+    size_t idx = 0;
+    while (idx < values.size() && values[idx] != s) ++idx;
+    if (idx < values.size()) {
+        out.push_back(static_cast<char>(idx));
+    } else {
+        out.push_back(static_cast<char>(kEnumLiteral));
+        put_string(out, s);
+    }
+}
+
+void write_uuid(std::string& out, std::string_view s) {
+    std::array<uint8_t, 16> packed;
+    if (pack_uuid(s, packed)) {
+        out.push_back(1);
+        out.append(reinterpret_cast<const char*>(packed.data()), packed.size());
+    } else {
+        out.push_back(0);
+        put_string(out, s);
+    }
+}
+
+// Writes the string kinds; false for a kind that does not take a string
+bool write_string_field(std::string& out, const Field& f, int64_t& prev, std::string_view s) {
+    switch (f.kind) {
+        case Kind::TIMESTAMP: write_timestamp(out, prev, s); return true;
+        case Kind::ENUM:      write_enum(out, f.values, s); return true;
+        case Kind::UUID:      write_uuid(out, s); return true;
+        case Kind::STRING:    put_string(out, s); return true;
+        default:              return false;
+    }
+}
+
+// First stamp against the stream's previous one, the rest against their predecessor
+void write_stamps(std::string& out, int64_t& prev, std::span<const int64_t> stamps) {
+    put_varint(out, stamps.size());
+    int64_t base = prev;
+    for (size_t k = 0; k < stamps.size(); ++k) {
+        put_varint(out, delta(stamps[k], base));
+        if (k == 0) prev = stamps[k];
+        base = stamps[k];
+    }
+}
+
+} // namespace
+
+CodecCounters::CodecCounters(const std::string& name) : prefix_("codec." + name + ".") {}
+
+CodecCounters::~CodecCounters() {
+    flush();
+}
+
+void CodecCounters::flush() {
+    const std::pair<const char*, uint64_t*> counters[] = {
+        {"messages", &messages},
+        {"bytes", &bytes},
+        {"sampled_json_bytes", &sampled_json_bytes},
+        {"sampled_frame_bytes", &sampled_frame_bytes},
+        {"codec_ns", &codec_ns},
+        {"keyframes", &keyframes},
+        {"json_frames", &json_fallbacks},
+        {"desync_drops", &desync_drops},
+        {"stream_collisions", &stream_collisions},
+        {"malformed", &malformed},
+    };
+    for (const auto& [key, value] : counters) {
+        if (*value != 0) {
+            metrics::add(prefix_ + key, *value);
+            *value = 0;
+        }
+    }
+}
+
+StreamEncoder::StreamEncoder(const std::string& name, int keyframe_interval)
+    : keyframe_interval_(keyframe_interval < 1 ? 1 : keyframe_interval),
+      counters_(name)
+{
+}
+
+void StreamEncoder::begin_frame(const Schema& schema, const std::string& node_id, uint64_t presence,
+                                std::string& out) {
+    pending_key_.assign(1, static_cast<char>(schema.id));
+    pending_key_ += node_id;
+    auto found = streams_.find(pending_key_);
+    pending_ = found != streams_.end() ? &found->second : nullptr;
+    pending_keyframe_ = !pending_ ||
+                        pending_->frames_since_keyframe >= static_cast<uint32_t>(keyframe_interval_);
+
+    // Work on a copy so a field that fails validation leaves the stream untouched
+    if (pending_) {
+        scratch_ = *pending_;
+    } else {
+        scratch_ = StreamState{};
+        scratch_.node_id = node_id;
+    }
+    if (pending_keyframe_) {
+        scratch_.prev.assign(schema.fields.size(), 0);
+        scratch_.last_sample.clear();
+        scratch_.frames_since_keyframe = 0;
+    }
+
+    out.push_back(static_cast<char>(kMagic));
+    out.push_back(static_cast<char>(schema.id));
+    out.push_back(static_cast<char>(pending_keyframe_ ? kFlagKeyframe : 0));
+    put_u64(out, stream_hash(schema.id, node_id));
+    put_varint(out, scratch_.next_frame);
+    if (pending_keyframe_) put_string(out, node_id);
+    if (schema.has_optional) put_varint(out, presence);
+}
+
+void StreamEncoder::end_frame() {
+    scratch_.next_frame++;
+    scratch_.frames_since_keyframe++;
+    if (pending_) {
+        std::swap(*pending_, scratch_);
+    } else {
+        streams_.emplace(std::move(pending_key_), std::move(scratch_));
+    }
+    if (pending_keyframe_) counters_.keyframes++;
+}
+
+bool StreamEncoder::encode_frame(const nlohmann::json& msg, std::string& out) {
+    if (!msg.is_object()) return false;
+    auto type_it = msg.find("msg_type");
+    auto node_it = msg.find("node_id");
+    if (type_it == msg.end() || node_it == msg.end() || !type_it->is_string() || !node_it->is_string()) {
+        return false;
+    }
+    const Schema* schema = find_schema(type_it->get_ref<const std::string&>());
+    if (!schema) return false;
+    const auto& node_id = node_it->get_ref<const std::string&>();
+
+    // Exactly the schema's fields, or the message goes out as JSON
+    size_t present = 2;
+    uint64_t presence = 0;
+    size_t optional_index = 0;
+    for (const auto& f : schema->fields) {
+        bool has = msg.contains(f.name);
+        if (f.optional) {
+            if (has) presence |= uint64_t(1) << optional_index;
+            ++optional_index;
+        } else if (!has) {
+            return false;
+        }
+        present += has;
+    }
+    if (present != msg.size()) return false;
+
+    begin_frame(*schema, node_id, presence, out);
+
+    for (size_t i = 0; i < schema->fields.size(); ++i) {
+        const Field& f = schema->fields[i];
+        auto it = msg.find(f.name);
+        if (it == msg.end()) continue;
+        const auto& v = *it;
+
+        switch (f.kind) {
+            case Kind::U64: {
+                int64_t x;
+                if (!get_u64(v, x)) return false;
+                write_u64(out, scratch_.prev[i], x);
+                break;
+            }
+            case Kind::F64:
+                if (!v.is_number_float()) return false;
+                put_f64(out, v.get<double>());
+                break;
+            case Kind::TIMESTAMP:
+            case Kind::ENUM:
+            case Kind::UUID:
+            case Kind::STRING:
+                if (!v.is_string()) return false;
+                write_string_field(out, f, scratch_.prev[i], v.get_ref<const std::string&>());
+                break;
+            case Kind::SAMPLES: {
+                if (!v.is_array() || v.empty() || !v[0].is_array()) return false;
+                const size_t channels = v.size();
+                const size_t n = v[0].size();
+                put_varint(out, channels);
+                put_varint(out, n);
+                // Each channel continues from the last sample of the previous block
+                scratch_.last_sample.resize(channels, 0);
+                for (size_t ch = 0; ch < channels; ++ch) {
+                    const auto& samples = v[ch];
+                    if (!samples.is_array() || samples.size() != n) return false;
+                    int64_t base = scratch_.last_sample[ch];
+                    for (const auto& s : samples) {
+                        if (!s.is_number_integer()) return false;
+                        int64_t x = s.get<int64_t>();
+                        if (x < std::numeric_limits<int16_t>::min() || x > std::numeric_limits<int16_t>::max()) {
+                            return false;
+                        }
+                        put_varint(out, delta(x, base));
+                        base = x;
+                    }
+                    scratch_.last_sample[ch] = static_cast<int16_t>(base);
+                }
+                break;
+            }
+            case Kind::STAMPS: {
+                if (!v.is_array() || v.size() > kMaxStamps) return false;
+                std::array<int64_t, kMaxStamps> stamps;
+                for (size_t k = 0; k < v.size(); ++k) {
+                    if (!get_u64(v[k], stamps[k])) return false;
+                }
+                write_stamps(out, scratch_.prev[i], std::span<const int64_t>(stamps.data(), v.size()));
+                break;
+            }
+            case Kind::NODE_ID:
+                return false; // never in a schema
+        }
+    }
+
+    end_frame();
+    return true;
+}
+
+// Walks M's descriptors directly: no key lookups and no DOM. Fails only for values the
+// frame cannot carry (integers above INT64_MAX), which go out as JSON instead.
+template <icd::Message M>
+bool StreamEncoder::encode_typed(const M& msg, uint8_t schema_id, std::string& out) {
+    static const Schema& schema = *find_schema(schema_id);
+
+    uint64_t presence = 0;
+    size_t optional_index = 0;
+    icd::for_each_field<M>([&](const auto& f) {
+        using T = typename std::decay_t<decltype(f)>::value_type;
+        if constexpr (icd::is_optional_field_v<T>) {
+            if (icd::present(msg.*(f.member))) presence |= uint64_t(1) << optional_index;
+            ++optional_index;
+        }
+    });
+
+    begin_frame(schema, msg.node_id, presence, out);
+
+    bool ok = true;
+    size_t i = 0;
+    icd::for_each_field<M>([&](const auto& f) {
+        if (f.encoding == Kind::NODE_ID) return;
+        const size_t index = i++;
+        const auto& v = msg.*(f.member);
+        if (!ok || !icd::present(v)) return;
+        const auto& value = icd::value_of(v);
+        using V = std::decay_t<decltype(value)>;
+
+        if constexpr (std::is_same_v<V, uint64_t>) {
+            if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                ok = false;
+                return;
+            }
+            write_u64(out, scratch_.prev[index], static_cast<int64_t>(value));
+        } else if constexpr (std::is_same_v<V, double>) {
+            put_f64(out, value);
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            ok = write_string_field(out, schema.fields[index], scratch_.prev[index], value);
+        } else if constexpr (std::is_same_v<V, icd::Stamps>) {
+            std::array<int64_t, icd::kMaxHops> stamps;
+            for (size_t k = 0; k < value.size(); ++k) {
+                if (value[k] > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                    ok = false;
+                    return;
+                }
+                stamps[k] = static_cast<int64_t>(value[k]);
+            }
+            write_stamps(out, scratch_.prev[index], std::span<const int64_t>(stamps.data(), value.size()));
+        } else {
+            static_assert(sizeof(V) == 0, "no codec encoding for this member type");
+        }
+    });
+    if (!ok) return false;
+
+    end_frame();
+    return true;
+}
+
+template <typename JsonSize>
+void StreamEncoder::account(uint64_t start_ns, const std::string& out, JsonSize&& json_size) {
+    counters_.codec_ns += time::monotonic_ns() - start_ns;
+    counters_.bytes += out.size();
+
+    if (++counters_.messages % kRatioSampleEvery == 0) {
+        counters_.sampled_json_bytes += json_size() + 1;
+        counters_.sampled_frame_bytes += out.size();
+    }
+    if (counters_.messages % kFlushEvery == 0) {
+        counters_.flush();
+    }
+}
+
+std::string StreamEncoder::encode(const nlohmann::json& msg) {
+    uint64_t start_ns = time::monotonic_ns();
+    std::string out;
+    if (!encode_frame(msg, out)) {
+        out = msg.dump() + "\n";
+        counters_.json_fallbacks++;
+    }
+    account(start_ns, out, [&] { return msg.dump().size(); });
+    return out;
+}
+
+template <icd::Message M>
+std::string StreamEncoder::encode_message(const M& msg, uint8_t schema_id) {
+    uint64_t start_ns = time::monotonic_ns();
+    std::string out;
+    if (!encode_typed(msg, schema_id, out)) {
+        out.clear();
+        icd::dump_to(out, msg);
+        out.push_back('\n');
+        counters_.json_fallbacks++;
+    }
+    account(start_ns, out, [&] { return icd::dump(msg).size(); });
+    return out;
+}
+
+std::string StreamEncoder::encode(const icd::DisturbanceEvent& msg) {
+    return encode_message(msg, kDisturbanceEventSchema);
+}
+
+std::string StreamEncoder::encode(const icd::NodeStatus& msg) {
+    return encode_message(msg, kNodeStatusSchema);
+}
+
+StreamDecoder::StreamDecoder(const std::string& name) : counters_(name) {}
+
+std::optional<nlohmann::json> StreamDecoder::decode_frame(const uint8_t* data, size_t size) {
+    Reader r{data, data + size};
+    if (r.u8() != kMagic) {
+        counters_.malformed++;
+        return std::nullopt;
+    }
+    const Schema* schema = find_schema(r.u8());
+    uint8_t flags = r.u8();
+    uint64_t key = r.u64();
+    uint64_t frame = r.varint();
+    if (!r.ok || !schema || frame > std::numeric_limits<uint32_t>::max()) {
+        counters_.malformed++;
+        return std::nullopt;
+    }
+
+    StreamState* st;
+    StreamState keyframe_only; // a keyframe of a stream whose id is shared with another
+    if (flags & kFlagKeyframe) {
+        std::string node_id = r.string();
+        if (!r.ok || stream_hash(schema->id, node_id) != key) {
+            counters_.malformed++;
+            return std::nullopt;
+        }
+        auto [it, added] = streams_.try_emplace(key);
+        st = &it->second;
+        if (!added && st->node_id != node_id) {
+            // Two node_ids with one 64-bit id: their delta frames cannot be told apart,
+            // so the id is decoded from keyframes only from now on
+            if (!st->collided) {
+                st->collided = true;
+                counters_.stream_collisions++;
+            }
+        }
+        if (st->collided) {
+            st->synced = false;
+            st = &keyframe_only;
+        }
+        st->node_id = std::move(node_id);
+        st->prev.assign(schema->fields.size(), 0);
+        st->last_sample.clear();
+        st->synced = true;
+        counters_.keyframes++;
+    } else {
+        auto it = streams_.find(key);
+        if (it == streams_.end() || !it->second.synced || it->second.next_frame != static_cast<uint32_t>(frame)) {
+            // Lost frames (or we joined mid-stream): skip this stream until its next keyframe
+            if (it != streams_.end()) it->second.synced = false;
+            counters_.desync_drops++;
+            return std::nullopt;
+        }
+        st = &it->second;
+    }
+
+    nlohmann::json msg = {{"msg_type", schema->msg_type}, {"node_id", st->node_id}};
+    uint64_t presence = schema->has_optional ? r.varint() : 0;
+    size_t optional_index = 0;
+
+    for (size_t i = 0; i < schema->fields.size() && r.ok; ++i) {
+        const Field& f = schema->fields[i];
+        if (f.optional && !(presence & (uint64_t(1) << optional_index++))) continue;
+
+        switch (f.kind) {
+            case Kind::U64: {
+                int64_t x = undelta(st->prev[i], r.varint());
+                if (x < 0) r.ok = false;
+                st->prev[i] = x;
+                msg[f.name] = static_cast<uint64_t>(x);
+                break;
+            }
+            case Kind::TIMESTAMP: {
+                uint64_t tag = r.varint();
+                if (tag & 1) {
+                    msg[f.name] = std::string(r.bytes(tag >> 1));
+                } else {
+                    int64_t ms = undelta(st->prev[i], tag >> 1);
+                    if (ms < 0 || ms >= kMaxTimestampMs) { r.ok = false; break; }
+                    st->prev[i] = ms;
+                    msg[f.name] = format_timestamp(ms);
+                }
+                break;
+            }
+            case Kind::F64:
+                msg[f.name] = r.f64();
+                break;
+            case Kind::ENUM: {
+                uint8_t idx = r.u8();
+                if (idx == kEnumLiteral) {
+                    msg[f.name] = r.string();
+                } else if (idx < f.values.size()) {
+                    msg[f.name] = std::string(f.values[idx]);
+                } else {
+                    r.ok = false;
+                }
+                break;
+            }
+            case Kind::UUID: {
+                uint8_t packed = r.u8();
+                if (packed) {
+                    auto b = r.bytes(16);
+                    if (r.ok) msg[f.name] = unpack_uuid(b);
+                } else {
+                    msg[f.name] = r.string();
+                }
+                break;
+            }
+            case Kind::STRING:
+                msg[f.name] = r.string();
+                break;
+            case Kind::SAMPLES: {
+                uint64_t channels = r.varint();
+                uint64_t n = r.varint();
+                // Every sample takes at least one byte
+                if (!r.ok || channels == 0 || channels > 64 ||
+                    n > static_cast<uint64_t>(r.end - r.p) / channels) {
+                    r.ok = false;
+                    break;
+                }
+                st->last_sample.resize(channels, 0);
+                nlohmann::json arr = nlohmann::json::array();
+                std::vector<int16_t> samples(n);
+                for (size_t ch = 0; ch < channels && r.ok; ++ch) {
+                    int64_t base = st->last_sample[ch];
+                    for (size_t k = 0; k < n; ++k) {
+                        base = undelta(base, r.varint());
+                        if (base < std::numeric_limits<int16_t>::min() || base > std::numeric_limits<int16_t>::max()) {
+                            r.ok = false;
+                            break;
+                        }
+                        samples[k] = static_cast<int16_t>(base);
+                    }
+                    st->last_sample[ch] = static_cast<int16_t>(base);
+                    arr.push_back(samples);
+                }
+                msg[f.name] = std::move(arr);
+                break;
+            }
+            case Kind::STAMPS: {
+                uint64_t count = r.varint();
+                if (count > kMaxStamps) { r.ok = false; break; }
+                nlohmann::json stamps = nlohmann::json::array();
+                int64_t base = st->prev[i];
+                for (uint64_t k = 0; k < count && r.ok; ++k) {
+                    int64_t x = undelta(base, r.varint());
+                    if (x < 0) { r.ok = false; break; }
+                    if (k == 0) st->prev[i] = x;
+                    stamps.push_back(static_cast<uint64_t>(x));
+                    base = x;
+                }
+                msg[f.name] = std::move(stamps);
+                break;
+            }
+            case Kind::NODE_ID:
+                r.ok = false; // never in a schema
+                break;
+        }
+    }
+
+    if (!r.ok || r.p != r.end) {
+        st->synced = false;
+        counters_.malformed++;
+        return std::nullopt;
+    }
+    st->next_frame = static_cast<uint32_t>(frame + 1);
+    return msg;
+}
+
+std::optional<nlohmann::json> StreamDecoder::decode(const void* data, size_t size) {
+    uint64_t start_ns = time::monotonic_ns();
+    const auto* bytes = static_cast<const uint8_t*>(data);
+
+    std::optional<nlohmann::json> msg;
+    if (size > 0 && bytes[0] == '{') {
+        try {
+            msg = nlohmann::json::parse(bytes, bytes + size);
+            counters_.json_fallbacks++;
+        } catch (const nlohmann::json::exception&) {
+            counters_.malformed++;
+        }
+    } else if (size > 0) {
+        msg = decode_frame(bytes, size);
+    }
+    counters_.codec_ns += time::monotonic_ns() - start_ns;
+    counters_.bytes += size;
+
+    if (++counters_.messages % kRatioSampleEvery == 0 && msg) {
+        counters_.sampled_json_bytes += msg->dump().size() + 1;
+        counters_.sampled_frame_bytes += size;
+    }
+    if (counters_.messages % kFlushEvery == 0) {
+        counters_.flush();
+    }
+    return msg;
+}
+
+nlohmann::json stats_json(const std::string& name) {
+    const std::string prefix = "codec." + name + ".";
+    uint64_t messages = metrics::get(prefix + "messages");
+    uint64_t sampled_json = metrics::get(prefix + "sampled_json_bytes");
+    uint64_t sampled_frame = metrics::get(prefix + "sampled_frame_bytes");
+    uint64_t codec_ns = metrics::get(prefix + "codec_ns");
+    return {
+        {"messages", messages},
+        {"bytes", metrics::get(prefix + "bytes")},
+        {"compression_ratio", sampled_frame > 0 ? static_cast<double>(sampled_json) / sampled_frame : 1.0},
+        {"ns_per_message", messages > 0 ? static_cast<double>(codec_ns) / messages : 0.0},
+        {"keyframes", metrics::get(prefix + "keyframes")},
+        {"json_frames", metrics::get(prefix + "json_frames")},
+        {"desync_drops", metrics::get(prefix + "desync_drops")},
+        {"stream_collisions", metrics::get(prefix + "stream_collisions")},
+        {"malformed", metrics::get(prefix + "malformed")}
+    };
+}
+
+} // namespace codec
+} // namespace surveillance
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "icd_messages.hpp"
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace surveillance {
+namespace codec {
+
+// Compact per-stream encoding for the 7001 (sensor -> emulator) and 7002
+// (emulator -> central) links.
+//
+// Every (node_id, msg_type) pair is a stream. A keyframe carries all fields of the
+// message; a delta frame carries integer fields (sequence numbers, timestamps,
+// quantized samples) as zigzag varints relative to the previous frame of the same
+// stream, and names the stream by a 64-bit hash of (type, node_id) instead of the
+// node_id string. A keyframe must match its hash; should two node_ids ever share one,
+// the decoder counts a collision and decodes that id from keyframes only. Doubles are
+// sent raw so decoding is bit-exact. Messages that do not match a known schema go
+// out as plain JSON, which the decoder recognises by the leading '{'. The
+// DisturbanceEvent and NodeStatus schemas are the field descriptors of the typed
+// messages (icd_messages.hpp), and encoding a typed message writes the frame straight
+// from its members.
+//
+// Frames carry a 32-bit per-stream counter. A decoder that sees a gap drops that
+// stream's delta frames until the next keyframe, which the encoder sends every
+// `keyframe_interval` frames of the stream.
+//
+// Encoders and decoders hold per-connection state and are not thread-safe; use one
+// per socket, on the thread that owns the socket. Counters are published to the
+// metrics registry as codec.<name>.* in batches (see stats_json).
+
+struct Schema;
+
+struct StreamState {
+    std::string node_id;
+    uint32_t next_frame{0};
+    uint32_t frames_since_keyframe{0};
+    bool synced{false};
+    bool collided{false}; // decoder: another node_id has the same stream id
+    std::vector<int64_t> prev;          // per schema field, integer kinds only
+    std::vector<int16_t> last_sample;   // per channel, WaveformBlock only
+};
+
+class CodecCounters {
+public:
+    explicit CodecCounters(const std::string& name);
+    ~CodecCounters();
+
+    // Publishes accumulated counts to the metrics registry
+    void flush();
+
+    uint64_t messages{0};
+    uint64_t bytes{0};
+    uint64_t sampled_json_bytes{0};
+    uint64_t sampled_frame_bytes{0};
+    uint64_t codec_ns{0};
+    uint64_t keyframes{0};
+    uint64_t json_fallbacks{0};
+    uint64_t desync_drops{0};
+    uint64_t stream_collisions{0};
+    uint64_t malformed{0};
+
+private:
+    std::string prefix_;
+};
+
+class StreamEncoder {
+public:
+    StreamEncoder(const std::string& name, int keyframe_interval);
+
+    // Returns the frame to put on the wire
+    std::string encode(const nlohmann::json& msg);
+    std::string encode(const icd::DisturbanceEvent& msg);
+    std::string encode(const icd::NodeStatus& msg);
+
+    void flush_metrics() { counters_.flush(); }
+
+private:
+    // Stream lookup and frame header; the frame is built in scratch_ and only
+    // committed to the stream by end_frame
+    void begin_frame(const Schema& schema, const std::string& node_id, uint64_t presence, std::string& out);
+    void end_frame();
+
+    bool encode_frame(const nlohmann::json& msg, std::string& out);
+    template <icd::Message M>
+    bool encode_typed(const M& msg, uint8_t schema_id, std::string& out);
+    template <icd::Message M>
+    std::string encode_message(const M& msg, uint8_t schema_id);
+    template <typename JsonSize>
+    void account(uint64_t start_ns, const std::string& out, JsonSize&& json_size);
+
+    int keyframe_interval_;
+    std::unordered_map<std::string, StreamState> streams_;
+    StreamState scratch_;
+    std::string pending_key_;
+    StreamState* pending_{nullptr};
+    bool pending_keyframe_{false};
+    CodecCounters counters_;
+};
+
+class StreamDecoder {
+public:
+    explicit StreamDecoder(const std::string& name);
+
+    // Accepts binary frames and plain JSON. Returns nullopt for malformed frames and
+    // for delta frames of a stream that lost synchronization.
+    std::optional<nlohmann::json> decode(const void* data, size_t size);
+
+    void flush_metrics() { counters_.flush(); }
+
+private:
+    std::optional<nlohmann::json> decode_frame(const uint8_t* data, size_t size);
+
+    std::unordered_map<uint64_t, StreamState> streams_;
+    CodecCounters counters_;
+};
+
+// Derived view of codec.<name>.* metrics: compression ratio, ns per message, drops
+nlohmann::json stats_json(const std::string& name);
+
+} // namespace codec
+} // namespace surveillance
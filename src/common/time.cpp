@@ -1,5 +1,7 @@
 #include "time.hpp"
 #include <chrono>
+#include <cstdio>
+#include <ctime>
 #include <sstream>
 #include <iomanip>
 
@@ -41,5 +43,27 @@ std::string format_utc_ms(uint64_t ms) {
     return oss.str();
 }
 
+uint64_t parse_utc_ms(std::string_view iso) {
+    // Fixed width "%Y-%m-%dT%H:%M:%S.123Z"
+    if (iso.size() < 24) return 0;
+    char buf[32];
+    buf[iso.copy(buf, sizeof(buf) - 1)] = '\0';
+    std::tm tm{};
+    int ms = 0;
+    if (std::sscanf(buf, "%4d-%2d-%2dT%2d:%2d:%2d.%3dZ", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour,
+                    &tm.tm_min, &tm.tm_sec, &ms) != 7) {
+        return 0;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+#if defined(_WIN32)
+    std::time_t t = _mkgmtime(&tm);
+#else
+    std::time_t t = timegm(&tm);
+#endif
+    if (t < 0) return 0;
+    return static_cast<uint64_t>(t) * 1000ULL + static_cast<uint64_t>(ms);
+}
+
 } // namespace time
 } // namespace surveillance
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 namespace surveillance {
@@ -17,5 +18,8 @@ uint64_t utc_now_ms();
 
 std::string format_utc_ms(uint64_t ms);
 
+// Inverse of format_utc_ms; 0 for anything not in that form
+uint64_t parse_utc_ms(std::string_view iso);
+
 } // namespace time
 } // namespace surveillance
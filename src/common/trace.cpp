@@ -0,0 +1,181 @@
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "spsc_ring.hpp"
+#include "time.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace surveillance {
+namespace trace {
+
+namespace {
+
+constexpr size_t kRingCapacity = 4096; // per thread; ~0.4 s of spans at 10k sampled events/s
+constexpr auto kFlushPeriod = std::chrono::milliseconds(100);
+
+struct TraceRecord {
+    const char* name{nullptr};
+    uint64_t start_ns{0};
+    uint64_t end_ns{0};
+    char event_id[40]{};
+};
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t id) : tid(id), ring(kRingCapacity) {}
+
+    uint32_t tid;
+    std::string name;          // guarded by g_mutex
+    bool name_written{false};  // guarded by g_mutex
+    spsc::Ring<TraceRecord> ring;
+};
+
+std::atomic<bool> g_enabled{false};
+uint64_t g_sample_every_n{1000};
+
+std::mutex g_mutex; // buffer registry and output file
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+std::ofstream g_out;
+
+std::mutex g_flush_mutex;
+std::condition_variable g_flush_cv;
+bool g_stopping{false};
+std::thread g_flusher;
+
+uint64_t fnv1a64(std::string_view s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+ThreadBuffer* local_buffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<uint32_t>(g_buffers.size() + 1)));
+        buffer = g_buffers.back().get();
+    }
+    return buffer;
+}
+
+void flush_locked() {
+    if (!g_out.is_open()) return;
+    for (auto& buffer : g_buffers) {
+        if (!buffer->name.empty() && !buffer->name_written) {
+            g_out << nlohmann::json{{"tid", buffer->tid}, {"thread_name", buffer->name}}.dump() << "\n";
+            buffer->name_written = true;
+        }
+        while (auto rec = buffer->ring.try_pop()) {
+            g_out << nlohmann::json{
+                {"name", rec->name},
+                {"event_id", rec->event_id},
+                {"tid", buffer->tid},
+                {"ts_ns", rec->start_ns},
+                {"dur_ns", rec->end_ns - rec->start_ns}
+            }.dump() << "\n";
+        }
+    }
+    g_out.flush();
+}
+
+void flush_loop() {
+    std::unique_lock<std::mutex> lock(g_flush_mutex);
+    while (!g_stopping) {
+        g_flush_cv.wait_for(lock, kFlushPeriod, [] { return g_stopping; });
+        std::lock_guard<std::mutex> out_lock(g_mutex);
+        flush_locked();
+    }
+}
+
+} // namespace
+
+void init(const std::string& component, const std::string& log_dir, const config::TracingConfig& cfg) {
+    if (!cfg.enabled) {
+        return;
+    }
+    std::filesystem::create_directories(log_dir);
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_out.open(log_dir + "/trace_" + component + ".jsonl", std::ios::trunc);
+        g_out << nlohmann::json{{"component", component}, {"sample_every_n", cfg.sample_every_n}}.dump() << "\n";
+    }
+    g_sample_every_n = static_cast<uint64_t>(cfg.sample_every_n < 1 ? 1 : cfg.sample_every_n);
+    g_stopping = false;
+    g_flusher = std::thread(flush_loop);
+    g_enabled = true;
+}
+
+void shutdown() {
+    if (!g_enabled.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_flush_mutex);
+        g_stopping = true;
+    }
+    g_flush_cv.notify_all();
+    if (g_flusher.joinable()) g_flusher.join();
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    flush_locked();
+    g_out.close();
+}
+
+void set_thread_name(const std::string& name) {
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    ThreadBuffer* buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    buffer->name = name;
+}
+
+const std::string* sampled_event_id(const nlohmann::json& msg) {
+    if (!g_enabled.load(std::memory_order_relaxed)) return nullptr;
+    auto it = msg.find("event_id");
+    if (it == msg.end() || !it->is_string()) return nullptr;
+    return sampled_event_id(it->get_ref<const std::string&>());
+}
+
+const std::string* sampled_event_id(const std::string& event_id) {
+    return is_sampled(event_id) ? &event_id : nullptr;
+}
+
+bool is_sampled(std::string_view event_id) {
+    if (!g_enabled.load(std::memory_order_relaxed) || event_id.empty()) return false;
+    return fnv1a64(event_id) % g_sample_every_n == 0;
+}
+
+void record(const char* name, std::string_view event_id, uint64_t start_ns, uint64_t end_ns) {
+    if (!g_enabled.load(std::memory_order_relaxed)) return;
+    TraceRecord rec;
+    rec.name = name;
+    rec.start_ns = start_ns;
+    rec.end_ns = end_ns < start_ns ? start_ns : end_ns;
+    event_id.copy(rec.event_id, sizeof(rec.event_id) - 1);
+    if (!local_buffer()->ring.try_push(std::move(rec))) {
+        metrics::increment("trace.dropped_spans");
+    }
+}
+
+Span::Span(const char* name, const std::string* event_id)
+    : name_(name), event_id_(event_id), start_ns_(event_id ? time::monotonic_ns() : 0)
+{
+}
+
+Span::~Span() {
+    if (event_id_) {
+        record(name_, *event_id_, start_ns_, time::monotonic_ns());
+    }
+}
+
+} // namespace trace
+} // namespace surveillance
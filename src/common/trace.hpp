@@ -0,0 +1,55 @@
+#pragma once
+
+#include "config.hpp"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace surveillance {
+namespace trace {
+
+// Per-hop trace spans keyed by event_id.
+//
+// Spans are recorded into a lock-free ring owned by the recording thread and a
+// background thread appends them to <log_dir>/trace_<component>.jsonl, so the
+// hot path never formats or writes. Sampling is decided by a hash of the event_id,
+// which makes every component pick the same 1-in-N events. Timestamps are
+// CLOCK_MONOTONIC nanoseconds, comparable across processes on one host.
+// tools/trace_merge turns the files of a run into Chrome/Perfetto trace JSON.
+
+void init(const std::string& component, const std::string& log_dir, const config::TracingConfig& cfg);
+
+// Drains outstanding spans and stops the flush thread
+void shutdown();
+
+// Names the calling thread in the trace viewer
+void set_thread_name(const std::string& name);
+
+// Returns the message's event_id if tracing is on and the event is sampled, else nullptr
+const std::string* sampled_event_id(const nlohmann::json& msg);
+const std::string* sampled_event_id(const std::string& event_id);
+
+// Same sampling decision for an event_id that is not held in a json
+bool is_sampled(std::string_view event_id);
+
+// `name` must be a string literal (or otherwise outlive the process)
+void record(const char* name, std::string_view event_id, uint64_t start_ns, uint64_t end_ns);
+
+// Records the lifetime of the scope; inert when `event_id` is nullptr
+class Span {
+public:
+    Span(const char* name, const std::string* event_id);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    const std::string* event_id_;
+    uint64_t start_ns_;
+};
+
+} // namespace trace
+} // namespace surveillance
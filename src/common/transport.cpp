@@ -0,0 +1,49 @@
+#include "transport.hpp"
+#include <filesystem>
+#include <stdexcept>
+
+namespace surveillance {
+namespace transport {
+
+std::string_view link_name(Link link) {
+    switch (link) {
+        case Link::SENSOR_UPLINK: return "sensor_uplink";
+        case Link::CENTRAL_FEED: return "central_feed";
+        case Link::SENSOR_CREDITS: return "sensor_credits";
+        case Link::CENTRAL_CREDITS: return "central_credits";
+        case Link::LOG_CONTROL: return "log_control";
+        case Link::REPLICATION: return "replication";
+    }
+    return "unknown";
+}
+
+std::string endpoint(const config::TransportConfig& cfg, Link link) {
+    const std::string name(link_name(link));
+    const bool data_link = link == Link::SENSOR_UPLINK || link == Link::CENTRAL_FEED;
+    if (cfg.kind == "shm" && data_link) {
+        return "shm://surveillance." + name;
+    }
+    if (cfg.kind == "ipc" || cfg.kind == "shm") {
+        return "ipc://" + cfg.ipc_dir + "/" + name + ".sock";
+    }
+    if (cfg.kind == "inproc") {
+        return "inproc://surveillance." + name;
+    }
+    if (cfg.kind == "tcp") {
+        return "tcp://" + cfg.host + ":" + std::to_string(cfg.base_port + static_cast<int>(link));
+    }
+    throw std::invalid_argument("unknown transport: " + cfg.kind);
+}
+
+void prepare_bind(const std::string& endpoint) {
+    constexpr std::string_view kIpc = "ipc://";
+    if (endpoint.compare(0, kIpc.size(), kIpc) != 0) return;
+    const std::filesystem::path dir = std::filesystem::path(endpoint.substr(kIpc.size())).parent_path();
+    if (!dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+    }
+}
+
+} // namespace transport
+} // namespace surveillance
@@ -0,0 +1,37 @@
+#pragma once
+#include "config.hpp"
+#include <string>
+#include <string_view>
+
+namespace surveillance {
+namespace transport {
+
+// The links between the components. The value is the link's offset from
+// transport.base_port, which keeps the historical ports (7001 ... 7011) by default.
+enum class Link : int {
+    SENSOR_UPLINK = 1,   // sensors -> emulator
+    CENTRAL_FEED = 2,    // emulator -> central (and its shards and standby)
+    SENSOR_CREDITS = 3,  // emulator -> sensors credit grants (deterministic mode)
+    CENTRAL_CREDITS = 4, // central -> emulator credit grants (deterministic mode)
+    LOG_CONTROL = 10,    // survctl -> every component (ICD §2.7)
+    REPLICATION = 11     // primary central -> standby (ICD §2.8)
+};
+
+std::string_view link_name(Link link);
+
+// Endpoint of `link` under `cfg.kind`:
+//   tcp     tcp://<host>:<base_port + offset>
+//   ipc     ipc://<ipc_dir>/<link name>.sock
+//   inproc  inproc://surveillance.<link name>
+//   shm     shm://surveillance.<link name> for the two data links (a shared-memory
+//           ring, see shm_ring.hpp), ipc for the others
+// inproc only connects sockets created from the same zmq::context_t, that is,
+// components running as threads of one process. config::load rejects it, since the
+// executables are separate processes; bench_transport uses it directly.
+std::string endpoint(const config::TransportConfig& cfg, Link link);
+
+// Whatever binding `endpoint` needs first: the directory of an ipc socket file
+void prepare_bind(const std::string& endpoint);
+
+} // namespace transport
+} // namespace surveillance
@@ -1,12 +1,16 @@
 #include "zmq_utils.hpp"
+#include "transport.hpp"
 #include <iostream>
 
 namespace surveillance {
 namespace zmq_utils {
 
 bool publish_json(zmq::socket_t& socket, const nlohmann::json& payload) {
-    std::string str = payload.dump() + "\n";
-    zmq::message_t msg(str.data(), str.size());
+    return publish_string(socket, payload.dump() + "\n");
+}
+
+bool publish_string(zmq::socket_t& socket, const std::string& payload) {
+    zmq::message_t msg(payload.data(), payload.size());
     try {
         auto res = socket.send(msg, zmq::send_flags::none);
         return res.has_value();
@@ -15,6 +19,17 @@ bool publish_json(zmq::socket_t& socket, const nlohmann::json& payload) {
     }
 }
 
+bool publish_string(zmq::socket_t& socket, const std::string& topic, const std::string& payload) {
+    try {
+        zmq::message_t head(topic.data(), topic.size());
+        zmq::message_t body(payload.data(), payload.size());
+        if (!socket.send(head, zmq::send_flags::sndmore)) return false;
+        return socket.send(body, zmq::send_flags::none).has_value();
+    } catch (const zmq::error_t& e) {
+        return false;
+    }
+}
+
 std::optional<nlohmann::json> receive_json(zmq::socket_t& socket, bool wait) {
     zmq::message_t msg;
     try {
@@ -30,10 +45,39 @@ std::optional<nlohmann::json> receive_json(zmq::socket_t& socket, bool wait) {
     return std::nullopt;
 }
 
+std::optional<nlohmann::json> receive_json(zmq::socket_t& socket, codec::StreamDecoder& decoder, bool wait) {
+    zmq::message_t msg;
+    try {
+        auto flags = wait ? zmq::recv_flags::none : zmq::recv_flags::dontwait;
+        if (socket.recv(msg, flags).has_value()) {
+            return decoder.decode(msg.data(), msg.size());
+        }
+    } catch (...) {
+        // Drop on network error
+    }
+    return std::nullopt;
+}
+
+bool receive_frame(zmq::socket_t& socket, zmq::message_t& msg, bool wait) {
+    try {
+        auto flags = wait ? zmq::recv_flags::none : zmq::recv_flags::dontwait;
+        if (!socket.recv(msg, flags)) return false;
+        // The remaining parts of a multipart message are already here
+        while (msg.more()) {
+            if (!socket.recv(msg, zmq::recv_flags::none)) return false;
+        }
+        return true;
+    } catch (...) {
+        // Drop on network error
+    }
+    return false;
+}
+
 zmq::socket_t create_publisher(zmq::context_t& ctx, const std::string& endpoint, bool bind) {
-    zmq::socket_t socket(ctx, zmq::socket_type::pub);
+    zmq::socket_t socket(ctx, zmq::socket_type::xpub);
     socket.set(zmq::sockopt::sndhwm, 10000);
     if (bind) {
+        transport::prepare_bind(endpoint);
         socket.bind(endpoint);
     } else {
         socket.connect(endpoint);
@@ -41,11 +85,13 @@ zmq::socket_t create_publisher(zmq::context_t& ctx, const std::string& endpoint,
     return socket;
 }
 
-zmq::socket_t create_subscriber(zmq::context_t& ctx, const std::string& endpoint, bool bind) {
+zmq::socket_t create_subscriber(zmq::context_t& ctx, const std::string& endpoint, bool bind,
+                                const std::string& topic) {
     zmq::socket_t socket(ctx, zmq::socket_type::sub);
     socket.set(zmq::sockopt::rcvhwm, 10000);
-    socket.set(zmq::sockopt::subscribe, "");
+    socket.set(zmq::sockopt::subscribe, topic);
     if (bind) {
+        transport::prepare_bind(endpoint);
         socket.bind(endpoint);
     } else {
         socket.connect(endpoint);
@@ -53,5 +99,39 @@ zmq::socket_t create_subscriber(zmq::context_t& ctx, const std::string& endpoint
     return socket;
 }
 
+bool wait_for_subscriber(zmq::socket_t& publisher,
+                         std::chrono::milliseconds timeout,
+                         const std::atomic<bool>& running) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (running && std::chrono::steady_clock::now() < deadline) {
+        zmq::pollitem_t items[] = {{publisher.handle(), 0, ZMQ_POLLIN, 0}};
+        try {
+            if (zmq::poll(items, 1, std::chrono::milliseconds(10)) <= 0) continue;
+            zmq::message_t sub;
+            if (!publisher.recv(sub, zmq::recv_flags::dontwait)) continue;
+            // XPUB subscription frames are 0x01 (subscribe) / 0x00 (unsubscribe) + topic
+            if (sub.size() > 0 && static_cast<const uint8_t*>(sub.data())[0] == 1) {
+                return true;
+            }
+        } catch (const zmq::error_t&) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool receive_subscription(zmq::socket_t& publisher, bool& subscribed, std::string& topic) {
+    zmq::message_t sub;
+    try {
+        if (!publisher.recv(sub, zmq::recv_flags::dontwait) || sub.size() == 0) return false;
+    } catch (const zmq::error_t&) {
+        return false;
+    }
+    const auto* data = static_cast<const char*>(sub.data());
+    subscribed = data[0] == 1;
+    topic.assign(data + 1, sub.size() - 1);
+    return true;
+}
+
 } // namespace zmq_utils
 } // namespace surveillance
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "stream_codec.hpp"
 #include <zmq.hpp>
 #include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
 #include <optional>
 #include <string>
 
@@ -11,12 +14,41 @@ namespace zmq_utils {
 // Publish a JSON object to a ZMQ publisher socket
 bool publish_json(zmq::socket_t& socket, const nlohmann::json& payload);
 
+// Publish an already serialized message (newline-terminated JSON)
+bool publish_string(zmq::socket_t& socket, const std::string& payload);
+
+// Same, as a two-part message whose first part is a subscription topic
+bool publish_string(zmq::socket_t& socket, const std::string& topic, const std::string& payload);
+
 // Receive a JSON object from a ZMQ subscriber socket (non-blocking if specified)
 std::optional<nlohmann::json> receive_json(zmq::socket_t& socket, bool wait = false);
 
-// Binds or connects ensuring appropriate timeout settings
+// Receive from a data link that may carry stream-codec frames (see stream_codec.hpp).
+// Also returns nullopt for frames the decoder had to drop.
+std::optional<nlohmann::json> receive_json(zmq::socket_t& socket, codec::StreamDecoder& decoder, bool wait = false);
+
+// Receive one raw frame into `msg` without copying or decoding it. For topic-prefixed
+// messages the topic part is skipped and `msg` holds the payload.
+bool receive_frame(zmq::socket_t& socket, zmq::message_t& msg, bool wait = false);
+
+// Binds or connects ensuring appropriate timeout settings.
+// Publishers are XPUB sockets: they send exactly like PUB but also surface subscriptions,
+// which wait_for_subscriber uses as the readiness signal for the link.
 zmq::socket_t create_publisher(zmq::context_t& ctx, const std::string& endpoint, bool bind);
-zmq::socket_t create_subscriber(zmq::context_t& ctx, const std::string& endpoint, bool bind);
+// Subscribers take everything unless given a `topic`
+zmq::socket_t create_subscriber(zmq::context_t& ctx, const std::string& endpoint, bool bind,
+                                const std::string& topic = "");
+
+// Blocks until a subscriber has connected to the publisher and subscribed, so nothing
+// published afterwards is lost to the ZMQ slow-joiner problem. Returns false on timeout
+// or when `running` turns false.
+bool wait_for_subscriber(zmq::socket_t& publisher,
+                         std::chrono::milliseconds timeout,
+                         const std::atomic<bool>& running);
+
+// Reads one pending (un)subscription from a publisher without blocking. A subscriber
+// that disconnects surfaces as an unsubscription of its topics.
+bool receive_subscription(zmq::socket_t& publisher, bool& subscribed, std::string& topic);
 
 } // namespace zmq_utils
 } // namespace surveillance
@@ -1,5 +1,9 @@
 #include "network_emulator.hpp"
+#include "control.hpp"
 #include "logging.hpp"
+#include "readiness.hpp"
+#include "runtime.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <csignal>
 #include <thread>
@@ -22,10 +26,14 @@ int main(int argc, char** argv) {
     }
 
     auto cfg = config::load(config_path);
-    logging::init("network", cfg.logging.log_dir, cfg.logging.flush_every_n);
+    logging::init("network", cfg.logging);
+    readiness::clear(cfg.logging.log_dir, "network");
+    trace::init("network", cfg.logging.log_dir, cfg.tracing);
+    runtime::configure(cfg.runtime, "network");
     logging::info("Starting network emulator", {{"mode", cfg.system.mode}});
 
     zmq::context_t ctx{1};
+    auto control_listener = control::start(ctx, cfg.logging.control_endpoint, "network");
     network::NetworkEmulator emulator{cfg, ctx};
     emulator.run();
 
@@ -35,7 +43,10 @@ int main(int argc, char** argv) {
 
     emulator.stop();
     
+    control_listener.reset();
     logging::info("Network emulator shutting down");
+    readiness::clear(cfg.logging.log_dir, "network");
+    trace::shutdown();
     logging::shutdown();
     return 0;
 }
@@ -1,20 +1,82 @@
 #include "network_emulator.hpp"
 #include "zmq_utils.hpp"
+#include "hops.hpp"
 #include "time.hpp"
 #include "logging.hpp"
 #include "metrics.hpp"
+#include "readiness.hpp"
+#include "runtime.hpp"
+#include "trace.hpp"
 
 #include <iostream>
 
 namespace surveillance {
 namespace network {
 
+// Roughly 20 s of stress-config traffic; ingress backs off if egress falls this far behind
+constexpr size_t kHandoffCapacity = 1 << 16;
+
+namespace {
+
+constexpr uint64_t kCounterFlushNs = 100'000'000;
+
+// A message count kept by one thread and added to metrics every kCounterFlushNs and when
+// the thread ends, so the message path does not take the metrics lock per message
+class LocalCounter {
+public:
+    explicit LocalCounter(const char* key) : key_(key), flushed_ns_(time::monotonic_ns()) {}
+    ~LocalCounter() { flush(); }
+
+    void increment() { ++pending_; }
+
+    void maybe_flush(uint64_t now_ns) {
+        if (now_ns - flushed_ns_ < kCounterFlushNs) return;
+        flushed_ns_ = now_ns;
+        flush();
+    }
+
+private:
+    void flush() {
+        if (pending_ == 0) return;
+        metrics::add(key_, pending_);
+        pending_ = 0;
+    }
+
+    const char* key_;
+    uint64_t pending_{0};
+    uint64_t flushed_ns_;
+};
+
+} // namespace
+
 NetworkEmulator::NetworkEmulator(const config::AppConfig& cfg, zmq::context_t& ctx)
     : cfg_(cfg),
-      sub_socket_(zmq_utils::create_subscriber(ctx, "tcp://127.0.0.1:7001", true)),
-      pub_socket_(zmq_utils::create_publisher(ctx, "tcp://127.0.0.1:7002", true))
+      sub_socket_(shm::is_shm_endpoint(cfg.transport.sensor_uplink)
+                      ? zmq::socket_t()
+                      : zmq_utils::create_subscriber(ctx, cfg.transport.sensor_uplink, true)),
+      pub_socket_(shm::is_shm_endpoint(cfg.transport.central_feed)
+                      ? zmq::socket_t()
+                      : zmq_utils::create_publisher(ctx, cfg.transport.central_feed, true)),
+      sharded_(cfg.central.shards > 1),
+      shard_ring_(cfg.central.shard_virtual_nodes),
+      handoff_(kHandoffCapacity)
 {
     rng_.seed(cfg_.network.network_seed);
+
+    if (shm::is_shm_endpoint(cfg_.transport.sensor_uplink)) {
+        ingress_ring_ = std::make_unique<shm::RingConsumer>(cfg_.transport.sensor_uplink, cfg_.transport.shm_ring_bytes, "sensor_uplink");
+    }
+    if (shm::is_shm_endpoint(cfg_.transport.central_feed)) {
+        egress_ring_ = std::make_unique<shm::RingProducer>(cfg_.transport.central_feed, "central_feed");
+    }
+
+    if (cfg_.system.mode == "deterministic") {
+        sensor_credits_ = std::make_unique<flow::CreditGrantor>(ctx, cfg_.transport.sensor_credits, cfg_.network.credit_window);
+        central_credits_ = std::make_unique<flow::CreditSender>(ctx, cfg_.transport.central_credits, flow::kEmulatorIdentity);
+    }
+    if (cfg_.network.compression && !sharded_) {
+        egress_encoder_ = std::make_unique<codec::StreamEncoder>("emulator_egress", cfg_.network.keyframe_interval);
+    }
 }
 
 NetworkEmulator::~NetworkEmulator() {
@@ -22,9 +84,29 @@ NetworkEmulator::~NetworkEmulator() {
 }
 
 void NetworkEmulator::stop() {
-    running_ = false;
+    bool was_running = running_.exchange(false);
     if (incoming_thread_.joinable()) incoming_thread_.join();
     if (outgoing_thread_.joinable()) outgoing_thread_.join();
+
+    if (was_running) {
+        ingress_decoder_.flush_metrics();
+        if (egress_encoder_) egress_encoder_->flush_metrics();
+        for (auto& [id, link] : shard_links_) {
+            if (link.encoder) link.encoder->flush_metrics();
+        }
+        logging::info("Stream codec summary", {
+            {"ingress", codec::stats_json("emulator_ingress")},
+            {"egress", codec::stats_json("emulator_egress")}
+        });
+        if (ingress_ring_) {
+            shm::RingStats s = ingress_ring_->stats();
+            logging::info("Ingress ring summary", {
+                {"capacity_bytes", s.capacity_bytes},
+                {"high_watermark_bytes", s.high_watermark_bytes},
+                {"producers", s.producers}
+            });
+        }
+    }
 }
 
 void NetworkEmulator::run() {
@@ -46,20 +128,46 @@ void NetworkEmulator::run() {
 }
 
 void NetworkEmulator::process_incoming() {
+    trace::set_thread_name("ingress");
+    runtime::enter_thread("ingress");
+    LocalCounter received("emulator.received_messages");
+    LocalCounter dropped("emulator.dropped_messages");
     while (running_) {
-        auto msg_opt = zmq_utils::receive_json(sub_socket_, false);
+        if (sensor_credits_) {
+            sensor_credits_->poll();
+        }
+
+        uint64_t rx_start_ns = time::monotonic_ns();
+        received.maybe_flush(rx_start_ns);
+        dropped.maybe_flush(rx_start_ns);
+        auto msg_opt = receive_ingress();
         if (!msg_opt) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (runtime::busy_polling()) {
+                runtime::cpu_relax();
+            } else if (ingress_ring_) {
+                ingress_ring_->wait(std::chrono::milliseconds(1));
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
             continue;
         }
         
-        nlohmann::json msg = *msg_opt;
-        metrics::increment("emulator.received_messages");
+        nlohmann::json msg = std::move(*msg_opt);
+        hops::append(msg, time::monotonic_ns());
+        received.increment();
+        const std::string* trace_id = trace::sampled_event_id(msg);
+        std::string traced = trace_id ? *trace_id : std::string();
+        if (sensor_credits_) {
+            sensor_credits_->on_message(msg.value("node_id", ""));
+        }
 
         // Loss logic (deterministic based on dropped p)
         if (cfg_.system.mode != "deterministic" && cfg_.network.loss_rate > 0.0) {
             if (uniform_dist_(rng_) < cfg_.network.loss_rate) {
-                metrics::increment("emulator.dropped_messages");
+                dropped.increment();
+                if (!traced.empty()) {
+                    trace::record("emulator.dropped", traced, rx_start_ns, time::monotonic_ns());
+                }
                 continue;
             }
         }
@@ -81,40 +189,169 @@ void NetworkEmulator::process_incoming() {
         
         uint64_t delivery_ns = source_time + (uint64_t(latency) * 1000000ULL);
 
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            queue_.push({delivery_ns, msg});
+        QueuedMessage queued{delivery_ns, std::move(msg), time::monotonic_ns()};
+        if (!handoff_.try_push(std::move(queued))) {
+            // Egress is behind; keep ordering and wait rather than drop. Counted once per stall.
+            metrics::increment("emulator.handoff_full_waits");
+            while (!handoff_.try_push(std::move(queued))) {
+                if (!running_) return;
+                std::this_thread::yield();
+            }
+        }
+        if (!traced.empty()) {
+            trace::record("emulator.ingress", traced, rx_start_ns, time::monotonic_ns());
         }
     }
 }
 
 void NetworkEmulator::process_outgoing() {
-     while (running_) {
-        std::vector<nlohmann::json> to_send;
+    trace::set_thread_name("egress");
+    runtime::enter_thread("egress");
+
+    // Hold traffic until central has subscribed; ingress backs up into the handoff ring meanwhile
+    if (sharded_) {
+        while (running_ && shard_ring_.empty()) {
+            poll_shard_membership();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    } else if (egress_ring_) {
+        while (running_ && !egress_ring_->wait_for_consumer(std::chrono::seconds(1), running_)) {
+        }
+        if (running_) {
+            readiness::mark_ready(cfg_.logging.log_dir, "network");
+        }
+    } else {
+        while (running_ && !zmq_utils::wait_for_subscriber(pub_socket_, std::chrono::seconds(1), running_)) {
+        }
+        if (running_) {
+            readiness::mark_ready(cfg_.logging.log_dir, "network");
+        }
+    }
+
+    LocalCounter forwarded("emulator.forwarded_messages");
+    while (running_) {
+        if (sharded_) {
+            poll_shard_membership();
+        }
+        while (auto handed = handoff_.try_pop()) {
+            queue_.push(std::move(*handed));
+        }
+
         uint64_t current_time = time::monotonic_ns();
+        forwarded.maybe_flush(current_time);
+        size_t sent = 0;
+        while (!queue_.empty()) {
+            if (cfg_.system.mode == "deterministic" || queue_.top().delivery_time_ns <= current_time) {
+                if (central_credits_ && !central_credits_->acquire(running_)) {
+                    return; // Stopping
+                }
+                // top() is const; the element is popped right away, so moving it out is safe
+                QueuedMessage next = std::move(const_cast<QueuedMessage&>(queue_.top()));
+                queue_.pop();
 
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            while (!queue_.empty()) {
-                if (cfg_.system.mode == "deterministic" || queue_.top().delivery_time_ns <= current_time) {
-                    to_send.push_back(queue_.top().payload);
-                    queue_.pop();
-                } else {
-                    break;
+                const std::string* trace_id = trace::sampled_event_id(next.payload);
+                if (trace_id) {
+                    // Includes the emulated latency and any wait for credits
+                    trace::record("emulator.delay_queue", *trace_id, next.enqueued_ns, time::monotonic_ns());
                 }
+                {
+                    trace::Span span("emulator.egress", trace_id);
+                    hops::append(next.payload, time::monotonic_ns());
+                    if (sharded_) {
+                        publish_to_shard(next.payload);
+                    } else if (egress_encoder_) {
+                        send_egress(egress_encoder_->encode(next.payload));
+                    } else {
+                        send_egress(next.payload.dump() + "\n");
+                    }
+                }
+                forwarded.increment();
+                ++sent;
+            } else {
+                break;
             }
         }
-        
-        for (const auto& payload : to_send) {
-            zmq_utils::publish_json(pub_socket_, payload);
-            metrics::increment("emulator.forwarded_messages");
+
+        if (sent == 0) {
+            runtime::idle(std::chrono::milliseconds(1));
         }
+    }
+}
+
+std::optional<nlohmann::json> NetworkEmulator::receive_ingress() {
+    if (!ingress_ring_) {
+        return zmq_utils::receive_json(sub_socket_, ingress_decoder_, false);
+    }
+    auto frame = ingress_ring_->peek();
+    if (!frame) return std::nullopt;
+    std::optional<nlohmann::json> msg;
+    try {
+        msg = ingress_decoder_.decode(frame->data(), frame->size());
+    } catch (...) {
+        // Dropped, as receive_json does
+    }
+    ingress_ring_->pop();
+    return msg;
+}
+
+void NetworkEmulator::send_egress(const std::string& payload) {
+    if (egress_ring_) {
+        egress_ring_->send(payload);
+    } else {
+        zmq_utils::publish_string(pub_socket_, payload);
+    }
+}
 
-        if (to_send.empty()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+void NetworkEmulator::poll_shard_membership() {
+    bool subscribed = false;
+    std::string topic;
+    while (zmq_utils::receive_subscription(pub_socket_, subscribed, topic)) {
+        auto id = shard::parse_topic(topic);
+        if (!id || *id >= cfg_.central.shards) {
+            SURV_LOG_RATE(logging::Level::warn, 1, "Ignoring non-shard subscription on sharded egress", {{"topic", topic}});
+            continue;
+        }
+        if (subscribed ? !shard_ring_.add(*id) : !shard_ring_.remove(*id)) {
+            continue;
+        }
+        if (subscribed) {
+            ShardLink link{shard::topic(*id), nullptr};
+            if (cfg_.network.compression) {
+                link.encoder = std::make_unique<codec::StreamEncoder>("emulator_egress", cfg_.network.keyframe_interval);
+            }
+            shard_links_[*id] = std::move(link);
+        } else {
+            auto it = shard_links_.find(*id);
+            if (it != shard_links_.end() && it->second.encoder) it->second.encoder->flush_metrics();
+            shard_links_.erase(*id);
+        }
+        metrics::increment("emulator.shard_rebalances");
+        logging::info(subscribed ? "Central shard joined" : "Central shard left", {
+            {"shard", *id},
+            {"members", shard_ring_.members()}
+        });
+        if (subscribed && shard_ring_.members().size() == static_cast<size_t>(cfg_.central.shards)) {
+            // Every configured shard is up, so the initial assignment is final
+            readiness::mark_ready(cfg_.logging.log_dir, "network");
         }
     }
 }
 
+void NetworkEmulator::publish_to_shard(const nlohmann::json& msg) {
+    auto node_it = msg.find("node_id");
+    std::optional<int> owner;
+    if (node_it != msg.end() && node_it->is_string()) {
+        owner = shard_ring_.owner(node_it->get_ref<const std::string&>());
+    }
+    if (!owner) {
+        // No shard is up (or the message names no node): dropped, like PUB without subscribers
+        metrics::increment("emulator.unrouted_messages");
+        return;
+    }
+    ShardLink& link = shard_links_[*owner];
+    std::string payload = link.encoder ? link.encoder->encode(msg) : msg.dump() + "\n";
+    zmq_utils::publish_string(pub_socket_, link.topic, payload);
+}
+
 } // namespace network
 } // namespace surveillance
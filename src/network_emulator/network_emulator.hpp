@@ -1,26 +1,40 @@
 #pragma once
 
 #include "config.hpp"
+#include "flow_control.hpp"
+#include "shard_ring.hpp"
+#include "shm_ring.hpp"
+#include "spsc_ring.hpp"
+#include "stream_codec.hpp"
 #include <zmq.hpp>
 #include <nlohmann/json.hpp>
+#include <map>
+#include <optional>
 #include <queue>
 #include <thread>
 #include <atomic>
-#include <mutex>
+#include <memory>
 #include <random>
 
 namespace surveillance {
 namespace network {
 
 struct QueuedMessage {
-    uint64_t delivery_time_ns;
+    uint64_t delivery_time_ns{0};
     nlohmann::json payload;
+    uint64_t enqueued_ns{0};
     
     bool operator>(const QueuedMessage& other) const {
         return delivery_time_ns > other.delivery_time_ns;
     }
 };
 
+// Egress state towards one central shard (central.shards > 1)
+struct ShardLink {
+    std::string topic;
+    std::unique_ptr<codec::StreamEncoder> encoder; // network.compression only
+};
+
 class NetworkEmulator {
 public:
     NetworkEmulator(const config::AppConfig& cfg, zmq::context_t& ctx);
@@ -32,16 +46,45 @@ public:
 private:
     void process_incoming();
     void process_outgoing();
+    std::optional<nlohmann::json> receive_ingress();
+    void send_egress(const std::string& payload);
+
+    // Sharded egress: tracks shard subscriptions on the publisher and routes by node_id
+    void poll_shard_membership();
+    void publish_to_shard(const nlohmann::json& msg);
     
     config::AppConfig cfg_;
     zmq::socket_t sub_socket_;
     zmq::socket_t pub_socket_;
 
+    // shm:// links replace the sockets above (transport.kind "shm")
+    std::unique_ptr<shm::RingConsumer> ingress_ring_;
+    std::unique_ptr<shm::RingProducer> egress_ring_;
+
+    // Deterministic mode only: credits granted to sensors, and credits held towards central
+    std::unique_ptr<flow::CreditGrantor> sensor_credits_;
+    std::unique_ptr<flow::CreditSender> central_credits_;
+
+    // Sensor frames are decoded on ingress and re-encoded on egress, after the loss
+    // emulation, so emulated drops never desynchronize central's decoder.
+    codec::StreamDecoder ingress_decoder_{"emulator_ingress"};
+    std::unique_ptr<codec::StreamEncoder> egress_encoder_; // network.compression only
+
+    // Sharded mode, egress thread only. A shard joins when it subscribes to its topic
+    // and leaves when it unsubscribes or disconnects; each has its own encoder, so a
+    // node that moves to another shard starts there with a keyframe.
+    bool sharded_{false};
+    shard::Ring shard_ring_;
+    std::map<int, ShardLink> shard_links_;
+
     std::mt19937_64 rng_;
     std::uniform_real_distribution<double> uniform_dist_{0.0, 1.0};
     
+    // Ingress -> egress handoff. Ingress is the only producer, egress the only consumer.
+    spsc::Ring<QueuedMessage> handoff_;
+
+    // Delay scheduler, owned exclusively by the egress thread
     std::priority_queue<QueuedMessage, std::vector<QueuedMessage>, std::greater<QueuedMessage>> queue_;
-    std::mutex queue_mutex_;
 
     std::atomic<bool> running_{true};
     std::thread incoming_thread_;
@@ -0,0 +1,275 @@
+#include "alert_index.hpp"
+#include "segmented_file.hpp"
+#include "time.hpp"
+
+#include <nlohmann/json.hpp>
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace surveillance {
+namespace ui {
+
+namespace {
+
+constexpr auto kPollInterval = std::chrono::milliseconds(250);
+
+std::string node_key(const std::string& node) { return "n\x1f" + node; }
+std::string class_key(const std::string& cls) { return "c\x1f" + cls; }
+std::string both_key(const std::string& node, const std::string& cls) { return "b\x1f" + node + "\x1f" + cls; }
+
+// False for a torn or foreign line
+bool parse_alert(std::string line, uint64_t& utc_ms, std::string& node, std::string& cls, std::string& text) {
+    auto j = nlohmann::json::parse(line, nullptr, false);
+    if (!j.is_object()) return false;
+    utc_ms = time::parse_utc_ms(j.value("timestamp_utc", ""));
+    node = j.value("source_node_id", "");
+    cls = j.value("classification", "");
+    text = std::move(line);
+    return true;
+}
+
+// Whole file, through zlib so closed segments may be gzipped or not
+std::string read_segment(const std::string& path) {
+    std::string data;
+    gzFile in = gzopen(path.c_str(), "rb");
+    if (!in) return data;
+    gzbuffer(in, 1 << 17);
+    char buf[1 << 16];
+    int n;
+    while ((n = gzread(in, buf, sizeof(buf))) > 0) {
+        data.append(buf, static_cast<size_t>(n));
+    }
+    gzclose(in);
+    return data;
+}
+
+// First complete line with its newline; empty while it is still being written
+std::string first_line(std::ifstream& f) {
+    f.clear();
+    f.seekg(0);
+    std::string line;
+    if (!std::getline(f, line) || f.eof()) return {};
+    return line + '\n';
+}
+
+} // namespace
+
+AlertIndex::AlertIndex(std::vector<std::string> files, size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+    for (auto& path : files) {
+        Source src;
+        src.path = std::move(path);
+        sources_.push_back(std::move(src));
+    }
+    load_history();
+    refresh();
+    thread_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(poll_mutex_);
+        while (!poll_cv_.wait_for(lock, kPollInterval, [this] { return stopping_; })) {
+            lock.unlock();
+            refresh();
+            lock.lock();
+        }
+    });
+}
+
+AlertIndex::~AlertIndex() {
+    {
+        std::lock_guard<std::mutex> lock(poll_mutex_);
+        stopping_ = true;
+    }
+    poll_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void AlertIndex::load_history() {
+    // Newest segments first, until they hold enough alerts to fill the history
+    std::vector<Alert> alerts;
+    for (const auto& src : sources_) {
+        auto segments = segments::SegmentedFile::find(src.path, 0, std::numeric_limits<uint64_t>::max());
+        if (!segments.empty() && segments.back() == src.path) segments.pop_back(); // tailed by refresh()
+        size_t lines = 0;
+        std::vector<std::vector<Alert>> newest_first;
+        for (auto it = segments.rbegin(); it != segments.rend() && lines < capacity_; ++it) {
+            std::vector<Alert> seg;
+            const std::string data = read_segment(*it);
+            size_t pos = 0;
+            while (pos < data.size()) {
+                size_t end = data.find('\n', pos);
+                if (end == std::string::npos) end = data.size();
+                Alert a;
+                if (end > pos && parse_alert(data.substr(pos, end - pos), a.utc_ms, a.node_id, a.classification, a.text)) {
+                    seg.push_back(std::move(a));
+                }
+                pos = end + 1;
+            }
+            lines += seg.size();
+            newest_first.push_back(std::move(seg));
+        }
+        for (auto it = newest_first.rbegin(); it != newest_first.rend(); ++it) {
+            std::move(it->begin(), it->end(), std::back_inserter(alerts));
+        }
+    }
+    if (sources_.size() > 1) {
+        std::stable_sort(alerts.begin(), alerts.end(), [](const Alert& a, const Alert& b) { return a.utc_ms < b.utc_ms; });
+    }
+    if (alerts.size() > capacity_) {
+        alerts.erase(alerts.begin(), alerts.end() - static_cast<std::ptrdiff_t>(capacity_));
+    }
+    add(alerts);
+}
+
+void AlertIndex::read_new(Source& src, std::vector<Alert>& out) {
+    auto drain = [&] {
+        src.in.clear();
+        std::string data(std::istreambuf_iterator<char>(src.in), {});
+        if (data.empty()) return;
+        data.insert(0, src.partial);
+        src.partial.clear();
+        size_t pos = 0;
+        for (size_t end; (end = data.find('\n', pos)) != std::string::npos; pos = end + 1) {
+            Alert a;
+            if (end > pos && parse_alert(data.substr(pos, end - pos), a.utc_ms, a.node_id, a.classification, a.text)) {
+                out.push_back(std::move(a));
+            }
+        }
+        src.partial = data.substr(pos);
+    };
+
+    // The rest of the file we have open, even if it was renamed away since
+    if (src.in.is_open()) drain();
+
+    std::ifstream probe(src.path, std::ios::binary);
+    if (!probe.is_open()) return; // not created yet, or between rotation and the new segment
+    const std::string head = first_line(probe);
+    if (src.in.is_open() && (src.head.empty() || head == src.head)) {
+        if (src.head.empty()) src.head = head;
+        return;
+    }
+    // First call, or a rotation put a new file under the name. Lines can have reached
+    // the old file after the drain above and before its rename, so drain it once more.
+    if (src.in.is_open()) drain();
+    src.in = std::move(probe);
+    src.in.clear();
+    src.in.seekg(0);
+    src.head = head;
+    src.partial.clear();
+    drain();
+}
+
+void AlertIndex::refresh() {
+    std::vector<Alert> batch;
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        for (auto& src : sources_) read_new(src, batch);
+    }
+    if (batch.empty()) return;
+    if (sources_.size() > 1) {
+        std::stable_sort(batch.begin(), batch.end(), [](const Alert& a, const Alert& b) { return a.utc_ms < b.utc_ms; });
+    }
+    add(batch);
+}
+
+void AlertIndex::add(std::vector<Alert>& batch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t seq = next_seq_.load(std::memory_order_relaxed);
+    for (auto& a : batch) {
+        const uint64_t order_ms = history_.empty() ? a.utc_ms : std::max(a.utc_ms, history_.back().order_ms);
+        if (order_ms > a.utc_ms) ++lateness_[order_ms - a.utc_ms];
+        by_key_[node_key(a.node_id)].push_back(seq);
+        by_key_[class_key(a.classification)].push_back(seq);
+        by_key_[both_key(a.node_id, a.classification)].push_back(seq);
+        history_.push_back({seq, a.utc_ms, order_ms, std::move(a.node_id), std::move(a.classification), std::move(a.text)});
+        ++seq;
+
+        if (history_.size() > capacity_) {
+            // The oldest alert is at the front of each of its lists
+            const Entry& old = history_.front();
+            for (const auto& key : {node_key(old.node_id), class_key(old.classification),
+                                    both_key(old.node_id, old.classification)}) {
+                auto it = by_key_.find(key);
+                it->second.pop_front();
+                if (it->second.empty()) by_key_.erase(it);
+            }
+            if (old.order_ms > old.utc_ms) {
+                auto it = lateness_.find(old.order_ms - old.utc_ms);
+                if (--it->second == 0) lateness_.erase(it);
+            }
+            history_.pop_front();
+        }
+    }
+    next_seq_.store(seq, std::memory_order_release);
+}
+
+const std::deque<uint64_t>* AlertIndex::list_for(const Query& q) const {
+    std::string key;
+    if (!q.node_id.empty() && !q.classification.empty()) {
+        key = both_key(q.node_id, q.classification);
+    } else if (!q.node_id.empty()) {
+        key = node_key(q.node_id);
+    } else {
+        key = class_key(q.classification);
+    }
+    auto it = by_key_.find(key);
+    return it == by_key_.end() ? nullptr : &it->second;
+}
+
+AlertIndex::Page AlertIndex::query(const Query& q) const {
+    Page page;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (history_.empty() || q.limit == 0 || q.since_ms > q.until_ms) return page;
+
+    // Candidates are the sequence numbers [begin, end): time bounds by binary search over
+    // the history, then the cursor. order_ms is never below utc_ms, and exceeds it by at
+    // most the largest lateness held, so the range covers every match; alerts in it whose
+    // own timestamp falls outside the window are skipped below.
+    const uint64_t first = history_.front().seq;
+    const uint64_t max_late_ms = lateness_.empty() ? 0 : lateness_.rbegin()->first;
+    const uint64_t until_order_ms = q.until_ms > std::numeric_limits<uint64_t>::max() - max_late_ms
+                                        ? std::numeric_limits<uint64_t>::max()
+                                        : q.until_ms + max_late_ms;
+    auto lo = std::lower_bound(history_.begin(), history_.end(), q.since_ms,
+                               [](const Entry& e, uint64_t ms) { return e.order_ms < ms; });
+    auto hi = std::upper_bound(lo, history_.end(), until_order_ms,
+                               [](uint64_t ms, const Entry& e) { return ms < e.order_ms; });
+    const uint64_t begin = first + static_cast<uint64_t>(lo - history_.begin());
+    uint64_t end = first + static_cast<uint64_t>(hi - history_.begin());
+    if (q.cursor != 0) end = std::min(end, q.cursor);
+    if (begin >= end) return page;
+
+    auto entry = [&](uint64_t seq) -> const Entry& { return history_[seq - first]; };
+    // Walks seqs newest first; the cursor is only set once another match is known to exist
+    auto visit = [&](uint64_t seq) {
+        const Entry& e = entry(seq);
+        if (e.utc_ms < q.since_ms || e.utc_ms > q.until_ms) return true;
+        if (page.alerts.size() == q.limit) {
+            page.next_cursor = seq + 1;
+            return false;
+        }
+        page.alerts.push_back(e.text);
+        return true;
+    };
+
+    if (q.node_id.empty() && q.classification.empty()) {
+        uint64_t seq = end;
+        while (seq > begin && visit(seq - 1)) --seq;
+        return page;
+    }
+
+    const auto* list = list_for(q);
+    if (!list) return page;
+    auto a = std::lower_bound(list->begin(), list->end(), begin);
+    auto b = std::lower_bound(a, list->end(), end);
+    while (b != a && visit(*(b - 1))) --b;
+    return page;
+}
+
+size_t AlertIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return history_.size();
+}
+
+} // namespace ui
+} // namespace surveillance
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace surveillance {
+namespace ui {
+
+// Queryable history of the alerts central has written, behind /api/alerts.
+//
+// A background thread tails alerts.jsonl (every shard's alerts_<k>.jsonl when
+// central.shards > 1) and keeps the newest `capacity` alerts, each numbered in arrival
+// order. On startup the history is filled from the closed segments as well. Per node,
+// per classification and per (node, classification) the index keeps the numbers of
+// that key's alerts, so a filtered query reads only matching alerts: it costs a binary
+// search plus the page it returns, however long the history is. Queries never touch
+// the files.
+//
+// Time filters match the alert's timestamp_utc exactly. Pages list alerts newest
+// first in arrival order, which is time order except for alerts that arrive late (an
+// earlier timestamp than one already indexed). The history is searched on the running
+// maximum of the timestamps, widened by the largest lateness still held, and the edges
+// of that range are checked against each alert's own timestamp.
+class AlertIndex {
+public:
+    struct Query {
+        uint64_t since_ms{0};                                     // inclusive
+        uint64_t until_ms{std::numeric_limits<uint64_t>::max()};  // inclusive
+        std::string node_id;                                      // empty: any
+        std::string classification;                               // empty: any
+        size_t limit{100};
+        uint64_t cursor{0}; // next_cursor of the previous page; 0 starts at the newest
+    };
+
+    struct Page {
+        std::vector<std::string> alerts; // JSON objects, newest first
+        uint64_t next_cursor{0};         // 0 when no older alert matches
+    };
+
+    AlertIndex(std::vector<std::string> files, size_t capacity);
+    ~AlertIndex();
+
+    AlertIndex(const AlertIndex&) = delete;
+    AlertIndex& operator=(const AlertIndex&) = delete;
+
+    Page query(const Query& q) const;
+
+    // Changes whenever an alert is added
+    uint64_t version() const { return next_seq_.load(std::memory_order_acquire); }
+    size_t size() const;
+
+    // Reads what was appended to the files since the last call; the background thread
+    // calls this every 250 ms
+    void refresh();
+
+private:
+    struct Alert {
+        uint64_t utc_ms{0};
+        std::string node_id;
+        std::string classification;
+        std::string text;
+    };
+
+    struct Entry {
+        uint64_t seq;
+        uint64_t utc_ms;
+        uint64_t order_ms; // max timestamp so far, so the history is sorted on it
+        std::string node_id;
+        std::string classification;
+        std::string text;
+    };
+
+    // One tailed file. The stream stays open across a rotation, so the lines written to
+    // the old segment before the rename are still read before switching to the new file.
+    struct Source {
+        std::string path;
+        std::ifstream in;
+        std::string head;    // first line, to tell a new file under the same name
+        std::string partial; // last line, still being written
+    };
+
+    void load_history();
+    void read_new(Source& src, std::vector<Alert>& out);
+    void add(std::vector<Alert>& batch);
+    const std::deque<uint64_t>* list_for(const Query& q) const;
+
+    const size_t capacity_;
+    std::mutex refresh_mutex_;
+    std::vector<Source> sources_; // under refresh_mutex_
+
+    mutable std::mutex mutex_;
+    std::deque<Entry> history_;
+    std::unordered_map<std::string, std::deque<uint64_t>> by_key_; // key -> seqs, ascending
+    std::map<uint64_t, size_t> lateness_; // order_ms - utc_ms -> alerts held, late ones only
+    std::atomic<uint64_t> next_seq_{1};
+
+    std::mutex poll_mutex_;
+    std::condition_variable poll_cv_;
+    bool stopping_{false};
+    std::thread thread_;
+};
+
+} // namespace ui
+} // namespace surveillance
@@ -1,5 +1,7 @@
 #include "ui_server.hpp"
+#include "control.hpp"
 #include "logging.hpp"
+#include "readiness.hpp"
 #include <iostream>
 #include <csignal>
 #include <thread>
@@ -27,9 +29,13 @@ int main(int argc, char** argv) {
     }
 
     auto cfg = config::load(config_path);
-    logging::init("ui", cfg.logging.log_dir, cfg.logging.flush_every_n);
+    logging::init("ui", cfg.logging);
+    readiness::clear(cfg.logging.log_dir, "ui");
     logging::info("Starting operator UI");
 
+    zmq::context_t ctx{1};
+    auto control_listener = control::start(ctx, cfg.logging.control_endpoint, "ui");
+
     ui::UIServer server{cfg, static_dir};
     server.run();
 
@@ -39,7 +45,9 @@ int main(int argc, char** argv) {
 
     server.stop();
     
+    control_listener.reset();
     logging::info("Operator UI shutting down");
+    readiness::clear(cfg.logging.log_dir, "ui");
     logging::shutdown();
     return 0;
 }
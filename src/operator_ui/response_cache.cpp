@@ -0,0 +1,230 @@
+#include "response_cache.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace surveillance {
+namespace ui {
+
+namespace {
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Size and modification time of each source; `newest_s` gets the latest mtime in Unix seconds
+uint64_t fingerprint(const std::vector<std::string>& sources, int64_t& newest_s) {
+    uint64_t hash = fnv1a("", 0);
+    newest_s = 0;
+    for (const auto& path : sources) {
+        std::error_code ec;
+        const auto mtime = fs::last_write_time(path, ec);
+        const uint64_t size = ec ? 0 : fs::file_size(path, ec);
+        const int64_t ticks = ec ? -1 : static_cast<int64_t>(mtime.time_since_epoch().count());
+        hash = fnv1a(&size, sizeof(size), hash);
+        hash = fnv1a(&ticks, sizeof(ticks), hash);
+        if (!ec) {
+            auto sys = std::chrono::file_clock::to_sys(mtime);
+            newest_s = std::max<int64_t>(newest_s, std::chrono::duration_cast<std::chrono::seconds>(sys.time_since_epoch()).count());
+        }
+    }
+    return hash;
+}
+
+int64_t unix_now_s() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string http_date(int64_t unix_s) {
+    std::time_t t = static_cast<std::time_t>(unix_s);
+    std::tm tm{};
+#if defined(_WIN32)
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buf[64];
+    std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buf;
+}
+
+std::string gzip(const std::string& in) {
+    z_stream zs{};
+    // windowBits 15 + 16 writes a gzip header and trailer instead of zlib's
+    if (deflateInit2(&zs, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return {};
+    std::string out(deflateBound(&zs, static_cast<uLong>(in.size())) + 32, '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    const int rc = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return rc == Z_STREAM_END ? out : std::string();
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Weak comparison (RFC 9110 §13.1.2): W/ prefixes are ignored
+bool etag_matches(const std::string& if_none_match, const std::string& etag, const std::string& gzip_etag) {
+    std::string_view rest(if_none_match);
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        std::string_view tag = trim(rest.substr(0, comma));
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        if (tag == "*") return true;
+        if (tag.substr(0, 2) == "W/") tag.remove_prefix(2);
+        if (tag == etag || (!gzip_etag.empty() && tag == gzip_etag)) return true;
+    }
+    return false;
+}
+
+// gzip listed without q=0
+bool accepts_gzip(const std::string& accept_encoding) {
+    std::string_view rest(accept_encoding);
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        std::string_view item = trim(rest.substr(0, comma));
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        const size_t semi = item.find(';');
+        std::string_view coding = trim(item.substr(0, semi));
+        if (coding != "gzip" && coding != "*") continue;
+        if (semi == std::string_view::npos) return true;
+        std::string_view params = trim(item.substr(semi + 1));
+        if (params.substr(0, 2) != "q=") return true;
+        return std::strtod(std::string(params.substr(2)).c_str(), nullptr) > 0.0;
+    }
+    return false;
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(size_t gzip_min_bytes) : gzip_min_bytes_(gzip_min_bytes) {}
+
+void ResponseCache::add(const std::string& path, std::string content_type, std::vector<std::string> sources,
+                        Builder build) {
+    auto r = std::make_unique<Resource>();
+    r->content_type = std::move(content_type);
+    r->sources = std::move(sources);
+    r->build = std::move(build);
+    resources_[path] = std::move(r);
+}
+
+void ResponseCache::add(const std::string& path, std::string content_type, std::function<uint64_t()> version,
+                        Builder build) {
+    auto r = std::make_unique<Resource>();
+    r->content_type = std::move(content_type);
+    r->version = std::move(version);
+    r->build = std::move(build);
+    resources_[path] = std::move(r);
+}
+
+std::shared_ptr<const ResponseCache::Version> ResponseCache::current(Resource& r, uint64_t fingerprint, int64_t mtime_s, bool& built) {
+    built = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (r.current && r.current->fingerprint == fingerprint) return r.current;
+    }
+    std::lock_guard<std::mutex> build_lock(r.build_mutex);
+    {
+        // Another request may have built this version while we waited
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (r.current && r.current->fingerprint == fingerprint) return r.current;
+    }
+
+    auto v = std::make_shared<Version>();
+    v->fingerprint = fingerprint;
+    auto body = std::make_shared<std::string>(r.build());
+    char tag[24];
+    std::snprintf(tag, sizeof(tag), "%016llx", static_cast<unsigned long long>(fnv1a(body->data(), body->size())));
+    v->etag = "\"" + std::string(tag) + "\"";
+    if (body->size() >= gzip_min_bytes_) {
+        std::string compressed = gzip(*body);
+        if (!compressed.empty() && compressed.size() < body->size()) {
+            v->gzip_body = std::make_shared<const std::string>(std::move(compressed));
+            v->gzip_etag = "\"" + std::string(tag) + "-gz\"";
+        }
+    }
+    v->body = std::move(body);
+    v->last_modified_s = mtime_s != 0 ? mtime_s : unix_now_s();
+    v->last_modified = http_date(v->last_modified_s);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    r.current = v;
+    ++stats_.builds;
+    built = true;
+    return v;
+}
+
+ResponseCache::Reply ResponseCache::get(const std::string& path, const std::string& if_none_match,
+                                        const std::string& if_modified_since, const std::string& accept_encoding) {
+    Reply reply;
+    auto it = resources_.find(path);
+    if (it == resources_.end()) {
+        reply.status = 404;
+        return reply;
+    }
+    Resource& r = *it->second;
+
+    int64_t mtime_s = 0; // Last-Modified is the build time for versioned content
+    const uint64_t fp = r.version ? r.version() : fingerprint(r.sources, mtime_s);
+    bool built = false;
+    auto v = current(r, fp, mtime_s, built);
+
+    const bool gz = v->gzip_body && accepts_gzip(accept_encoding);
+    reply.content_type = r.content_type;
+    reply.headers.emplace_back("ETag", gz ? v->gzip_etag : v->etag);
+    reply.headers.emplace_back("Last-Modified", v->last_modified);
+    // Cacheable, but revalidated on every poll
+    reply.headers.emplace_back("Cache-Control", "no-cache");
+    reply.headers.emplace_back("Vary", "Accept-Encoding");
+
+    // If-Modified-Since only counts without If-None-Match, as an exact match, and once the
+    // second Last-Modified names is over: until then the sources can change again unseen
+    bool not_modified = false;
+    if (!if_none_match.empty()) {
+        not_modified = etag_matches(if_none_match, v->etag, v->gzip_etag);
+    } else if (!if_modified_since.empty() && if_modified_since == v->last_modified) {
+        not_modified = v->last_modified_s < unix_now_s();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (not_modified) {
+        reply.status = 304;
+        ++stats_.not_modified;
+        return reply;
+    }
+    reply.body = gz ? v->gzip_body : v->body;
+    if (gz) {
+        reply.headers.emplace_back("Content-Encoding", "gzip");
+        ++stats_.gzip_replies;
+    }
+    if (!built) ++stats_.hits;
+    return reply;
+}
+
+ResponseCache::Stats ResponseCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace ui
+} // namespace surveillance
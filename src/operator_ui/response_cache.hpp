@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace surveillance {
+namespace ui {
+
+// Cached HTTP representations of the UI's endpoints.
+//
+// Each resource is built from files on disk, and its version is a fingerprint of
+// those files (size and modification time), taken with one stat per file per request.
+// Central replaces its state file with a write-then-rename, so every write changes it.
+// While the version holds, requests are answered from memory: an If-None-Match naming
+// the current ETag gets 304, and clients that accept gzip get a variant compressed once
+// per version. A new version is built once; concurrent requests wait for that build
+// instead of repeating it.
+class ResponseCache {
+public:
+    // The body of a resource, rebuilt when its version changes
+    using Builder = std::function<std::string()>;
+
+    struct Reply {
+        int status{200};                          // 200, 304, or 404 for an unknown path
+        std::shared_ptr<const std::string> body;  // null unless 200
+        std::string content_type;
+        std::vector<std::pair<std::string, std::string>> headers;
+    };
+
+    explicit ResponseCache(size_t gzip_min_bytes);
+
+    // `sources` are the files `build` reads; a resource without sources is built once
+    void add(const std::string& path, std::string content_type, std::vector<std::string> sources, Builder build);
+    // For content that is not read from files: `version` is called on every request and
+    // changes whenever the content does
+    void add(const std::string& path, std::string content_type, std::function<uint64_t()> version, Builder build);
+
+    // Reply for `path` given the request's If-None-Match, If-Modified-Since and
+    // Accept-Encoding headers (empty when absent)
+    Reply get(const std::string& path, const std::string& if_none_match, const std::string& if_modified_since,
+              const std::string& accept_encoding);
+
+    struct Stats {
+        uint64_t hits{0};         // 200 from memory
+        uint64_t not_modified{0}; // 304
+        uint64_t builds{0};
+        uint64_t gzip_replies{0};
+    };
+    Stats stats() const;
+
+private:
+    // Immutable once published
+    struct Version {
+        uint64_t fingerprint{0};
+        std::shared_ptr<const std::string> body;
+        std::shared_ptr<const std::string> gzip_body; // null below gzip_min_bytes
+        std::string etag;      // of the identity body
+        std::string gzip_etag; // of the gzip variant; validators differ per encoding
+        int64_t last_modified_s{0};
+        std::string last_modified;
+    };
+
+    struct Resource {
+        std::string content_type;
+        std::vector<std::string> sources;
+        std::function<uint64_t()> version; // instead of sources
+        Builder build;
+        std::mutex build_mutex; // one build at a time
+        std::shared_ptr<const Version> current; // under ResponseCache::mutex_
+    };
+
+    // `built` is set when this call built the version rather than finding it in memory
+    std::shared_ptr<const Version> current(Resource& r, uint64_t fingerprint, int64_t mtime_s, bool& built);
+
+    size_t gzip_min_bytes_;
+    std::map<std::string, std::unique_ptr<Resource>> resources_; // fixed after setup
+    mutable std::mutex mutex_;
+    Stats stats_;
+};
+
+} // namespace ui
+} // namespace surveillance
@@ -0,0 +1,119 @@
+#include "shard_aggregator.hpp"
+#include "shard_ring.hpp"
+#include "time.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace surveillance {
+namespace ui {
+
+namespace {
+
+nlohmann::json read_json(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) return nullptr;
+    return nlohmann::json::parse(f, nullptr, false);
+}
+
+void add_numbers(nlohmann::json& into, const nlohmann::json& from) {
+    if (!from.is_object()) return;
+    for (const auto& [key, value] : from.items()) {
+        if (value.is_number_unsigned()) {
+            into[key] = into.value(key, uint64_t{0}) + value.get<uint64_t>();
+        }
+    }
+}
+
+} // namespace
+
+ShardAggregator::ShardAggregator(const config::AppConfig& cfg) : cfg_(cfg) {}
+
+nlohmann::json ShardAggregator::state() const {
+    const uint64_t now_ms = time::utc_now_ms();
+
+    nlohmann::json nodes = nlohmann::json::object();
+    nlohmann::json metrics = nlohmann::json::object();
+    nlohmann::json ingest = {{"overloaded", false}, {"depth", 0}, {"capacity", 0}, {"dropped", nlohmann::json::object()}};
+    nlohmann::json codec = nlohmann::json::object();
+    nlohmann::json shards = nlohmann::json::array();
+    std::vector<nlohmann::json> alerts;
+    double codec_ratio_sum = 0.0;
+    double codec_ns_sum = 0.0;
+
+    for (int k = 0; k < cfg_.central.shards; ++k) {
+        nlohmann::json st = read_json(cfg_.logging.log_dir + "/central_state" + shard::suffix(k) + ".json");
+        if (!st.is_object()) {
+            shards.push_back({{"shard", k}, {"up", false}});
+            continue;
+        }
+        // A shard that stopped writing its state is down, whatever the file says
+        const uint64_t written_ms = st.value("written_utc_ms", uint64_t{0});
+        const double state_age_s = now_ms > written_ms ? (now_ms - written_ms) / 1000.0 : 0.0;
+
+        const auto shard_nodes = st.value("nodes", nlohmann::json::object());
+        for (const auto& [node_id, node] : shard_nodes.items()) {
+            nlohmann::json entry = node;
+            entry["last_seen_age_s"] = node.value("last_seen_age_s", 0.0) + state_age_s;
+            entry["shard"] = k;
+            auto it = nodes.find(node_id);
+            if (it == nodes.end() || entry["last_seen_age_s"].get<double>() < (*it)["last_seen_age_s"].get<double>()) {
+                nodes[node_id] = std::move(entry);
+            }
+        }
+
+        add_numbers(metrics, st.value("metrics", nlohmann::json::object()));
+
+        const auto shard_ingest = st.value("ingest", nlohmann::json::object());
+        ingest["overloaded"] = ingest["overloaded"].get<bool>() || shard_ingest.value("overloaded", false);
+        ingest["depth"] = ingest["depth"].get<uint64_t>() + shard_ingest.value("depth", uint64_t{0});
+        ingest["capacity"] = ingest["capacity"].get<uint64_t>() + shard_ingest.value("capacity", uint64_t{0});
+        add_numbers(ingest["dropped"], shard_ingest.value("dropped", nlohmann::json::object()));
+
+        // Counters add up; the derived ratios are weighted by each shard's message count
+        const auto shard_codec = st.value("codec", nlohmann::json::object());
+        add_numbers(codec, shard_codec);
+        const double messages = static_cast<double>(shard_codec.value("messages", uint64_t{0}));
+        codec_ratio_sum += shard_codec.value("compression_ratio", 1.0) * messages;
+        codec_ns_sum += shard_codec.value("ns_per_message", 0.0) * messages;
+
+        for (auto& alert : st.value("recent_alerts", nlohmann::json::array())) {
+            alerts.push_back(std::move(alert));
+        }
+
+        shards.push_back({
+            {"shard", k},
+            {"up", state_age_s <= cfg_.central.heartbeat_timeout_s},
+            {"state_age_s", state_age_s},
+            {"nodes", shard_nodes.size()},
+            {"ingest", shard_ingest},
+            {"codec", shard_codec},
+            {"latency_histograms", st.value("latency_histograms", nlohmann::json::object())}
+        });
+    }
+
+    const double total_messages = static_cast<double>(codec.value("messages", uint64_t{0}));
+    codec["compression_ratio"] = total_messages > 0 ? codec_ratio_sum / total_messages : 1.0;
+    codec["ns_per_message"] = total_messages > 0 ? codec_ns_sum / total_messages : 0.0;
+
+    // Newest first, as each shard publishes them; the fixed-width UTC strings sort by time
+    std::stable_sort(alerts.begin(), alerts.end(), [](const nlohmann::json& a, const nlohmann::json& b) {
+        return a.value("timestamp_utc", "") > b.value("timestamp_utc", "");
+    });
+    if (alerts.size() > static_cast<size_t>(std::max(0, cfg_.central.alerts_buffer))) {
+        alerts.resize(static_cast<size_t>(std::max(0, cfg_.central.alerts_buffer)));
+    }
+
+    return {
+        {"nodes", std::move(nodes)},
+        {"metrics", std::move(metrics)},
+        {"ingest", std::move(ingest)},
+        {"codec", std::move(codec)},
+        {"recent_alerts", std::move(alerts)},
+        {"shards", std::move(shards)}
+    };
+}
+
+} // namespace ui
+} // namespace surveillance
@@ -0,0 +1,29 @@
+#pragma once
+#include "config.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace surveillance {
+namespace ui {
+
+// Merged view of a sharded central tier (central.shards > 1) for the operator UI.
+//
+// Every shard writes its own central_state_<k>.json and alerts_<k>.jsonl. state()
+// folds the shard states into the central_state.json shape the UI already reads;
+// AlertIndex merges the alert files. Nothing is kept between calls; each call reads
+// the shards' files afresh.
+class ShardAggregator {
+public:
+    explicit ShardAggregator(const config::AppConfig& cfg);
+
+    // Nodes take the entry of the shard that heard from them last (a node that moved
+    // shows as FAILED in its old shard), counters are summed, and per-shard ingest,
+    // codec and latency histograms are kept under "shards"
+    nlohmann::json state() const;
+
+private:
+    config::AppConfig cfg_;
+};
+
+} // namespace ui
+} // namespace surveillance
@@ -1,5 +1,6 @@
 document.addEventListener('DOMContentLoaded', () => {
     const statusIndicator = document.getElementById('connection-status');
+    const ingestIndicator = document.getElementById('ingest-status');
     const metricsContainer = document.getElementById('metrics-container');
     const nodesBody = document.querySelector('#nodes-table tbody');
     const alertsBody = document.querySelector('#alerts-table tbody');
@@ -18,6 +19,7 @@ document.addEventListener('DOMContentLoaded', () => {
                 const state = await statusRes.json();
                 const alerts = await alertsRes.json();
 
+                renderIngest(state.ingest);
                 renderMetrics(state.metrics || {});
                 renderNodes(state.nodes || {});
                 renderAlerts(alerts || []);
@@ -30,6 +32,20 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     }
 
+    function renderIngest(ingest) {
+        if (!ingest) {
+            ingestIndicator.textContent = 'Ingest: --';
+            ingestIndicator.className = 'status-indicator';
+            return;
+        }
+        const dropped = Object.entries(ingest.dropped || {})
+            .map(([cls, n]) => `${cls}=${n}`)
+            .join(' ');
+        ingestIndicator.textContent = `Ingest: ${ingest.overloaded ? 'OVERLOAD' : 'OK'} (${ingest.depth}/${ingest.capacity})`;
+        ingestIndicator.title = `Dropped per class: ${dropped}`;
+        ingestIndicator.className = 'status-indicator ' + (ingest.overloaded ? 'overloaded' : 'connected');
+    }
+
     function renderMetrics(metrics) {
         metricsContainer.innerHTML = '';
         for (const [key, value] of Object.entries(metrics)) {
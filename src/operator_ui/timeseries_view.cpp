@@ -0,0 +1,185 @@
+#include "timeseries_view.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace surveillance {
+namespace ui {
+
+namespace {
+
+const char* const kCounts[] = {"events", "lost"};
+
+// Size and modification time of every file
+uint64_t fingerprint(const std::vector<std::string>& files) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (v >> (i * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (const auto& path : files) {
+        std::error_code ec;
+        const auto mtime = fs::last_write_time(path, ec);
+        mix(ec ? 0 : fs::file_size(path, ec));
+        mix(ec ? ~0ULL : static_cast<uint64_t>(mtime.time_since_epoch().count()));
+    }
+    return hash;
+}
+
+// `into` += `from`, aligned on time: the merged window ends at the later of the two
+// and keeps the longer one's length
+void merge_series(nlohmann::json& into, const nlohmann::json& from) {
+    const int64_t step = into.value("step_s", int64_t{1});
+    if (from.value("step_s", int64_t{0}) != step || step <= 0) return;
+    auto slots = [](const nlohmann::json& series) {
+        auto it = series.find("events");
+        return it == series.end() ? size_t{0} : it->size();
+    };
+    const size_t len_a = slots(into);
+    const size_t len_b = slots(from);
+    const int64_t end_a = into.value("start_s", int64_t{0}) + static_cast<int64_t>(len_a) * step;
+    const int64_t end_b = from.value("start_s", int64_t{0}) + static_cast<int64_t>(len_b) * step;
+    const size_t len = std::max(len_a, len_b);
+    const int64_t start = std::max(end_a, end_b) - static_cast<int64_t>(len) * step;
+
+    // Slot i of a series that starts at `s` is slot (s - start) / step + i of the result
+    auto shifted = [&](const nlohmann::json& series, const nlohmann::json& values, const nlohmann::json& fill) {
+        nlohmann::json out(len, fill);
+        const int64_t offset = (series.value("start_s", int64_t{0}) - start) / step;
+        for (size_t i = 0; i < values.size(); ++i) {
+            const int64_t at = offset + static_cast<int64_t>(i);
+            if (at >= 0 && at < static_cast<int64_t>(len)) out[static_cast<size_t>(at)] = values[i];
+        }
+        return out;
+    };
+    auto sum = [&](nlohmann::json& a, const nlohmann::json& b) {
+        nlohmann::json x = shifted(into, a, 0);
+        nlohmann::json y = shifted(from, b, 0);
+        for (size_t i = 0; i < len; ++i) x[i] = x[i].get<uint64_t>() + y[i].get<uint64_t>();
+        a = std::move(x);
+    };
+    auto highest = [&](nlohmann::json& a, const nlohmann::json& b) {
+        nlohmann::json x = shifted(into, a, nullptr);
+        nlohmann::json y = shifted(from, b, nullptr);
+        for (size_t i = 0; i < len; ++i) {
+            if (x[i].is_null() || (!y[i].is_null() && y[i].get<double>() > x[i].get<double>())) x[i] = y[i];
+        }
+        a = std::move(x);
+    };
+
+    const auto none = nlohmann::json::array();
+    for (const char* key : kCounts) sum(into[key], from.value(key, none));
+    const auto from_alerts = from.value("alerts", nlohmann::json::object());
+    for (auto& [cls, values] : into["alerts"].items()) sum(values, from_alerts.value(cls, none));
+    const auto from_latency = from.value("latency_ms", nlohmann::json::object());
+    for (auto& [q, values] : into["latency_ms"].items()) highest(values, from_latency.value(q, none));
+    into["start_s"] = start;
+}
+
+void merge_rings(nlohmann::json& into, const nlohmann::json& from) {
+    for (const auto& [res, series] : from.items()) {
+        if (into.contains(res)) {
+            merge_series(into[res], series);
+        } else {
+            into[res] = series;
+        }
+    }
+}
+
+} // namespace
+
+TimeseriesView::TimeseriesView(std::vector<std::string> files) : files_(std::move(files)) {}
+
+nlohmann::json TimeseriesView::load() const {
+    nlohmann::json merged;
+    for (const auto& path : files_) {
+        std::ifstream f(path);
+        if (!f.is_open()) continue;
+        auto doc = nlohmann::json::parse(f, nullptr, false);
+        if (!doc.is_object() || !doc.contains("fleet")) continue; // not written yet
+        if (merged.is_null()) {
+            merged = std::move(doc);
+            continue;
+        }
+        merge_rings(merged["fleet"], doc["fleet"]);
+        const auto nodes = doc.value("nodes", nlohmann::json::object());
+        for (const auto& [node_id, rings] : nodes.items()) {
+            if (merged["nodes"].contains(node_id)) {
+                merge_rings(merged["nodes"][node_id], rings);
+            } else {
+                merged["nodes"][node_id] = rings;
+            }
+        }
+    }
+    if (merged.is_null()) {
+        merged = {{"resolutions", nlohmann::json::array()},
+                  {"fleet", nlohmann::json::object()},
+                  {"nodes", nlohmann::json::object()}};
+    }
+    return merged;
+}
+
+uint64_t TimeseriesView::refresh() {
+    const uint64_t fp = fingerprint(files_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (doc_ && fp == fingerprint_) return version_;
+    }
+    // Parsed outside the lock; two requests that both see the change both parse
+    auto doc = std::make_shared<const nlohmann::json>(load());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!doc_ || fp != fingerprint_) {
+        doc_ = std::move(doc);
+        fingerprint_ = fp;
+        ++version_;
+    }
+    return version_;
+}
+
+nlohmann::json TimeseriesView::select(int resolution_s, const std::vector<std::string>& node_ids) const {
+    std::shared_ptr<const nlohmann::json> doc;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        doc = doc_;
+    }
+    nlohmann::json out = {{"resolutions", nlohmann::json::array()},
+                          {"fleet", nlohmann::json::object()},
+                          {"nodes", nlohmann::json::object()},
+                          {"node_ids", nlohmann::json::array()}};
+    if (!doc) return out;
+
+    const std::string res = std::to_string(resolution_s);
+    auto pick = [&](const nlohmann::json& rings) {
+        if (resolution_s == 0) return rings;
+        nlohmann::json one = nlohmann::json::object();
+        if (rings.contains(res)) one[res] = rings[res];
+        return one;
+    };
+    out["resolutions"] = doc->value("resolutions", nlohmann::json::array());
+    out["fleet"] = pick(doc->value("fleet", nlohmann::json::object()));
+    auto nodes = doc->find("nodes");
+    if (nodes == doc->end()) return out;
+    for (const auto& id : node_ids) {
+        auto it = nodes->find(id);
+        if (it != nodes->end()) out["nodes"][id] = pick(*it);
+    }
+    for (const auto& [id, rings] : nodes->items()) out["node_ids"].push_back(id);
+    return out;
+}
+
+bool TimeseriesView::has_resolution(int resolution_s) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!doc_) return false;
+    for (const auto& r : doc_->value("resolutions", nlohmann::json::array())) {
+        if (r.get<int>() == resolution_s) return true;
+    }
+    return false;
+}
+
+} // namespace ui
+} // namespace surveillance
@@ -0,0 +1,43 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace surveillance {
+namespace ui {
+
+// central_timeseries.json behind /api/timeseries (see central::Rollups for its layout).
+//
+// With central.shards > 1 every shard writes its own file, and they are merged: counts
+// are summed slot by slot, and a percentile is the highest of the shards' since
+// percentiles do not add up. A node that moved between shards is merged the same way.
+// The parsed document is kept until one of the files changes.
+class TimeseriesView {
+public:
+    explicit TimeseriesView(std::vector<std::string> files);
+
+    // Reloads if a file changed since the last call; the result changes with every reload
+    uint64_t refresh();
+
+    // The fleet series at `resolution_s` (0 for every resolution), the series of the
+    // named nodes that have one, and the ids of all nodes with a series:
+    //   { "resolutions": [...], "fleet": {...}, "nodes": { "<node_id>": {...} }, "node_ids": [...] }
+    nlohmann::json select(int resolution_s, const std::vector<std::string>& node_ids) const;
+
+    bool has_resolution(int resolution_s) const;
+
+private:
+    nlohmann::json load() const;
+
+    std::vector<std::string> files_;
+    mutable std::mutex mutex_;
+    uint64_t fingerprint_{0};
+    uint64_t version_{0};
+    std::shared_ptr<const nlohmann::json> doc_; // under mutex_, replaced whole
+};
+
+} // namespace ui
+} // namespace surveillance
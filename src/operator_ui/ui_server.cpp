@@ -1,17 +1,115 @@
 #include "ui_server.hpp"
 #include "logging.hpp"
+#include "readiness.hpp"
+#include "shard_ring.hpp"
+#include "time.hpp"
 
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <iostream>
+#include <limits>
 
 namespace surveillance {
 namespace ui {
 
+namespace {
+
+constexpr size_t kMaxAlertPage = 1000;
+
+bool parse_u64(const std::string& text, uint64_t& out) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    out = std::stoull(text);
+    return true;
+}
+
+// UTC milliseconds or an ICD timestamp ("2026-02-23T12:34:56.123Z")
+bool parse_time(const std::string& text, uint64_t& out) {
+    if (parse_u64(text, out)) return true;
+    out = time::parse_utc_ms(text);
+    return out != 0;
+}
+
+bool parse_alert_query(const httplib::Request& req, AlertIndex::Query& q, std::string& error) {
+    for (const auto& [name, value] : req.params) {
+        uint64_t n = 0;
+        if (name == "since" || name == "until") {
+            if (!parse_time(value, name == "since" ? q.since_ms : q.until_ms)) {
+                error = name + " must be UTC milliseconds or a timestamp like 2026-02-23T12:34:56.123Z";
+                return false;
+            }
+        } else if (name == "node_id") {
+            q.node_id = value;
+        } else if (name == "classification") {
+            q.classification = value;
+        } else if (name == "limit") {
+            if (!parse_u64(value, n) || n == 0 || n > kMaxAlertPage) {
+                error = "limit must be between 1 and " + std::to_string(kMaxAlertPage);
+                return false;
+            }
+            q.limit = static_cast<size_t>(n);
+        } else if (name == "cursor") {
+            if (!parse_u64(value, q.cursor) || q.cursor == 0) {
+                error = "cursor must be the next_cursor of a previous page";
+                return false;
+            }
+        } else {
+            error = "unknown parameter " + name;
+            return false;
+        }
+    }
+    return true;
+}
+
+// resolution=<seconds>, and node_id as often as wanted (or comma-separated)
+bool parse_timeseries_query(const httplib::Request& req, const TimeseriesView& view, int& resolution_s,
+                            std::vector<std::string>& node_ids, std::string& error) {
+    for (const auto& [name, value] : req.params) {
+        uint64_t n = 0;
+        if (name == "resolution") {
+            if (!parse_u64(value, n) || n > 3600 || !view.has_resolution(static_cast<int>(n))) {
+                error = "resolution must be one of the resolutions listed by /api/timeseries";
+                return false;
+            }
+            resolution_s = static_cast<int>(n);
+        } else if (name == "node_id") {
+            size_t start = 0;
+            while (start <= value.size()) {
+                size_t comma = value.find(',', start);
+                if (comma == std::string::npos) comma = value.size();
+                if (comma > start) node_ids.push_back(value.substr(start, comma - start));
+                start = comma + 1;
+            }
+        } else {
+            error = "unknown parameter " + name;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 UIServer::UIServer(const config::AppConfig& cfg, const std::string& static_dir)
-    : cfg_(cfg), static_dir_(static_dir)
+    : cfg_(cfg), static_dir_(static_dir), cache_(cfg.ui.gzip_min_bytes)
 {
+    std::vector<std::string> alert_files;
+    std::vector<std::string> timeseries_files;
+    if (cfg_.central.shards > 1) {
+        aggregator_ = std::make_unique<ShardAggregator>(cfg_);
+        for (int k = 0; k < cfg_.central.shards; ++k) {
+            alert_files.push_back(cfg_.logging.log_dir + "/alerts" + shard::suffix(k) + ".jsonl");
+            timeseries_files.push_back(cfg_.logging.log_dir + "/central_timeseries" + shard::suffix(k) + ".json");
+        }
+    } else {
+        alert_files.push_back(cfg_.logging.log_dir + "/alerts.jsonl");
+        timeseries_files.push_back(cfg_.logging.log_dir + "/central_timeseries.json");
+    }
+    alerts_ = std::make_unique<AlertIndex>(std::move(alert_files), cfg_.ui.alert_history);
+    timeseries_ = std::make_unique<TimeseriesView>(std::move(timeseries_files));
     setup_routes();
 }
 
@@ -26,6 +124,11 @@ void UIServer::stop() {
         if (server_thread_.joinable()) {
             server_thread_.join();
         }
+        auto st = cache_.stats();
+        logging::info("HTTP cache summary", {{"served_from_cache", st.hits},
+                                              {"not_modified", st.not_modified},
+                                              {"gzip_replies", st.gzip_replies},
+                                              {"builds", st.builds}});
     }
 }
 
@@ -34,12 +137,25 @@ void UIServer::run() {
         logging::error("Failed to mount static directory: " + static_dir_);
     }
     
+    // Dashboards poll over persistent connections; each one holds a worker while open,
+    // so the pool is sized for them rather than for the CPU count
+    const int threads = cfg_.ui.http_threads;
+    svr_.new_task_queue = [threads] { return new httplib::ThreadPool(static_cast<size_t>(threads)); };
+    svr_.set_keep_alive_max_count(std::numeric_limits<size_t>::max());
+    svr_.set_keep_alive_timeout(cfg_.ui.keep_alive_s);
+
+    const auto& host = cfg_.transport.ui_host;
+    const int port = cfg_.transport.ui_port;
+    if (!svr_.bind_to_port(host, port)) {
+        logging::error("Failed to bind UI server", {{"host", host}, {"port", port}});
+        return;
+    }
+
     running_ = true;
-    server_thread_ = std::thread([this]() {
-        logging::info("Operator UI server listening on http://127.0.0.1:8080");
-        if (!svr_.listen("127.0.0.1", 8080)) {
-            logging::error("Failed to bind UI server to port 8080");
-        }
+    readiness::mark_ready(cfg_.logging.log_dir, "ui");
+    server_thread_ = std::thread([this, url = "http://" + host + ":" + std::to_string(port)]() {
+        logging::info("Operator UI server listening on " + url);
+        svr_.listen_after_bind();
         running_ = false;
     });
 }
@@ -52,48 +168,101 @@ std::string UIServer::read_file_content(const std::string& path) {
     return ss.str();
 }
 
-std::string UIServer::read_recent_alerts() {
-    // Read the tail of alerts.jsonl safely. Since central processor replaces or appends,
-    // we simply read the file. If it gets big, a tail approach is better.
-    // For this simulation reading it bounded is fine.
-    std::ifstream f(cfg_.logging.log_dir + "/alerts.jsonl");
-    if (!f.is_open()) return "[]";
-    
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(f, line)) {
-        if (!line.empty()) lines.push_back(line);
+void UIServer::reply_cached(const std::string& path, const httplib::Request& req, httplib::Response& res) {
+    auto reply = cache_.get(path, req.get_header_value("If-None-Match"), req.get_header_value("If-Modified-Since"),
+                            req.get_header_value("Accept-Encoding"));
+    res.status = reply.status;
+    for (auto& [name, value] : reply.headers) {
+        res.set_header(name, value);
     }
-    
-    size_t count = std::min(lines.size(), static_cast<size_t>(100));
-    std::ostringstream ss;
-    ss << "[";
-    for (size_t i = lines.size() - count; i < lines.size(); ++i) {
-        ss << lines[i] << (i + 1 == lines.size() ? "" : ",");
+    if (reply.body) {
+        res.set_content(*reply.body, reply.content_type);
     }
-    ss << "]";
-    return ss.str();
+    res.set_header("Access-Control-Allow-Origin", "*");
+}
+
+void UIServer::serve_cached(const std::string& path) {
+    svr_.Get(path, [this, path](const httplib::Request& req, httplib::Response& res) { reply_cached(path, req, res); });
 }
 
 void UIServer::setup_routes() {
-    svr_.Get("/", [this](const httplib::Request&, httplib::Response& res) {
-        std::string content = read_file_content(static_dir_ + "/index.html");
-        res.set_content(content, "text/html");
+    // The files /api/status is built from; the cache rebuilds it when one changes
+    std::vector<std::string> state_files;
+    for (int k = 0; k < std::max(1, cfg_.central.shards); ++k) {
+        state_files.push_back(cfg_.logging.log_dir + "/central_state" + (aggregator_ ? shard::suffix(k) : "") + ".json");
+    }
+
+    cache_.add("/", "text/html", {static_dir_ + "/index.html"}, [this] {
+        return read_file_content(static_dir_ + "/index.html");
     });
+    serve_cached("/");
 
-    svr_.Get("/api/status", [this](const httplib::Request&, httplib::Response& res) {
-        std::string content = read_file_content(cfg_.logging.log_dir + "/central_state.json");
+    cache_.add("/api/status", "application/json", state_files, [this] {
+        std::string content = aggregator_ ? aggregator_->state().dump()
+                                          : read_file_content(cfg_.logging.log_dir + "/central_state.json");
         if (content.empty()) {
             content = "{}";
         }
-        res.set_content(content, "application/json");
+        return content;
+    });
+    serve_cached("/api/status");
+
+    // Without parameters: the newest 100, oldest first, which the dashboard polls
+    cache_.add("/api/alerts", "application/json", [this] { return alerts_->version(); }, [this] {
+        auto page = alerts_->query({});
+        std::string out = "[";
+        for (auto it = page.alerts.rbegin(); it != page.alerts.rend(); ++it) {
+            if (it != page.alerts.rbegin()) out += ",";
+            out += *it;
+        }
+        out += "]";
+        return out;
+    });
+    svr_.Get("/api/alerts", [this](const httplib::Request& req, httplib::Response& res) {
+        if (req.params.empty()) {
+            reply_cached("/api/alerts", req, res);
+            return;
+        }
         res.set_header("Access-Control-Allow-Origin", "*");
+        AlertIndex::Query query;
+        std::string error;
+        if (!parse_alert_query(req, query, error)) {
+            res.status = 400;
+            res.set_content(nlohmann::json{{"error", error}}.dump(), "application/json");
+            return;
+        }
+        auto page = alerts_->query(query);
+        std::string out = "{\"alerts\":[";
+        for (size_t i = 0; i < page.alerts.size(); ++i) {
+            if (i > 0) out += ",";
+            out += page.alerts[i];
+        }
+        out += "],\"next_cursor\":";
+        out += page.next_cursor ? "\"" + std::to_string(page.next_cursor) + "\"" : "null";
+        out += "}";
+        res.set_content(out, "application/json");
     });
 
-    svr_.Get("/api/alerts", [this](const httplib::Request&, httplib::Response& res) {
-        std::string content = read_recent_alerts();
-        res.set_content(content, "application/json");
+    // Without parameters: every fleet series and the node ids; that is what changes
+    // once a second, so it is the one worth caching
+    cache_.add("/api/timeseries", "application/json", [this] { return timeseries_->refresh(); },
+               [this] { return timeseries_->select(0, {}).dump(); });
+    svr_.Get("/api/timeseries", [this](const httplib::Request& req, httplib::Response& res) {
+        if (req.params.empty()) {
+            reply_cached("/api/timeseries", req, res);
+            return;
+        }
         res.set_header("Access-Control-Allow-Origin", "*");
+        timeseries_->refresh();
+        int resolution_s = 0;
+        std::vector<std::string> node_ids;
+        std::string error;
+        if (!parse_timeseries_query(req, *timeseries_, resolution_s, node_ids, error)) {
+            res.status = 400;
+            res.set_content(nlohmann::json{{"error", error}}.dump(), "application/json");
+            return;
+        }
+        res.set_content(timeseries_->select(resolution_s, node_ids).dump(), "application/json");
     });
 }
 
@@ -1,5 +1,9 @@
 #pragma once
+#include "alert_index.hpp"
 #include "config.hpp"
+#include "response_cache.hpp"
+#include "shard_aggregator.hpp"
+#include "timeseries_view.hpp"
 #include <string>
 #include <thread>
 #include <atomic>
@@ -19,11 +23,17 @@ public:
 
 private:
     void setup_routes();
+    void reply_cached(const std::string& path, const httplib::Request& req, httplib::Response& res);
+    // Answers GET `path` from cache_
+    void serve_cached(const std::string& path);
     std::string read_file_content(const std::string& path);
-    std::string read_recent_alerts();
 
     config::AppConfig cfg_;
     std::string static_dir_;
+    std::unique_ptr<ShardAggregator> aggregator_; // central.shards > 1 only
+    std::unique_ptr<AlertIndex> alerts_;
+    std::unique_ptr<TimeseriesView> timeseries_;
+    ResponseCache cache_;
     httplib::Server svr_;
     
     std::atomic<bool> running_{false};
@@ -1,5 +1,9 @@
 #include "sensor_node.hpp"
+#include "control.hpp"
 #include "logging.hpp"
+#include "readiness.hpp"
+#include "runtime.hpp"
+#include "trace.hpp"
 #include "ids.hpp"
 #include <iostream>
 #include <vector>
@@ -35,10 +39,14 @@ int main(int argc, char** argv) {
         ids::seed(cfg.system.seed_base + node_index);
     }
     
-    logging::init(node_id, cfg.logging.log_dir, cfg.logging.flush_every_n);
+    logging::init(node_id, cfg.logging);
+    readiness::clear(cfg.logging.log_dir, node_id);
+    trace::init(node_id, cfg.logging.log_dir, cfg.tracing);
+    runtime::configure(cfg.runtime, node_id);
     logging::info("Starting sensor node", {{"node_id", node_id}, {"index", node_index}});
 
     zmq::context_t ctx{1};
+    auto control_listener = control::start(ctx, cfg.logging.control_endpoint, node_id);
     sensor::SensorNode node{node_id, node_index, cfg, ctx};
 
     std::thread t([&node, &cfg]() {
@@ -57,7 +65,10 @@ int main(int argc, char** argv) {
     node.stop();
     t.join();
     
+    control_listener.reset();
     logging::info("Sensor node shutting down");
+    readiness::clear(cfg.logging.log_dir, node_id);
+    trace::shutdown();
     logging::shutdown();
     return 0;
 }
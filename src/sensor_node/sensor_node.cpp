@@ -1,9 +1,15 @@
 #include "sensor_node.hpp"
+#include "hops.hpp"
 #include "ids.hpp"
 #include "time.hpp"
 #include "zmq_utils.hpp"
 #include "logging.hpp"
+#include "metrics.hpp"
+#include "readiness.hpp"
+#include "runtime.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <thread>
 #include <iostream>
@@ -13,18 +19,117 @@ namespace sensor {
 
 SensorNode::SensorNode(const std::string& node_id, int node_index, const config::AppConfig& cfg, zmq::context_t& ctx)
     : node_id_(node_id), node_index_(node_index), cfg_(cfg),
-      pub_socket_(zmq_utils::create_publisher(ctx, "tcp://127.0.0.1:7001", false))
+      pub_socket_(shm::is_shm_endpoint(cfg.transport.sensor_uplink)
+                      ? zmq::socket_t()
+                      : zmq_utils::create_publisher(ctx, cfg.transport.sensor_uplink, false))
 {
+    if (shm::is_shm_endpoint(cfg_.transport.sensor_uplink)) {
+        uplink_ring_ = std::make_unique<shm::RingProducer>(cfg_.transport.sensor_uplink, "sensor_uplink");
+    }
     rng_.seed(cfg_.system.seed_base + node_index_);
     next_event_time_s_ = -std::log(uniform_dist_(rng_)) / cfg_.sensor.event_rate_hz;
     next_status_time_s_ = 1.0 / cfg_.sensor.status_rate_hz;
     start_time_ns_ = time::monotonic_ns();
+
+    if (cfg_.system.mode == "deterministic") {
+        credits_ = std::make_unique<flow::CreditSender>(ctx, cfg.transport.sensor_credits, node_id_);
+    }
+    if (cfg_.network.compression) {
+        encoder_ = std::make_unique<codec::StreamEncoder>("sensor_uplink", cfg_.network.keyframe_interval);
+    }
+    if (cfg_.waveform.enabled) {
+        // Separate stream so enabling waveforms does not perturb the event sequence
+        waveform_ = std::make_unique<WaveformGenerator>(cfg_.waveform, (cfg_.system.seed_base + node_index_) ^ 0x5eed5eedULL);
+        if (cfg_.waveform.edge_detection) {
+            edge_detector_ = std::make_unique<dsp::BurstDetector>(dsp::make_detector_config(cfg_.waveform));
+        }
+    }
 }
 
 void SensorNode::stop() {
     running_ = false;
 }
 
+void SensorNode::publish(const nlohmann::json& msg) {
+    if (credits_ && !credits_->acquire(running_)) {
+        return; // Stopping
+    }
+    send_payload(encoder_ ? encoder_->encode(msg) : msg.dump() + "\n");
+}
+
+void SensorNode::publish(const icd::DisturbanceEvent& msg) {
+    if (credits_ && !credits_->acquire(running_)) {
+        return; // Stopping
+    }
+    send_payload(encoder_ ? encoder_->encode(msg) : icd::dump(msg) + "\n");
+}
+
+void SensorNode::publish(const icd::NodeStatus& msg) {
+    if (credits_ && !credits_->acquire(running_)) {
+        return; // Stopping
+    }
+    send_payload(encoder_ ? encoder_->encode(msg) : icd::dump(msg) + "\n");
+}
+
+void SensorNode::send_payload(const std::string& payload) {
+    if (uplink_ring_) {
+        uplink_ring_->send(payload); // a full ring drops, like the XPUB at its HWM
+    } else {
+        zmq_utils::publish_string(pub_socket_, payload);
+    }
+    ++messages_sent_;
+    bytes_sent_ += payload.size();
+}
+
+void SensorNode::stamp(double sample_time_s, double current_time_s, uint64_t& mono_ns, std::string& utc_str) const {
+    if (cfg_.system.mode == "deterministic") {
+        mono_ns = (uint64_t)(sample_time_s * 1e9);
+        utc_str = time::format_utc_ms((uint64_t)(sample_time_s * 1000.0) + 1700000000000ULL);
+    } else {
+        double age_s = std::max(0.0, current_time_s - sample_time_s);
+        mono_ns = time::monotonic_ns() - (uint64_t)(age_s * 1e9);
+        utc_str = time::format_utc_ms(time::utc_now_ms() - (uint64_t)(age_s * 1000.0));
+    }
+}
+
+bool SensorNode::suppress_as_wind(const dsp::BurstFeatures& burst) const {
+    const auto& wcfg = cfg_.waveform;
+    double hf_ratio = burst.band_energy_low > 0.0 ? burst.band_energy_high / burst.band_energy_low : 0.0;
+    return burst.peak_amplitude < wcfg.suppress_max_amplitude &&
+           burst.energy < wcfg.suppress_max_energy &&
+           hf_ratio < wcfg.suppress_max_hf_ratio;
+}
+
+void SensorNode::emit_features(const dsp::BurstFeatures& burst, double current_time_s) {
+    ++edge_triggers_;
+    if (suppress_as_wind(burst)) {
+        ++suppressed_events_;
+        return;
+    }
+
+    // Stamped at the detrigger sample, when the burst was detected
+    double detect_s = static_cast<double>(burst.start_sample) / cfg_.waveform.sample_rate_hz + burst.duration_s;
+    uint64_t mono_ns;
+    std::string utc_str;
+    stamp(detect_s, current_time_s, mono_ns, utc_str);
+
+    // Compact summary: central classifies from the features, the type is not known on the node
+    icd::DisturbanceEvent msg;
+    msg.event_id = ids::generate_uuid();
+    msg.node_id = node_id_;
+    msg.sequence_number = seq_num_++;
+    msg.timestamp_utc = std::move(utc_str);
+    msg.monotonic_ns = mono_ns;
+    msg.signal_amplitude = burst.peak_amplitude;
+    msg.signal_energy = burst.energy;
+    msg.band_energy_low = burst.band_energy_low;
+    msg.band_energy_high = burst.band_energy_high;
+    msg.duration_s = burst.duration_s;
+    trace::Span span("sensor.publish", trace::sampled_event_id(msg.event_id));
+    hops::begin(msg.hops, time::monotonic_ns());
+    publish(msg);
+}
+
 void SensorNode::emit_event(double current_time_s) {
     // Determine type
     double p = uniform_dist_(rng_);
@@ -56,6 +161,13 @@ void SensorNode::emit_event(double current_time_s) {
     double signal_energy = std::max(0.0, dist_en(rng_));
     uint32_t generated_seed = rng_();
 
+    if (waveform_) {
+        // The event is detected from the raw samples instead (at central, or here in edge
+        // mode). Only what is published takes a sequence number or is logged as generated.
+        waveform_->add_burst(event_type, signal_amplitude, signal_energy);
+        return;
+    }
+
     uint64_t mono_ns = time::monotonic_ns();
     std::string utc_str = time::utc_now_string();
     if (cfg_.system.mode == "deterministic") {
@@ -63,23 +175,74 @@ void SensorNode::emit_event(double current_time_s) {
         utc_str = time::format_utc_ms((uint64_t)(current_time_s * 1000.0) + 1700000000000ULL); // Baseline arbitrary deterministic epoch + time
     }
 
-    nlohmann::json msg = {
-        {"msg_type", "DisturbanceEvent"},
-        {"event_id", ids::generate_uuid()},
-        {"node_id", node_id_},
-        {"sequence_number", seq_num_++},
-        {"timestamp_utc", utc_str},
-        {"monotonic_ns", mono_ns},
-        {"signal_amplitude", signal_amplitude},
-        {"signal_energy", signal_energy},
-        {"event_type", event_type},
-        {"generated_seed", generated_seed}
-    };
+    icd::DisturbanceEvent msg;
+    msg.event_id = ids::generate_uuid();
+    msg.node_id = node_id_;
+    msg.sequence_number = seq_num_++;
+    msg.timestamp_utc = std::move(utc_str);
+    msg.monotonic_ns = mono_ns;
+    msg.signal_amplitude = signal_amplitude;
+    msg.signal_energy = signal_energy;
+    msg.event_type = event_type;
+    msg.generated_seed = generated_seed;
 
-    zmq_utils::publish_json(pub_socket_, msg);
+    {
+        trace::Span span("sensor.publish", trace::sampled_event_id(msg.event_id));
+        hops::begin(msg.hops, time::monotonic_ns());
+        publish(msg);
+    }
     
-    // log locally as well to support TC-FT-001 mapping
-    logging::info("Generated event", msg);
+    // log locally as well to support TC-FT-001 mapping (sampled by logging.sample_every_n)
+    SURV_LOG_SAMPLED(logging::Level::info, "Generated event", msg);
+}
+
+void SensorNode::stream_waveform(double current_time_s) {
+    const auto& wcfg = cfg_.waveform;
+    const size_t block = static_cast<size_t>(std::max(1, wcfg.block_samples));
+    const size_t channels = static_cast<size_t>(std::max(1, wcfg.channels));
+    const double fs = wcfg.sample_rate_hz;
+
+    while ((waveform_->next_sample() + block) / fs <= current_time_s) {
+        uint64_t first_sample = waveform_->next_sample();
+        waveform_->generate(block, wave_buf_);
+
+        if (edge_detector_) {
+            edge_bursts_.clear();
+            edge_detector_->process(wave_buf_.data(), block, edge_bursts_);
+            for (const auto& burst : edge_bursts_) {
+                emit_features(burst, current_time_s);
+            }
+            continue;
+        }
+
+        nlohmann::json samples = nlohmann::json::array();
+        wave_quantized_.resize(block);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            for (size_t i = 0; i < block; ++i) {
+                float x = std::clamp(wave_buf_[ch * block + i], -1.0f, 1.0f);
+                wave_quantized_[i] = static_cast<int16_t>(std::lround(x * 32767.0f));
+            }
+            samples.push_back(wave_quantized_);
+        }
+
+        // Stamp the first sample of the block
+        uint64_t mono_ns;
+        std::string utc_str;
+        stamp(first_sample / fs, current_time_s, mono_ns, utc_str);
+
+        nlohmann::json msg = {
+            {"msg_type", "WaveformBlock"},
+            {"node_id", node_id_},
+            {"block_sequence", block_seq_++},
+            {"timestamp_utc", utc_str},
+            {"monotonic_ns", mono_ns},
+            {"sample_rate_hz", wcfg.sample_rate_hz},
+            {"first_sample", first_sample},
+            {"scale", 1.0 / 32767.0},
+            {"samples", std::move(samples)}
+        };
+        publish(msg);
+    }
 }
 
 void SensorNode::send_status(double current_time_s) {
@@ -89,16 +252,18 @@ void SensorNode::send_status(double current_time_s) {
         mono_ns = (uint64_t)(current_time_s * 1e9);
         utc_str = time::format_utc_ms((uint64_t)(current_time_s * 1000.0) + 1700000000000ULL);
     }
-    nlohmann::json msg = {
-        {"msg_type", "NodeStatus"},
-        {"node_id", node_id_},
-        {"timestamp_utc", utc_str},
-        {"monotonic_ns", mono_ns},
-        {"health", "OK"},
-        {"uptime_s", current_time_s},
-        {"last_sequence_number", seq_num_ - 1}
-    };
-    zmq_utils::publish_json(pub_socket_, msg);
+    icd::NodeStatus msg;
+    msg.node_id = node_id_;
+    msg.timestamp_utc = std::move(utc_str);
+    msg.monotonic_ns = mono_ns;
+    msg.uptime_s = current_time_s;
+    msg.last_sequence_number = seq_num_ - 1;
+    msg.bytes_sent = bytes_sent_;
+    if (edge_detector_) {
+        msg.edge_triggers = edge_triggers_;
+        msg.suppressed_events = suppressed_events_;
+    }
+    publish(msg);
 }
 
 void SensorNode::generate_events(double current_time_s) {
@@ -107,13 +272,50 @@ void SensorNode::generate_events(double current_time_s) {
         next_event_time_s_ += -std::log(uniform_dist_(rng_)) / cfg_.sensor.event_rate_hz;
     }
 
+    if (waveform_) {
+        stream_waveform(current_time_s);
+    }
+
     if (next_status_time_s_ <= current_time_s) {
         send_status(current_time_s);
         next_status_time_s_ += 1.0 / cfg_.sensor.status_rate_hz;
     }
 }
 
+void SensorNode::wait_for_uplink() {
+    // The emulator's subscription arriving on our XPUB means the link is up; anything
+    // published before that would be silently dropped (ZMQ "slow joiner"). A shm ring
+    // is up once the emulator has created its segment.
+    bool up = uplink_ring_ ? uplink_ring_->wait_for_consumer(std::chrono::seconds(10), running_)
+                           : zmq_utils::wait_for_subscriber(pub_socket_, std::chrono::seconds(10), running_);
+    if (up) {
+        readiness::mark_ready(cfg_.logging.log_dir, node_id_);
+    } else if (running_) {
+        logging::warn("No subscriber on uplink after 10 s, publishing anyway", {{"node_id", node_id_}});
+    }
+}
+
+void SensorNode::log_uplink_summary() {
+    metrics::add("sensor.bytes_sent", bytes_sent_);
+    metrics::add("sensor.edge_suppressed", suppressed_events_);
+    nlohmann::json fields = {
+        {"node_id", node_id_},
+        {"messages_sent", messages_sent_},
+        {"bytes_sent", bytes_sent_},
+        {"edge_triggers", edge_triggers_},
+        {"suppressed_events", suppressed_events_}
+    };
+    if (encoder_) {
+        encoder_->flush_metrics();
+        fields["codec"] = codec::stats_json("sensor_uplink");
+    }
+    logging::info("Uplink summary", fields);
+}
+
 void SensorNode::run_live() {
+    trace::set_thread_name(node_id_);
+    runtime::enter_thread("generate");
+    wait_for_uplink();
     double start_time_s = time::monotonic_ns() / 1e9;
     while (running_) {
         double current_time_s = (time::monotonic_ns() / 1e9) - start_time_s;
@@ -123,23 +325,37 @@ void SensorNode::run_live() {
             break;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        runtime::idle(std::chrono::milliseconds(10));
     }
+    log_uplink_summary();
 }
 
 void SensorNode::run_deterministic() {
-    // Allow ZMQ subscriptions to establish before flooding messages.
-    // Without this delay, the PUB socket sends all ticks before the network
-    // emulator's SUB socket completes its TCP handshake (ZMQ "slow joiner").
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    trace::set_thread_name(node_id_);
+    runtime::enter_thread("generate");
+    wait_for_uplink();
 
     double tick_s = 0.01; // 100 Hz
     int ticks = cfg_.system.duration_s / tick_s;
-    
+
+    // Paced only by emulator credits: as fast as the downstream can absorb without loss
+    uint64_t replay_start_ns = time::monotonic_ns();
     for (int i = 0; i < ticks && running_; ++i) {
         double current_time_s = i * tick_s;
         generate_events(current_time_s);
     }
+    double elapsed_s = (time::monotonic_ns() - replay_start_ns) / 1e9;
+
+    metrics::add("sensor.messages_sent", messages_sent_);
+    logging::info("Deterministic replay complete", {
+        {"node_id", node_id_},
+        {"messages_sent", messages_sent_},
+        {"elapsed_s", elapsed_s},
+        {"messages_per_s", elapsed_s > 0.0 ? messages_sent_ / elapsed_s : 0.0},
+        {"credit_waits", credits_ ? credits_->waits() : 0},
+        {"credit_resyncs", credits_ ? credits_->resyncs() : 0}
+    });
+    log_uplink_summary();
 }
 
 } // namespace sensor
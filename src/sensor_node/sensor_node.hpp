@@ -1,10 +1,19 @@
 #pragma once
 
 #include "config.hpp"
+#include "dsp.hpp"
+#include "flow_control.hpp"
+#include "icd_messages.hpp"
+#include "shm_ring.hpp"
+#include "stream_codec.hpp"
+#include "waveform_generator.hpp"
 #include <zmq.hpp>
+#include <nlohmann/json.hpp>
 #include <random>
 #include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace surveillance {
 namespace sensor {
@@ -26,17 +35,40 @@ private:
     void generate_events(double current_time_s);
     void send_status(double current_time_s);
     void emit_event(double current_time_s);
+    void stream_waveform(double current_time_s);
+    void emit_features(const dsp::BurstFeatures& burst, double current_time_s);
+    bool suppress_as_wind(const dsp::BurstFeatures& burst) const;
+    void stamp(double sample_time_s, double current_time_s, uint64_t& mono_ns, std::string& utc_str) const;
+    void publish(const nlohmann::json& msg);
+    void publish(const icd::DisturbanceEvent& msg);
+    void publish(const icd::NodeStatus& msg);
+    void send_payload(const std::string& payload);
+    void wait_for_uplink();
+    void log_uplink_summary();
 
     std::string node_id_;
     int node_index_;
     config::AppConfig cfg_;
-    zmq::socket_t pub_socket_;
+    zmq::socket_t pub_socket_; // unused when the uplink is a shm:// ring
+    std::unique_ptr<shm::RingProducer> uplink_ring_;
+    std::unique_ptr<flow::CreditSender> credits_; // deterministic mode only
+    std::unique_ptr<codec::StreamEncoder> encoder_; // network.compression only
+    std::unique_ptr<WaveformGenerator> waveform_; // waveform mode only
+    std::vector<float> wave_buf_;
+    std::vector<int16_t> wave_quantized_;
+    uint64_t block_seq_{1};
+    std::unique_ptr<dsp::BurstDetector> edge_detector_; // edge mode only
+    std::vector<dsp::BurstFeatures> edge_bursts_;
 
     std::mt19937_64 rng_;
     std::uniform_real_distribution<double> uniform_dist_{std::nextafter(0.0, 1.0), 1.0};
     
     // Stats and state
     uint64_t seq_num_{1};
+    uint64_t messages_sent_{0};
+    uint64_t bytes_sent_{0};
+    uint64_t edge_triggers_{0};
+    uint64_t suppressed_events_{0};
     uint64_t start_time_ns_{0};
     double next_event_time_s_{0.0};
     double next_status_time_s_{0.0};
@@ -0,0 +1,79 @@
+#include "waveform_generator.hpp"
+#include "dsp.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace surveillance {
+namespace sensor {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kRampS = 0.01;
+} // namespace
+
+WaveformGenerator::WaveformGenerator(const config::WaveformConfig& cfg, uint64_t seed)
+    : cfg_(cfg), rng_(seed), noise_(0.0f, static_cast<float>(cfg.noise_floor))
+{
+    cfg_.channels = std::max(1, cfg_.channels);
+}
+
+void WaveformGenerator::add_burst(const std::string& event_type, double amplitude, double energy) {
+    amplitude = std::clamp(amplitude, 0.01, 0.99);
+
+    // Carrier per channel (seismic, acoustic); footsteps and digging are impulse trains
+    Burst b{next_sample_, 0, amplitude, {40.0, 120.0}, false};
+    if (event_type == "WALKING") {
+        b.freq_hz[0] = 20.0; b.freq_hz[1] = 60.0; b.impulsive = true;
+    } else if (event_type == "VEHICLE") {
+        b.freq_hz[0] = 35.0; b.freq_hz[1] = 90.0;
+    } else if (event_type == "DIGGING") {
+        b.freq_hz[0] = 150.0; b.freq_hz[1] = 300.0; b.impulsive = true;
+    } else if (event_type == "WIND") {
+        b.freq_hz[0] = 5.0; b.freq_hz[1] = 15.0;
+    }
+
+    // Sine energy is A^2/2 per second (x kEnergyScale); impulse trains have a 50% duty cycle
+    double duty = b.impulsive ? 0.5 : 1.0;
+    double duration_s = energy / (dsp::kEnergyScale * amplitude * amplitude * 0.5 * duty);
+    duration_s = std::clamp(duration_s, 0.1, 4.0);
+    b.length = static_cast<uint64_t>(duration_s * cfg_.sample_rate_hz);
+    bursts_.push_back(b);
+}
+
+void WaveformGenerator::generate(size_t n, std::vector<float>& out) {
+    const size_t channels = static_cast<size_t>(cfg_.channels);
+    out.resize(channels * n);
+    for (size_t ch = 0; ch < channels; ++ch) {
+        for (size_t i = 0; i < n; ++i) {
+            out[ch * n + i] = noise_(rng_);
+        }
+    }
+
+    const double fs = cfg_.sample_rate_hz;
+    const uint64_t ramp = static_cast<uint64_t>(kRampS * fs);
+    for (const auto& b : bursts_) {
+        uint64_t from = std::max(b.start_sample, next_sample_);
+        uint64_t to = std::min(b.start_sample + b.length, next_sample_ + n);
+        for (uint64_t s = from; s < to; ++s) {
+            uint64_t k = s - b.start_sample;
+            double env = b.amplitude;
+            if (k < ramp) env *= static_cast<double>(k) / ramp;
+            if (b.length - k < ramp) env *= static_cast<double>(b.length - k) / ramp;
+            if (b.impulsive && std::fmod(k / fs * 4.0, 1.0) >= 0.5) env = 0.0; // 4 Hz bursts
+
+            for (size_t ch = 0; ch < channels; ++ch) {
+                double carrier = std::sin(2.0 * kPi * b.freq_hz[ch % 2] * k / fs);
+                out[ch * n + (s - next_sample_)] += static_cast<float>(env * carrier);
+            }
+        }
+    }
+
+    next_sample_ += n;
+    bursts_.erase(std::remove_if(bursts_.begin(), bursts_.end(),
+                                 [this](const Burst& b) { return b.start_sample + b.length <= next_sample_; }),
+                  bursts_.end());
+}
+
+} // namespace sensor
+} // namespace surveillance
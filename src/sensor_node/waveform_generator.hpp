@@ -0,0 +1,45 @@
+#pragma once
+
+#include "config.hpp"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace surveillance {
+namespace sensor {
+
+// Synthetic seismic/acoustic sample stream. Background is Gaussian noise; each
+// disturbance adds a tone burst whose carrier depends on the event type and whose
+// amplitude/duration are chosen so central's features reproduce the event's
+// amplitude and energy (see dsp::kEnergyScale).
+class WaveformGenerator {
+public:
+    WaveformGenerator(const config::WaveformConfig& cfg, uint64_t seed);
+
+    // Starts a burst at the next generated sample.
+    void add_burst(const std::string& event_type, double amplitude, double energy);
+
+    // Produces the next `n` samples per channel, channel-major, into `out` (resized).
+    void generate(size_t n, std::vector<float>& out);
+
+    uint64_t next_sample() const { return next_sample_; }
+
+private:
+    struct Burst {
+        uint64_t start_sample;
+        uint64_t length;
+        double amplitude;
+        double freq_hz[2];
+        bool impulsive;
+    };
+
+    config::WaveformConfig cfg_;
+    std::mt19937_64 rng_;
+    std::normal_distribution<float> noise_;
+    std::vector<Burst> bursts_;
+    uint64_t next_sample_{0};
+};
+
+} // namespace sensor
+} // namespace surveillance
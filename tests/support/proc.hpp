@@ -14,6 +14,11 @@ public:
 
     void wait();
     void terminate();
+    // Kills without a chance to clean up (SIGKILL), as a crash would
+    void kill();
+
+    // Non-blocking: reaps the process and returns true if it has exited.
+    bool try_wait();
 
 private:
     handle_t handle_;
@@ -39,11 +39,18 @@ Process::~Process() {
 void Process::terminate() {
     if (running_) {
         pid_t pid = static_cast<pid_t>(reinterpret_cast<intptr_t>(handle_));
-        kill(pid, SIGTERM);
+        ::kill(pid, SIGTERM);
         // give it a bit of time, then SIGKILL if we wanted strict, but we assume SIGTERM works for clean shutdown tests
     }
 }
 
+void Process::kill() {
+    if (running_) {
+        pid_t pid = static_cast<pid_t>(reinterpret_cast<intptr_t>(handle_));
+        ::kill(pid, SIGKILL);
+    }
+}
+
 void Process::wait() {
     if (running_) {
         pid_t pid = static_cast<pid_t>(reinterpret_cast<intptr_t>(handle_));
@@ -53,5 +60,15 @@ void Process::wait() {
     }
 }
 
+bool Process::try_wait() {
+    if (!running_) return true;
+    pid_t pid = static_cast<pid_t>(reinterpret_cast<intptr_t>(handle_));
+    int status;
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+        running_ = false;
+    }
+    return !running_;
+}
+
 } // namespace proc
 } // namespace surveillance
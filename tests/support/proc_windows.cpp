@@ -42,6 +42,10 @@ void Process::terminate() {
     }
 }
 
+void Process::kill() {
+    terminate(); // TerminateProcess already gives no chance to clean up
+}
+
 void Process::wait() {
     if (running_) {
         WaitForSingleObject(handle_, INFINITE);
@@ -50,6 +54,15 @@ void Process::wait() {
     }
 }
 
+bool Process::try_wait() {
+    if (!running_) return true;
+    if (WaitForSingleObject(handle_, 0) == WAIT_OBJECT_0) {
+        CloseHandle(handle_);
+        running_ = false;
+    }
+    return !running_;
+}
+
 } // namespace proc
 } // namespace surveillance
 
@@ -0,0 +1,48 @@
+#include "sandbox.hpp"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+namespace surveillance {
+namespace sandbox {
+
+Sandbox create(const std::string& base_config, const std::string& name, const nlohmann::json& overrides) {
+    std::ifstream in(base_config);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open config file: " + base_config);
+    }
+    nlohmann::json cfg = nlohmann::json::parse(in);
+    if (overrides.is_object()) cfg.merge_patch(overrides);
+
+    std::filesystem::remove_all(name);
+    Sandbox sb{name + "/config.json", name + "/run_logs"};
+    std::filesystem::create_directories(sb.log_dir);
+
+    cfg["logging"]["log_dir"] = sb.log_dir;
+    auto& transport = cfg["transport"];
+#if defined(_WIN32)
+    const bool tcp = true;
+#else
+    // Overrides can keep a case on tcp, the shipped default
+    const bool tcp = overrides.is_object() && overrides.contains("transport") &&
+                     overrides["transport"].value("kind", "") == "tcp";
+#endif
+    if (tcp) {
+        transport["kind"] = "tcp";
+        transport["base_port"] = 20000 + static_cast<int>(std::hash<std::string>{}(name) % 2000) * 20;
+    } else {
+        transport["kind"] = "ipc";
+        transport["ipc_dir"] = name + "/ipc";
+    }
+    // Let the control and replication links follow the private transport
+    cfg["logging"].erase("control_endpoint");
+    if (cfg.contains("central")) cfg["central"].erase("replication_endpoint");
+
+    std::ofstream(sb.config_path) << cfg.dump(4);
+    return sb;
+}
+
+} // namespace sandbox
+} // namespace surveillance
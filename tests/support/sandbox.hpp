@@ -0,0 +1,25 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace surveillance {
+namespace sandbox {
+
+// A private run directory for one test case, so test cases can run side by side
+// under `ctest -j`: the components log to its own log_dir and meet on ipc endpoints
+// inside it instead of the fixed ports. On Windows, or when `overrides` asks for
+// transport.kind "tcp", they use tcp ports derived from the name instead.
+struct Sandbox {
+    std::string config_path;
+    std::string log_dir;
+
+    std::string log(const std::string& file) const { return log_dir + "/" + file; }
+};
+
+// Recreates `<name>/` with a copy of `base_config` pointed into it. `overrides` is
+// merged into the copy (JSON merge patch) before the sandbox paths are applied.
+Sandbox create(const std::string& base_config, const std::string& name,
+               const nlohmann::json& overrides = nlohmann::json());
+
+} // namespace sandbox
+} // namespace surveillance
@@ -0,0 +1,28 @@
+#include "wait.hpp"
+#include "readiness.hpp"
+#include <filesystem>
+#include <thread>
+
+namespace surveillance {
+namespace wait {
+
+bool until(const std::function<bool()>& pred,
+           std::chrono::milliseconds timeout,
+           std::chrono::milliseconds poll_interval) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (pred()) return true;
+        std::this_thread::sleep_for(poll_interval);
+    }
+    return pred();
+}
+
+bool for_ready(const std::string& log_dir,
+               const std::string& component,
+               std::chrono::milliseconds timeout) {
+    std::string marker = readiness::marker_path(log_dir, component);
+    return until([&] { return std::filesystem::exists(marker); }, timeout);
+}
+
+} // namespace wait
+} // namespace surveillance
@@ -0,0 +1,20 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace surveillance {
+namespace wait {
+
+// Polls `pred` until it holds or `timeout` expires. Returns the final value of `pred`.
+bool until(const std::function<bool()>& pred,
+           std::chrono::milliseconds timeout,
+           std::chrono::milliseconds poll_interval = std::chrono::milliseconds(20));
+
+// Waits for the component's `<log_dir>/<component>.ready` marker (see common/readiness.hpp).
+bool for_ready(const std::string& log_dir,
+               const std::string& component,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+} // namespace wait
+} // namespace surveillance
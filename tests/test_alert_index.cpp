@@ -0,0 +1,157 @@
+#include <catch2/catch_test_macros.hpp>
+#include "alert_index.hpp"
+#include "time.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+constexpr uint64_t kStartMs = 1700000000000ULL;
+
+struct TestAlert {
+    int id;
+    uint64_t offset_ms;
+    std::string node;
+    std::string classification;
+};
+
+void append(const std::string& path, const std::vector<TestAlert>& alerts) {
+    std::ofstream f(path, std::ios::binary | std::ios::app);
+    for (const auto& a : alerts) {
+        f << "{\"id\":" << a.id << ",\"source_node_id\":\"" << a.node << "\",\"classification\":\""
+          << a.classification << "\",\"timestamp_utc\":\"" << time::format_utc_ms(kStartMs + a.offset_ms) << "\"}\n";
+    }
+}
+
+std::string fresh_file(const std::string& dir) {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir + "/alerts.jsonl";
+}
+
+ui::AlertIndex::Query window(uint64_t since_offset_ms, uint64_t until_offset_ms) {
+    ui::AlertIndex::Query q;
+    q.since_ms = kStartMs + since_offset_ms;
+    q.until_ms = kStartMs + until_offset_ms;
+    return q;
+}
+
+std::vector<int> ids(const ui::AlertIndex::Page& page) {
+    std::vector<int> out;
+    for (const auto& text : page.alerts) out.push_back(nlohmann::json::parse(text)["id"].get<int>());
+    return out;
+}
+
+// Every page of `q`, following the cursors
+std::vector<std::vector<int>> pages(const ui::AlertIndex& index, ui::AlertIndex::Query q) {
+    std::vector<std::vector<int>> out;
+    for (;;) {
+        auto page = index.query(q);
+        out.push_back(ids(page));
+        if (page.next_cursor == 0) return out;
+        q.cursor = page.next_cursor;
+    }
+}
+
+} // namespace
+
+TEST_CASE("TC-ALIDX-001: Alert index pages, filters and evicts its history", "[alert_index]") {
+    const std::string path = fresh_file("tc_alidx_001");
+    // Arrival order; alerts 3 and 5 arrive after a later timestamp was indexed
+    append(path, {
+        {0, 1000, "sensor_0", "VEHICLE"},
+        {1, 2000, "sensor_1", "VEHICLE"},
+        {2, 5000, "sensor_0", "PERSONNEL"},
+        {3, 1500, "sensor_1", "PERSONNEL"},
+        {4, 6000, "sensor_0", "VEHICLE"},
+        {5, 3000, "sensor_1", "VEHICLE"},
+        {6, 7000, "sensor_0", "VEHICLE"},
+    });
+
+    SECTION("Pages follow the cursor, newest first in arrival order") {
+        ui::AlertIndex index({path}, 100);
+        REQUIRE(index.size() == 7);
+
+        auto q = window(0, 10000);
+        q.limit = 3;
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{6, 5, 4}, {3, 2, 1}, {0}});
+        q.limit = 7;
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{6, 5, 4, 3, 2, 1, 0}});
+
+        // The cursor is only set when another match exists
+        q = window(0, 2500);
+        q.limit = 1;
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{3}, {1}, {0}});
+        q.limit = 0;
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{}});
+    }
+
+    SECTION("Late alerts are found by their own timestamp") {
+        ui::AlertIndex index({path}, 100);
+        REQUIRE(pages(index, window(1400, 1600)) == std::vector<std::vector<int>>{{3}});
+        REQUIRE(pages(index, window(2500, 3500)) == std::vector<std::vector<int>>{{5}});
+        REQUIRE(pages(index, window(5000, 5000)) == std::vector<std::vector<int>>{{2}});
+        REQUIRE(pages(index, window(8000, 9000)) == std::vector<std::vector<int>>{{}});
+    }
+
+    SECTION("Node, classification and combined filters read their own lists") {
+        ui::AlertIndex index({path}, 100);
+        auto q = window(0, 10000);
+        q.node_id = "sensor_1";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{5, 3, 1}});
+        q.node_id.clear();
+        q.classification = "PERSONNEL";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{3, 2}});
+        q.node_id = "sensor_0";
+        q.classification = "VEHICLE";
+        q.limit = 2;
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{6, 4}, {0}});
+        q.node_id = "sensor_9";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{}});
+
+        // A late alert within a filtered window
+        q = window(2500, 3500);
+        q.node_id = "sensor_1";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{5}});
+        q.node_id = "sensor_0";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{}});
+    }
+
+    SECTION("The oldest alerts are evicted at capacity, from every list") {
+        ui::AlertIndex index({path}, 3);
+        REQUIRE(index.size() == 3);
+        REQUIRE(pages(index, window(0, 10000)) == std::vector<std::vector<int>>{{6, 5, 4}});
+
+        const uint64_t version = index.version();
+        append(path, {{7, 8000, "sensor_1", "PERSONNEL"}, {8, 9000, "sensor_2", "VEHICLE"}});
+        index.refresh();
+        REQUIRE(index.version() != version);
+        REQUIRE(index.size() == 3);
+        REQUIRE(pages(index, window(0, 10000)) == std::vector<std::vector<int>>{{8, 7, 6}});
+
+        auto q = window(0, 10000);
+        q.node_id = "sensor_1";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{7}});
+        q.node_id.clear();
+        q.classification = "VEHICLE";
+        REQUIRE(pages(index, q) == std::vector<std::vector<int>>{{8, 6}});
+        // Alert 5 was the only late one held; its window no longer matches
+        REQUIRE(pages(index, window(2500, 3500)) == std::vector<std::vector<int>>{{}});
+    }
+
+    SECTION("Lines written before a rotation are read before the new file") {
+        ui::AlertIndex index({path}, 100);
+        append(path, {{7, 8000, "sensor_0", "VEHICLE"}});
+        std::filesystem::rename(path, path + ".rotated");
+        append(path, {{8, 9000, "sensor_0", "VEHICLE"}});
+        index.refresh();
+        REQUIRE(pages(index, window(7500, 10000)) == std::vector<std::vector<int>>{{8, 7}});
+    }
+}
@@ -0,0 +1,140 @@
+#include <catch2/catch_test_macros.hpp>
+#include "async_file.hpp"
+#include "metrics.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace surveillance;
+
+// The engine is process-wide and chosen once, so each backend has its own test case;
+// ctest runs every case in a process of its own. A case whose backend is not the one
+// in effect (another case ran first, or io_uring is unavailable) is skipped.
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+std::string fresh_dir(const std::string& name) {
+    std::filesystem::remove_all(name);
+    std::filesystem::create_directories(name);
+    return name;
+}
+
+bool use_backend(const std::string& name, aio::Backend expected) {
+    config::IoConfig cfg;
+    cfg.backend = name;
+    cfg.threads = 1;
+    cfg.max_pending_bytes = 64 << 10; // small, so writers also block on a full queue
+    const aio::Backend chosen = aio::configure(cfg);
+    if (chosen != expected) {
+        WARN("Skipped: the " << aio::backend_name(chosen) << " backend is in effect, not " << name);
+        return false;
+    }
+    return true;
+}
+
+void check_file_output(const std::string& dir) {
+    const std::string path = dir + "/out.jsonl";
+
+    // Append order, across many writes and a queue that fills up
+    std::string expected;
+    {
+        aio::File f(path, false);
+        for (int i = 0; i < 20000; ++i) {
+            std::string line = "{\"n\":" + std::to_string(i) + "}\n";
+            f.append(line.data(), line.size());
+            expected += line;
+            if (i % 5000 == 4999) {
+                f.request_sync();
+                REQUIRE(f.drain());
+                REQUIRE(read_file(path) == expected);
+            }
+        }
+        REQUIRE(f.size() == expected.size());
+    }
+    REQUIRE(read_file(path) == expected); // the destructor drains
+
+    // Append mode continues at the end; truncating mode starts over
+    {
+        aio::File f(path, true);
+        REQUIRE(f.size() == expected.size());
+        f.append("tail\n", 5);
+        REQUIRE(f.drain());
+    }
+    REQUIRE(read_file(path) == expected + "tail\n");
+    {
+        aio::File f(path, false);
+        f.append("new\n", 4);
+        REQUIRE(f.drain());
+    }
+    REQUIRE(read_file(path) == "new\n");
+
+#if defined(__linux__)
+    // A failed write stops the file: later bytes are discarded, every drain reports it
+    const uint64_t errors_before = metrics::get("aio.write_errors");
+    {
+        aio::File full("/dev/full", true);
+        full.append("lost\n", 5);
+        REQUIRE_FALSE(full.drain());
+        full.append("also lost\n", 10);
+        full.request_sync();
+        REQUIRE_FALSE(full.drain());
+        REQUIRE(full.size() == 0);
+    }
+    REQUIRE(metrics::get("aio.write_errors") > errors_before);
+#endif
+}
+
+void check_replacement(const std::string& dir) {
+    const std::string path = dir + "/state.json";
+    for (int i = 0; i < 50; ++i) {
+        aio::replace_file(path, "{\"version\":" + std::to_string(i) + "}");
+    }
+    aio::drain_replacements();
+    REQUIRE(read_file(path) == "{\"version\":49}");
+    REQUIRE_FALSE(std::filesystem::exists(path + ".tmp"));
+}
+
+} // namespace
+
+TEST_CASE("TC-AIO-001: Sync backend writes in order and replaces files", "[aio]") {
+    if (!use_backend("sync", aio::Backend::SYNC)) return;
+    const std::string dir = fresh_dir("tc_aio_001");
+    check_file_output(dir);
+    check_replacement(dir);
+}
+
+TEST_CASE("TC-AIO-002: Threads backend writes in order, syncs and supersedes replacements", "[aio]") {
+    if (!use_backend("threads", aio::Backend::THREADS)) return;
+    const std::string dir = fresh_dir("tc_aio_002");
+    check_file_output(dir);
+    check_replacement(dir);
+
+    // The only worker is busy with a large write, so the first replacement has not
+    // started when the second arrives and is superseded by it
+    const uint64_t superseded_before = metrics::get("aio.superseded_replacements");
+    const std::string big(32 << 20, 'x');
+    {
+        aio::File f(dir + "/big.bin", false);
+        f.append(big.data(), big.size());
+        aio::replace_file(dir + "/state.json", "first");
+        aio::replace_file(dir + "/state.json", "second");
+        REQUIRE(f.drain());
+    }
+    aio::drain_replacements();
+    REQUIRE(read_file(dir + "/state.json") == "second");
+    REQUIRE(metrics::get("aio.superseded_replacements") - superseded_before == 1);
+}
+
+TEST_CASE("TC-AIO-003: io_uring backend writes in order and replaces files", "[aio]") {
+    if (!use_backend("io_uring", aio::Backend::IO_URING)) return;
+    const std::string dir = fresh_dir("tc_aio_003");
+    check_file_output(dir);
+    check_replacement(dir);
+}
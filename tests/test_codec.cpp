@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+#include "icd_messages.hpp"
+#include "metrics.hpp"
+#include "stream_codec.hpp"
+#include "time.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+icd::DisturbanceEvent make_event(const std::string& node_id, uint64_t seq) {
+    const uint64_t t_ms = 1700000000000ULL + seq * 250;
+    icd::DisturbanceEvent ev;
+    ev.event_id = "3f1c2a4e-9b7d-4e21-8c55-" + std::to_string(100000000000ULL + seq);
+    ev.node_id = node_id;
+    ev.sequence_number = seq;
+    ev.timestamp_utc = time::format_utc_ms(t_ms);
+    ev.monotonic_ns = t_ms * 1000000ULL;
+    ev.signal_amplitude = 0.25 + 0.001 * static_cast<double>(seq);
+    ev.signal_energy = 9.5 + static_cast<double>(seq % 7);
+    ev.event_type = seq % 3 == 0 ? "VEHICLE" : "WALKING";
+    ev.generated_seed = static_cast<uint32_t>(seq * 2654435761u);
+    return ev;
+}
+
+nlohmann::json decode_ok(codec::StreamDecoder& decoder, const std::string& frame) {
+    auto msg = decoder.decode(frame.data(), frame.size());
+    REQUIRE(msg.has_value());
+    return *msg;
+}
+
+} // namespace
+
+TEST_CASE("TC-CODEC-001: Stream codec round trip", "[codec]") {
+    codec::StreamEncoder encoder("test_rt_enc", 8);
+    codec::StreamDecoder decoder("test_rt_dec");
+
+    // Interleaved streams, across several keyframe intervals
+    for (uint64_t seq = 1; seq <= 40; ++seq) {
+        for (const char* node : {"sensor_0", "sensor_1", "sensor_17"}) {
+            auto ev = make_event(node, seq);
+            REQUIRE(decode_ok(decoder, encoder.encode(ev)) == nlohmann::json(ev));
+
+            icd::NodeStatus st;
+            st.node_id = node;
+            st.timestamp_utc = time::format_utc_ms(1700000000000ULL + seq * 1000);
+            st.monotonic_ns = seq * 1000000000ULL;
+            st.uptime_s = static_cast<double>(seq);
+            st.last_sequence_number = seq;
+            st.bytes_sent = seq * 1500;
+            REQUIRE(decode_ok(decoder, encoder.encode(st)) == nlohmann::json(st));
+        }
+    }
+
+    // Off-schema messages travel as JSON text
+    nlohmann::json odd = {{"msg_type", "Unknown"}, {"node_id", "sensor_0"}, {"x", 1}};
+    REQUIRE(decode_ok(decoder, encoder.encode(odd)) == odd);
+}
+
+TEST_CASE("TC-CODEC-002: Stream codec drops delta frames after a gap", "[codec]") {
+    const int interval = 1000; // no keyframe inside the test window except the first
+    codec::StreamEncoder encoder("test_gap_enc", interval);
+    codec::StreamDecoder decoder("test_gap_dec");
+    const uint64_t drops_before = metrics::get("codec.test_gap_dec.desync_drops");
+
+    std::vector<std::string> frames;
+    for (uint64_t seq = 0; seq < 600; ++seq) frames.push_back(encoder.encode(make_event("sensor_3", seq)));
+
+    decode_ok(decoder, frames[0]); // keyframe
+    decode_ok(decoder, frames[1]);
+
+    // One frame lost: the next delta frame is dropped rather than decoded against stale state
+    REQUIRE_FALSE(decoder.decode(frames[3].data(), frames[3].size()).has_value());
+    // Still out of sync on the following frames
+    REQUIRE_FALSE(decoder.decode(frames[4].data(), frames[4].size()).has_value());
+
+    // A loss of exactly 256 frames is a gap too (the counter is not 8 bits)
+    codec::StreamDecoder fresh("test_gap_dec");
+    decode_ok(fresh, frames[0]);
+    decode_ok(fresh, frames[1]);
+    REQUIRE_FALSE(fresh.decode(frames[258].data(), frames[258].size()).has_value());
+
+    decoder.flush_metrics();
+    fresh.flush_metrics();
+    REQUIRE(metrics::get("codec.test_gap_dec.desync_drops") - drops_before == 3);
+
+    // The next keyframe brings the stream back
+    codec::StreamEncoder keyed("test_gap_enc", 4);
+    codec::StreamDecoder resync("test_gap_dec");
+    std::vector<std::string> short_frames;
+    for (uint64_t seq = 0; seq < 10; ++seq) short_frames.push_back(keyed.encode(make_event("sensor_3", seq)));
+    decode_ok(resync, short_frames[0]);
+    REQUIRE_FALSE(resync.decode(short_frames[2].data(), short_frames[2].size()).has_value());
+    REQUIRE_FALSE(resync.decode(short_frames[3].data(), short_frames[3].size()).has_value());
+    REQUIRE(decode_ok(resync, short_frames[4]) == nlohmann::json(make_event("sensor_3", 4))); // keyframe
+    REQUIRE(decode_ok(resync, short_frames[5]) == nlohmann::json(make_event("sensor_3", 5)));
+}
+
+TEST_CASE("TC-CODEC-003: Stream codec rejects a keyframe whose stream id does not match", "[codec]") {
+    codec::StreamEncoder encoder("test_id_enc", 32);
+    codec::StreamDecoder decoder("test_id_dec");
+
+    std::string keyframe = encoder.encode(make_event("sensor_5", 1));
+    REQUIRE(static_cast<uint8_t>(keyframe[0]) != '{');
+    std::string forged = keyframe;
+    forged[3] = static_cast<char>(forged[3] ^ 0x01); // first byte of the 64-bit stream id
+    REQUIRE_FALSE(decoder.decode(forged.data(), forged.size()).has_value());
+
+    // The stream was not created, so its delta frames are not decoded either
+    std::string delta = encoder.encode(make_event("sensor_5", 2));
+    REQUIRE_FALSE(decoder.decode(delta.data(), delta.size()).has_value());
+
+    REQUIRE(decode_ok(decoder, keyframe) == nlohmann::json(make_event("sensor_5", 1)));
+    REQUIRE(decode_ok(decoder, delta) == nlohmann::json(make_event("sensor_5", 2)));
+}
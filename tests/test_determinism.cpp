@@ -1,5 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "proc.hpp"
+#include "log_analysis.hpp"
+#include "sandbox.hpp"
+#include "wait.hpp"
 #include <filesystem>
 #include <thread>
 #include <fstream>
@@ -21,21 +24,20 @@ std::string read_file_content(const std::string& path) {
     return ss.str();
 }
 
-void run_deterministic_cycle(const std::string& out_dir) {
-    std::string config_path = "../../../config/system_deterministic.json";
-    
-    std::filesystem::remove_all("run_logs");
-    std::filesystem::create_directory("run_logs");
+// Runs one replay in its own sandbox and returns its log_dir
+std::string run_deterministic_cycle(const std::string& name) {
+    auto sb = sandbox::create("../../../config/system_deterministic.json", name);
+    const std::string& config_path = sb.config_path;
 
     std::vector<std::unique_ptr<proc::Process>> procs;
     
     // Index 0: central processor
     procs.push_back(std::make_unique<proc::Process>("../central_processor" + EXT, std::vector<std::string>{config_path}));
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    REQUIRE(wait::for_ready(sb.log_dir, "central"));
     
     // Index 1: network emulator
     procs.push_back(std::make_unique<proc::Process>("../network_emulator" + EXT, std::vector<std::string>{config_path}));
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    REQUIRE(wait::for_ready(sb.log_dir, "network"));
     
     // Index 2+: sensor nodes
     for (int i = 0; i < 1; ++i) {
@@ -44,40 +46,35 @@ void run_deterministic_cycle(const std::string& out_dir) {
         }));
     }
 
-    // Sensor runs in deterministic mode (no real-time sleep), so it finishes quickly.
-    // Wait long enough for sensor to complete all events.
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+    // Sensors replay the whole run under credit flow control and exit on their own
+    for (size_t i = 2; i < procs.size(); ++i) {
+        REQUIRE(wait::until([&] { return procs[i]->try_wait(); }, std::chrono::seconds(30)));
+    }
 
-    // Staged shutdown: kill sensors first
+    // Flow control makes the replay lossless, so central is drained once it has
+    // written one alert per generated event
+    std::vector<std::string> sensor_logs;
     for (size_t i = 2; i < procs.size(); ++i) {
-        procs[i]->terminate();
-        procs[i]->wait();
+        sensor_logs.push_back(sb.log("sensor_" + std::to_string(i - 2) + ".jsonl"));
     }
+    size_t expected = log_analysis::count_messages(sensor_logs, "Generated event");
+    REQUIRE(wait::until([&] { return log_analysis::count_lines(sb.log("alerts.jsonl")) >= expected; },
+                        std::chrono::seconds(30)));
 
-    // Wait for network emulator to flush its queue to central
-    std::this_thread::sleep_for(std::chrono::seconds(2));
     procs[1]->terminate();
     procs[1]->wait();
-
-    // Wait for central processor to drain the ZMQ receive queue and write all alerts
-    std::this_thread::sleep_for(std::chrono::seconds(3));
     procs[0]->terminate();
     procs[0]->wait();
-    
-    std::filesystem::remove_all(out_dir);
-    std::filesystem::copy("run_logs", out_dir, std::filesystem::copy_options::recursive);
+
+    return sb.log_dir;
 }
 
 TEST_CASE("TC-DET-001: Determinism Requirement (SR-005)", "[determinism]") {
-    run_deterministic_cycle("run_1_logs");
+    std::string logs1 = run_deterministic_cycle("tc_det_001_run_1");
+    std::string logs2 = run_deterministic_cycle("tc_det_001_run_2");
 
-    // Give the OS time to fully release ZMQ ports before run 2 rebinds them
-    std::this_thread::sleep_for(std::chrono::seconds(2));
-
-    run_deterministic_cycle("run_2_logs");
-    
-    std::string alerts1 = read_file_content("run_1_logs/alerts.jsonl");
-    std::string alerts2 = read_file_content("run_2_logs/alerts.jsonl");
+    std::string alerts1 = read_file_content(logs1 + "/alerts.jsonl");
+    std::string alerts2 = read_file_content(logs2 + "/alerts.jsonl");
     
     REQUIRE(!alerts1.empty());
     REQUIRE(alerts1 == alerts2);
@@ -0,0 +1,172 @@
+#include <catch2/catch_test_macros.hpp>
+#include "icd_parser.hpp"
+#include "metrics.hpp"
+#include "quarantine.hpp"
+#include "time.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace surveillance;
+
+namespace {
+
+nlohmann::json valid_event() {
+    icd::DisturbanceEvent ev;
+    ev.event_id = "3f1c2a4e-9b7d-4e21-8c55-100000000001";
+    ev.node_id = "sensor_4";
+    ev.sequence_number = 17;
+    ev.timestamp_utc = time::format_utc_ms(1700000000000ULL);
+    ev.monotonic_ns = 123456789;
+    ev.signal_amplitude = 0.5;
+    ev.signal_energy = 12.25;
+    ev.event_type = "VEHICLE";
+    ev.generated_seed = 42;
+    return nlohmann::json(ev);
+}
+
+// The valid event with `key` replaced by the raw JSON text `value`
+std::string with_field(const std::string& key, const std::string& value) {
+    nlohmann::json j = valid_event();
+    j[key] = "@@";
+    std::string text = j.dump();
+    return text.replace(text.find("\"@@\""), 4, value);
+}
+
+std::string without_field(const std::string& key) {
+    nlohmann::json j = valid_event();
+    j.erase(key);
+    return j.dump();
+}
+
+icd::ParseError parse(const std::string& frame) {
+    icd::MessageView view;
+    return icd::parse(frame, view);
+}
+
+} // namespace
+
+TEST_CASE("TC-ICD-001: In-place parser accepts valid messages", "[icd_parser]") {
+    const std::string frame = valid_event().dump();
+    icd::MessageView view;
+    REQUIRE(icd::parse(frame, view) == icd::ParseError::NONE);
+    REQUIRE(view.type == icd::MessageType::DISTURBANCE_EVENT);
+    REQUIRE(view.node_id == "sensor_4");
+    REQUIRE(view.sequence_number == 17);
+    REQUIRE(view.signal_energy == 12.25);
+
+    // Whitespace, unknown keys of any shape, and nesting up to the limit are skipped
+    std::string nested = std::string(64, '[') + std::string(64, ']');
+    REQUIRE(parse(with_field("extra", " { \"a\" : [1, -2.5e3, true, null, \"x\\\"y\"] } ")) == icd::ParseError::NONE);
+    REQUIRE(parse(with_field("extra", nested)) == icd::ParseError::NONE);
+
+    // Duplicate keys: the last one wins, as in the DOM
+    std::string dup = valid_event().dump();
+    dup.insert(dup.size() - 1, ",\"sequence_number\":99");
+    REQUIRE(icd::parse(dup, view) == icd::ParseError::NONE);
+    REQUIRE(view.sequence_number == 99);
+    nlohmann::json dom = nlohmann::json::parse(dup);
+    icd::MessageView dom_view;
+    REQUIRE(icd::from_json(dom, dom_view) == icd::ParseError::NONE);
+    REQUIRE(dom_view.sequence_number == 99);
+}
+
+TEST_CASE("TC-ICD-002: In-place parser rejects malformed messages", "[icd_parser]") {
+    struct Case {
+        std::string name;
+        std::string frame;
+        icd::ParseError expected;
+        std::optional<icd::ParseError> dom_expected{}; // when the DOM path differs
+    };
+    std::vector<Case> cases = {
+        {"trailing bytes", valid_event().dump() + " {}", icd::ParseError::SYNTAX},
+        {"not an object", "[1,2,3]", icd::ParseError::NOT_OBJECT},
+        {"no msg_type", without_field("msg_type"), icd::ParseError::MISSING_TYPE},
+        {"missing field", without_field("event_id"), icd::ParseError::MISSING_FIELD},
+        {"string for a number", with_field("sequence_number", "\"17\""), icd::ParseError::WRONG_TYPE},
+        {"negative unsigned", with_field("sequence_number", "-1"), icd::ParseError::WRONG_TYPE},
+        {"fractional unsigned", with_field("sequence_number", "1.5"), icd::ParseError::WRONG_TYPE},
+        {"number for a string", with_field("node_id", "4"), icd::ParseError::WRONG_TYPE},
+        {"object for a number", with_field("signal_energy", "{}"), icd::ParseError::WRONG_TYPE},
+        // The DOM has already decoded the escape into plain ASCII
+        {"escape in a string", with_field("node_id", "\"sensor\\u0034\""), icd::ParseError::BAD_STRING, icd::ParseError::NONE},
+        {"non-ASCII string", with_field("node_id", "\"sens\xC3\xB6r\""), icd::ParseError::BAD_STRING},
+        {"hops not an array", with_field("hops", "5"), icd::ParseError::WRONG_TYPE},
+        {"too many hops", with_field("hops", "[1,2,3,4,5,6,7,8,9]"), icd::ParseError::TOO_MANY_HOPS},
+        // The in-place parser bounds its recursion; the DOM has no depth limit
+        {"nesting too deep", with_field("extra", std::string(200, '[') + std::string(200, ']')), icd::ParseError::SYNTAX,
+         icd::ParseError::NONE},
+        {"bad literal", with_field("extra", "tru"), icd::ParseError::SYNTAX},
+        {"bad number", with_field("extra", "01"), icd::ParseError::SYNTAX},
+        {"unterminated string", "{\"msg_type\":\"DisturbanceEvent", icd::ParseError::SYNTAX},
+    };
+
+    for (const auto& c : cases) {
+        INFO(c.name);
+        REQUIRE(parse(c.frame) == c.expected);
+
+        // The DOM path (decoded codec frames) reaches the same verdict
+        nlohmann::json dom = nlohmann::json::parse(c.frame, nullptr, false);
+        if (!dom.is_discarded()) {
+            icd::MessageView view;
+            REQUIRE(icd::from_json(dom, view) == c.dom_expected.value_or(c.expected));
+        }
+    }
+
+    // Every truncation of a valid frame is a syntax error, never a partial message
+    const std::string frame = valid_event().dump();
+    for (size_t n = 0; n < frame.size(); ++n) {
+        INFO("truncated to " << n << " bytes");
+        REQUIRE(parse(frame.substr(0, n)) == icd::ParseError::SYNTAX);
+    }
+}
+
+TEST_CASE("TC-ICD-003: Other message types are left to the DOM", "[icd_parser]") {
+    // A type the parser does not cover may reuse a known key with another type
+    const std::string frame =
+        "{\"msg_type\":\"WaveformBlock\",\"node_id\":\"sensor_1\",\"sequence_number\":\"n/a\",\"samples\":[1,2,3]}";
+    REQUIRE(parse(frame) == icd::ParseError::UNSUPPORTED_TYPE);
+    nlohmann::json dom = nlohmann::json::parse(frame, nullptr, false);
+    REQUIRE_FALSE(dom.is_discarded());
+    icd::MessageView view;
+    REQUIRE(icd::from_json(dom, view) == icd::ParseError::UNSUPPORTED_TYPE);
+}
+
+TEST_CASE("TC-ICD-004: Quarantine names every rejection reason", "[icd_parser]") {
+    const std::vector<std::pair<icd::ParseError, std::string>> names = {
+        {icd::ParseError::SYNTAX, "syntax"},
+        {icd::ParseError::NOT_OBJECT, "not_object"},
+        {icd::ParseError::MISSING_TYPE, "missing_type"},
+        {icd::ParseError::UNSUPPORTED_TYPE, "unsupported_type"},
+        {icd::ParseError::WRONG_TYPE, "wrong_type"},
+        {icd::ParseError::MISSING_FIELD, "missing_field"},
+        {icd::ParseError::BAD_STRING, "bad_string"},
+        {icd::ParseError::TOO_MANY_HOPS, "too_many_hops"},
+    };
+    REQUIRE(names.size() == static_cast<size_t>(icd::ParseError::COUNT) - 1);
+
+    std::filesystem::create_directories("tc_icd_004");
+    const std::string path = "tc_icd_004/quarantine.jsonl";
+    {
+        central::Quarantine quarantine(path, 100);
+        for (const auto& [reason, name] : names) {
+            INFO(name);
+            REQUIRE(icd::parse_error_name(reason) == name);
+            const uint64_t before = metrics::get("central.invalid_messages." + name);
+            const std::string frame = "{\"bad\":" + name + "}";
+            quarantine.add(reason, frame.data(), frame.size());
+            REQUIRE(metrics::get("central.invalid_messages." + name) - before == 1);
+        }
+    }
+
+    std::ifstream in(path);
+    std::string line;
+    for (const auto& [reason, name] : names) {
+        REQUIRE(std::getline(in, line));
+        auto record = nlohmann::json::parse(line);
+        REQUIRE(record["reason"] == name);
+    }
+}
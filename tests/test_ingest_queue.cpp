@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ingest_queue.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+using namespace surveillance;
+using central::PriorityClass;
+
+namespace {
+
+// rx_ns tells the messages apart
+central::InboundMessage message(uint64_t tag) {
+    central::InboundMessage msg;
+    msg.rx_ns = tag;
+    return msg;
+}
+
+// Offers tags first..first+n-1 of one class; the number accepted
+size_t offer(central::IngestQueue& queue, PriorityClass cls, uint64_t first, size_t n = 1) {
+    size_t accepted = 0;
+    for (uint64_t tag = first; tag < first + n; ++tag) {
+        if (queue.offer(cls, message(tag))) ++accepted;
+    }
+    return accepted;
+}
+
+// Everything queued, in pop order
+std::vector<std::pair<PriorityClass, uint64_t>> pop_all(central::IngestQueue& queue) {
+    std::vector<std::pair<PriorityClass, uint64_t>> out;
+    while (auto item = queue.pop(std::chrono::milliseconds(0))) {
+        out.emplace_back(item->cls, item->msg.rx_ns);
+    }
+    return out;
+}
+
+void require_dropped(const central::IngestQueue& queue, std::initializer_list<uint64_t> expected) {
+    size_t cls = 0;
+    for (uint64_t n : expected) {
+        INFO(central::priority_class_name(static_cast<PriorityClass>(cls)));
+        REQUIRE(queue.dropped(static_cast<PriorityClass>(cls++)) == n);
+    }
+}
+
+} // namespace
+
+TEST_CASE("TC-INGEST-001: Ingest queue sheds by priority class", "[ingest_queue]") {
+    SECTION("STATUS is never shed while a lower class is queued") {
+        central::IngestQueueConfig cfg;
+        cfg.capacity = 4;
+        cfg.overload_high_watermark = 0.5;
+        cfg.overload_low_watermark = 0.25;
+        cfg.low_priority_sample_every_n = 1000;
+        central::IngestQueue queue(cfg);
+
+        REQUIRE(offer(queue, PriorityClass::HIGH, 1, 2) == 2);
+        REQUIRE(offer(queue, PriorityClass::MEDIUM, 3, 2) == 2);
+        REQUIRE(queue.depth() == 4);
+        REQUIRE(queue.overloaded());
+
+        // Overloaded and full: each status message evicts the newest of the lowest class
+        REQUIRE(offer(queue, PriorityClass::STATUS, 10, 4) == 4);
+        require_dropped(queue, {0, 2, 2, 0});
+        REQUIRE(pop_all(queue) == std::vector<std::pair<PriorityClass, uint64_t>>{
+            {PriorityClass::STATUS, 10}, {PriorityClass::STATUS, 11},
+            {PriorityClass::STATUS, 12}, {PriorityClass::STATUS, 13}});
+    }
+
+    SECTION("HIGH evicts LOW, then MEDIUM, before it is dropped") {
+        central::IngestQueueConfig cfg;
+        cfg.capacity = 3;
+        cfg.overload_high_watermark = 1.0;
+        cfg.low_priority_sample_every_n = 1;
+        central::IngestQueue queue(cfg);
+
+        REQUIRE(offer(queue, PriorityClass::LOW, 1) == 1);
+        REQUIRE(offer(queue, PriorityClass::MEDIUM, 2) == 1);
+        REQUIRE(offer(queue, PriorityClass::LOW, 3) == 1);
+
+        REQUIRE(offer(queue, PriorityClass::HIGH, 10) == 1); // evicts LOW 3, the newest
+        require_dropped(queue, {0, 0, 0, 1});
+        REQUIRE(offer(queue, PriorityClass::HIGH, 11) == 1); // evicts LOW 1
+        require_dropped(queue, {0, 0, 0, 2});
+        REQUIRE(offer(queue, PriorityClass::HIGH, 12) == 1); // evicts MEDIUM 2
+        require_dropped(queue, {0, 0, 1, 2});
+        REQUIRE(offer(queue, PriorityClass::HIGH, 13) == 0); // nothing lower is left
+        REQUIRE(offer(queue, PriorityClass::LOW, 14) == 0);  // nor below a LOW
+        require_dropped(queue, {0, 1, 1, 3});
+
+        REQUIRE(pop_all(queue) == std::vector<std::pair<PriorityClass, uint64_t>>{
+            {PriorityClass::HIGH, 10}, {PriorityClass::HIGH, 11}, {PriorityClass::HIGH, 12}});
+    }
+
+    SECTION("LOW is sampled 1-in-N while overloaded, and only then") {
+        central::IngestQueueConfig cfg;
+        cfg.capacity = 100;
+        cfg.overload_high_watermark = 0.1;
+        cfg.overload_low_watermark = 0.05;
+        cfg.low_priority_sample_every_n = 3;
+        central::IngestQueue queue(cfg);
+
+        REQUIRE(offer(queue, PriorityClass::LOW, 1, 5) == 5);
+        REQUIRE(offer(queue, PriorityClass::MEDIUM, 100, 5) == 5);
+        REQUIRE_FALSE(queue.overloaded());
+
+        // The next offer sees the high watermark: LOW 10, 13 and 16 are kept
+        REQUIRE(offer(queue, PriorityClass::LOW, 10, 9) == 3);
+        REQUIRE(queue.overloaded());
+        REQUIRE(offer(queue, PriorityClass::MEDIUM, 200, 3) == 3); // other classes are not sampled
+        require_dropped(queue, {0, 0, 0, 6});
+
+        // Down to the low watermark the overload ends, and so does the sampling
+        for (int i = 0; i < 11; ++i) REQUIRE(queue.pop(std::chrono::milliseconds(0)));
+        REQUIRE(queue.depth() == 5);
+        REQUIRE_FALSE(queue.overloaded());
+        REQUIRE(offer(queue, PriorityClass::LOW, 30, 4) == 4);
+        require_dropped(queue, {0, 0, 0, 6});
+
+        std::vector<uint64_t> low;
+        for (const auto& [cls, tag] : pop_all(queue)) {
+            REQUIRE(cls == PriorityClass::LOW);
+            low.push_back(tag);
+        }
+        REQUIRE(low == std::vector<uint64_t>{4, 5, 10, 13, 16, 30, 31, 32, 33});
+    }
+}
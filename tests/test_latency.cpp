@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "proc.hpp"
-#include "log_parse.hpp"
+#include "log_analysis.hpp"
+#include "sandbox.hpp"
+#include "wait.hpp"
 #include <filesystem>
 #include <thread>
 #include <algorithm>
@@ -15,24 +17,21 @@ using namespace surveillance;
 #endif
 
 TEST_CASE("TC-LAT-001: Latency Requirement (SR-001)", "[latency]") {
-    // Generate a temporary config for a 10s run to avoid 10 min CTest hangs in general CI,
-    // though the requirement says 10 minutes. We assume a 15s test proves the p95.
-    // In actual rigorous run, we'd use 600.
-    std::string config_path = "../../../config/system_nominal.json";
-    
-    // Clean old logs
-    std::filesystem::remove_all("run_logs");
-    std::filesystem::create_directory("run_logs");
+    // Runs until a fixed number of alerts is collected to avoid 10 min CTest hangs in general CI,
+    // though the requirement says 10 minutes. In actual rigorous run, we'd use 600.
+    // On tcp, the shipped default transport; the other cases use ipc
+    auto sb = sandbox::create("../../../config/system_nominal.json", "tc_lat_001", {{"transport", {{"kind", "tcp"}}}});
+    const std::string& config_path = sb.config_path;
 
     std::vector<std::unique_ptr<proc::Process>> procs;
     
     // Start central
     procs.push_back(std::make_unique<proc::Process>("../central_processor" + EXT, std::vector<std::string>{config_path}));
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    REQUIRE(wait::for_ready(sb.log_dir, "central"));
     
-    // Start network emulator
+    // Start network emulator; it is ready once central has subscribed downstream
     procs.push_back(std::make_unique<proc::Process>("../network_emulator" + EXT, std::vector<std::string>{config_path}));
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    REQUIRE(wait::for_ready(sb.log_dir, "network"));
     
     // Start sensors
     for (int i = 0; i < 10; ++i) {
@@ -40,9 +39,14 @@ TEST_CASE("TC-LAT-001: Latency Requirement (SR-001)", "[latency]") {
             config_path, "sensor_" + std::to_string(i), std::to_string(i)
         }));
     }
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(wait::for_ready(sb.log_dir, "sensor_" + std::to_string(i)));
+    }
 
-    // Wait for tests to finish (approx 15 seconds)
-    std::this_thread::sleep_for(std::chrono::seconds(15));
+    // Collect enough alerts for a stable p95 rather than sleeping a fixed 15 s
+    const size_t kMinSamples = 40;
+    REQUIRE(wait::until([&] { return log_analysis::count_lines(sb.log("alerts.jsonl")) >= kMinSamples; },
+                        std::chrono::seconds(30), std::chrono::milliseconds(100)));
     
     for (auto& p : procs) {
         p->terminate();
@@ -51,22 +55,15 @@ TEST_CASE("TC-LAT-001: Latency Requirement (SR-001)", "[latency]") {
         p->wait();
     }
     
-    // Parse alerts
-    auto alerts = log_parse::read_jsonl("run_logs/alerts.jsonl");
-    REQUIRE(!alerts.empty());
-    
-    std::vector<double> latencies;
-    for (const auto& a : alerts) {
-        if (a.contains("processing_latency_ms")) {
-            latencies.push_back(a["processing_latency_ms"].get<double>());
-        }
-    }
-    REQUIRE(latencies.size() > 0);
+    // Scan alerts (p95 is the sorted sample at floor(0.95 * n))
+    auto alerts = log_analysis::summarize_alerts({sb.log("alerts.jsonl")});
+    REQUIRE(alerts.alerts > 0);
+    REQUIRE(alerts.latency.count > 0);
+
+    // Nothing our own components send may fail central's ICD validation
+    REQUIRE(log_analysis::count_lines(sb.log("quarantine.jsonl")) == 0);
     
-    // Compute p95
-    std::sort(latencies.begin(), latencies.end());
-    size_t p95_idx = static_cast<size_t>(0.95 * latencies.size());
-    double p95 = latencies[p95_idx];
+    double p95 = alerts.latency.p95;
     
     REQUIRE(p95 <= 250.0);
 }
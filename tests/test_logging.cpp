@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "proc.hpp"
-#include "log_parse.hpp"
+#include "log_analysis.hpp"
+#include "sandbox.hpp"
+#include "wait.hpp"
 #include <filesystem>
 #include <thread>
 
@@ -13,15 +15,13 @@ using namespace surveillance;
 #endif
 
 TEST_CASE("TC-LOG-001: Logging Completeness Requirement (SR-003)", "[logging]") {
-    std::string config_path = "../../../config/system_nominal.json";
-    
-    std::filesystem::remove_all("run_logs");
-    std::filesystem::create_directory("run_logs");
+    auto sb = sandbox::create("../../../config/system_nominal.json", "tc_log_001");
+    const std::string& config_path = sb.config_path;
 
     std::vector<std::unique_ptr<proc::Process>> procs;
     
     procs.push_back(std::make_unique<proc::Process>("../central_processor" + EXT, std::vector<std::string>{config_path}));
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    REQUIRE(wait::for_ready(sb.log_dir, "central"));
     
     procs.push_back(std::make_unique<proc::Process>("../sensor_node" + EXT, std::vector<std::string>{
         config_path, "sensor_0", "0"
@@ -34,12 +34,8 @@ TEST_CASE("TC-LOG-001: Logging Completeness Requirement (SR-003)", "[logging]")
         p->wait();
     }
 
-    auto alerts = log_parse::read_jsonl("run_logs/alerts.jsonl");
-    for (const auto& a : alerts) {
-        REQUIRE(a.contains("timestamp_utc"));
-        REQUIRE(a.contains("source_node_id"));
-        REQUIRE(a.contains("event_id"));
-        REQUIRE(a.contains("classification"));
-        REQUIRE(a.contains("processing_latency_ms"));
-    }
+    // Every alert carries timestamp_utc, source_node_id, event_id, classification
+    // and processing_latency_ms
+    auto alerts = log_analysis::summarize_alerts({sb.log("alerts.jsonl")});
+    REQUIRE(alerts.missing_fields == 0);
 }
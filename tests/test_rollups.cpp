@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+#include "rollups.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+using namespace surveillance;
+
+namespace {
+
+constexpr uint64_t kStartMs = 1700000000000ULL;
+
+// Events of `node` in arrival order, one every `step_ms` of central's clock
+void feed(central::Rollups& rollups, const std::string& node, std::initializer_list<uint64_t> sequences,
+          uint64_t& now_ms, uint64_t step_ms = 10) {
+    for (uint64_t seq : sequences) {
+        rollups.record(node, now_ms, seq, "LOW", 1.0);
+        now_ms += step_ms;
+    }
+}
+
+// Lost events in the per-second series of `node` ("" for the fleet)
+uint64_t lost(central::Rollups& rollups, const std::string& node, uint64_t now_ms) {
+    auto j = rollups.to_json(now_ms);
+    const auto& series = node.empty() ? j["fleet"]["1"] : j["nodes"][node]["1"];
+    uint64_t total = 0;
+    for (const auto& v : series["lost"]) total += v.get<uint64_t>();
+    return total;
+}
+
+} // namespace
+
+TEST_CASE("TC-ROLL-001: Rollups count lost events under reordering", "[rollups]") {
+    central::Rollups rollups(16);
+    uint64_t now_ms = kStartMs;
+
+    SECTION("Reordered arrivals are not losses") {
+        feed(rollups, "sensor_0", {1, 2, 3, 5, 4, 6, 9, 7, 8, 10}, now_ms);
+        REQUIRE(lost(rollups, "sensor_0", now_ms) == 0);
+        REQUIRE(lost(rollups, "", now_ms) == 0);
+    }
+
+    SECTION("A real gap stays counted, and so does one filled too late") {
+        feed(rollups, "sensor_0", {1, 2, 4, 5}, now_ms);
+        REQUIRE(lost(rollups, "sensor_0", now_ms) == 1);
+
+        feed(rollups, "sensor_1", {1}, now_ms);
+        for (uint64_t seq = 3; seq < 3 + central::Rollups::kReorderWindow; ++seq) feed(rollups, "sensor_1", {seq}, now_ms);
+        feed(rollups, "sensor_1", {2}, now_ms); // fell out of the window
+        REQUIRE(lost(rollups, "sensor_1", now_ms) == 1);
+        REQUIRE(lost(rollups, "", now_ms) == 2);
+    }
+
+    SECTION("A late arrival is credited to the slot where its gap was counted") {
+        feed(rollups, "sensor_0", {1, 3}, now_ms, 600); // the gap is counted in the first second
+        feed(rollups, "sensor_0", {2, 2}, now_ms, 600); // the next second fills it; the duplicate is ignored
+        auto j = rollups.to_json(now_ms);
+        for (const auto& v : j["nodes"]["sensor_0"]["1"]["lost"]) REQUIRE(v.get<uint64_t>() == 0);
+        REQUIRE(lost(rollups, "", now_ms) == 0);
+    }
+
+    SECTION("Only a restart resets the numbering") {
+        feed(rollups, "sensor_0", {100, 101}, now_ms);
+        feed(rollups, "sensor_0", {1}, now_ms);  // far behind: not a restart, not a loss
+        feed(rollups, "sensor_0", {102}, now_ms);
+        REQUIRE(lost(rollups, "sensor_0", now_ms) == 0);
+
+        rollups.node_restarted("sensor_0");
+        feed(rollups, "sensor_0", {1, 2, 4}, now_ms);
+        REQUIRE(lost(rollups, "sensor_0", now_ms) == 1);
+    }
+}
@@ -0,0 +1,105 @@
+#include <catch2/catch_test_macros.hpp>
+#include "proc.hpp"
+#include "log_analysis.hpp"
+#include "sandbox.hpp"
+#include "wait.hpp"
+#include <map>
+#include <set>
+#include <thread>
+
+using namespace surveillance;
+
+#if defined(_WIN32)
+    const std::string EXT = ".exe";
+#else
+    const std::string EXT = "";
+#endif
+
+namespace {
+
+constexpr int kShards = 2;
+constexpr int kNodes = 10;
+
+// node_id -> shards whose alerts file holds an alert from it
+std::map<std::string, std::set<int>> alert_owners(const sandbox::Sandbox& sb) {
+    std::map<std::string, std::set<int>> owners;
+    for (int k = 0; k < kShards; ++k) {
+        auto files = log_analysis::log_files(sb.log("alerts_" + std::to_string(k) + ".jsonl"));
+        for (const auto& [node, count] : log_analysis::summarize_alerts(files).by_node) {
+            if (count > 0) owners[node].insert(k);
+        }
+    }
+    return owners;
+}
+
+} // namespace
+
+TEST_CASE("TC-SHARD-001: Sharded routing and rebalance on shard loss", "[sharding]") {
+    auto sb = sandbox::create("../../../config/system_sharded.json", "tc_shard_001",
+                              {{"central", {{"shards", kShards}}}});
+    const std::string& config_path = sb.config_path;
+
+    std::vector<std::unique_ptr<proc::Process>> shards;
+    for (int k = 0; k < kShards; ++k) {
+        shards.push_back(std::make_unique<proc::Process>("../central_processor" + EXT, std::vector<std::string>{
+            config_path, "--shard", std::to_string(k)
+        }));
+    }
+    for (int k = 0; k < kShards; ++k) {
+        REQUIRE(wait::for_ready(sb.log_dir, "central_" + std::to_string(k)));
+    }
+
+    std::vector<std::unique_ptr<proc::Process>> procs;
+    procs.push_back(std::make_unique<proc::Process>("../network_emulator" + EXT, std::vector<std::string>{config_path}));
+    REQUIRE(wait::for_ready(sb.log_dir, "network"));
+    for (int i = 0; i < kNodes; ++i) {
+        procs.push_back(std::make_unique<proc::Process>("../sensor_node" + EXT, std::vector<std::string>{
+            config_path, "sensor_" + std::to_string(i), std::to_string(i)
+        }));
+    }
+    for (int i = 0; i < kNodes; ++i) {
+        REQUIRE(wait::for_ready(sb.log_dir, "sensor_" + std::to_string(i)));
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+
+    // Every node's alerts land in exactly one shard's file
+    auto owners = alert_owners(sb);
+    REQUIRE(owners.size() == kNodes);
+    std::set<std::string> moved; // nodes of the shard that is killed below
+    for (const auto& [node, in] : owners) {
+        INFO(node);
+        REQUIRE(in.size() == 1);
+        if (*in.begin() == 0) moved.insert(node);
+    }
+    REQUIRE(!moved.empty());
+    REQUIRE(moved.size() < static_cast<size_t>(kNodes));
+
+    // A crash: the emulator sees the shard's subscription go with its connection
+    shards[0]->kill();
+    shards[0]->wait();
+    REQUIRE(wait::until([&] {
+        return log_analysis::count_messages({sb.log("network.jsonl")}, "Central shard left") >= 1;
+    }, std::chrono::seconds(5)));
+
+    // The departed shard's nodes move to the survivor; nothing else moves
+    REQUIRE(wait::until([&] {
+        auto now = alert_owners(sb);
+        for (const auto& node : moved) {
+            if (!now[node].count(1)) return false;
+        }
+        return true;
+    }, std::chrono::seconds(10)));
+
+    for (auto& p : procs) {
+        p->terminate();
+        p->wait();
+    }
+    shards[1]->terminate();
+    shards[1]->wait();
+
+    for (const auto& [node, in] : alert_owners(sb)) {
+        INFO(node);
+        if (!moved.count(node)) CHECK(in == std::set<int>{1});
+    }
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include "metrics.hpp"
+#include "shm_ring.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace surveillance;
+
+namespace {
+
+// In the forked producer: the fault in the middle of its copy becomes a SIGKILL
+void kill_self(int) {
+    ::kill(::getpid(), SIGKILL);
+}
+
+// Frames until `n` arrived or `timeout` passed
+std::vector<std::string> receive(shm::RingConsumer& consumer, size_t n, std::chrono::milliseconds timeout) {
+    std::vector<std::string> frames;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (frames.size() < n && std::chrono::steady_clock::now() < deadline) {
+        auto frame = consumer.peek();
+        if (!frame) {
+            consumer.wait(std::chrono::milliseconds(1));
+            continue;
+        }
+        frames.emplace_back(*frame);
+        consumer.pop();
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST_CASE("TC-SHM-001: Shared-memory ring skips the frame of a producer killed mid-claim", "[shm]") {
+    const std::string endpoint = "shm://surveillance.tc_shm_001." + std::to_string(::getpid());
+    shm::RingConsumer consumer(endpoint, 1 << 16, "tc_shm_001");
+    const uint64_t abandoned_before = metrics::get("shm.tc_shm_001.abandoned_frames");
+
+    // The source of the second frame runs into an inaccessible page part way through,
+    // so the producer dies after claiming the space and before committing it
+    const long page = ::sysconf(_SC_PAGESIZE);
+    char* pages = static_cast<char*>(::mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE,
+                                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    REQUIRE(pages != MAP_FAILED);
+    REQUIRE(::mprotect(pages + page, page, PROT_NONE) == 0);
+
+    pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        std::signal(SIGSEGV, kill_self);
+        std::atomic<bool> running{true};
+        shm::RingProducer producer(endpoint, "tc_shm_001");
+        if (!producer.wait_for_consumer(std::chrono::seconds(5), running)) ::_exit(1);
+        producer.send("before");
+        producer.send(std::string_view(pages + page - 64, 1024));
+        ::_exit(2); // not reached
+    }
+    int status = 0;
+    REQUIRE(::waitpid(child, &status, 0) == child);
+    REQUIRE(WIFSIGNALED(status));
+    REQUIRE(WTERMSIG(status) == SIGKILL);
+
+    // Claimed after the abandoned frame, so only delivered once it is skipped
+    std::atomic<bool> running{true};
+    shm::RingProducer producer(endpoint, "tc_shm_001");
+    REQUIRE(producer.wait_for_consumer(std::chrono::seconds(5), running));
+    REQUIRE(producer.send("after"));
+
+    auto frames = receive(consumer, 2, std::chrono::seconds(5));
+    REQUIRE(frames == std::vector<std::string>{"before", "after"});
+    REQUIRE(metrics::get("shm.tc_shm_001.abandoned_frames") - abandoned_before == 1);
+    REQUIRE(consumer.stats().producers == 1); // the dead producer's slot is free again
+
+    ::munmap(pages, 2 * page);
+}
@@ -0,0 +1,390 @@
+#include "log_analysis.hpp"
+#include "segmented_file.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace surveillance {
+namespace log_analysis {
+
+namespace {
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+uint64_t fnv1a64(std::string_view s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Same-sized per-worker slots, merged after the parallel pass
+template <typename T>
+std::vector<T> per_worker(size_t threads) {
+    return std::vector<T>(worker_count(threads));
+}
+
+} // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    if (ends_with(path, ".gz")) {
+        gzFile in = gzopen(path.c_str(), "rb");
+        if (!in) return;
+        gzbuffer(in, 1 << 17);
+        char buf[1 << 16];
+        int n;
+        while ((n = gzread(in, buf, sizeof(buf))) > 0) {
+            owned_.append(buf, static_cast<size_t>(n));
+        }
+        gzclose(in);
+        data_ = owned_.data();
+        size_ = owned_.size();
+        return;
+    }
+#if defined(_WIN32)
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return;
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    owned_ = ss.str();
+    data_ = owned_.data();
+    size_ = owned_.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            map_ = p;
+            data_ = static_cast<const char*>(p);
+            size_ = static_cast<size_t>(st.st_size);
+        }
+    }
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (map_) {
+        ::munmap(map_, size_);
+    }
+#endif
+}
+
+std::vector<std::string_view> split_lines(std::string_view data, size_t parts) {
+    std::vector<std::string_view> chunks;
+    if (data.empty()) return chunks;
+    parts = std::max<size_t>(1, parts);
+    const size_t target = data.size() / parts + 1;
+    size_t begin = 0;
+    while (begin < data.size()) {
+        size_t end = std::min(data.size(), begin + target);
+        if (end < data.size()) {
+            size_t nl = data.find('\n', end);
+            end = (nl == std::string_view::npos) ? data.size() : nl + 1;
+        }
+        chunks.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+size_t worker_count(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threads;
+}
+
+void for_each_line(const std::vector<std::string>& files,
+                   size_t threads,
+                   const std::function<void(size_t worker, std::string_view line)>& fn) {
+    const size_t workers = worker_count(threads);
+    auto run_parallel = [workers](size_t tasks, const std::function<void(size_t worker, size_t task)>& body) {
+        std::atomic<size_t> next{0};
+        auto loop = [&](size_t worker) {
+            for (size_t t; (t = next.fetch_add(1, std::memory_order_relaxed)) < tasks;) {
+                body(worker, t);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (size_t w = 1; w < std::min(workers, tasks); ++w) {
+            pool.emplace_back(loop, w);
+        }
+        loop(0);
+        for (auto& t : pool) t.join();
+    };
+
+    // Open (and for .gz, inflate) the files in parallel, then scan ~4 chunks per worker
+    std::vector<std::unique_ptr<MappedFile>> mapped(files.size());
+    run_parallel(files.size(), [&](size_t, size_t i) {
+        mapped[i] = std::make_unique<MappedFile>(files[i]);
+    });
+
+    size_t total = 0;
+    for (const auto& m : mapped) total += m->data().size();
+    const size_t chunk_bytes = std::max<size_t>(1 << 20, total / (workers * 4) + 1);
+
+    std::vector<std::string_view> chunks;
+    for (const auto& m : mapped) {
+        auto parts = split_lines(m->data(), m->data().size() / chunk_bytes + 1);
+        chunks.insert(chunks.end(), parts.begin(), parts.end());
+    }
+
+    run_parallel(chunks.size(), [&](size_t worker, size_t c) {
+        std::string_view chunk = chunks[c];
+        size_t pos = 0;
+        while (pos < chunk.size()) {
+            size_t nl = chunk.find('\n', pos);
+            size_t end = (nl == std::string_view::npos) ? chunk.size() : nl;
+            if (end > pos) {
+                fn(worker, chunk.substr(pos, end - pos));
+            }
+            pos = end + 1;
+        }
+    });
+}
+
+namespace {
+
+// Position just past `"key":`, or npos
+size_t value_pos(std::string_view line, std::string_view key) {
+    size_t pos = 0;
+    while ((pos = line.find(key, pos)) != std::string_view::npos) {
+        const size_t end = pos + key.size();
+        if (pos > 0 && line[pos - 1] == '"' && end + 1 < line.size() && line[end] == '"' && line[end + 1] == ':') {
+            return end + 2;
+        }
+        pos = end;
+    }
+    return std::string_view::npos;
+}
+
+} // namespace
+
+std::optional<std::string_view> find_string(std::string_view line, std::string_view key) {
+    size_t pos = value_pos(line, key);
+    if (pos == std::string_view::npos || pos >= line.size() || line[pos] != '"') return std::nullopt;
+    const size_t begin = pos + 1;
+    for (size_t i = begin; i < line.size(); ++i) {
+        if (line[i] == '\\') {
+            ++i;
+        } else if (line[i] == '"') {
+            return line.substr(begin, i - begin);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<double> find_number(std::string_view line, std::string_view key) {
+    size_t pos = value_pos(line, key);
+    if (pos == std::string_view::npos) return std::nullopt;
+    double value = 0.0;
+    auto [ptr, ec] = std::from_chars(line.data() + pos, line.data() + line.size(), value);
+    if (ec != std::errc()) return std::nullopt;
+    return value;
+}
+
+bool has_key(std::string_view line, std::string_view key) {
+    return value_pos(line, key) != std::string_view::npos;
+}
+
+size_t count_lines(const std::string& path) {
+    MappedFile f(path);
+    std::string_view data = f.data();
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t nl = data.find('\n', pos);
+        size_t end = (nl == std::string_view::npos) ? data.size() : nl;
+        if (end > pos) ++count;
+        pos = end + 1;
+    }
+    return count;
+}
+
+std::vector<std::string> log_files(const std::string& path, uint64_t from_utc_ms, uint64_t to_utc_ms) {
+    return segments::SegmentedFile::find(path, from_utc_ms, to_utc_ms);
+}
+
+LatencyStats latency_stats(std::vector<double> samples) {
+    LatencyStats s;
+    s.count = samples.size();
+    if (samples.empty()) return s;
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    s.mean = sum / samples.size();
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    s.p50 = at(0.50);
+    s.p95 = at(0.95);
+    s.p99 = at(0.99);
+    s.max = samples.back();
+    return s;
+}
+
+AlertSummary summarize_alerts(const std::vector<std::string>& alert_files, size_t threads) {
+    struct Partial {
+        size_t alerts{0};
+        size_t missing_fields{0};
+        std::vector<double> latencies;
+        std::map<std::string, size_t, std::less<>> by_classification;
+        std::map<std::string, size_t, std::less<>> by_node;
+    };
+    auto partials = per_worker<Partial>(threads);
+
+    auto bump = [](std::map<std::string, size_t, std::less<>>& m, std::string_view key) {
+        auto it = m.find(key);
+        if (it == m.end()) it = m.emplace(std::string(key), 0).first;
+        ++it->second;
+    };
+
+    for_each_line(alert_files, threads, [&](size_t worker, std::string_view line) {
+        Partial& p = partials[worker];
+        ++p.alerts;
+        auto latency = find_number(line, "processing_latency_ms");
+        auto classification = find_string(line, "classification");
+        auto node = find_string(line, "source_node_id");
+        if (!latency || !classification || !node || !has_key(line, "event_id") || !has_key(line, "timestamp_utc")) {
+            ++p.missing_fields;
+        }
+        if (latency) p.latencies.push_back(*latency);
+        if (classification) bump(p.by_classification, *classification);
+        if (node) bump(p.by_node, *node);
+    });
+
+    AlertSummary out;
+    std::vector<double> latencies;
+    for (auto& p : partials) {
+        out.alerts += p.alerts;
+        out.missing_fields += p.missing_fields;
+        latencies.insert(latencies.end(), p.latencies.begin(), p.latencies.end());
+        for (auto& [k, v] : p.by_classification) out.by_classification[k] += v;
+        for (auto& [k, v] : p.by_node) out.by_node[k] += v;
+    }
+    out.latency = latency_stats(std::move(latencies));
+    return out;
+}
+
+JoinReport join_events(const std::vector<std::string>& sensor_files,
+                       const std::vector<std::string>& alert_files,
+                       size_t threads) {
+    // event_ids are compared by 64-bit hash; a collision needs billions of events
+    auto alert_parts = per_worker<std::vector<uint64_t>>(threads);
+    for_each_line(alert_files, threads, [&](size_t worker, std::string_view line) {
+        if (auto id = find_string(line, "event_id")) {
+            alert_parts[worker].push_back(fnv1a64(*id));
+        }
+    });
+
+    using EventsByNode = std::map<std::string, std::vector<uint64_t>, std::less<>>;
+    auto event_parts = per_worker<EventsByNode>(threads);
+    for_each_line(sensor_files, threads, [&](size_t worker, std::string_view line) {
+        if (find_string(line, "message") != std::string_view("Generated event")) return;
+        auto id = find_string(line, "event_id");
+        auto node = find_string(line, "node_id");
+        if (!id || !node) return;
+        auto& m = event_parts[worker];
+        auto it = m.find(*node);
+        if (it == m.end()) it = m.emplace(std::string(*node), std::vector<uint64_t>()).first;
+        it->second.push_back(fnv1a64(*id));
+    });
+
+    std::vector<uint64_t> alerts;
+    for (auto& part : alert_parts) alerts.insert(alerts.end(), part.begin(), part.end());
+    std::sort(alerts.begin(), alerts.end());
+
+    JoinReport report;
+    for (size_t i = 1; i < alerts.size(); ++i) {
+        if (alerts[i] == alerts[i - 1] && (i == 1 || alerts[i - 1] != alerts[i - 2])) {
+            ++report.duplicate_alerts;
+        }
+    }
+    alerts.erase(std::unique(alerts.begin(), alerts.end()), alerts.end());
+
+    std::vector<uint64_t> generated;
+    for (auto& part : event_parts) {
+        for (auto& [node, ids] : part) {
+            NodeLoss& loss = report.by_node[node];
+            for (uint64_t id : ids) {
+                ++loss.generated;
+                if (std::binary_search(alerts.begin(), alerts.end(), id)) ++loss.alerted;
+                generated.push_back(id);
+            }
+        }
+    }
+    for (const auto& [node, loss] : report.by_node) {
+        report.generated += loss.generated;
+        report.alerted += loss.alerted;
+    }
+    std::sort(generated.begin(), generated.end());
+    for (uint64_t id : alerts) {
+        if (!std::binary_search(generated.begin(), generated.end(), id)) ++report.unmatched_alerts;
+    }
+    return report;
+}
+
+size_t count_messages(const std::vector<std::string>& files, std::string_view message, size_t threads) {
+    auto counts = per_worker<size_t>(threads);
+    for_each_line(files, threads, [&](size_t worker, std::string_view line) {
+        if (find_string(line, "message") == message) ++counts[worker];
+    });
+    size_t total = 0;
+    for (size_t c : counts) total += c;
+    return total;
+}
+
+nlohmann::json to_json(const LatencyStats& s) {
+    return {{"count", s.count}, {"mean", s.mean}, {"p50", s.p50}, {"p95", s.p95}, {"p99", s.p99}, {"max", s.max}};
+}
+
+nlohmann::json to_json(const AlertSummary& s) {
+    return {
+        {"alerts", s.alerts},
+        {"missing_fields", s.missing_fields},
+        {"processing_latency_ms", to_json(s.latency)},
+        {"by_classification", s.by_classification},
+        {"by_node", s.by_node}
+    };
+}
+
+nlohmann::json to_json(const JoinReport& r) {
+    nlohmann::json nodes = nlohmann::json::object();
+    for (const auto& [node, loss] : r.by_node) {
+        nodes[node] = {{"generated", loss.generated}, {"alerted", loss.alerted}, {"loss_rate", loss.loss_rate()}};
+    }
+    return {
+        {"generated", r.generated},
+        {"alerted", r.alerted},
+        {"loss_rate", r.loss_rate()},
+        {"duplicate_alerts", r.duplicate_alerts},
+        {"unmatched_alerts", r.unmatched_alerts},
+        {"by_node", nodes}
+    };
+}
+
+} // namespace log_analysis
+} // namespace surveillance
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace surveillance {
+namespace log_analysis {
+
+// Read-only contents of one log file: memory-mapped for plain files, decompressed
+// into memory for rotated .gz segments. Empty if the file cannot be read.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view data() const { return {data_, size_}; }
+
+private:
+    const char* data_{nullptr};
+    size_t size_{0};
+    void* map_{nullptr};
+    std::string owned_;
+};
+
+// Splits `data` into at most `parts` chunks that start and end on line boundaries
+std::vector<std::string_view> split_lines(std::string_view data, size_t parts);
+
+// Calls fn(worker, line) for every non-empty line of the files, on `threads` workers
+// (0 = hardware concurrency). Lines of one chunk are visited in order by one worker;
+// `worker` indexes per-thread state so results can be merged without locks.
+void for_each_line(const std::vector<std::string>& files,
+                   size_t threads,
+                   const std::function<void(size_t worker, std::string_view line)>& fn);
+
+size_t worker_count(size_t threads);
+
+// Field scanner for the single-line JSON the components write (nlohmann dump: no
+// whitespace). Finds the first `"key":` anywhere in the line, nested objects
+// included, without parsing the rest. Strings are returned raw (escapes kept).
+std::optional<std::string_view> find_string(std::string_view line, std::string_view key);
+std::optional<double> find_number(std::string_view line, std::string_view key);
+bool has_key(std::string_view line, std::string_view key);
+
+// Non-empty lines of a plain file; cheap progress check while a run is still writing
+size_t count_lines(const std::string& path);
+
+// The live file plus its rotated segments overlapping [from_utc_ms, to_utc_ms], oldest first
+std::vector<std::string> log_files(const std::string& path,
+                                   uint64_t from_utc_ms = 0,
+                                   uint64_t to_utc_ms = UINT64_MAX);
+
+struct LatencyStats {
+    size_t count{0};
+    double mean{0.0};
+    double p50{0.0};
+    double p95{0.0};
+    double p99{0.0};
+    double max{0.0};
+};
+
+// Sorted-sample percentile: element floor(q * n), as the latency requirement defines it
+LatencyStats latency_stats(std::vector<double> samples);
+
+struct AlertSummary {
+    size_t alerts{0};
+    size_t missing_fields{0};               // alerts lacking any of the CentralAlert fields
+    LatencyStats latency;                   // processing_latency_ms
+    std::map<std::string, size_t> by_classification;
+    std::map<std::string, size_t> by_node;
+};
+
+AlertSummary summarize_alerts(const std::vector<std::string>& alert_files, size_t threads = 0);
+
+struct NodeLoss {
+    size_t generated{0};  // "Generated event" lines in the node's log (sampled if logging.sample_every_n > 1)
+    size_t alerted{0};    // of those, events that produced an alert
+    double loss_rate() const { return generated ? 1.0 - static_cast<double>(alerted) / generated : 0.0; }
+};
+
+struct JoinReport {
+    size_t generated{0};
+    size_t alerted{0};
+    size_t duplicate_alerts{0};             // event_ids with more than one alert
+    size_t unmatched_alerts{0};             // alerts for events not in the scanned sensor logs
+    std::map<std::string, NodeLoss> by_node;
+    double loss_rate() const { return generated ? 1.0 - static_cast<double>(alerted) / generated : 0.0; }
+};
+
+// Joins the sensors' generated events to central's alerts on event_id
+JoinReport join_events(const std::vector<std::string>& sensor_files,
+                       const std::vector<std::string>& alert_files,
+                       size_t threads = 0);
+
+// Lines whose "message" is `message`
+size_t count_messages(const std::vector<std::string>& files, std::string_view message, size_t threads = 0);
+
+nlohmann::json to_json(const LatencyStats& s);
+nlohmann::json to_json(const AlertSummary& s);
+nlohmann::json to_json(const JoinReport& r);
+
+} // namespace log_analysis
+} // namespace surveillance
@@ -0,0 +1,91 @@
+// Sends runtime control commands to running components over the control bus
+// (logging.control_endpoint, ICD §2.7). Components keep a SUB socket connected to
+// the endpoint; survctl binds it just long enough to collect their subscriptions
+// and publish one command.
+//
+// Usage: survctl [--config <path>] [--target <component|prefix*>] [--wait-ms <ms>] <command>
+//   log-level <debug|info|warn|error|off>
+//   log-sample <n>                  keep 1 in n lines at sampled call sites
+
+#include "config.hpp"
+#include "logging.hpp"
+#include "zmq_utils.hpp"
+
+#include <nlohmann/json.hpp>
+#include <zmq.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace surveillance;
+
+namespace {
+
+int usage() {
+    std::cerr << "Usage: survctl [--config <path>] [--target <component|prefix*>] [--wait-ms <ms>] <command>\n"
+                 "  log-level <debug|info|warn|error|off>\n"
+                 "  log-sample <n>\n";
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string config_path = "config/system_nominal.json";
+    std::string target = "*";
+    int wait_ms = 1000;
+    int i = 1;
+    for (; i + 1 < argc && std::string(argv[i]).rfind("--", 0) == 0; i += 2) {
+        std::string opt = argv[i];
+        if (opt == "--config") config_path = argv[i + 1];
+        else if (opt == "--target") target = argv[i + 1];
+        else if (opt == "--wait-ms") wait_ms = std::stoi(argv[i + 1]);
+        else return usage();
+    }
+    if (argc - i != 2) return usage();
+
+    std::string command = argv[i];
+    std::string value = argv[i + 1];
+    nlohmann::json msg = {{"msg_type", "LogControl"}, {"target", target}};
+    if (command == "log-level") {
+        if (!logging::parse_level(value)) return usage();
+        msg["level"] = value;
+    } else if (command == "log-sample") {
+        msg["sample_every_n"] = std::stoi(value);
+    } else {
+        return usage();
+    }
+
+    auto cfg = config::load(config_path);
+    if (cfg.logging.control_endpoint.empty()) {
+        std::cerr << "logging.control_endpoint is disabled in " << config_path << "\n";
+        return 1;
+    }
+
+    zmq::context_t ctx{1};
+    auto socket = zmq_utils::create_publisher(ctx, cfg.logging.control_endpoint, true);
+    // Report every subscription, not just the first per topic, so components can be counted
+    socket.set(zmq::sockopt::xpub_verbose, 1);
+
+    // Components reconnect within their reconnect interval; collect for the whole window
+    int subscribers = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        zmq::pollitem_t items[] = {{socket.handle(), 0, ZMQ_POLLIN, 0}};
+        if (zmq::poll(items, 1, std::chrono::milliseconds(10)) <= 0) continue;
+        zmq::message_t sub;
+        if (socket.recv(sub, zmq::recv_flags::dontwait) && sub.size() > 0 &&
+            static_cast<const uint8_t*>(sub.data())[0] == 1) {
+            ++subscribers;
+        }
+    }
+
+    zmq_utils::publish_json(socket, msg);
+    socket.set(zmq::sockopt::linger, 1000);
+    socket.close();
+
+    std::cout << "Sent " << msg.dump() << " to " << subscribers << " component(s)\n";
+    return subscribers > 0 ? 0 : 2;
+}
@@ -0,0 +1,161 @@
+// Merges the per-component trace_<component>.jsonl files of a run into one
+// Chrome/Perfetto trace (open in ui.perfetto.dev or chrome://tracing). Spans of the
+// same event are linked with flow arrows, and a per-hop summary is printed,
+// including the gaps between hops (ZMQ transfer and wake-up time).
+//
+// Usage: trace_merge <log_dir> [output.json]   (default output: <log_dir>/trace.json)
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct SpanRecord {
+    std::string name;
+    std::string event_id;
+    int pid;
+    uint32_t tid;
+    uint64_t ts_ns;
+    uint64_t dur_ns;
+};
+
+void print_stats(const std::string& name, std::vector<uint64_t> ns) {
+    if (ns.empty()) return;
+    std::sort(ns.begin(), ns.end());
+    double sum = 0.0;
+    for (auto v : ns) sum += static_cast<double>(v);
+    auto at = [&ns](double q) {
+        return ns[std::min(ns.size() - 1, static_cast<size_t>(q * ns.size()))] / 1000.0;
+    };
+    std::printf("%-48s n=%-7zu mean=%10.1f us  p50=%10.1f us  p99=%10.1f us\n",
+                name.c_str(), ns.size(), sum / ns.size() / 1000.0, at(0.50), at(0.99));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: trace_merge <log_dir> [output.json]\n";
+        return 1;
+    }
+    fs::path log_dir = argv[1];
+    fs::path out_path = argc > 2 ? fs::path(argv[2]) : log_dir / "trace.json";
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(log_dir)) {
+        auto name = entry.path().filename().string();
+        if (name.rfind("trace_", 0) == 0 && entry.path().extension() == ".jsonl") {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        std::cerr << "No trace_*.jsonl files in " << log_dir << "\n";
+        return 1;
+    }
+
+    nlohmann::json events = nlohmann::json::array();
+    std::vector<SpanRecord> spans;
+    int pid = 0;
+    for (const auto& path : files) {
+        ++pid;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            nlohmann::json j;
+            try {
+                j = nlohmann::json::parse(line);
+            } catch (const nlohmann::json::exception&) {
+                continue; // Truncated last line of a killed process
+            }
+            if (j.contains("component")) {
+                events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", pid},
+                                  {"args", {{"name", j["component"]}}}});
+            } else if (j.contains("thread_name")) {
+                events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", j["tid"]},
+                                  {"args", {{"name", j["thread_name"]}}}});
+            } else if (j.contains("ts_ns")) {
+                spans.push_back({j.value("name", ""), j.value("event_id", ""), pid,
+                                 j.value("tid", 0u), j["ts_ns"].get<uint64_t>(), j.value("dur_ns", 0ULL)});
+            }
+        }
+    }
+
+    uint64_t base_ns = std::numeric_limits<uint64_t>::max();
+    for (const auto& s : spans) base_ns = std::min(base_ns, s.ts_ns);
+
+    std::map<std::string, std::vector<const SpanRecord*>> by_event;
+    for (const auto& s : spans) {
+        events.push_back({
+            {"name", s.name},
+            {"cat", "hop"},
+            {"ph", "X"},
+            {"ts", (s.ts_ns - base_ns) / 1000.0},
+            {"dur", s.dur_ns / 1000.0},
+            {"pid", s.pid},
+            {"tid", s.tid},
+            {"args", {{"event_id", s.event_id}}}
+        });
+        by_event[s.event_id].push_back(&s);
+    }
+
+    // Flow arrows along each event's path, plus hop and inter-hop statistics
+    std::map<std::string, std::vector<uint64_t>> hop_ns;
+    std::map<std::string, std::vector<uint64_t>> gap_ns;
+    std::vector<uint64_t> end_to_end_ns;
+    uint64_t flow_id = 0;
+    for (auto& [event_id, path] : by_event) {
+        std::sort(path.begin(), path.end(), [](const SpanRecord* a, const SpanRecord* b) {
+            return a->ts_ns < b->ts_ns;
+        });
+        ++flow_id;
+        for (size_t i = 0; i < path.size(); ++i) {
+            const SpanRecord* s = path[i];
+            hop_ns[s->name].push_back(s->dur_ns);
+            if (path.size() > 1) {
+                const char* ph = i == 0 ? "s" : (i + 1 == path.size() ? "f" : "t");
+                nlohmann::json flow = {{"name", "event"}, {"cat", "flow"}, {"ph", ph}, {"id", flow_id},
+                                       {"ts", (s->ts_ns - base_ns) / 1000.0}, {"pid", s->pid}, {"tid", s->tid}};
+                if (ph[0] != 's') flow["bp"] = "e";
+                events.push_back(std::move(flow));
+            }
+            if (i > 0) {
+                // Only gaps between sequential hops; nested spans (e.g. alert write) overlap
+                const SpanRecord* prev = path[i - 1];
+                uint64_t prev_end = prev->ts_ns + prev->dur_ns;
+                if (s->ts_ns >= prev_end) {
+                    gap_ns[prev->name + " -> " + s->name].push_back(s->ts_ns - prev_end);
+                }
+            }
+        }
+        const SpanRecord* first = path.front();
+        uint64_t last_end = 0;
+        for (const auto* s : path) last_end = std::max(last_end, s->ts_ns + s->dur_ns);
+        end_to_end_ns.push_back(last_end - first->ts_ns);
+    }
+
+    std::ofstream out(out_path);
+    out << nlohmann::json{{"traceEvents", events}, {"displayTimeUnit", "ns"}}.dump() << "\n";
+
+    std::printf("Merged %zu spans of %zu events from %zu files into %s\n\n",
+                spans.size(), by_event.size(), files.size(), out_path.string().c_str());
+    std::printf("Hops:\n");
+    for (auto& [name, ns] : hop_ns) print_stats(name, ns);
+    std::printf("\nBetween hops:\n");
+    for (auto& [name, ns] : gap_ns) print_stats(name, ns);
+    std::printf("\n");
+    print_stats("end to end (first span start -> last span end)", end_to_end_ns);
+    return 0;
+}